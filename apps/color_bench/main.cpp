@@ -0,0 +1,175 @@
+#include "colorspan.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+using namespace mssm;
+
+namespace {
+
+constexpr int width = 1920;
+constexpr int height = 1080;
+constexpr int repeats = 20;
+
+// x / 255, rounded, as colorspan rounds it
+uint32_t div255(uint32_t x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// best of repeats runs, in milliseconds.  reset restores the input first,
+// outside the timing
+double timeMs(const std::function<void()>& reset, const std::function<void()>& op)
+{
+    double best = 1e300;
+    for (int i = 0; i < repeats; i++) {
+        reset();
+        auto start = std::chrono::steady_clock::now();
+        op();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+struct Bench {
+    std::vector<Color> input;
+    std::vector<Color> other;
+    std::vector<Color> loopOut;
+    std::vector<Color> spanOut;
+
+    void run(const char* name,
+             const std::function<void(std::vector<Color>&)>& loop,
+             const std::function<void(std::vector<Color>&)>& span)
+    {
+        double loopMs = timeMs([&] { loopOut = input; }, [&] { loop(loopOut); });
+        double spanMs = timeMs([&] { spanOut = input; }, [&] { span(spanOut); });
+        std::printf("%-14s %8.3f ms %8.3f ms %6.1fx  %s\n", name, loopMs, spanMs, loopMs / spanMs,
+                    loopOut == spanOut ? "" : "DIFFERENT");
+    }
+};
+
+}
+
+int main()
+{
+    std::mt19937 rng(12345);
+    auto randomColors = [&] {
+        std::vector<Color> colors(width * height);
+        for (Color& c : colors) {
+            uint32_t x = rng();
+            c = Color(uint8_t(x), uint8_t(x >> 8), uint8_t(x >> 16), uint8_t(x >> 24));
+        }
+        return colors;
+    };
+
+    Bench bench{randomColors(), randomColors(), {}, {}};
+    const std::vector<Color>& other = bench.other;
+    const Color tint(255, 128, 0, 100);
+
+    std::printf("%d x %d colors, best of %d\n", width, height, repeats);
+    std::printf("%-14s %11s %11s %7s\n", "", "loop", "colorspan", "");
+
+    bench.run("fill",
+        [&](auto& v) { for (Color& c : v) { c = tint; } },
+        [&](auto& v) { colorspan::fill(v, tint); });
+
+    bench.run("blend color",
+        [&](auto& v) {
+            uint32_t a = tint.a;
+            uint32_t na = 255 - a;
+            for (Color& c : v) {
+                c.r = div255(tint.r * a + c.r * na);
+                c.g = div255(tint.g * a + c.g * na);
+                c.b = div255(tint.b * a + c.b * na);
+                c.a = div255(255 * a + c.a * na);
+            }
+        },
+        [&](auto& v) { colorspan::blend(v, tint); });
+
+    bench.run("blend colors",
+        [&](auto& v) {
+            for (size_t i = 0; i < v.size(); i++) {
+                Color s = other[i];
+                uint32_t a = s.a;
+                uint32_t na = 255 - a;
+                v[i].r = div255(s.r * a + v[i].r * na);
+                v[i].g = div255(s.g * a + v[i].g * na);
+                v[i].b = div255(s.b * a + v[i].b * na);
+                v[i].a = div255(255 * a + v[i].a * na);
+            }
+        },
+        [&](auto& v) { colorspan::blend(v, other); });
+
+    bench.run("lerp",
+        [&](auto& v) {
+            uint32_t w = 77; // 0.3
+            for (size_t i = 0; i < v.size(); i++) {
+                Color a = v[i];
+                Color b = other[i];
+                v[i] = Color(uint8_t(div255(a.r * (255 - w) + b.r * w)), uint8_t(div255(a.g * (255 - w) + b.g * w)),
+                             uint8_t(div255(a.b * (255 - w) + b.b * w)), uint8_t(div255(a.a * (255 - w) + b.a * w)));
+            }
+        },
+        [&](auto& v) { colorspan::lerp(v, v, other, 0.3); });
+
+    bench.run("premultiply",
+        [&](auto& v) {
+            for (Color& c : v) {
+                c.r = div255(c.r * c.a);
+                c.g = div255(c.g * c.a);
+                c.b = div255(c.b * c.a);
+            }
+        },
+        [&](auto& v) { colorspan::premultiply(v); });
+
+    bench.run("unpremultiply",
+        [&](auto& v) {
+            for (Color& c : v) {
+                if (c.a != 255) {
+                    uint32_t s = c.a ? ((255u << 16) + c.a / 2) / c.a : 0;
+                    c.r = std::min<uint32_t>(255, (c.r * s + 0x8000) >> 16);
+                    c.g = std::min<uint32_t>(255, (c.g * s + 0x8000) >> 16);
+                    c.b = std::min<uint32_t>(255, (c.b * s + 0x8000) >> 16);
+                }
+            }
+        },
+        [&](auto& v) { colorspan::unpremultiply(v); });
+
+    bench.run("swap r and b",
+        [&](auto& v) { for (Color& c : v) { std::swap(c.r, c.b); } },
+        [&](auto& v) { colorspan::swizzle(v, {2, 1, 0, 3}); });
+
+    bench.run("gamma 2.2",
+        [&](auto& v) {
+            for (Color& c : v) {
+                c.r = uint8_t(std::lround(std::pow(c.r / 255.0, 2.2) * 255));
+                c.g = uint8_t(std::lround(std::pow(c.g / 255.0, 2.2) * 255));
+                c.b = uint8_t(std::lround(std::pow(c.b / 255.0, 2.2) * 255));
+            }
+        },
+        [&](auto& v) { colorspan::applyGamma(v, 2.2); });
+
+    std::vector<ColorHSV> hsv(width * height, ColorHSV(0, 0, 0));
+    bench.run("HSV and back",
+        [&](auto& v) {
+            for (size_t i = 0; i < v.size(); i++) {
+                hsv[i] = ColorHSV(v[i]);
+            }
+            for (size_t i = 0; i < v.size(); i++) {
+                v[i] = hsv[i];
+            }
+        },
+        [&](auto& v) {
+            colorspan::toHSV(v, hsv);
+            colorspan::fromHSV(hsv, v);
+        });
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include "csvreader.h"
+#include "csvwriter.h"
+
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+// Writes CSV with CsvWriter and reads it back with CsvReader, with buffers
+// small enough that every row crosses a buffer boundary or two, with and
+// without the background flush thread.
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what)
+{
+    std::printf("%s  %s\n", ok ? "ok    " : "FAILED", what.c_str());
+    if (!ok) {
+        failures++;
+    }
+}
+
+std::string modeName(bool background, size_t bufferSize)
+{
+    return (background ? "background, " : "direct, ") + std::to_string(bufferSize) + " byte buffer";
+}
+
+// random fields made mostly of the characters that need quoting
+bool stringsRoundTrip(const std::string& path, bool background, size_t bufferSize, std::mt19937& rng)
+{
+    static const char alphabet[] = "ab ,\"\n\r\t1xyz";
+
+    for (int i = 0; i < 200; i++) {
+        size_t columns = rng() % 4 + 1;
+        std::vector<std::vector<std::string>> rows(rng() % 30 + 1);
+        for (auto& row : rows) {
+            for (size_t c = 0; c < columns; c++) {
+                std::string field;
+                for (size_t n = rng() % 10; n > 0; n--) {
+                    field += alphabet[rng() % (sizeof(alphabet) - 1)];
+                }
+                row.push_back(field);
+            }
+        }
+        if (columns == 1) {
+            // a row of one empty field is a blank line, which reads back as no fields
+            for (auto& row : rows) {
+                row[0] += "x";
+            }
+        }
+
+        {
+            CsvWriter writer(path, background, bufferSize);
+            for (auto& row : rows) {
+                writer.WriteLine(row);
+            }
+        }
+
+        CsvReader reader(path, false);
+        if (reader.read(false) != rows || reader.SyntaxError()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// doubles come back bit for bit, integers exactly
+bool numbersRoundTrip(const std::string& path, bool background, size_t bufferSize)
+{
+    constexpr int count = 20000;
+
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> real(-1e6, 1e6);
+    std::vector<double> doubles;
+    std::vector<long long> integers;
+    for (int i = 0; i < count; i++) {
+        doubles.push_back(i % 3 == 0 ? real(rng) * 1e-300 : real(rng));
+        integers.push_back(static_cast<long long>(rng()));
+    }
+
+    {
+        CsvWriter writer(path, background, bufferSize);
+        for (int i = 0; i < count; i++) {
+            writer.WriteRow(i, doubles[i], "name, " + std::to_string(i), integers[i]);
+        }
+    }
+
+    CsvReader reader(path, false);
+    std::vector<std::string> row;
+    int rows = 0;
+    while (reader.readLine(row)) {
+        if (rows >= count || row.size() != 4) {
+            return false;
+        }
+        double d = 0;
+        long long n = 0;
+        std::from_chars(row[1].data(), row[1].data() + row[1].size(), d);
+        std::from_chars(row[3].data(), row[3].data() + row[3].size(), n);
+        if (row[0] != std::to_string(rows) || d != doubles[rows] || row[2] != "name, " + std::to_string(rows) || n != integers[rows]) {
+            return false;
+        }
+        rows++;
+    }
+    return rows == count;
+}
+
+// everything written before Flush() is in the file while the writer is still open
+bool flushWritesEverything(const std::string& path, bool background, size_t bufferSize)
+{
+    CsvWriter writer(path, background, bufferSize);
+    std::vector<std::vector<std::string>> rows;
+    for (int i = 0; i < 500; i++) {
+        rows.push_back({ std::to_string(i), "row \"" + std::to_string(i) + "\"" });
+        writer.WriteLine(rows.back());
+    }
+    writer.Flush();
+
+    CsvReader reader(path, false);
+    return reader.read(false) == rows;
+}
+
+}
+
+int main()
+{
+    std::string path = (std::filesystem::temp_directory_path() / "csv_roundtrip.csv").string();
+
+    std::mt19937 rng(12345);
+    for (bool background : { false, true }) {
+        for (size_t bufferSize : { size_t(64), size_t(100), size_t(1) << 20 }) {
+            std::string mode = modeName(background, bufferSize);
+            check(stringsRoundTrip(path, background, bufferSize, rng), "strings, " + mode);
+            check(numbersRoundTrip(path, background, bufferSize), "numbers, " + mode);
+            check(flushWritesEverything(path, background, bufferSize), "flush, " + mode);
+        }
+    }
+
+    std::filesystem::remove(path);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,239 @@
+#include "dxfcanvas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Draws the same scene (lines, circles, arcs and ellipses on the default layer
+// and two named ones) with DXFCanvas in Document and Streaming modes, and
+// checks the two files describe the same drawing: the same header variables,
+// layer table and entities, in the same order.
+//
+// Entity handles are numbered by each mode separately, and readers don't care
+// about the order of the records within an entity, so neither is compared.
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char* what)
+{
+    std::printf("%s  %s\n", ok ? "ok    " : "FAILED", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+using Group = std::pair<int, std::string>;
+
+struct Entity {
+    std::string type;
+    std::vector<Group> groups; // sorted by code, handle left out
+};
+
+struct Drawing {
+    std::vector<std::string> lines;
+    std::map<std::string, std::vector<Group>> header;
+    std::map<std::string, std::vector<Group>> layers;
+    std::vector<Entity> entities;
+};
+
+std::string trimmed(const std::string& s)
+{
+    size_t first = s.find_first_not_of(" \t\r");
+    size_t last = s.find_last_not_of(" \t\r");
+    return first == std::string::npos ? "" : s.substr(first, last - first + 1);
+}
+
+// numbers compare by value, to the six significant digits both modes write
+bool sameValue(const std::string& a, const std::string& b)
+{
+    if (a == b) {
+        return true;
+    }
+    char* endA;
+    char* endB;
+    double x = std::strtod(a.c_str(), &endA);
+    double y = std::strtod(b.c_str(), &endB);
+    if (a.empty() || b.empty() || *endA || *endB) {
+        return false;
+    }
+    return std::abs(x - y) <= 1e-5 * std::max(1.0, std::max(std::abs(x), std::abs(y)));
+}
+
+bool sameGroups(const std::vector<Group>& a, const std::vector<Group>& b)
+{
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const Group& x, const Group& y) {
+        return x.first == y.first && sameValue(x.second, y.second);
+    });
+}
+
+Drawing read(const std::filesystem::path& path)
+{
+    Drawing drawing;
+    std::ifstream in(path);
+    std::vector<Group> groups;
+    std::string code;
+    std::string value;
+    while (std::getline(in, code) && std::getline(in, value)) {
+        drawing.lines.push_back(code);
+        drawing.lines.push_back(value);
+        groups.emplace_back(std::atoi(code.c_str()), trimmed(value));
+    }
+
+    std::string section;
+    std::string table;
+    // the record collecting groups: a header variable, a layer or an entity
+    std::vector<Group>* current = nullptr;
+
+    for (const auto& [code, text] : groups) {
+        if (code == 0) {
+            current = nullptr;
+            if (text == "ENDSEC") {
+                section.clear();
+            }
+            else if (text == "ENDTAB") {
+                table.clear();
+            }
+            else if (section == "ENTITIES") {
+                drawing.entities.push_back({text, {}});
+                current = &drawing.entities.back().groups;
+            }
+            continue;
+        }
+        if (code == 2 && section.empty()) {
+            section = text;
+            continue;
+        }
+        if (section == "HEADER" && code == 9) {
+            current = &drawing.header[text];
+            continue;
+        }
+        if (section == "TABLES" && code == 2 && table.empty()) {
+            table = text;
+            continue;
+        }
+        if (table == "LAYER" && code == 2) {
+            current = &drawing.layers[text];
+            continue;
+        }
+        if (current && code != 5) {
+            current->emplace_back(code, text);
+        }
+    }
+
+    for (auto& e : drawing.entities) {
+        std::stable_sort(e.groups.begin(), e.groups.end(),
+                         [](const Group& a, const Group& b) { return a.first < b.first; });
+    }
+    for (auto& [name, layer] : drawing.layers) {
+        std::stable_sort(layer.begin(), layer.end(),
+                         [](const Group& a, const Group& b) { return a.first < b.first; });
+    }
+    return drawing;
+}
+
+// connected lines of one colour would be joined into a LWPOLYLINE when
+// streaming, so the lines here never share an end with the line before
+void scene(DXFCanvas& g)
+{
+    g.line({0, 0}, {100, 0});
+    g.line({0, 10}, {100, 10}, mssm::RED);
+    g.ellipse({50, 50}, 20, 20);
+    g.ellipse({50, 50}, 40, 20, mssm::BLUE);
+    g.ellipse({50, 50}, 10, 30.5, mssm::GREEN);
+    g.arc({50, 50}, 30, 30, -30, 90);
+    g.arc({50, 50}, 30, 30, 300, 120, mssm::YELLOW);
+
+    g.pushGroup("outline");
+    g.line({-1.5, -1.5}, {201.25, -1.5});
+    g.line({201.25, 0}, {201.25, 101.75}, mssm::CYAN);
+    g.arc({100, 50}, 80, 80, 0, 180);
+    g.popGroup();
+
+    g.pushGroup("holes");
+    for (int i = 0; i < 5; i++) {
+        g.ellipse({20.0 + i * 40, 80}, 12.5, 12.5);
+        g.ellipse({20.0 + i * 40, 20}, 16, 8, mssm::MAGENTA);
+    }
+    g.popGroup();
+
+    g.line({0, 100}, {0.333333333, 99.666666667});
+}
+
+// the first line where the files differ, for when they do
+void reportFirstDifference(const Drawing& a, const Drawing& b)
+{
+    size_t n = std::min(a.lines.size(), b.lines.size());
+    for (size_t i = 0; i < n; i++) {
+        if (a.lines[i] != b.lines[i]) {
+            std::printf("        first differing line %zu: \"%s\" and \"%s\"\n", i + 1, a.lines[i].c_str(),
+                        b.lines[i].c_str());
+            return;
+        }
+    }
+    if (a.lines.size() != b.lines.size()) {
+        std::printf("        one file is %zu lines, the other %zu\n", a.lines.size(), b.lines.size());
+    }
+}
+
+}
+
+int main()
+{
+    auto dir = std::filesystem::temp_directory_path();
+    auto documentPath = dir / "dxf_check_document.dxf";
+    auto streamingPath = dir / "dxf_check_streaming.dxf";
+    const std::vector<std::string> layers{"outline", "holes"};
+
+    {
+        DXFCanvas g(200, 100, documentPath.string(), DXFCanvas::Mode::Document, layers);
+        scene(g);
+        g.save();
+    }
+    {
+        DXFCanvas g(200, 100, streamingPath.string(), DXFCanvas::Mode::Streaming, layers);
+        scene(g);
+        g.save();
+    }
+
+    Drawing document = read(documentPath);
+    Drawing streaming = read(streamingPath);
+
+    std::printf("document %zu lines, streaming %zu lines\n", document.lines.size(), streaming.lines.size());
+    if (document.lines != streaming.lines) {
+        reportFirstDifference(document, streaming);
+    }
+
+    check(!document.entities.empty(), "the document file has entities");
+
+    check(document.header.size() == streaming.header.size() &&
+          std::equal(document.header.begin(), document.header.end(), streaming.header.begin(),
+                     [](const auto& a, const auto& b) { return a.first == b.first && sameGroups(a.second, b.second); }),
+          "the header variables match");
+
+    check(document.layers.size() == streaming.layers.size() &&
+          std::equal(document.layers.begin(), document.layers.end(), streaming.layers.begin(),
+                     [](const auto& a, const auto& b) { return a.first == b.first && sameGroups(a.second, b.second); }),
+          "the layer tables match");
+
+    bool entitiesMatch = document.entities.size() == streaming.entities.size();
+    for (size_t i = 0; entitiesMatch && i < document.entities.size(); i++) {
+        const Entity& a = document.entities[i];
+        const Entity& b = streaming.entities[i];
+        if (a.type != b.type || !sameGroups(a.groups, b.groups)) {
+            std::printf("        entity %zu: %s and %s differ\n", i, a.type.c_str(), b.type.c_str());
+            entitiesMatch = false;
+        }
+    }
+    check(entitiesMatch, "the entities match, in order");
+
+    return failures == 0 ? 0 : 1;
+}
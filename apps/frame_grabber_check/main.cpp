@@ -0,0 +1,143 @@
+#include "framegrabber.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Runs FrameGrabber over sources that need no camera: one that numbers its
+// frames, to check the triple buffering hands them over in order and loses
+// none without counting them, and the SyntheticFrameSource test pattern.
+
+namespace {
+
+using namespace std::chrono_literals;
+
+int failures = 0;
+
+void check(bool ok, const char* what)
+{
+    std::printf("%s  %s\n", ok ? "ok    " : "FAILED", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+// count frames, each filled with its own number (low byte first, repeated),
+// then nothing more
+class CountingSource : public FrameSource {
+    int w;
+    int h;
+    uint32_t count;
+    uint32_t next{0};
+public:
+    CountingSource(int width, int height, uint32_t count) : w{width}, h{height}, count{count} {}
+    int width() const override { return w; }
+    int height() const override { return h; }
+    bool grab(uint8_t* rgb, size_t size) override
+    {
+        if (next == count) {
+            std::this_thread::sleep_for(1ms);
+            return false;
+        }
+        std::this_thread::sleep_for(200us);
+        for (size_t i = 0; i < size; i++) {
+            rgb[i] = static_cast<uint8_t>(next >> (8 * (i % 3)));
+        }
+        next++;
+        return true;
+    }
+};
+
+uint32_t frameNumber(const mssm::Color& c)
+{
+    return c.r | (c.g << 8) | (c.b << 16);
+}
+
+bool convertsCorrectly()
+{
+    for (size_t n : { 0, 1, 5, 6, 7, 100, 1003 }) {
+        std::vector<uint8_t> rgb(n * 3);
+        for (size_t i = 0; i < rgb.size(); i++) {
+            rgb[i] = static_cast<uint8_t>(i * 7 + 3);
+        }
+        std::vector<mssm::Color> rgba(n + 1, mssm::Color(1, 2, 3, 4));
+        rgbToRgba(rgb.data(), rgba.data(), n);
+        for (size_t i = 0; i < n; i++) {
+            const mssm::Color& c = rgba[i];
+            if (c.r != rgb[i * 3] || c.g != rgb[i * 3 + 1] || c.b != rgb[i * 3 + 2] || c.a != 255) {
+                return false;
+            }
+        }
+        if (rgba[n] != mssm::Color(1, 2, 3, 4)) {
+            return false; // wrote past the end
+        }
+    }
+    return true;
+}
+
+}
+
+int main()
+{
+    check(convertsCorrectly(), "rgb to rgba, odd pixel counts, no overrun");
+
+    constexpr uint32_t frames = 2000;
+    constexpr int width = 64;
+    constexpr int height = 48;
+
+    FrameGrabber grabber(std::make_unique<CountingSource>(width, height, frames));
+    std::vector<mssm::Color> pixels(width * height);
+
+    uint64_t read = 0;
+    bool inOrder = true;
+    bool wholeFrames = true;
+    bool neverWaited = true;
+    int64_t last = -1;
+
+    auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (grabber.framesGrabbed() < frames && std::chrono::steady_clock::now() < deadline) {
+        auto start = std::chrono::steady_clock::now();
+        bool fresh = grabber.latest(pixels.data());
+        if (std::chrono::steady_clock::now() - start > 5ms) {
+            neverWaited = false;
+        }
+        if (fresh) {
+            read++;
+            int64_t n = frameNumber(pixels[0]);
+            inOrder = inOrder && n > last;
+            wholeFrames = wholeFrames && frameNumber(pixels.back()) == n;
+            last = n;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(read % 7 * 100));
+    }
+    // the last one, if it hasn't been read (it's counted just before it's handed over)
+    std::this_thread::sleep_for(20ms);
+    if (grabber.latest(pixels.data())) {
+        read++;
+        inOrder = inOrder && static_cast<int64_t>(frameNumber(pixels[0])) > last;
+    }
+
+    std::printf("frames grabbed %llu  read %llu  dropped %llu\n",
+                static_cast<unsigned long long>(grabber.framesGrabbed()),
+                static_cast<unsigned long long>(read),
+                static_cast<unsigned long long>(grabber.framesDropped()));
+
+    check(grabber.framesGrabbed() == frames, "every frame from the source is grabbed");
+    check(neverWaited, "latest() never waits for the grab thread");
+    check(inOrder, "frames are read in order");
+    check(wholeFrames, "frames are read whole");
+    check(read + grabber.framesDropped() == frames, "every frame is either read or counted as dropped");
+
+    SyntheticFrameSource bars(80, 4, 1000);
+    std::vector<uint8_t> first(80 * 4 * 3);
+    std::vector<uint8_t> second(first.size());
+    bool grabbed = bars.grab(first.data(), first.size()) && bars.grab(second.data(), second.size());
+    bool rowsMatch = std::memcmp(first.data(), first.data() + 80 * 3, 80 * 3 * 3) == 0;
+    bool scrolled = std::memcmp(second.data(), first.data() + 3, 79 * 3) == 0;
+    check(grabbed && rowsMatch && scrolled, "test pattern bars scroll one pixel a frame");
+    check(!bars.grab(first.data(), first.size() - 1), "test pattern refuses a buffer that's too small");
+
+    return failures == 0 ? 0 : 1;
+}
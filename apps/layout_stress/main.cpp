@@ -0,0 +1,120 @@
+#include "layoutcontainers.h"
+#include "layoutlabel.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Checks that incremental layout only re-measures what changed, on a tree of
+// 1000 rows of 4 labels (5001 elements): new properties redo everything, while
+// adding, removing or hiding a child only redoes its parent's path.
+
+namespace {
+
+// text measured as 8 pixels a character, without a window
+class CheckContext : public LayoutContext {
+    FontInfo font{20};
+public:
+    const FontInfo& defaultFont() const override { return font; }
+    void textExtents(const FontInfo&, const std::string& str, TextExtents& extents) override
+    {
+        extents.textWidth = str.size() * 8;
+        extents.fontHeight = 20;
+    }
+    double textWidth(const FontInfo&, const std::string& str) override { return str.size() * 8; }
+    std::vector<double> getCharacterXOffsets(const FontInfo&, double, const std::string&) override { return {}; }
+    std::vector<mssm::Event> events() override { return {}; }
+    Vec2d mouseDragStart(mssm::MouseButton) const override { return {}; }
+    double maxDragDistance(mssm::MouseButton) const override { return 0; }
+    void setCursor(mssm::CoreWindowCursor) override {}
+    mssm::CoreWindowCursor getCursor() const override { return {}; }
+    Vec2d mousePos() const override { return {}; }
+    void debugMouse(const RectI&, MouseEventReason, const MouseEvt&) override {}
+};
+
+int failures = 0;
+
+void check(bool ok, const char* what)
+{
+    std::printf("%s  %s\n", ok ? "ok    " : "FAILED", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+}
+
+int main()
+{
+    CheckContext context;
+
+    std::vector<LayoutPtr> rows;
+    std::vector<std::shared_ptr<LayoutStacked>> rowPtrs;
+    for (int i = 0; i < 1000; i++) {
+        std::vector<LayoutPtr> cells;
+        for (int j = 0; j < 4; j++) {
+            cells.push_back(LayoutLabel::make(&context, "cell " + std::to_string(i * 4 + j)));
+        }
+        auto row = LayoutStacked::make(&context, true, Justify::begin, CrossJustify::begin, cells);
+        rowPtrs.push_back(row);
+        rows.push_back(row);
+    }
+    auto root = LayoutStacked::make(&context, false, Justify::begin, CrossJustify::stretch, rows);
+    root->updateLayer(0, 0);
+
+    PropertyBag props;
+    RectI rect{{0, 0}, 1000, 30000};
+
+    auto layout = [&](const char* what, const PropertyBag& p) {
+        context.resetLayoutCounters();
+        root->resize(p, rect);
+        context.clearNeedsResize();
+        auto counters = context.getLayoutCounters();
+        std::printf("%-16s bounds %5llu  resized %5llu\n", what,
+                    static_cast<unsigned long long>(counters.boundsComputed),
+                    static_cast<unsigned long long>(counters.nodesResized));
+        return counters;
+    };
+
+    auto first = layout("first", props);
+    check(first.boundsComputed == 5000 && first.nodesResized == 5001, "the first layout measures everything");
+
+    auto clean = layout("clean", props);
+    check(clean.boundsComputed == 0 && clean.nodesResized == 0, "an unchanged tree does nothing");
+
+    rowPtrs[500]->setNeedsResize();
+    auto oneRow = layout("one row dirty", props);
+    check(oneRow.boundsComputed <= 2 && oneRow.nodesResized <= 2, "one dirty row only re-measures its path");
+
+    rect.width = 900;
+    auto narrower = layout("width change", props);
+    check(narrower.boundsComputed == 0 && narrower.nodesResized == 1001, "a new width re-arranges rows, not cells");
+
+    PropertyBag otherProps;
+    otherProps.setProperty(PropertyKeys::checked, true);
+    auto newProps = layout("new properties", otherProps);
+    check(newProps.boundsComputed == 5000, "different properties invalidate cached bounds");
+
+    // as LayoutExpander does every pass: a new bag, but with the same contents
+    auto rebuilt = layout("rebuilt props", props.withModification(PropertyKeys::checked, true));
+    check(rebuilt.boundsComputed == 0 && rebuilt.nodesResized == 0, "an equal bag built again keeps the cache");
+
+    auto extra = LayoutLabel::make(&context, "extra");
+    rowPtrs[10]->appendChild(extra);
+    check(!context.getNeedsFullResize() && context.getNeedsResize(), "adding a child only asks for a resize");
+    check(extra->getDepth() == rowPtrs[10]->getDepth() + 1, "an added child gets its parent's depth + 1");
+    auto added = layout("child added", otherProps);
+    check(added.boundsComputed <= 3 && added.nodesResized <= 3, "adding a child only re-measures its parent's path");
+
+    rowPtrs[20]->setCollapsed(true);
+    check(!context.getNeedsFullResize() && context.getNeedsResize(), "hiding a child only asks for a resize");
+    auto hidden = layout("child hidden", otherProps);
+    check(hidden.boundsComputed <= 1 && hidden.nodesResized <= 1001, "hiding a row re-arranges the rows, not their cells");
+
+    rowPtrs[30]->removeChild(0);
+    auto removed = layout("child removed", otherProps);
+    // the root, the row, and the three cells that moved up
+    check(removed.boundsComputed <= 2 && removed.nodesResized <= 5, "removing a child only re-measures its parent's path and moves its siblings");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+#include "rastercanvas.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Renders a fixed 1920x1080 UI scene with RasterCanvas on one thread and on
+// several, checks every run gives the same bytes, and prints the frame times.
+
+using namespace mssm;
+
+namespace {
+
+constexpr int width = 1920;
+constexpr int height = 1080;
+constexpr int repeats = 20;
+
+int failures = 0;
+
+void check(bool ok, const char* what)
+{
+    std::printf("%s  %s\n", ok ? "ok    " : "FAILED", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+// a window of widgets: a toolbar of buttons, a list of text rows, a panel of
+// controls, a translucent popup and a clipped chart
+void scene(Canvas2d& g)
+{
+    g.setBackground(Color(30, 30, 36));
+
+    g.rect({0, 0}, width, 48, TRANSPARENT, Color(45, 45, 55));
+    for (int i = 0; i < 10; i++) {
+        double x = 12 + i * 132;
+        g.rect({x + 0.5, 8.5}, 120, 32, Color(90, 90, 110), Color(60, 90, 160));
+        g.text({x + 60, 24}, FontInfo(16), "Button " + std::to_string(i), WHITE, HAlign::center, VAlign::center);
+    }
+
+    for (int r = 0; r < 40; r++) {
+        double y = 60 + r * 24;
+        g.rect({12, y}, 700, 24, TRANSPARENT, r % 2 ? Color(38, 38, 46) : Color(34, 34, 40));
+        g.text({20, y + 17}, FontInfo(14), "Row " + std::to_string(r) + ": The quick brown fox jumps over the lazy dog",
+               Color(220, 220, 220), HAlign::left, VAlign::baseline);
+    }
+
+    // sliders and check boxes
+    for (int i = 0; i < 8; i++) {
+        double y = 80 + i * 60;
+        g.rect({760, y}, 400, 6, TRANSPARENT, Color(80, 80, 90));
+        g.ellipse({760 + 50.0 * i, y + 3}, 18, 18, WHITE, Color(100, 160, 255));
+        g.rect({1200.5, y - 8.5}, 20, 20, WHITE, i % 2 ? Color(100, 160, 255) : TRANSPARENT);
+        g.polyline({{1204, y + 1}, {1210, y + 7}, {1218, y - 5}}, WHITE);
+    }
+
+    // a chart, clipped to its frame
+    g.rect({760, 580}, 800, 440, Color(90, 90, 110), Color(24, 24, 30));
+    g.pushClip(760, 580, 800, 440, false);
+    std::vector<Vec2d> curve;
+    for (int i = 0; i <= 200; i++) {
+        curve.push_back({740 + i * 4.3, 800 - 180 * std::sin(i * 0.07) * std::cos(i * 0.013)});
+    }
+    g.polyline(curve, Color(255, 200, 0));
+    g.pie({1400, 700}, 160, 160, 0.3, 4, TRANSPARENT, Color(0, 200, 100, 160));
+    g.arc({1400, 700}, 200, 200, 0.3, 4, RED);
+    g.popClip();
+
+    // a popup over everything, with a star icon
+    g.rect({1300.25, 120.75}, 500, 360, WHITE, Color(20, 20, 20, 200));
+    std::vector<Vec2d> star;
+    for (int i = 0; i < 10; i++) {
+        double r = i % 2 ? 40 : 100;
+        star.push_back({1550 + r * std::cos(i * M_PI / 5), 300 + r * std::sin(i * M_PI / 5)});
+    }
+    g.polygon(star, WHITE, Color(255, 220, 0, 220));
+    g.text({1550, 450}, FontInfo(20), "Saved", WHITE, HAlign::center, VAlign::baseline);
+}
+
+// renders the scene repeats times; returns the best time per frame, in ms
+double render(std::vector<Color>& pixels, unsigned threads)
+{
+    pixels.assign(width * height, Color{});
+    RasterCanvas g(pixels.data(), width, height, threads);
+    scene(g);
+    g.flush(); // loads the fonts, and builds the atlas
+
+    double best = 1e30;
+    for (int i = 0; i < repeats; i++) {
+        auto start = std::chrono::steady_clock::now();
+        scene(g);
+        g.flush();
+        std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+        best = std::min(best, ms.count());
+    }
+    return best;
+}
+
+bool same(const std::vector<Color>& a, const std::vector<Color>& b)
+{
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(Color)) == 0;
+}
+
+}
+
+int main()
+{
+    unsigned cores = std::max(2u, std::thread::hardware_concurrency());
+
+    std::vector<Color> single;
+    std::vector<Color> two;
+    std::vector<Color> all;
+
+    try {
+        std::printf("%d x %d UI scene, best of %d\n", width, height, repeats);
+        double singleMs = render(single, 1);
+        std::printf("%2u thread   %8.3f ms\n", 1u, singleMs);
+        double twoMs = render(two, 2);
+        std::printf("%2u threads  %8.3f ms  %5.1fx\n", 2u, twoMs, singleMs / twoMs);
+        double allMs = render(all, cores);
+        std::printf("%2u threads  %8.3f ms  %5.1fx\n", cores, allMs, singleMs / allMs);
+    }
+    catch (const std::exception& e) {
+        std::printf("FAILED  %s\n", e.what());
+        return 1;
+    }
+
+    check(std::any_of(single.begin(), single.end(), [](Color c) { return c.r != 30 || c.g != 30 || c.b != 36; }),
+          "the scene draws over the background");
+    check(same(single, two), "two threads give the same bytes as one");
+    check(same(single, all), "one thread per core gives the same bytes as one");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+#include "canvasDisplayList.h"
+#include "image.h"
+
+void DisplayList::replay(mssm::Canvas2d &g) const
+{
+    for (const auto& op : ops) {
+        op(g);
+    }
+}
+
+// every drawing call goes through record: it is applied to the wrapped canvas
+// and then kept for replay
+void DisplayListRecorder::record(std::function<void (mssm::Canvas2d &)> op)
+{
+    op(*canvas);
+    list.ops.push_back(std::move(op));
+}
+
+void DisplayListRecorder::setBackground(mssm::Color c) {
+    record([c](mssm::Canvas2d& g) { g.setBackground(c); });
+}
+
+void DisplayListRecorder::line(Vec2d p1, Vec2d p2, mssm::Color c) {
+    record([p1, p2, c](mssm::Canvas2d& g) { g.line(p1, p2, c); });
+}
+
+void DisplayListRecorder::ellipse(Vec2d center, double w, double h, mssm::Color c, mssm::Color f) {
+    record([=](mssm::Canvas2d& g) { g.ellipse(center, w, h, c, f); });
+}
+
+void DisplayListRecorder::arc(Vec2d center, double w, double h, double a, double alen, mssm::Color c) {
+    record([=](mssm::Canvas2d& g) { g.arc(center, w, h, a, alen, c); });
+}
+
+void DisplayListRecorder::chord(Vec2d center, double w, double h, double a, double alen, mssm::Color c, mssm::Color f) {
+    record([=](mssm::Canvas2d& g) { g.chord(center, w, h, a, alen, c, f); });
+}
+
+void DisplayListRecorder::pie(Vec2d center, double w, double h, double a, double alen, mssm::Color c, mssm::Color f) {
+    record([=](mssm::Canvas2d& g) { g.pie(center, w, h, a, alen, c, f); });
+}
+
+void DisplayListRecorder::rect(Vec2d corner, double w, double h, mssm::Color c, mssm::Color f) {
+    record([=](mssm::Canvas2d& g) { g.rect(corner, w, h, c, f); });
+}
+
+void DisplayListRecorder::polygon(const std::vector<Vec2d> &points, mssm::Color border, mssm::Color fill) {
+    record([points, border, fill](mssm::Canvas2d& g) { g.polygon(points, border, fill); });
+}
+
+void DisplayListRecorder::polyline(const std::vector<Vec2d> &points, mssm::Color color) {
+    record([points, color](mssm::Canvas2d& g) { g.polyline(points, color); });
+}
+
+void DisplayListRecorder::points(const std::vector<Vec2d> &points, mssm::Color c) {
+    record([points, c](mssm::Canvas2d& g) { g.points(points, c); });
+}
+
+void DisplayListRecorder::polygon(std::initializer_list<Vec2d> points, mssm::Color border, mssm::Color fill) {
+    polygon(std::vector<Vec2d>(points), border, fill);
+}
+
+void DisplayListRecorder::polyline(std::initializer_list<Vec2d> points, mssm::Color color) {
+    polyline(std::vector<Vec2d>(points), color);
+}
+
+void DisplayListRecorder::points(std::initializer_list<Vec2d> points, mssm::Color c) {
+    this->points(std::vector<Vec2d>(points), c);
+}
+
+#ifdef SUPPORT_MSSM_ARRAY
+void DisplayListRecorder::polygon(const mssm::Array<Vec2d>& points, mssm::Color border, mssm::Color fill) {
+    record([points, border, fill](mssm::Canvas2d& g) { g.polygon(points, border, fill); });
+}
+
+void DisplayListRecorder::polyline(const mssm::Array<Vec2d>& points, mssm::Color color) {
+    record([points, color](mssm::Canvas2d& g) { g.polyline(points, color); });
+}
+
+void DisplayListRecorder::points(const mssm::Array<Vec2d>& points, mssm::Color c) {
+    record([points, c](mssm::Canvas2d& g) { g.points(points, c); });
+}
+#endif // SUPPORT_MSSM_ARRAY
+
+void DisplayListRecorder::text(Vec2d pos, const FontInfo &sizeAndFace, const std::string &str,
+                               mssm::Color textcolor, HAlign hAlign, VAlign vAlign) {
+    record([=](mssm::Canvas2d& g) { g.text(pos, sizeAndFace, str, textcolor, hAlign, vAlign); });
+}
+
+void DisplayListRecorder::point(Vec2d pos, mssm::Color c) {
+    record([pos, c](mssm::Canvas2d& g) { g.point(pos, c); });
+}
+
+// images are captured by value: mssm::Image copies share the underlying texture
+
+void DisplayListRecorder::image(Vec2d pos, const mssm::Image &img, double alpha) {
+    record([pos, img, alpha](mssm::Canvas2d& g) { g.image(pos, img, alpha); });
+}
+
+void DisplayListRecorder::image(Vec2d pos, const mssm::Image &img, Vec2d src, int srcw, int srch, double alpha) {
+    record([=](mssm::Canvas2d& g) { g.image(pos, img, src, srcw, srch, alpha); });
+}
+
+void DisplayListRecorder::image(Vec2d pos, double w, double h, const mssm::Image &img, double alpha) {
+    record([=](mssm::Canvas2d& g) { g.image(pos, w, h, img, alpha); });
+}
+
+void DisplayListRecorder::image(Vec2d pos, double w, double h, const mssm::Image &img, Vec2d src, int srcw, int srch, double alpha) {
+    record([=](mssm::Canvas2d& g) { g.image(pos, w, h, img, src, srcw, srch, alpha); });
+}
+
+void DisplayListRecorder::imageC(Vec2d center, double angle, const mssm::Image &img, double alpha) {
+    record([=](mssm::Canvas2d& g) { g.imageC(center, angle, img, alpha); });
+}
+
+void DisplayListRecorder::imageC(Vec2d center, double angle, const mssm::Image &img, Vec2d src, int srcw, int srch, double alpha) {
+    record([=](mssm::Canvas2d& g) { g.imageC(center, angle, img, src, srcw, srch, alpha); });
+}
+
+void DisplayListRecorder::imageC(Vec2d center, double angle, double w, double h, const mssm::Image &img, double alpha) {
+    record([=](mssm::Canvas2d& g) { g.imageC(center, angle, w, h, img, alpha); });
+}
+
+void DisplayListRecorder::imageC(Vec2d center, double angle, double w, double h, const mssm::Image &img,
+                                 Vec2d src, int srcw, int srch, double alpha) {
+    record([=](mssm::Canvas2d& g) { g.imageC(center, angle, w, h, img, src, srcw, srch, alpha); });
+}
+
+void DisplayListRecorder::pushClip(int x, int y, int w, int h, bool replace) {
+    record([=](mssm::Canvas2d& g) { g.pushClip(x, y, w, h, replace); });
+}
+
+void DisplayListRecorder::popClip() {
+    record([](mssm::Canvas2d& g) { g.popClip(); });
+}
+
+void DisplayListRecorder::setClip(int x, int y, int w, int h) {
+    record([=](mssm::Canvas2d& g) { g.setClip(x, y, w, h); });
+}
+
+void DisplayListRecorder::resetClip() {
+    record([](mssm::Canvas2d& g) { g.resetClip(); });
+}
+
+void DisplayListRecorder::setViewport(int x, int y, int w, int h) {
+    record([=](mssm::Canvas2d& g) { g.setViewport(x, y, w, h); });
+}
+
+void DisplayListRecorder::resetViewport() {
+    record([](mssm::Canvas2d& g) { g.resetViewport(); });
+}
+
+void DisplayListRecorder::pushGroup(std::string groupName) {
+    record([groupName](mssm::Canvas2d& g) { g.pushGroup(groupName); });
+}
+
+void DisplayListRecorder::popGroup() {
+    record([](mssm::Canvas2d& g) { g.popGroup(); });
+}
+
+void DisplayListRecorder::polygonPattern(const std::vector<Vec2d> &points, mssm::Color c, mssm::Color f) {
+    record([points, c, f](mssm::Canvas2d& g) { g.polygonPattern(points, c, f); });
+}
+
+void DisplayListRecorder::polygonPattern(std::initializer_list<Vec2d> points, mssm::Color c, mssm::Color f) {
+    polygonPattern(std::vector<Vec2d>(points), c, f);
+}
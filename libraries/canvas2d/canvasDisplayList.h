@@ -0,0 +1,90 @@
+#ifndef CANVASDISPLAYLIST_H
+#define CANVASDISPLAYLIST_H
+
+#include <functional>
+#include <vector>
+#include "canvas2d.h"
+
+// A recorded sequence of canvas drawing calls that can be replayed later
+// (clips and groups included).  Queries such as textWidth are not recorded.
+class DisplayList
+{
+    friend class DisplayListRecorder;
+private:
+    std::vector<std::function<void(mssm::Canvas2d&)>> ops;
+public:
+    void   clear() { ops.clear(); }
+    bool   empty() const { return ops.empty(); }
+    size_t size() const { return ops.size(); }
+    void   replay(mssm::Canvas2d& g) const;
+};
+
+// Canvas that draws to another canvas while recording every drawing call into a DisplayList
+class DisplayListRecorder : public mssm::Canvas2dWrapper
+{
+private:
+    DisplayList& list;
+public:
+    DisplayListRecorder(mssm::Canvas2d& g, DisplayList& list) : Canvas2dWrapper(&g), list{list} {}
+
+    // Canvas2d interface
+public:
+    void setBackground(mssm::Color c) override;
+    void line(Vec2d p1, Vec2d p2, mssm::Color c) override;
+    void ellipse(Vec2d center, double w, double h, mssm::Color c, mssm::Color f) override;
+    void arc(Vec2d center, double w, double h, double a, double alen, mssm::Color c) override;
+    void chord(Vec2d center, double w, double h, double a, double alen, mssm::Color c, mssm::Color f)
+        override;
+    void pie(Vec2d center, double w, double h, double a, double alen, mssm::Color c, mssm::Color f)
+        override;
+    void rect(Vec2d corner, double w, double h, mssm::Color c, mssm::Color f) override;
+    void polygon(const std::vector<Vec2d> &points, mssm::Color border, mssm::Color fill) override;
+    void polyline(const std::vector<Vec2d> &points, mssm::Color color) override;
+    void points(const std::vector<Vec2d> &points, mssm::Color c) override;
+    void polygon(std::initializer_list<Vec2d> points, mssm::Color border, mssm::Color fill) override;
+    void polyline(std::initializer_list<Vec2d> points, mssm::Color color) override;
+    void points(std::initializer_list<Vec2d> points, mssm::Color c) override;
+#ifdef SUPPORT_MSSM_ARRAY
+    void polygon(const mssm::Array<Vec2d>& points, mssm::Color border, mssm::Color fill) override;
+    void polyline(const mssm::Array<Vec2d>& points, mssm::Color color) override;
+    void points(const mssm::Array<Vec2d>& points, mssm::Color c) override;
+#endif // SUPPORT_MSSM_ARRAY
+    void text(Vec2d pos,
+              const FontInfo &sizeAndFace,
+              const std::string &str,
+              mssm::Color textcolor,
+              HAlign hAlign,
+              VAlign vAlign) override;
+    void point(Vec2d pos, mssm::Color c) override;
+    void image(Vec2d pos, const mssm::Image &img, double alpha = 1.0) override;
+    void image(Vec2d pos, const mssm::Image &img, Vec2d src, int srcw, int srch, double alpha = 1.0) override;
+    void image(Vec2d pos, double w, double h, const mssm::Image &img, double alpha = 1.0) override;
+    void image(Vec2d pos, double w, double h, const mssm::Image &img, Vec2d src, int srcw, int srch, double alpha = 1.0)
+        override;
+    void imageC(Vec2d center, double angle, const mssm::Image &img, double alpha = 1.0) override;
+    void imageC(
+        Vec2d center, double angle, const mssm::Image &img, Vec2d src, int srcw, int srch, double alpha = 1.0) override;
+    void imageC(Vec2d center, double angle, double w, double h, const mssm::Image &img, double alpha = 1.0) override;
+    void imageC(Vec2d center,
+                double angle,
+                double w,
+                double h,
+                const mssm::Image &img,
+                Vec2d src,
+                int srcw,
+                int srch, double alpha = 1.0) override;
+    void pushClip(int x, int y, int w, int h, bool replace) override;
+    void popClip() override;
+    void setClip(int x, int y, int w, int h) override;
+    void resetClip() override;
+    void setViewport(int x, int y, int w, int h) override;
+    void resetViewport() override;
+    void pushGroup(std::string groupName) override;
+    void popGroup() override;
+    void polygonPattern(const std::vector<Vec2d> &points, mssm::Color c, mssm::Color f) override;
+    void polygonPattern(std::initializer_list<Vec2d> points, mssm::Color c, mssm::Color f) override;
+private:
+    void record(std::function<void(mssm::Canvas2d&)> op);
+};
+
+#endif // CANVASDISPLAYLIST_H
@@ -0,0 +1,93 @@
+#include "canvasStreamWriter.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+CanvasStreamWriter::CanvasStreamWriter(const std::string& filename, NumberFormat format, size_t bufferSize)
+    : out(filename, std::ios::binary), filename(filename), format(format),
+      capacity(std::max(bufferSize, 2 * maxNumberSize))
+{
+    if (!out) {
+        throw std::runtime_error("Cannot open " + filename);
+    }
+    buffer = std::make_unique<char[]>(capacity);
+}
+
+void CanvasStreamWriter::writeBuffer()
+{
+    out.write(buffer.get(), static_cast<std::streamsize>(used));
+    used = 0;
+}
+
+void CanvasStreamWriter::write(std::string_view text)
+{
+    while (!text.empty()) {
+        if (used == capacity) {
+            writeBuffer();
+        }
+        size_t n = std::min(text.size(), capacity - used);
+        std::memcpy(buffer.get() + used, text.data(), n);
+        used += n;
+        text.remove_prefix(n);
+    }
+}
+
+void CanvasStreamWriter::number(double value)
+{
+    if (capacity - used < maxNumberSize) {
+        writeBuffer();
+    }
+
+    char* first = buffer.get() + used;
+    char* last = first + maxNumberSize;
+
+    auto result = std::to_chars(first, last, value, format.format, format.precision);
+    if (result.ec != std::errc()) {
+        result = std::to_chars(first, last, value); // too big for fixed
+    }
+    char* end = result.ptr;
+
+    if (format.trimZeros) {
+        if (std::find(first, end, '.') != end && std::find(first, end, 'e') == end) {
+            while (end[-1] == '0') {
+                end--;
+            }
+            if (end[-1] == '.') {
+                end--;
+            }
+        }
+        if (end - first == 2 && first[0] == '-' && first[1] == '0') {
+            first[0] = '0'; // rounded to -0
+            end--;
+        }
+    }
+
+    used = end - buffer.get();
+}
+
+void CanvasStreamWriter::integer(int64_t value, int width)
+{
+    if (capacity - used < maxNumberSize) {
+        writeBuffer();
+    }
+
+    char digits[24];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    int length = static_cast<int>(end - digits);
+    // an int64 takes at most 20 characters, leaving the rest for padding
+    int pad = std::clamp(width - length, 0, static_cast<int>(maxNumberSize) - length);
+
+    char* first = buffer.get() + used;
+    std::memset(first, ' ', pad);
+    std::memcpy(first + pad, digits, length);
+    used += pad + length;
+}
+
+void CanvasStreamWriter::flush()
+{
+    writeBuffer();
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("Error writing " + filename);
+    }
+}
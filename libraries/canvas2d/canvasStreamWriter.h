@@ -0,0 +1,69 @@
+#ifndef CANVASSTREAMWRITER_H
+#define CANVASSTREAMWRITER_H
+
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Writes text to a file through a buffer of its own, so memory use doesn't
+// grow with what's written.  The canvases that stream to a file (SVG, OBJ
+// and DXF) write through one of these, each with its own NumberFormat.
+// Numbers are formatted straight into the buffer with std::to_chars.
+//
+// Throws std::runtime_error if the file can't be opened, and from flush() if
+// writing failed
+class CanvasStreamWriter
+{
+public:
+    struct NumberFormat {
+        std::chars_format format;
+        int precision;
+        bool trimZeros; // drop trailing zeros (and the point), and write -0 as 0
+
+        // to a number of decimals, without trailing zeros
+        static constexpr NumberFormat fixed(int decimals) { return { std::chars_format::fixed, decimals, true }; }
+        // as printf's %g
+        static constexpr NumberFormat general(int precision) { return { std::chars_format::general, precision, false }; }
+    };
+
+private:
+    static constexpr size_t maxNumberSize = 32;
+
+    std::ofstream out;
+    std::string filename;
+    NumberFormat format;
+    std::unique_ptr<char[]> buffer;
+    size_t capacity;
+    size_t used{0};
+public:
+    CanvasStreamWriter(const std::string& filename, NumberFormat format, size_t bufferSize = 1 << 20);
+
+    CanvasStreamWriter(const CanvasStreamWriter&) = delete;
+    CanvasStreamWriter& operator=(const CanvasStreamWriter&) = delete;
+
+    void write(std::string_view text);
+    void write(char c)
+    {
+        if (used == capacity) {
+            writeBuffer();
+        }
+        buffer[used++] = c;
+    }
+
+    void number(double value);
+
+    // right aligned in width columns with spaces, like %*d
+    template <std::integral T>
+    void number(T value, int width = 0) { integer(static_cast<int64_t>(value), width); }
+
+    void flush();
+private:
+    void writeBuffer();
+    void integer(int64_t value, int width);
+};
+
+#endif // CANVASSTREAMWRITER_H
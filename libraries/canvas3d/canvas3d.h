@@ -12,6 +12,7 @@
 #include <memory>
 
 class StaticMesh;
+class StaticMeshLod;
 
 namespace mssm {
 
@@ -62,6 +63,7 @@ public:
     virtual void setCameraParams(Vec3d eye, Vec3d target, Vec3d up, double near, double far) = 0;
     virtual void setLightParams(Vec3d pos, Color color) = 0;
     virtual void drawMesh(const StaticMesh& mesh, const mat4x4& modelMatrix) = 0;
+    virtual void drawMesh(const StaticMeshLod& mesh, const mat4x4& modelMatrix) = 0; // level chosen by distance from the camera
 
     virtual std::unique_ptr<ITriWriter<Vertex3dUV>> getTriangleWriter(uint32_t triCount) = 0;
 };
@@ -139,6 +141,7 @@ public:
     void setCameraParams(Vec3d eye, Vec3d target, Vec3d up, double near, double far) override { canvas->setCameraParams(eye, target, up, near, far); }
     void setLightParams(Vec3d pos, Color color) override { canvas->setLightParams(pos, color); }
     void drawMesh(const StaticMesh& mesh, const mat4x4& modelMatrix) override { canvas->drawMesh(mesh, modelMatrix); }
+    void drawMesh(const StaticMeshLod& mesh, const mat4x4& modelMatrix) override { canvas->drawMesh(mesh, modelMatrix); }
     std::unique_ptr<ITriWriter<Vertex3dUV>> getTriangleWriter(uint32_t triCount) override { return canvas->getTriangleWriter(triCount); }
 
     // Canvas2d interface
@@ -0,0 +1,62 @@
+#ifndef COLORBLEND_H
+#define COLORBLEND_H
+
+#include "color.h"
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define COLORBLEND_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// The per pixel blend arithmetic shared by colorspan and the software
+// rasterizer, so both produce the same bytes.  Not part of colorspan's
+// interface: code outside the graphics libraries should use colorspan.
+
+namespace mssm::colorblend {
+
+// x / 255, rounded, for x up to 255 * 255
+inline uint32_t div255(uint32_t x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// c over d, c weighted by a (0..255).  Alpha blends towards opaque
+inline void blendPixel(Color& d, Color c, uint32_t a)
+{
+    uint32_t na = 255 - a;
+    d.r = div255(c.r * a + d.r * na);
+    d.g = div255(c.g * a + d.g * na);
+    d.b = div255(c.b * a + d.b * na);
+    d.a = div255(255 * a + d.a * na);
+}
+
+#if defined(COLORBLEND_SSE2)
+
+// SSE2: two colors in a __m128i as 16 bit lanes
+
+inline __m128i div255(__m128i x)
+{
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+inline __m128i alphaLanes()
+{
+    return _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+}
+
+// src over dst as blendPixel does, with each color's weight in all four lanes of a
+inline __m128i blendLanes(__m128i dst, __m128i src, __m128i a)
+{
+    src = _mm_or_si128(src, alphaLanes());
+    __m128i na = _mm_sub_epi16(_mm_set1_epi16(255), a);
+    return div255(_mm_add_epi16(_mm_mullo_epi16(src, a), _mm_mullo_epi16(dst, na)));
+}
+
+#endif // COLORBLEND_SSE2
+
+}
+
+#endif // COLORBLEND_H
@@ -0,0 +1,472 @@
+#include "colorspan.h"
+#include "colorblend.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define COLORSPAN_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define COLORSPAN_AVX2
+#else
+#define COLORSPAN_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace std;
+
+namespace mssm::colorspan {
+
+static_assert(sizeof(Color) == 4, "colors are processed four bytes at a time");
+
+// Each operation has a scalar loop, which defines its result, and on x86 an
+// SSE2 and an AVX2 version that give exactly the same bytes.  Those work on
+// four or eight colors at a time, widened to 16 bit lanes, and return how many
+// they did; the scalar loop finishes the rest.
+
+namespace {
+
+using colorblend::div255;
+using colorblend::blendPixel;
+
+inline uint32_t toBits(Color c)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &c, 4);
+    return bits;
+}
+
+#if defined(COLORSPAN_X86)
+
+bool hasAvx2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osxsave = info[2] & (1 << 27);
+    bool avx = info[2] & (1 << 28);
+    // the OS must save the ymm registers too
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return info[1] & (1 << 5);
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+bool useAvx2()
+{
+    static const bool avx2 = hasAvx2();
+    return avx2;
+}
+
+// SSE2: four colors in a __m128i, two at a time in 16 bit lanes
+
+using colorblend::alphaLanes;
+using colorblend::blendLanes;
+
+// each color's alpha in all four of its lanes
+inline __m128i broadcastAlpha(__m128i x)
+{
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+size_t fillSse2(Color* dst, size_t n, Color c)
+{
+    const __m128i v = _mm_set1_epi32(static_cast<int>(toBits(c)));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+    }
+    return i;
+}
+
+size_t blendSse2(Color* dst, size_t n, Color c)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i src = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(toBits(c))), zero);
+    const __m128i a = _mm_set1_epi16(c.a);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i* p = reinterpret_cast<__m128i*>(dst + i);
+        __m128i d = _mm_loadu_si128(p);
+        __m128i lo = blendLanes(_mm_unpacklo_epi8(d, zero), src, a);
+        __m128i hi = blendLanes(_mm_unpackhi_epi8(d, zero), src, a);
+        _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+size_t blendSse2(Color* dst, const Color* src, size_t n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi8(-1);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        // the alpha bytes' bits of the masks
+        int opaque = _mm_movemask_epi8(_mm_cmpeq_epi8(s, ones)) & 0x8888;
+        int clear = _mm_movemask_epi8(_mm_cmpeq_epi8(s, zero)) & 0x8888;
+        __m128i* p = reinterpret_cast<__m128i*>(dst + i);
+        if (opaque == 0x8888) {
+            _mm_storeu_si128(p, s);
+            continue;
+        }
+        if (clear == 0x8888) {
+            continue;
+        }
+        __m128i d = _mm_loadu_si128(p);
+        __m128i slo = _mm_unpacklo_epi8(s, zero);
+        __m128i shi = _mm_unpackhi_epi8(s, zero);
+        __m128i lo = blendLanes(_mm_unpacklo_epi8(d, zero), slo, broadcastAlpha(slo));
+        __m128i hi = blendLanes(_mm_unpackhi_epi8(d, zero), shi, broadcastAlpha(shi));
+        _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+size_t lerpSse2(Color* dst, const Color* a, const Color* b, size_t n, uint32_t w)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wb = _mm_set1_epi16(static_cast<short>(w));
+    const __m128i wa = _mm_set1_epi16(static_cast<short>(255 - w));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        __m128i lo = div255(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), wa),
+                                          _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), wb)));
+        __m128i hi = div255(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), wa),
+                                          _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), wb)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+size_t premultiplySse2(Color* colors, size_t n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i* p = reinterpret_cast<__m128i*>(colors + i);
+        __m128i c = _mm_loadu_si128(p);
+        __m128i lo = _mm_unpacklo_epi8(c, zero);
+        __m128i hi = _mm_unpackhi_epi8(c, zero);
+        // alpha times 255, divided by 255, stays as it was
+        lo = div255(_mm_mullo_epi16(lo, _mm_or_si128(broadcastAlpha(lo), alphaLanes())));
+        hi = div255(_mm_mullo_epi16(hi, _mm_or_si128(broadcastAlpha(hi), alphaLanes())));
+        _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+// AVX2: the same, eight colors at a time.  Unpacking and packing work within
+// each 128 bit half, so the colors come back in order
+
+COLORSPAN_AVX2 inline __m256i div255(__m256i x)
+{
+    x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+COLORSPAN_AVX2 inline __m256i broadcastAlpha(__m256i x)
+{
+    return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+COLORSPAN_AVX2 inline __m256i alphaLanes256()
+{
+    return _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+}
+
+COLORSPAN_AVX2 inline __m256i blendLanes(__m256i dst, __m256i src, __m256i a)
+{
+    src = _mm256_or_si256(src, alphaLanes256());
+    __m256i na = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+    return div255(_mm256_add_epi16(_mm256_mullo_epi16(src, a), _mm256_mullo_epi16(dst, na)));
+}
+
+COLORSPAN_AVX2 size_t fillAvx2(Color* dst, size_t n, Color c)
+{
+    const __m256i v = _mm256_set1_epi32(static_cast<int>(toBits(c)));
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+    }
+    return i;
+}
+
+COLORSPAN_AVX2 size_t blendAvx2(Color* dst, size_t n, Color c)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i src = _mm256_unpacklo_epi8(_mm256_set1_epi32(static_cast<int>(toBits(c))), zero);
+    const __m256i a = _mm256_set1_epi16(c.a);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i* p = reinterpret_cast<__m256i*>(dst + i);
+        __m256i d = _mm256_loadu_si256(p);
+        __m256i lo = blendLanes(_mm256_unpacklo_epi8(d, zero), src, a);
+        __m256i hi = blendLanes(_mm256_unpackhi_epi8(d, zero), src, a);
+        _mm256_storeu_si256(p, _mm256_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+COLORSPAN_AVX2 size_t blendAvx2(Color* dst, const Color* src, size_t n)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi8(-1);
+    const int alphaBits = static_cast<int>(0x88888888u);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        int opaque = _mm256_movemask_epi8(_mm256_cmpeq_epi8(s, ones)) & alphaBits;
+        int clear = _mm256_movemask_epi8(_mm256_cmpeq_epi8(s, zero)) & alphaBits;
+        __m256i* p = reinterpret_cast<__m256i*>(dst + i);
+        if (opaque == alphaBits) {
+            _mm256_storeu_si256(p, s);
+            continue;
+        }
+        if (clear == alphaBits) {
+            continue;
+        }
+        __m256i d = _mm256_loadu_si256(p);
+        __m256i slo = _mm256_unpacklo_epi8(s, zero);
+        __m256i shi = _mm256_unpackhi_epi8(s, zero);
+        __m256i lo = blendLanes(_mm256_unpacklo_epi8(d, zero), slo, broadcastAlpha(slo));
+        __m256i hi = blendLanes(_mm256_unpackhi_epi8(d, zero), shi, broadcastAlpha(shi));
+        _mm256_storeu_si256(p, _mm256_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+COLORSPAN_AVX2 size_t lerpAvx2(Color* dst, const Color* a, const Color* b, size_t n, uint32_t w)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i wb = _mm256_set1_epi16(static_cast<short>(w));
+    const __m256i wa = _mm256_set1_epi16(static_cast<short>(255 - w));
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i lo = div255(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(va, zero), wa),
+                                             _mm256_mullo_epi16(_mm256_unpacklo_epi8(vb, zero), wb)));
+        __m256i hi = div255(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(va, zero), wa),
+                                             _mm256_mullo_epi16(_mm256_unpackhi_epi8(vb, zero), wb)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+COLORSPAN_AVX2 size_t premultiplyAvx2(Color* colors, size_t n)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i* p = reinterpret_cast<__m256i*>(colors + i);
+        __m256i c = _mm256_loadu_si256(p);
+        __m256i lo = _mm256_unpacklo_epi8(c, zero);
+        __m256i hi = _mm256_unpackhi_epi8(c, zero);
+        lo = div255(_mm256_mullo_epi16(lo, _mm256_or_si256(broadcastAlpha(lo), alphaLanes256())));
+        hi = div255(_mm256_mullo_epi16(hi, _mm256_or_si256(broadcastAlpha(hi), alphaLanes256())));
+        _mm256_storeu_si256(p, _mm256_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+// pshufb needs SSSE3, so there's no SSE2 version of this one
+COLORSPAN_AVX2 size_t swizzleAvx2(Color* colors, size_t n, const std::array<int, 4>& order)
+{
+    alignas(32) int8_t shuffle[32];
+    for (int i = 0; i < 32; i++) {
+        // shuffles pick bytes within each 128 bit half
+        shuffle[i] = static_cast<int8_t>((i & 12) + order[i & 3]);
+    }
+    const __m256i s = _mm256_load_si256(reinterpret_cast<const __m256i*>(shuffle));
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i* p = reinterpret_cast<__m256i*>(colors + i);
+        _mm256_storeu_si256(p, _mm256_shuffle_epi8(_mm256_loadu_si256(p), s));
+    }
+    return i;
+}
+
+#endif // COLORSPAN_X86
+
+void checkSizes(size_t dst, size_t src)
+{
+    if (dst != src) {
+        throw std::invalid_argument("colorspan: source and destination sizes differ");
+    }
+}
+
+}
+
+void fill(std::span<Color> dst, Color c)
+{
+    size_t n = dst.size();
+    size_t i = 0;
+#if defined(COLORSPAN_X86)
+    i = useAvx2() ? fillAvx2(dst.data(), n, c) : fillSse2(dst.data(), n, c);
+#endif
+    for (; i < n; i++) {
+        dst[i] = c;
+    }
+}
+
+void blend(std::span<Color> dst, Color c)
+{
+    if (c.a == 0) {
+        return;
+    }
+    if (c.a == 255) {
+        fill(dst, c);
+        return;
+    }
+    size_t n = dst.size();
+    size_t i = 0;
+#if defined(COLORSPAN_X86)
+    i = useAvx2() ? blendAvx2(dst.data(), n, c) : blendSse2(dst.data(), n, c);
+#endif
+    for (; i < n; i++) {
+        blendPixel(dst[i], c, c.a);
+    }
+}
+
+void blend(std::span<Color> dst, std::span<const Color> src)
+{
+    checkSizes(dst.size(), src.size());
+    size_t n = dst.size();
+    size_t i = 0;
+#if defined(COLORSPAN_X86)
+    i = useAvx2() ? blendAvx2(dst.data(), src.data(), n) : blendSse2(dst.data(), src.data(), n);
+#endif
+    for (; i < n; i++) {
+        blendPixel(dst[i], src[i], src[i].a);
+    }
+}
+
+void lerp(std::span<Color> dst, std::span<const Color> a, std::span<const Color> b, double t)
+{
+    checkSizes(dst.size(), a.size());
+    checkSizes(dst.size(), b.size());
+    uint32_t w = static_cast<uint32_t>(std::lround(std::clamp(t, 0.0, 1.0) * 255));
+    size_t n = dst.size();
+    size_t i = 0;
+#if defined(COLORSPAN_X86)
+    i = useAvx2() ? lerpAvx2(dst.data(), a.data(), b.data(), n, w)
+                  : lerpSse2(dst.data(), a.data(), b.data(), n, w);
+#endif
+    uint32_t nw = 255 - w;
+    for (; i < n; i++) {
+        Color ca = a[i];
+        Color cb = b[i];
+        dst[i] = Color(static_cast<uint8_t>(div255(ca.r * nw + cb.r * w)),
+                       static_cast<uint8_t>(div255(ca.g * nw + cb.g * w)),
+                       static_cast<uint8_t>(div255(ca.b * nw + cb.b * w)),
+                       static_cast<uint8_t>(div255(ca.a * nw + cb.a * w)));
+    }
+}
+
+void premultiply(std::span<Color> colors)
+{
+    size_t n = colors.size();
+    size_t i = 0;
+#if defined(COLORSPAN_X86)
+    i = useAvx2() ? premultiplyAvx2(colors.data(), n) : premultiplySse2(colors.data(), n);
+#endif
+    for (; i < n; i++) {
+        Color& c = colors[i];
+        c.r = div255(c.r * c.a);
+        c.g = div255(c.g * c.a);
+        c.b = div255(c.b * c.a);
+    }
+}
+
+void unpremultiply(std::span<Color> colors)
+{
+    // 255 / a as 16.16 fixed point, so there's no division for each color
+    static const auto scale = [] {
+        std::array<uint32_t, 256> s{};
+        for (uint32_t a = 1; a < 256; a++) {
+            s[a] = ((255u << 16) + a / 2) / a;
+        }
+        return s;
+    }();
+
+    for (Color& c : colors) {
+        if (c.a == 255) {
+            continue;
+        }
+        uint32_t s = scale[c.a];
+        c.r = std::min<uint32_t>(255, (c.r * s + 0x8000) >> 16);
+        c.g = std::min<uint32_t>(255, (c.g * s + 0x8000) >> 16);
+        c.b = std::min<uint32_t>(255, (c.b * s + 0x8000) >> 16);
+    }
+}
+
+void swizzle(std::span<Color> colors, std::array<int, 4> order)
+{
+    for (int o : order) {
+        if (o < 0 || o > 3) {
+            throw std::invalid_argument("colorspan::swizzle: channels are numbered 0 to 3");
+        }
+    }
+    size_t n = colors.size();
+    size_t i = 0;
+#if defined(COLORSPAN_X86)
+    if (useAvx2()) {
+        i = swizzleAvx2(colors.data(), n, order);
+    }
+#endif
+    for (; i < n; i++) {
+        uint8_t in[4];
+        uint8_t out[4];
+        std::memcpy(in, &colors[i], 4);
+        for (int j = 0; j < 4; j++) {
+            out[j] = in[order[j]];
+        }
+        colors[i] = Color(out[0], out[1], out[2], out[3]);
+    }
+}
+
+void applyGamma(std::span<Color> colors, double gamma)
+{
+    std::array<uint8_t, 256> lut;
+    for (int i = 0; i < 256; i++) {
+        lut[i] = static_cast<uint8_t>(std::lround(std::clamp(std::pow(i / 255.0, gamma) * 255, 0.0, 255.0)));
+    }
+    for (Color& c : colors) {
+        c.r = lut[c.r];
+        c.g = lut[c.g];
+        c.b = lut[c.b];
+    }
+}
+
+void toHSV(std::span<const Color> src, std::span<ColorHSV> dst)
+{
+    checkSizes(dst.size(), src.size());
+    for (size_t i = 0; i < src.size(); i++) {
+        dst[i] = ColorHSV(src[i]);
+    }
+}
+
+void fromHSV(std::span<const ColorHSV> src, std::span<Color> dst)
+{
+    checkSizes(dst.size(), src.size());
+    for (size_t i = 0; i < src.size(); i++) {
+        dst[i] = src[i];
+    }
+}
+
+}
@@ -0,0 +1,45 @@
+#ifndef COLORSPAN_H
+#define COLORSPAN_H
+
+#include "color.h"
+#include <array>
+#include <span>
+
+namespace mssm::colorspan {
+
+// Operations on whole buffers of colors at once, such as an image's pixels:
+//
+//     colorspan::blend({img.pixels(), size_t(img.width() * img.height())}, Color(255, 0, 0, 64));
+//
+// They use SSE2 or AVX2 when the CPU has them, and give the same results
+// either way.  Where a source and destination are both given they must be
+// the same size.
+
+void fill(std::span<Color> dst, Color c);
+
+// c over each color, weighted by c's alpha.  The alpha moves towards opaque
+void blend(std::span<Color> dst, Color c);
+
+// each of src over the same color of dst, weighted by its alpha
+void blend(std::span<Color> dst, std::span<const Color> src);
+
+// dst = a + (b - a) * t, all four channels, t from 0 to 1
+void lerp(std::span<Color> dst, std::span<const Color> a, std::span<const Color> b, double t);
+
+// r, g and b multiplied by alpha, and back
+void premultiply(std::span<Color> colors);
+void unpremultiply(std::span<Color> colors);
+
+// channel i of each result is channel order[i] of the original, with
+// r, g, b, a numbered 0 to 3: {2, 1, 0, 3} swaps red and blue
+void swizzle(std::span<Color> colors, std::array<int, 4> order);
+
+// r, g and b (as 0 to 1) raised to the power gamma
+void applyGamma(std::span<Color> colors, double gamma);
+
+void toHSV(std::span<const Color> src, std::span<ColorHSV> dst);
+void fromHSV(std::span<const ColorHSV> src, std::span<Color> dst);
+
+}
+
+#endif // COLORSPAN_H
@@ -0,0 +1,246 @@
+#include "csvparser.h"
+#include "csvscan.h"
+#include <bit>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+CsvFile::CsvFile(const std::string &filename)
+{
+#ifndef _WIN32
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + filename);
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+        _size = static_cast<size_t>(info.st_size);
+        if (_size == 0) {
+            ::close(fd);
+            return;
+        }
+        void* mapped = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            ::close(fd);
+            madvise(mapped, _size, MADV_SEQUENTIAL);
+            _data = static_cast<const char*>(mapped);
+            _mapped = true;
+            return;
+        }
+        _size = 0;
+    }
+    ::close(fd);
+#endif
+
+    ifstream file(filename, ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open " + filename);
+    }
+    _contents.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    _data = _contents.data();
+    _size = _contents.size();
+}
+
+CsvFile::~CsvFile()
+{
+#ifndef _WIN32
+    if (_mapped) {
+        munmap(const_cast<char*>(_data), _size);
+    }
+#endif
+}
+
+CsvParser::CsvParser(std::string_view text, char delimiter, bool skipBlankRows)
+    : _begin(text.data()), _pos(text.data()), _end(text.data() + text.size()),
+      _delimiter(delimiter), _skipBlankRows(skipBlankRows)
+{
+}
+
+void CsvParser::loadBlock(const char *blockStart)
+{
+    const char chars[3] = { '"', _delimiter, '\n' };
+    uint64_t masks[3];
+
+    size_t size = static_cast<size_t>(_end - blockStart);
+    if (size >= csvBlockSize) {
+        csvMatchBlock(blockStart, chars, 3, masks);
+    }
+    else {
+        csvMatchPartial(blockStart, size, chars, 3, masks);
+    }
+
+    _blockStart = blockStart;
+    _quoteBits = masks[0];
+    _structuralBits = masks[0] | masks[1] | masks[2];
+}
+
+// the next quote (or delimiter, newline or quote) at or after p, or _end
+const char* CsvParser::find(const char *p, bool quotesOnly)
+{
+    while (p < _end) {
+        const char* block = _begin + ((p - _begin) & ~static_cast<ptrdiff_t>(csvBlockSize - 1));
+        if (block != _blockStart) {
+            loadBlock(block);
+        }
+        uint64_t bits = (quotesOnly ? _quoteBits : _structuralBits) >> (p - block);
+        if (bits) {
+            return p + std::countr_zero(bits);
+        }
+        p = block + csvBlockSize;
+    }
+    return _end;
+}
+
+void CsvParser::parseRow(std::vector<std::string_view> &fields, bool &blank)
+{
+    fields.clear();
+    _unescaped.clear();
+    _unescapedFields.clear();
+
+    blank = true;
+
+    const char* p = _pos;
+
+    for (;;) {
+        while (p < _end && isBlank(*p)) {
+            p++;
+        }
+
+        const char* next;
+
+        if (p < _end && *p == '"') {
+            blank = false;
+
+            const char* start = p + 1;
+            const char* close = start;
+            bool escaped = false;
+            for (;;) {
+                close = find(close, true);
+                if (close + 1 < _end && close[1] == '"') {
+                    escaped = true;
+                    close += 2;
+                    continue;
+                }
+                break;
+            }
+            if (close == _end) {
+                _syntaxError = true; // unclosed quote
+            }
+
+            // only blanks are allowed between the closing quote and the delimiter
+            const char* after = close < _end ? close + 1 : _end;
+            while (after < _end && isBlank(*after)) {
+                after++;
+            }
+            next = find(after, false);
+            while (next < _end && *next == '"') {
+                next = find(next + 1, false);
+            }
+            if (next != after) {
+                _syntaxError = true;
+            }
+
+            if (escaped) {
+                _unescapedFields.push_back({ fields.size(), _unescaped.size() });
+                for (const char* c = start; c < close; c++) {
+                    _unescaped.push_back(*c);
+                    if (*c == '"') {
+                        c++; // the second of the pair
+                    }
+                }
+                fields.emplace_back();
+            }
+            else {
+                fields.emplace_back(start, close - start);
+            }
+        }
+        else {
+            const char* start = p;
+            next = find(p, false);
+            while (next < _end && *next == '"') {
+                _syntaxError = true; // quote in the middle of a field: kept as is
+                next = find(next + 1, false);
+            }
+
+            const char* last = next;
+            while (last > start && isBlank(last[-1])) {
+                last--;
+            }
+            if (last > start || (next < _end && *next == _delimiter)) {
+                blank = false;
+            }
+            fields.emplace_back(start, last - start);
+        }
+
+        if (next == _end) {
+            _pos = _end;
+            break;
+        }
+        if (*next == '\n') {
+            _pos = next + 1;
+            break;
+        }
+        p = next + 1; // delimiter
+    }
+
+    // point the unescaped fields at the buffer, now it's finished growing
+    for (size_t i = 0; i < _unescapedFields.size(); i++) {
+        size_t start = _unescapedFields[i].second;
+        size_t end = i + 1 < _unescapedFields.size() ? _unescapedFields[i + 1].second : _unescaped.size();
+        fields[_unescapedFields[i].first] = std::string_view(_unescaped).substr(start, end - start);
+    }
+}
+
+bool CsvParser::next(std::vector<std::string_view> &fields)
+{
+    while (_pos < _end) {
+        bool blank;
+        parseRow(fields, blank);
+        if (!blank || !_skipBlankRows) {
+            return true;
+        }
+    }
+
+    fields.clear();
+    return false;
+}
+
+bool CsvParser::skipRow()
+{
+    if (_pos >= _end) {
+        return false;
+    }
+
+    // quotes pair up, so a newline after an even number of them ends the row
+    const char* p = _pos;
+    for (;;) {
+        p = find(p, false);
+        if (p == _end) {
+            break;
+        }
+        if (*p == '\n') {
+            p++;
+            break;
+        }
+        if (*p == '"') {
+            p = find(p + 1, true);
+            if (p == _end) {
+                _syntaxError = true;
+                break;
+            }
+        }
+        p++;
+    }
+
+    _pos = p;
+    return true;
+}
@@ -0,0 +1,77 @@
+#ifndef CSVPARSER_H
+#define CSVPARSER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// The whole of a file as one block of text: memory mapped where possible (POSIX
+// regular files), otherwise read into memory in one go.  Throws
+// std::runtime_error if the file can't be opened.
+class CsvFile
+{
+private:
+    const char* _data{nullptr};
+    size_t      _size{0};
+    bool        _mapped{false};
+    std::string _contents;   // when not mapped
+public:
+    explicit CsvFile(const std::string& filename);
+   ~CsvFile();
+
+    CsvFile(const CsvFile&) = delete;
+    CsvFile& operator=(const CsvFile&) = delete;
+
+    std::string_view text() const { return { _data, _size }; }
+};
+
+// Splits CSV text into rows of fields without copying it.  Fields are views of
+// the text, except those with doubled quotes ("") in them, which are unescaped
+// into a buffer owned by the parser; either way they're only valid until the
+// next call to next() (and, for the text, as long as it is).
+//
+// Unquoted fields have spaces and tabs trimmed from both ends (so \r\n line
+// ends work).  Quoted fields can hold delimiters and newlines.  Malformed input
+// (a stray quote, text after a closing quote, an unclosed quote) is read as
+// sensibly as possible and sets syntaxError().
+class CsvParser
+{
+private:
+    const char* _begin;
+    const char* _pos;
+    const char* _end;
+    char        _delimiter;
+    bool        _skipBlankRows;
+    bool        _syntaxError{false};
+
+    // quote and delimiter/newline/quote bits of the 64 byte block at _blockStart
+    const char* _blockStart{nullptr};
+    uint64_t    _quoteBits{0};
+    uint64_t    _structuralBits{0};
+
+    std::string _unescaped;
+    std::vector<std::pair<size_t, size_t>> _unescapedFields; // field number, start in _unescaped
+public:
+    CsvParser(std::string_view text, char delimiter = ',', bool skipBlankRows = false);
+
+    // the next row, or false at the end of the text
+    bool next(std::vector<std::string_view>& fields);
+
+    // skip the next row (a header, say) without splitting it into fields
+    bool skipRow();
+
+    bool syntaxError() const { return _syntaxError; }
+
+    // offset in the text of the start of the next row
+    size_t position() const { return static_cast<size_t>(_pos - _begin); }
+
+private:
+    const char* find(const char* p, bool quotesOnly);
+    void loadBlock(const char* blockStart);
+    bool isBlank(char c) const { return (c == ' ' || c == '\t' || c == '\r') && c != _delimiter; }
+    void parseRow(std::vector<std::string_view>& fields, bool& blank);
+};
+
+#endif // CSVPARSER_H
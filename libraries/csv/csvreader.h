@@ -2,56 +2,37 @@
 #define CSVREADER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <fstream>
 #include <functional>
-
-/*
-class CsvReader
-{
-    std::string _filename;
-public:
-    CsvReader(const std::string &filename);
-   ~CsvReader();
-    std::vector<std::vector<std::string>> read();
-};
-*/
-
+#include "csvparser.h"
+
+// Reads a CSV file row by row.  The file is mapped (see CsvFile) and split by
+// CsvParser; processViews hands the fields over without copying them, the
+// other functions copy each row into strings.
+//
+// The constructor throws std::runtime_error if the file can't be opened (it
+// used to read it as empty).
 class CsvReader
 {
-    enum class State
-    {
-        before,
-        inField,
-        inQuote,
-        onQuote,
-        after,
-        skipping
-    };
 private:
-    std::ifstream _reader;
-    bool _endOfLine;
-    bool _endOfFile;
-    bool _syntaxError;
-    bool _skipBlankRows;
-
-    static constexpr int bufferSize = 4096;
-
-    State state;
-    char buffer[bufferSize];
-    int  pos;
-    int  length;
+    CsvFile   _file;
+    CsvParser _parser;
+    std::vector<std::string_view> _fields;
 
 public:
-    CsvReader(const std::string& filename, bool skipBlankRows);
+    CsvReader(const std::string& filename, bool skipBlankRows, char delimiter = ',');
    ~CsvReader();
 
-    bool SyntaxError() { return _syntaxError; }
+    bool SyntaxError() { return _parser.syntaxError(); }
 
     std::vector<std::vector<std::string>> read(bool skipFirstRow);
 
     void process(std::function<void(std::vector<std::string>&&)> func, bool skipFirstRow);
 
+    // fields are only valid during the call
+    void processViews(std::function<void(const std::vector<std::string_view>&)> func, bool skipFirstRow);
+
     bool readLine(std::vector<std::string>& oneRow);
 };
 
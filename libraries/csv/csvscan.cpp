@@ -0,0 +1,155 @@
+#include "csvscan.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CSV_X86 1
+#include <immintrin.h>
+#endif
+
+// AVX2 is only built where it can be switched on per function and the CPU can
+// be asked about it at run time
+#if defined(CSV_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CSV_AVX2 1
+#endif
+
+namespace {
+
+using MatchFunc = void (*)(const char* block, const char* chars, int count, uint64_t* masks);
+
+#ifndef CSV_X86
+
+void matchScalar(const char* block, const char* chars, int count, uint64_t* masks)
+{
+    for (int i = 0; i < count; i++) {
+        uint64_t mask = 0;
+        for (size_t j = 0; j < csvBlockSize; j++) {
+            mask |= static_cast<uint64_t>(block[j] == chars[i]) << j;
+        }
+        masks[i] = mask;
+    }
+}
+
+#else
+
+void matchSse2(const char* block, const char* chars, int count, uint64_t* masks)
+{
+    __m128i data[4];
+    for (int k = 0; k < 4; k++) {
+        data[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + k * 16));
+    }
+    for (int i = 0; i < count; i++) {
+        __m128i c = _mm_set1_epi8(chars[i]);
+        uint64_t mask = 0;
+        for (int k = 0; k < 4; k++) {
+            uint32_t bits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(data[k], c)));
+            mask |= static_cast<uint64_t>(bits) << (k * 16);
+        }
+        masks[i] = mask;
+    }
+}
+
+#endif
+
+#ifdef CSV_AVX2
+
+__attribute__((target("avx2")))
+void matchAvx2(const char* block, const char* chars, int count, uint64_t* masks)
+{
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+    __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+    for (int i = 0; i < count; i++) {
+        __m256i c = _mm256_set1_epi8(chars[i]);
+        uint32_t loBits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, c)));
+        uint32_t hiBits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, c)));
+        masks[i] = loBits | (static_cast<uint64_t>(hiBits) << 32);
+    }
+}
+
+#endif
+
+MatchFunc pickMatch()
+{
+#ifdef CSV_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return matchAvx2;
+    }
+#endif
+#ifdef CSV_X86
+    return matchSse2;  // every x86-64 has SSE2
+#else
+    return matchScalar;
+#endif
+}
+
+// picked on first use, so it's safe from other files' static initialisers
+MatchFunc matcher()
+{
+    static const MatchFunc match = pickMatch();
+    return match;
+}
+
+} // namespace
+
+void csvMatchBlock(const char* block, const char* chars, int count, uint64_t* masks)
+{
+    matcher()(block, chars, count, masks);
+}
+
+void csvMatchPartial(const char* block, size_t size, const char* chars, int count, uint64_t* masks)
+{
+    char padded[csvBlockSize] = {};
+    std::memcpy(padded, block, size);
+    matcher()(padded, chars, count, masks);
+
+    // the zero padding may match a zero char
+    uint64_t valid = size == 0 ? 0 : ~uint64_t{0} >> (csvBlockSize - size);
+    for (int i = 0; i < count; i++) {
+        masks[i] &= valid;
+    }
+}
+
+const char* csvFindAny(const char* begin, const char* end, const char* chars, int count)
+{
+    MatchFunc match = matcher();
+    uint64_t masks[csvMaxMatchChars];
+
+    while (begin < end) {
+        size_t size = static_cast<size_t>(end - begin);
+        if (size >= csvBlockSize) {
+            match(begin, chars, count, masks);
+        }
+        else {
+            csvMatchPartial(begin, size, chars, count, masks);
+        }
+        uint64_t any = 0;
+        for (int i = 0; i < count; i++) {
+            any |= masks[i];
+        }
+        if (any) {
+            return begin + std::countr_zero(any);
+        }
+        begin += std::min(size, csvBlockSize);
+    }
+
+    return end;
+}
+
+size_t csvCount(const char* begin, const char* end, char c)
+{
+    MatchFunc match = matcher();
+    uint64_t mask;
+    size_t count = 0;
+
+    for (; end - begin >= static_cast<ptrdiff_t>(csvBlockSize); begin += csvBlockSize) {
+        match(begin, &c, 1, &mask);
+        count += std::popcount(mask);
+    }
+    if (begin < end) {
+        csvMatchPartial(begin, static_cast<size_t>(end - begin), &c, 1, &mask);
+        count += std::popcount(mask);
+    }
+
+    return count;
+}
@@ -0,0 +1,28 @@
+#ifndef CSVSCAN_H
+#define CSVSCAN_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Character classification for the CSV parser and writer, 64 bytes at a time.
+// Uses AVX2 or SSE2 when the CPU has them (picked once, at startup) and plain
+// loops otherwise.  The masks let the parser jump from one quote, delimiter or
+// newline to the next instead of looking at every byte.
+
+constexpr size_t csvBlockSize = 64;
+constexpr int    csvMaxMatchChars = 4;
+
+// masks[i] gets bit j set where block[j] == chars[i], for each of the count
+// (at most csvMaxMatchChars) chars.  block must have csvBlockSize readable bytes
+void csvMatchBlock(const char* block, const char* chars, int count, uint64_t* masks);
+
+// as csvMatchBlock, for the last size (< csvBlockSize) bytes of a buffer
+void csvMatchPartial(const char* block, size_t size, const char* chars, int count, uint64_t* masks);
+
+// position of the first of the count chars in [begin, end), or end
+const char* csvFindAny(const char* begin, const char* end, const char* chars, int count);
+
+// number of times c appears in [begin, end)
+size_t csvCount(const char* begin, const char* end, char c);
+
+#endif // CSVSCAN_H
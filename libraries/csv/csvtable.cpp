@@ -0,0 +1,381 @@
+#include "csvtable.h"
+#include "csvparser.h"
+#include "csvscan.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+namespace {
+
+bool parseInt(std::string_view cell, int64_t& value)
+{
+    const char* begin = cell.data();
+    const char* end = begin + cell.size();
+    if (begin < end && *begin == '+') {
+        begin++; // from_chars doesn't take a plus sign
+    }
+    auto [last, ec] = std::from_chars(begin, end, value);
+    return ec == std::errc() && last == end;
+}
+
+bool parseDouble(std::string_view cell, double& value)
+{
+    const char* begin = cell.data();
+    const char* end = begin + cell.size();
+    if (begin < end && *begin == '+') {
+        begin++;
+    }
+    auto [last, ec] = std::from_chars(begin, end, value);
+    return ec == std::errc() && last == end;
+}
+
+void appendCell(CsvColumn& column, std::string_view cell)
+{
+    switch (column.type) {
+    case CsvType::Int64: {
+        int64_t value = CsvColumn::missingInt;
+        if (cell.empty()) {
+            column.missing++;
+        }
+        else if (!parseInt(cell, value)) {
+            column.invalid++;
+            value = CsvColumn::missingInt;
+        }
+        column.ints.push_back(value);
+        break;
+    }
+    case CsvType::Double: {
+        double value = std::numeric_limits<double>::quiet_NaN();
+        if (cell.empty()) {
+            column.missing++;
+        }
+        else if (!parseDouble(cell, value)) {
+            column.invalid++;
+            value = std::numeric_limits<double>::quiet_NaN();
+        }
+        column.doubles.push_back(value);
+        break;
+    }
+    case CsvType::String:
+        if (cell.empty()) {
+            column.missing++;
+        }
+        column.chars.append(cell);
+        column.ends.push_back(column.chars.size());
+        break;
+    }
+}
+
+// Runs task(0) .. task(count - 1) on up to threads threads, each taking the next
+// undone task as it finishes one.  The first exception thrown is rethrown
+void runTasks(size_t count, unsigned threads, const std::function<void(size_t)>& task)
+{
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::min<size_t>(threads, count));
+
+    std::atomic<size_t> next{0};
+    std::exception_ptr error;
+    std::atomic<bool> failed{false};
+
+    auto work = [&]() {
+        for (size_t i = next++; i < count && !failed; i = next++) {
+            try {
+                task(i);
+            }
+            catch (...) {
+                if (!failed.exchange(true)) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; t++) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+// Start of each chunk (and the end of the text): nominally every chunkSize bytes,
+// moved on to the start of the next row.  That depends on whether the nominal
+// start is inside a quoted field, which depends on everything before it, so the
+// quotes in each chunk are counted first (in parallel).  Quotes pair up (an
+// escaped "" counts twice), so an odd number before a point puts it inside quotes
+std::vector<size_t> splitRows(std::string_view text, size_t chunkSize, unsigned threads)
+{
+    chunkSize = std::max<size_t>(chunkSize, csvBlockSize);
+    size_t chunks = std::max<size_t>(1, (text.size() + chunkSize - 1) / chunkSize);
+
+    std::vector<size_t> quotes(chunks);
+    runTasks(chunks, threads, [&](size_t i) {
+        size_t begin = i * chunkSize;
+        size_t end = std::min(text.size(), begin + chunkSize);
+        quotes[i] = csvCount(text.data() + begin, text.data() + end, '"');
+    });
+
+    std::vector<size_t> starts{0};
+    size_t quotesBefore = 0;
+    const char* end = text.data() + text.size();
+    const char stops[2] = { '"', '\n' };
+
+    for (size_t i = 1; i < chunks; i++) {
+        quotesBefore += quotes[i - 1];
+
+        const char* p = text.data() + i * chunkSize;
+        bool inQuotes = quotesBefore % 2 != 0;
+        if (starts.back() > i * chunkSize) {
+            // a long row ran past this chunk's start; where it ended is a row start,
+            // so not inside quotes
+            p = text.data() + starts.back();
+            inQuotes = false;
+        }
+
+        for (;;) {
+            p = csvFindAny(p, end, stops, 2);
+            if (p == end) {
+                break;
+            }
+            if (*p == '"') {
+                inQuotes = !inQuotes;
+            }
+            else if (!inQuotes) {
+                p++;
+                break;
+            }
+            p++;
+        }
+
+        if (p == end) {
+            break;
+        }
+        starts.push_back(static_cast<size_t>(p - text.data()));
+    }
+
+    starts.push_back(text.size());
+    return starts;
+}
+
+class Chunk {
+public:
+    std::vector<CsvColumn> columns;
+    size_t rows{0};
+    bool   syntaxError{false};
+};
+
+void parseChunk(std::string_view text, char delimiter, Chunk& chunk)
+{
+    CsvParser parser(text, delimiter, true);
+    std::vector<std::string_view> fields;
+
+    while (parser.next(fields)) {
+        for (size_t c = 0; c < chunk.columns.size(); c++) {
+            appendCell(chunk.columns[c], c < fields.size() ? fields[c] : std::string_view{});
+        }
+        chunk.rows++;
+    }
+
+    chunk.syntaxError = parser.syntaxError();
+}
+
+// the header row, and where the data starts
+std::vector<std::string> readHeader(std::string_view text, const CsvTableOptions& options, size_t& dataStart)
+{
+    std::vector<std::string> names;
+    dataStart = 0;
+
+    if (options.header) {
+        CsvParser parser(text, options.delimiter, true);
+        std::vector<std::string_view> fields;
+        parser.next(fields);
+        names.assign(fields.begin(), fields.end());
+        dataStart = parser.position();
+    }
+
+    return names;
+}
+
+std::vector<CsvColumnSpec> inferTypes(std::string_view data, const CsvTableOptions& options, const std::vector<std::string>& names)
+{
+    class Guess {
+    public:
+        bool any{false};
+        bool ints{true};
+        bool numbers{true};
+    };
+
+    std::vector<Guess> guesses(names.size());
+
+    CsvParser parser(data, options.delimiter, true);
+    std::vector<std::string_view> fields;
+
+    for (size_t row = 0; row < options.sampleRows && parser.next(fields); row++) {
+        if (guesses.size() < fields.size()) {
+            guesses.resize(fields.size());
+        }
+        for (size_t c = 0; c < fields.size(); c++) {
+            auto& guess = guesses[c];
+            if (fields[c].empty()) {
+                continue;
+            }
+            guess.any = true;
+            int64_t i;
+            double d;
+            if (guess.ints && !parseInt(fields[c], i)) {
+                guess.ints = false;
+            }
+            if (guess.numbers && !guess.ints && !parseDouble(fields[c], d)) {
+                guess.numbers = false;
+            }
+        }
+    }
+
+    std::vector<CsvColumnSpec> schema(guesses.size());
+    for (size_t c = 0; c < guesses.size(); c++) {
+        auto& guess = guesses[c];
+        schema[c].type = !guess.any ? CsvType::String : guess.ints ? CsvType::Int64 : guess.numbers ? CsvType::Double : CsvType::String;
+    }
+    return schema;
+}
+
+} // namespace
+
+size_t CsvColumn::size() const
+{
+    switch (type) {
+    case CsvType::Int64:
+        return ints.size();
+    case CsvType::Double:
+        return doubles.size();
+    case CsvType::String:
+        return ends.size();
+    }
+    return 0;
+}
+
+std::string_view CsvColumn::string(size_t row) const
+{
+    size_t start = row == 0 ? 0 : ends[row - 1];
+    return std::string_view(chars).substr(start, ends[row] - start);
+}
+
+const CsvColumn &CsvTable::column(std::string_view name) const
+{
+    for (auto& column : columns) {
+        if (column.name == name) {
+            return column;
+        }
+    }
+    throw std::out_of_range("No column named " + std::string(name));
+}
+
+CsvColumn &CsvTable::column(std::string_view name)
+{
+    return const_cast<CsvColumn&>(static_cast<const CsvTable*>(this)->column(name));
+}
+
+std::vector<CsvColumnSpec> inferCsvSchema(std::string_view text, const CsvTableOptions &options)
+{
+    size_t dataStart;
+    auto names = readHeader(text, options, dataStart);
+    auto schema = inferTypes(text.substr(dataStart), options, names);
+    for (size_t c = 0; c < schema.size(); c++) {
+        schema[c].name = c < names.size() ? names[c] : "column" + std::to_string(c);
+    }
+    return schema;
+}
+
+CsvTable parseCsvTable(std::string_view text, const CsvTableOptions &options)
+{
+    size_t dataStart;
+    auto names = readHeader(text, options, dataStart);
+    std::string_view data = text.substr(dataStart);
+
+    auto schema = options.schema.empty() ? inferTypes(data, options, names) : options.schema;
+
+    CsvTable table;
+    table.columns.resize(schema.size());
+    for (size_t c = 0; c < schema.size(); c++) {
+        auto& column = table.columns[c];
+        column.type = schema[c].type;
+        column.name = !schema[c].name.empty() ? schema[c].name : c < names.size() ? names[c] : "column" + std::to_string(c);
+    }
+
+    auto starts = splitRows(data, options.chunkSize, options.threads);
+
+    std::vector<Chunk> chunks(starts.size() - 1);
+    for (auto& chunk : chunks) {
+        chunk.columns.resize(schema.size());
+        for (size_t c = 0; c < schema.size(); c++) {
+            chunk.columns[c].type = schema[c].type;
+        }
+    }
+
+    runTasks(chunks.size(), options.threads, [&](size_t i) {
+        parseChunk(data.substr(starts[i], starts[i + 1] - starts[i]), options.delimiter, chunks[i]);
+    });
+
+    for (auto& chunk : chunks) {
+        table.rows += chunk.rows;
+        table.syntaxError = table.syntaxError || chunk.syntaxError;
+    }
+
+    // join the chunks' columns, letting go of each as it's copied
+    for (size_t c = 0; c < table.columns.size(); c++) {
+        auto& column = table.columns[c];
+        switch (column.type) {
+        case CsvType::Int64:
+            column.ints.reserve(table.rows);
+            break;
+        case CsvType::Double:
+            column.doubles.reserve(table.rows);
+            break;
+        case CsvType::String: {
+            size_t chars = 0;
+            for (auto& chunk : chunks) {
+                chars += chunk.columns[c].chars.size();
+            }
+            column.chars.reserve(chars);
+            column.ends.reserve(table.rows);
+            break;
+        }
+        }
+
+        for (auto& chunk : chunks) {
+            auto& part = chunk.columns[c];
+            column.missing += part.missing;
+            column.invalid += part.invalid;
+            column.ints.insert(column.ints.end(), part.ints.begin(), part.ints.end());
+            column.doubles.insert(column.doubles.end(), part.doubles.begin(), part.doubles.end());
+            size_t offset = column.chars.size();
+            column.chars.append(part.chars);
+            for (auto end : part.ends) {
+                column.ends.push_back(end + offset);
+            }
+            part = CsvColumn{};
+        }
+    }
+
+    return table;
+}
+
+CsvTable readCsvTable(const std::string &filename, const CsvTableOptions &options)
+{
+    CsvFile file(filename);
+    return parseCsvTable(file.text(), options);
+}
@@ -0,0 +1,76 @@
+#ifndef CSVTABLE_H
+#define CSVTABLE_H
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Column oriented CSV reading: each column is parsed straight into a typed
+// vector (numbers with std::from_chars), so a table of numbers takes about as
+// much memory as the numbers and no string is made per cell.  Large inputs
+// are split into chunks at row boundaries and parsed on several threads.
+
+enum class CsvType {
+    Int64,
+    Double,
+    String
+};
+
+struct CsvColumnSpec {
+    std::string name;   // empty: taken from the header row (or "column<n>")
+    CsvType     type{CsvType::String};
+};
+
+class CsvColumn {
+public:
+    static constexpr int64_t missingInt = std::numeric_limits<int64_t>::min();
+
+    std::string name;
+    CsvType     type{CsvType::String};
+
+    // only the one for type is used.  Empty or unparseable cells are
+    // missingInt or NaN; string cells are stored end to end in chars
+    std::vector<int64_t> ints;
+    std::vector<double>  doubles;
+    std::string          chars;
+    std::vector<size_t>  ends;      // end of each string cell in chars
+
+    size_t missing{0};  // empty cells (and rows that were too short)
+    size_t invalid{0};  // cells that weren't numbers in a numeric column
+public:
+    size_t size() const;
+    std::string_view string(size_t row) const;
+};
+
+class CsvTable {
+public:
+    std::vector<CsvColumn> columns;
+    size_t rows{0};
+    bool   syntaxError{false};
+public:
+    // throws std::out_of_range if there isn't one with that name
+    const CsvColumn& column(std::string_view name) const;
+    CsvColumn& column(std::string_view name);
+};
+
+struct CsvTableOptions {
+    char     delimiter{','};
+    bool     header{true};               // first row has the column names
+    std::vector<CsvColumnSpec> schema;   // column types in order; empty to infer them
+    size_t   sampleRows{1000};           // rows looked at to infer the types
+    unsigned threads{0};                 // 0: one per core
+    size_t   chunkSize{4 << 20};         // bytes of text per parallel task
+};
+
+// Guess column types from the first sampleRows rows: Int64 if every non empty
+// cell is an integer, Double if they're all numbers, String otherwise
+std::vector<CsvColumnSpec> inferCsvSchema(std::string_view text, const CsvTableOptions& options = {});
+
+CsvTable parseCsvTable(std::string_view text, const CsvTableOptions& options = {});
+
+// throws std::runtime_error if the file can't be opened
+CsvTable readCsvTable(const std::string& filename, const CsvTableOptions& options = {});
+
+#endif // CSVTABLE_H
@@ -1,114 +1,183 @@
 #include "csvwriter.h"
+#include "csvscan.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
 
 using namespace std;
 
-CsvWriter::CsvWriter(const std::string& filename) : _writer(filename)
+CsvWriter::CsvWriter(const std::string& filename, bool backgroundFlush, size_t bufferSize, char delimiter)
+    : _writer(filename, ios::binary), _delimiter(delimiter), _bufferSize(std::max(bufferSize, 2 * maxNumberSize)), _background(backgroundFlush)
 {
+    if (!_writer) {
+        throw std::runtime_error("Cannot open " + filename);
+    }
+
     _needComma = false;
+
+    _buffers[0] = std::make_unique<char[]>(_bufferSize);
+    if (_background) {
+        _buffers[1] = std::make_unique<char[]>(_bufferSize);
+        _flusher = std::thread(&CsvWriter::FlushLoop, this);
+    }
 }
 
 CsvWriter::~CsvWriter()
 {
+    try {
+        Flush();
+    }
+    catch (...) {
+        // nowhere to report it from here
+    }
 
+    if (_background) {
+        {
+            std::lock_guard lock(_mutex);
+            _stop = true;
+        }
+        _changed.notify_all();
+        _flusher.join();
+    }
 }
 
-void WriteQuotedItem(ostream &dest, string item)
+// Hand the full buffer to the file (or the flush thread) and start on an empty one
+void CsvWriter::WriteBuffer()
 {
-    if (item.find_first_of("\",") != string::npos) {
-        dest.put('"');
-        for (auto c : item)
-        {
-            if (c == '"')
-            {
-                dest << "\"\"";
-            }
-            else
-            {
-                dest.put(c);
-            }
+    if (!_background) {
+        if (!_writer.write(_buffers[0].get(), static_cast<streamsize>(_used))) {
+            _failed = true;
         }
-        dest.put('"');
-    }
-    else {
-        dest << item;
+        _used = 0;
+        return;
     }
+
+    std::unique_lock lock(_mutex);
+    _changed.wait(lock, [this]() { return _pendingSize == 0; }); // the other buffer is free
+    _pendingIndex = _active;
+    _pendingSize = _used;
+    lock.unlock();
+    _changed.notify_all();
+
+    _active ^= 1;
+    _used = 0;
 }
 
-void WriteQuoted(ostream &ss, const vector<string>& data)
+void CsvWriter::FlushLoop()
 {
-    bool needComma = false;
-    for (auto s : data)
-    {
-        if (needComma)
-        {
-            ss.put(',');
-        }
-        else
-        {
-            needComma = true;
+    std::unique_lock lock(_mutex);
+
+    for (;;) {
+        _changed.wait(lock, [this]() { return _pendingSize > 0 || _stop; });
+        if (_pendingSize == 0) {
+            return; // stopped, with nothing left to write
         }
-        WriteQuotedItem(ss, s);
+
+        const char* data = _buffers[_pendingIndex].get();
+        size_t size = _pendingSize;
+
+        lock.unlock();
+        bool ok = static_cast<bool>(_writer.write(data, static_cast<streamsize>(size)));
+        lock.lock();
+
+        _failed = _failed || !ok;
+        _pendingSize = 0;
+        _changed.notify_all();
     }
 }
 
-void WriteQuoted(ostream &ss, std::initializer_list<string> data)
+void CsvWriter::Append(const char* data, size_t size)
 {
-    bool needComma = false;
-    for (auto s : data)
-    {
-        if (needComma)
-        {
-            ss.put(',');
+    while (size > 0) {
+        if (_used == _bufferSize) {
+            WriteBuffer();
         }
-        else
-        {
-            needComma = true;
+        size_t n = std::min(size, _bufferSize - _used);
+        std::memcpy(_buffers[_active].get() + _used, data, n);
+        _used += n;
+        data += n;
+        size -= n;
+    }
+}
+
+void CsvWriter::AppendEscaped(std::string_view field)
+{
+    const char* p = field.data();
+    const char* end = p + field.size();
+    const char quote = '"';
+
+    Append(&quote, 1);
+    for (;;) {
+        const char* q = csvFindAny(p, end, &quote, 1);
+        if (q == end) {
+            Append(p, end - p);
+            break;
         }
-        WriteQuotedItem(ss, s);
+        Append(p, q + 1 - p);
+        Append(&quote, 1); // doubled
+        p = q + 1;
     }
+    Append(&quote, 1);
 }
 
+void CsvWriter::WriteField(std::string_view value)
+{
+    Separate();
 
+    const char special[4] = { _delimiter, '"', '\n', '\r' };
 
+    bool blankEnds = !value.empty() && (value.front() == ' ' || value.front() == '\t' || value.back() == ' ' || value.back() == '\t');
+    if (blankEnds || csvFindAny(value.data(), value.data() + value.size(), special, 4) != value.data() + value.size()) {
+        AppendEscaped(value);
+    }
+    else {
+        Append(value.data(), value.size());
+    }
+}
 
-void CsvWriter::WriteGeneral(bool writeEndOfLine, const vector<string>& values)
+void CsvWriter::EndLine()
 {
-    if (_needComma)
-    {
-        _writer.put(',');
+    if (_used == _bufferSize) {
+        WriteBuffer();
     }
+    _buffers[_active][_used++] = '\n';
+    _needComma = false;
+}
 
-    WriteQuoted(_writer, values);
+void CsvWriter::Flush()
+{
+    WriteBuffer();
 
-    if (writeEndOfLine)
-    {
-        _writer << endl;
-        _needComma = false;
+    if (_background) {
+        std::unique_lock lock(_mutex);
+        _changed.wait(lock, [this]() { return _pendingSize == 0; });
     }
-    else
-    {
-        _needComma = true;
+
+    _writer.flush();
+
+    if (_failed || !_writer) {
+        throw std::runtime_error("Error writing CSV file");
     }
 }
 
-void CsvWriter::WriteGeneral(bool writeEndOfLine, std::initializer_list<string> values)
+void CsvWriter::WriteGeneral(bool writeEndOfLine, const vector<string>& values)
 {
-    if (_needComma)
-    {
-        _writer.put(',');
+    for (auto& value : values) {
+        WriteField(value);
     }
 
-    WriteQuoted(_writer, values);
-
-    if (writeEndOfLine)
-    {
-        _writer << endl;
-        _needComma = false;
-    }
-    else
-    {
-        _needComma = true;
+    if (writeEndOfLine) {
+        EndLine();
     }
 }
 
+void CsvWriter::WriteGeneral(bool writeEndOfLine, std::initializer_list<string> values)
+{
+    for (auto& value : values) {
+        WriteField(value);
+    }
 
+    if (writeEndOfLine) {
+        EndLine();
+    }
+}
@@ -1,25 +1,87 @@
 #ifndef CSVWRITER_H
 #define CSVWRITER_H
 
+#include <charconv>
+#include <concepts>
+#include <condition_variable>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
-
+// Writes CSV through a large buffer of its own.  Numbers are formatted with
+// std::to_chars (floating point in the shortest form that reads back exactly)
+// and a field is only quoted when a scan finds a delimiter, quote, line break
+// or leading/trailing blank in it.
+//
+// With backgroundFlush, full buffers are written out by a separate thread
+// while the next one fills, so the caller only waits for the disk if it gets
+// a whole buffer ahead of it.  Throws std::runtime_error if the file can't be
+// opened, and from Flush() if writing failed.
 class CsvWriter
 {
 private:
+    static constexpr size_t maxNumberSize = 32;
+
     std::ofstream _writer;
     bool          _needComma;
+    char          _delimiter;
+
+    size_t _bufferSize;
+    std::unique_ptr<char[]> _buffers[2];
+    int    _active{0};          // the one being filled
+    size_t _used{0};
+
+    // background flushing
+    bool                    _background;
+    std::thread             _flusher;
+    std::mutex              _mutex;
+    std::condition_variable _changed;
+    int                     _pendingIndex{0};
+    size_t                  _pendingSize{0}; // bytes of _buffers[_pendingIndex] to write
+    bool                    _stop{false};
+    bool                    _failed{false};
 public:
-    CsvWriter(const std::string& filename);
+    CsvWriter(const std::string& filename, bool backgroundFlush = false, size_t bufferSize = 1 << 20, char delimiter = ',');
    ~CsvWriter();
 
+    CsvWriter(const CsvWriter&) = delete;
+    CsvWriter& operator=(const CsvWriter&) = delete;
+
 private:
 
     void WriteGeneral(bool writeEndOfLine, const std::vector<std::string>& data);
     void WriteGeneral(bool writeEndOfLine, std::initializer_list<std::string> values);
 
+    void WriteBuffer();
+    void FlushLoop();
+    void Append(const char* data, size_t size);
+    void AppendEscaped(std::string_view field);
+
+    void Separate()
+    {
+        if (_needComma) {
+            if (_used == _bufferSize) {
+                WriteBuffer();
+            }
+            _buffers[_active][_used++] = _delimiter;
+        }
+        _needComma = true;
+    }
+
+    template <typename T>
+    void AppendNumber(T value)
+    {
+        if (_bufferSize - _used < maxNumberSize) {
+            WriteBuffer();
+        }
+        char* out = _buffers[_active].get() + _used;
+        _used = std::to_chars(out, out + maxNumberSize, value).ptr - _buffers[_active].get();
+    }
+
 public:
 
     void WriteLine(const std::vector<std::string>& values)
@@ -42,7 +104,31 @@ public:
         WriteGeneral(false, values);
     }
 
+    // one field at a time, with EndLine after the last of a row
+
+    void WriteField(std::string_view value);
+    void WriteField(const char* value) { WriteField(std::string_view(value)); }
+
+    template <typename T>
+        requires (std::integral<T> || std::floating_point<T>) && (!std::same_as<T, bool>) && (!std::same_as<T, char>)
+    void WriteField(T value)
+    {
+        Separate();
+        AppendNumber(value);
+    }
+
+    void EndLine();
+
+    // a whole row of mixed strings and numbers
+    template <typename... Ts>
+    void WriteRow(const Ts&... values)
+    {
+        (WriteField(values), ...);
+        EndLine();
+    }
 
+    // write everything so far to the file (waiting for the background thread)
+    void Flush();
 };
 
 #endif // CSVWRITER_H
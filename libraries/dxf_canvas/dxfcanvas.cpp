@@ -2,27 +2,64 @@
 #include "image.h"
 #include <algorithm>
 #include <cctype>
+#include <charconv>
 #include <cmath>
 #include <iostream>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t maxRunPoints = 10000;  // longest LWPOLYLINE made from joined lines
+
+} // namespace
 
 // Constructor
-DXFCanvas::DXFCanvas(int width, int height, const std::string& filename)
+DXFCanvas::DXFCanvas(int width, int height, const std::string& filename, Mode mode, const std::vector<std::string>& layers)
     : m_width(width), m_height(height), m_backgroundColor(mssm::BLACK), 
       m_filename(filename), m_nextLayerColor(1) {
-    
+
+    if (mode == Mode::Streaming) {
+        m_stream = std::make_unique<DXFStreamWriter>(filename);
+        m_layerStack.push_back({"0", nullptr});
+        streamHeader(layers);
+        return;
+    }
+
     initializeDXFModel();
     
     // Create a default layer
-    m_layerStack.push_back(m_model.getLayer("0"));
+    m_layerStack.push_back({"0", m_model.getLayer("0")});
+
+    for (const auto& name : layers) {
+        createLayer(layerName(name, m_nextLayerColor), m_nextLayerColor);
+        if (++m_nextLayerColor > 7) m_nextLayerColor = 1;
+    }
 }
 
 // Destructor
 DXFCanvas::~DXFCanvas() {
-    save();
+    try {
+        save();
+    }
+    catch (...) {
+        // nowhere to report it from here
+    }
 }
 
 // Save the DXF file
 void DXFCanvas::save()  {
+    if (m_stream) {
+        if (m_finished) {
+            return;
+        }
+        flushRun();
+        m_stream->group(0, "ENDSEC");
+        m_stream->group(0, "EOF");
+        m_finished = true;
+        m_stream->flush();
+        return;
+    }
+
     dimeOutput out;
     if (out.setFilename(m_filename.c_str())) {
         m_model.write(&out);
@@ -31,6 +68,117 @@ void DXFCanvas::save()  {
     }
 }
 
+// Streaming mode output
+
+// The same header variables and layer table initializeDXFModel sets up,
+// leaving the ENTITIES section open
+void DXFCanvas::streamHeader(const std::vector<std::string>& layers) {
+    DXFStreamWriter& out = *m_stream;
+
+    out.group(0, "SECTION");
+    out.group(2, "HEADER");
+    out.group(9, "$ACADVER");
+    out.group(1, "AC1014");
+    out.group(9, "$INSUNITS");
+    out.group(70, 1);
+    out.group(9, "$DIMSCALE");
+    out.group(40, 1.0);
+    out.group(9, "$DIMTXT");
+    out.group(40, 12.0);
+    out.group(9, "$EXTMIN");
+    out.point(10, 0.0, 0.0, 0.0);
+    out.group(9, "$EXTMAX");
+    out.point(10, m_width, m_height, 0.0);
+    out.group(0, "ENDSEC");
+
+    out.group(0, "SECTION");
+    out.group(2, "TABLES");
+    out.group(0, "TABLE");
+    out.group(2, "LAYER");
+
+    // as createLayer does, a name that's already there keeps its first colour
+    std::vector<std::pair<std::string, int>> table{{"0", 7}};
+    for (const auto& name : layers) {
+        std::string layer = layerName(name, m_nextLayerColor);
+        auto same = [&layer](const auto& entry) { return entry.first == layer; };
+        if (std::find_if(table.begin(), table.end(), same) == table.end()) {
+            table.emplace_back(layer, m_nextLayerColor);
+        }
+        if (++m_nextLayerColor > 7) m_nextLayerColor = 1;
+    }
+
+    out.group(70, static_cast<int>(table.size()));
+    for (const auto& [name, colorIndex] : table) {
+        out.group(0, "LAYER");
+        out.group(2, name);
+        out.group(70, 64);
+        out.group(62, colorIndex);
+        out.group(6, "CONTINUOUS");
+    }
+
+    out.group(0, "ENDTAB");
+    out.group(0, "ENDSEC");
+
+    out.group(0, "SECTION");
+    out.group(2, "ENTITIES");
+}
+
+// the records every entity starts with, as addEntity and dime lay them out
+void DXFCanvas::entityHeader(std::string_view type, mssm::Color c) {
+    if (m_finished) {
+        throw std::logic_error("DXFCanvas: drawing after save() in streaming mode");
+    }
+
+    char handle[16];
+    char* end = std::to_chars(handle, handle + sizeof(handle), m_nextHandle++, 16).ptr;
+    std::transform(handle, end, handle, [](char ch) { return std::toupper(static_cast<unsigned char>(ch)); });
+
+    m_stream->group(0, type);
+    m_stream->group(5, std::string_view(handle, end - handle));
+    m_stream->group(8, m_layerStack.back().name);
+    if (c != mssm::WHITE) {
+        m_stream->group(62, colorToDxfColorIndex(c));
+    }
+}
+
+void DXFCanvas::beginEntity(std::string_view type, mssm::Color c) {
+    flushRun();
+    entityHeader(type, c);
+}
+
+void DXFCanvas::streamPolyline(const Vec2d* points, size_t count, mssm::Color c, bool closed) {
+    if (closed && count > 1 && points[count - 1].exactlyEquals(points[0])) {
+        count--;  // the closed flag joins the ends
+    }
+    beginEntity("LWPOLYLINE", c);
+    m_stream->group(90, static_cast<int>(count));
+    m_stream->group(70, closed ? 1 : 0);
+    for (size_t i = 0; i < count; i++) {
+        m_stream->point(10, points[i].x, points[i].y);
+    }
+}
+
+// a single line is written as a LINE, a longer run as a LWPOLYLINE
+void DXFCanvas::flushRun() {
+    if (m_run.empty()) {
+        return;
+    }
+    if (m_run.size() == 2) {
+        entityHeader("LINE", m_runColor);
+        m_stream->point(10, m_run[0].x, m_run[0].y, 0.0);
+        m_stream->point(11, m_run[1].x, m_run[1].y, 0.0);
+    }
+    else {
+        entityHeader("LWPOLYLINE", m_runColor);
+        m_stream->group(90, static_cast<int>(m_run.size()));
+        m_stream->group(70, 0);
+        for (const auto& p : m_run) {
+            m_stream->point(10, p.x, p.y);
+        }
+    }
+    m_run.clear();
+}
+
 // Initialize DXF model with required sections and tables
 void DXFCanvas::initializeDXFModel() {
     // Initialize the DXF model
@@ -45,12 +193,8 @@ void DXFCanvas::initializeDXFModel() {
     addHeaderEntry("$INSUNITS", 70, 1);            // Set inches as default unit
     addHeaderEntry("$DIMSCALE", 40, 1.0);          // Dimension scale factor
     addHeaderEntry("$DIMTXT", 40, 12.0);           // Dimension text height
-    addHeaderEntry("$EXTMIN", 10, 0.0);            // Drawing extents min x
-    addHeaderEntry("$EXTMIN", 20, 0.0);            // Drawing extents min y
-    addHeaderEntry("$EXTMIN", 30, 0.0);            // Drawing extents min z
-    addHeaderEntry("$EXTMAX", 10, m_width);        // Drawing extents max x
-    addHeaderEntry("$EXTMAX", 20, m_height);       // Drawing extents max y
-    addHeaderEntry("$EXTMAX", 30, 0.0);            // Drawing extents max z
+    addHeaderPoint("$EXTMIN", 0.0, 0.0, 0.0);      // Drawing extents min
+    addHeaderPoint("$EXTMAX", m_width, m_height, 0.0); // Drawing extents max
     
     // Create tables section
     dimeTablesSection* tablesSection = new dimeTablesSection;
@@ -105,10 +249,21 @@ void DXFCanvas::addHeaderEntry(const std::string& name, int group, const std::st
     m_headerSection->setVariable(name.c_str(), &groupcode, &param, 1, m_model.getMemHandler());
 }
 
+// Helper to add a 10/20/30 point header entry.  The three values go in one
+// call: setting the same variable again replaces what it held
+void DXFCanvas::addHeaderPoint(const std::string& name, double x, double y, double z) {
+    int groupcodes[3] = { 10, 20, 30 };
+    dimeParam params[3];
+    params[0].double_data = x;
+    params[1].double_data = y;
+    params[2].double_data = z;
+    m_headerSection->setVariable(name.c_str(), groupcodes, params, 3, m_model.getMemHandler());
+}
+
 // Add entity to the model with proper layer and handle setup
 void DXFCanvas::addEntity(dimeEntity* entity) {
     // Set the entity's layer
-    entity->setLayer(m_layerStack.back());
+    entity->setLayer(m_layerStack.back().layer);
     
     // Create a unique handle for the entity (needed for AutoCAD)
     const int BUFSIZE = 1024;
@@ -200,6 +355,21 @@ void DXFCanvas::setBackground(mssm::Color c) {
 }
 
 void DXFCanvas::line(Vec2d p1, Vec2d p2, mssm::Color c) {
+    if (m_stream) {
+        if (m_finished) {
+            throw std::logic_error("DXFCanvas: drawing after save() in streaming mode");
+        }
+        if (!m_run.empty() && m_runColor == c && m_run.back().exactlyEquals(p1) && m_run.size() < maxRunPoints) {
+            m_run.push_back(p2);
+            return;
+        }
+        flushRun();
+        m_run.push_back(p1);
+        m_run.push_back(p2);
+        m_runColor = c;
+        return;
+    }
+
     // Create a DXF line entity
     dimeLine* line = new dimeLine;
     
@@ -219,6 +389,13 @@ void DXFCanvas::line(Vec2d p1, Vec2d p2, mssm::Color c) {
 void DXFCanvas::ellipse(Vec2d center, double w, double h, mssm::Color c, mssm::Color f) {
     // If width equals height, create a circle
     if (std::abs(w - h) < 0.001) {
+        if (m_stream) {
+            beginEntity("CIRCLE", c);
+            m_stream->point(10, center.x, center.y, 0.0);
+            m_stream->group(40, w / 2.0);
+            return;
+        }
+
         dimeCircle* circle = new dimeCircle;
         circle->setCenter(toVec3f(center));
         circle->setRadius(w / 2.0);
@@ -229,25 +406,35 @@ void DXFCanvas::ellipse(Vec2d center, double w, double h, mssm::Color c, mssm::C
         
         addEntity(circle);
     } else {
-        // Create an ellipse entity
-        dimeEllipse* ellipse = new dimeEllipse;
-        ellipse->setCenter(toVec3f(center));
-        
-        // Set major axis and ratio
+        // Major axis endpoint (relative to the center) and ratio
         dimeVec3f majorAxis;
         double ratio;
         
         if (w > h) {
-            majorAxis.x = center.x + w/2;
-            majorAxis.y = center.y;
+            majorAxis.x = w/2;
+            majorAxis.y = 0;
             majorAxis.z = 0;
             ratio = h / w;
         } else {
-            majorAxis.x = center.x;
-            majorAxis.y = center.y + h/2;
+            majorAxis.x = 0;
+            majorAxis.y = h/2;
             majorAxis.z = 0;
             ratio = w / h;
         }
+
+        if (m_stream) {
+            beginEntity("ELLIPSE", c);
+            m_stream->point(10, center.x, center.y, 0.0);
+            m_stream->point(11, majorAxis.x, majorAxis.y, 0.0);
+            m_stream->group(40, ratio);
+            m_stream->group(41, 0.0);
+            m_stream->group(42, 2 * M_PI);
+            return;
+        }
+
+        // Create an ellipse entity
+        dimeEllipse* ellipse = new dimeEllipse;
+        ellipse->setCenter(toVec3f(center));
         
         ellipse->setMajorAxisEndpoint(majorAxis);
         ellipse->setMinorMajorRatio(ratio);
@@ -263,10 +450,6 @@ void DXFCanvas::ellipse(Vec2d center, double w, double h, mssm::Color c, mssm::C
 void DXFCanvas::arc(Vec2d center, double w, double h, double a, double alen, mssm::Color c) {
     // If width equals height, we can use a proper DXF arc entity
     if (std::abs(w - h) < 0.001) {
-        dimeArc* arc = new dimeArc;
-        arc->setCenter(toVec3f(center));
-        arc->setRadius(w / 2.0);
-        
         // Convert angles to the format DXF expects (degrees, counterclockwise from positive X)
         double startAngle = a;
         double endAngle = a + alen;
@@ -276,7 +459,19 @@ void DXFCanvas::arc(Vec2d center, double w, double h, double a, double alen, mss
         while (startAngle >= 360) startAngle -= 360;
         while (endAngle < 0) endAngle += 360;
         while (endAngle >= 360) endAngle -= 360;
-        
+
+        if (m_stream) {
+            beginEntity("ARC", c);
+            m_stream->point(10, center.x, center.y, 0.0);
+            m_stream->group(40, w / 2.0);
+            m_stream->group(50, startAngle);
+            m_stream->group(51, endAngle);
+            return;
+        }
+
+        dimeArc* arc = new dimeArc;
+        arc->setCenter(toVec3f(center));
+        arc->setRadius(w / 2.0);
         arc->setStartAngle(startAngle);
         arc->setEndAngle(endAngle);
         
@@ -397,6 +592,11 @@ void DXFCanvas::rect(Vec2d corner, double w, double h, mssm::Color c, mssm::Colo
 
 void DXFCanvas::polygon(const std::vector<Vec2d>& points, mssm::Color c, mssm::Color f) {
     if (points.size() < 3) return;
+
+    if (m_stream) {
+        streamPolyline(points.data(), points.size(), c, true);
+        return;
+    }
     
     // Create a DXF Polyline
     dimePolyline* polyline = new dimePolyline;
@@ -413,14 +613,14 @@ void DXFCanvas::polygon(const std::vector<Vec2d>& points, mssm::Color c, mssm::C
         dimeVertex* vertex = vertices[i] = new dimeVertex;
         vertex->setFlags(dimeVertex::POLYLINE_3D_VERTEX);
         vertex->setCoords(toVec3f(points[i]));
-        vertex->setLayer(m_layerStack.back());
+        vertex->setLayer(m_layerStack.back().layer);
     }
     
     // Close the polygon by adding the first point again
     vertices[points.size()] = new dimeVertex;
     vertices[points.size()]->setFlags(dimeVertex::POLYLINE_3D_VERTEX);
     vertices[points.size()]->setCoords(toVec3f(points[0]));
-    vertices[points.size()]->setLayer(m_layerStack.back());
+    vertices[points.size()]->setLayer(m_layerStack.back().layer);
     
     polyline->setCoordVertices(vertices.data(), points.size() + 1);
     
@@ -429,6 +629,11 @@ void DXFCanvas::polygon(const std::vector<Vec2d>& points, mssm::Color c, mssm::C
 
 void DXFCanvas::polyline(const std::vector<Vec2d>& points, mssm::Color c) {
     if (points.empty()) return;
+
+    if (m_stream) {
+        streamPolyline(points.data(), points.size(), c, false);
+        return;
+    }
     
     // Create a DXF Polyline
     dimePolyline* polyline = new dimePolyline;
@@ -445,7 +650,7 @@ void DXFCanvas::polyline(const std::vector<Vec2d>& points, mssm::Color c) {
         dimeVertex* vertex = vertices[i] = new dimeVertex;
         vertex->setFlags(dimeVertex::POLYLINE_3D_VERTEX);
         vertex->setCoords(toVec3f(points[i]));
-        vertex->setLayer(m_layerStack.back());
+        vertex->setLayer(m_layerStack.back().layer);
     }
     
     polyline->setCoordVertices(vertices.data(), points.size());
@@ -494,18 +699,6 @@ void DXFCanvas::points(std::initializer_list<Vec2d> points, mssm::Color c) {
 void DXFCanvas::text(Vec2d pos, const FontInfo& sizeAndFace, const std::string& str, 
                      mssm::Color textcolor, HAlign hAlign, VAlign vAlign) {
     
-    dimeText* text = new dimeText;
-    
-    // Set the text properties
-    text->setTextString(str.c_str());
-    text->setOrigin(toVec3f(pos));
-    text->setHeight(sizeAndFace.getSize());
-    
-    // Set color if not using layer color
-    if (textcolor != mssm::WHITE) {
-        text->setColorNumber(colorToDxfColorIndex(textcolor));
-    }
-    
     // Set alignment
     int horizontalJustification = 0;  // Left
     int verticalJustification = 0;    // Baseline
@@ -524,6 +717,31 @@ void DXFCanvas::text(Vec2d pos, const FontInfo& sizeAndFace, const std::string&
         verticalJustification = 1;  // Bottom
     }
 
+    if (m_stream) {
+        beginEntity("TEXT", textcolor);
+        m_stream->point(10, pos.x, pos.y, 0.0);
+        m_stream->group(40, static_cast<double>(sizeAndFace.getSize()));
+        m_stream->group(1, str);
+        if (horizontalJustification != 0 || verticalJustification != 0) {
+            m_stream->group(72, horizontalJustification);
+            m_stream->point(11, pos.x, pos.y, 0.0);  // aligned text is placed by this point
+            m_stream->group(73, verticalJustification);
+        }
+        return;
+    }
+
+    dimeText* text = new dimeText;
+    
+    // Set the text properties
+    text->setTextString(str.c_str());
+    text->setOrigin(toVec3f(pos));
+    text->setHeight(sizeAndFace.getSize());
+    
+    // Set color if not using layer color
+    if (textcolor != mssm::WHITE) {
+        text->setColorNumber(colorToDxfColorIndex(textcolor));
+    }
+
     text->setHJust(horizontalJustification);
     text->setVJust(verticalJustification);
     
@@ -562,6 +780,12 @@ std::vector<double> DXFCanvas::getCharacterXOffsets(const FontInfo& sizeAndFace,
 }
 
 void DXFCanvas::point(Vec2d pos, mssm::Color c) {
+    if (m_stream) {
+        beginEntity("POINT", c);
+        m_stream->point(10, pos.x, pos.y, 0.0);
+        return;
+    }
+
     // Create a DXF point entity
     dimePoint* point = new dimePoint;
     
@@ -576,7 +800,7 @@ void DXFCanvas::point(Vec2d pos, mssm::Color c) {
     addEntity(point);
 }
 
-void DXFCanvas::image(Vec2d pos, const mssm::Image& img) {
+void DXFCanvas::image(Vec2d pos, const mssm::Image& img, double alpha) {
     // DXF can support images but it's complex
     // For simplicity, we'll just create a rectangle with text as a placeholder
     rect(pos, img.width(), img.height(), mssm::WHITE, mssm::TRANSPARENT);
@@ -586,11 +810,11 @@ void DXFCanvas::image(Vec2d pos, const mssm::Image& img) {
     text(textPos, font, "Image", mssm::WHITE, HAlign::center, VAlign::center);
 }
 
-void DXFCanvas::image(Vec2d pos, const mssm::Image& img, Vec2d src, int srcw, int srch) {
+void DXFCanvas::image(Vec2d pos, const mssm::Image& img, Vec2d src, int srcw, int srch, double alpha) {
     image(pos, img);  // Simplified implementation
 }
 
-void DXFCanvas::image(Vec2d pos, double w, double h, const mssm::Image& img) {
+void DXFCanvas::image(Vec2d pos, double w, double h, const mssm::Image& img, double alpha) {
     rect(pos, w, h, mssm::WHITE, mssm::TRANSPARENT);
     
     FontInfo font(10);
@@ -598,11 +822,11 @@ void DXFCanvas::image(Vec2d pos, double w, double h, const mssm::Image& img) {
     text(textPos, font, "Image", mssm::WHITE, HAlign::center, VAlign::center);
 }
 
-void DXFCanvas::image(Vec2d pos, double w, double h, const mssm::Image& img, Vec2d src, int srcw, int srch) {
+void DXFCanvas::image(Vec2d pos, double w, double h, const mssm::Image& img, Vec2d src, int srcw, int srch, double alpha) {
     image(pos, w, h, img);  // Simplified implementation
 }
 
-void DXFCanvas::imageC(Vec2d center, double angle, const mssm::Image& img) {
+void DXFCanvas::imageC(Vec2d center, double angle, const mssm::Image& img, double alpha) {
     // DXF supports rotated elements, but for simplicity we'll create a placeholder
     double w = img.width();
     double h = img.height();
@@ -633,11 +857,11 @@ void DXFCanvas::imageC(Vec2d center, double angle, const mssm::Image& img) {
     text(center, font, "Image", mssm::WHITE, HAlign::center, VAlign::center);
 }
 
-void DXFCanvas::imageC(Vec2d center, double angle, const mssm::Image& img, Vec2d src, int srcw, int srch) {
+void DXFCanvas::imageC(Vec2d center, double angle, const mssm::Image& img, Vec2d src, int srcw, int srch, double alpha) {
     imageC(center, angle, img);  // Simplified implementation
 }
 
-void DXFCanvas::imageC(Vec2d center, double angle, double w, double h, const mssm::Image& img) {
+void DXFCanvas::imageC(Vec2d center, double angle, double w, double h, const mssm::Image& img, double alpha) {
     // Similar to the above, but with custom dimensions
     std::vector<Vec2d> points = {
         Vec2d(-w/2, -h/2),
@@ -663,7 +887,7 @@ void DXFCanvas::imageC(Vec2d center, double angle, double w, double h, const mss
     text(center, font, "Image", mssm::WHITE, HAlign::center, VAlign::center);
 }
 
-void DXFCanvas::imageC(Vec2d center, double angle, double w, double h, const mssm::Image& img, Vec2d src, int srcw, int srch) {
+void DXFCanvas::imageC(Vec2d center, double angle, double w, double h, const mssm::Image& img, Vec2d src, int srcw, int srch, double alpha) {
     imageC(center, angle, w, h, img);  // Simplified implementation
 }
 
@@ -702,27 +926,41 @@ void DXFCanvas::resetViewport() {
     // For simplicity, we'll do nothing here in this implementation
 }
 
+// DXF layer names can't have spaces
+std::string DXFCanvas::layerName(const std::string& groupName, int colorIndex) {
+    std::string name = groupName;
+    std::replace(name.begin(), name.end(), ' ', '_');
+    
+    if (name.empty()) {
+        name = "Layer_" + std::to_string(colorIndex);
+    }
+    return name;
+}
+
 void DXFCanvas::pushGroup(std::string groupName) {
     // In DXF, we use layers as a way to group objects
-    // Creating a new layer with the group name
-    
-    // Replace spaces with underscores (DXF layer names can't have spaces)
-    std::string layerName = groupName;
-    std::replace(layerName.begin(), layerName.end(), ' ', '_');
-    
-    if (layerName.empty()) {
-        layerName = "Layer_" + std::to_string(m_nextLayerColor);
+    std::string name = layerName(groupName, m_nextLayerColor);
+
+    if (m_stream) {
+        // the layer table has already been written
+        flushRun();
+        m_layerStack.push_back({name, nullptr});
+        if (++m_nextLayerColor > 7) m_nextLayerColor = 1;
+        return;
     }
     
     // Create the layer with the next color index
-    const dimeLayer* layer = createLayer(layerName, m_nextLayerColor++);
+    const dimeLayer* layer = createLayer(name, m_nextLayerColor++);
     if (m_nextLayerColor > 7) m_nextLayerColor = 1;  // Cycle through colors 1-7
     
-    m_layerStack.push_back(layer);
+    m_layerStack.push_back({name, layer});
 }
 
 void DXFCanvas::popGroup() {
     if (m_layerStack.size() > 1) {  // Always keep at least one layer (Layer 0)
+        if (m_stream) {
+            flushRun();
+        }
         m_layerStack.pop_back();
     }
 }
@@ -733,6 +971,11 @@ void DXFCanvas::polygonPattern(const std::vector<Vec2d>& points, mssm::Color c,
     // For simplicity, we'll create a closed polyline and add a special record to indicate hatching
     
     if (points.size() < 3) return;
+
+    if (m_stream) {
+        streamPolyline(points.data(), points.size(), c, true);
+        return;
+    }
     
     // Create a standard polyline for the boundary
     dimePolyline* polyline = new dimePolyline;
@@ -749,14 +992,14 @@ void DXFCanvas::polygonPattern(const std::vector<Vec2d>& points, mssm::Color c,
         dimeVertex* vertex = vertices[i] = new dimeVertex;
         vertex->setFlags(dimeVertex::POLYLINE_3D_VERTEX);
         vertex->setCoords(toVec3f(points[i]));
-        vertex->setLayer(m_layerStack.back());
+        vertex->setLayer(m_layerStack.back().layer);
     }
     
     // Close the polygon by adding the first point again
     vertices[points.size()] = new dimeVertex;
     vertices[points.size()]->setFlags(dimeVertex::POLYLINE_3D_VERTEX);
     vertices[points.size()]->setCoords(toVec3f(points[0]));
-    vertices[points.size()]->setLayer(m_layerStack.back());
+    vertices[points.size()]->setLayer(m_layerStack.back().layer);
     
     polyline->setCoordVertices(vertices.data(), points.size() + 1);
     
@@ -24,25 +24,58 @@
 #include <dime/entities/Arc.h>
 #include <dime/Output.h>
 #include <dime/util/Linear.h>
+#include "dxfstreamwriter.h"
 #include <string>
 #include <map>
 #include <memory>
 #include <stack>
 #include <vector>
 
+// Draws into a DXF file.
+//
+// In Document mode (the default) the drawing is built up as a dime model and
+// written out by save().  In Streaming mode the header and layer table are
+// written when the canvas is created and each entity is written to the file
+// as it's drawn, through a fixed size buffer, so memory use stays the same
+// however much is drawn.  Polylines go out as LWPOLYLINE entities, and
+// connected lines of the same colour are run together into one.  save()
+// finishes the file, after which nothing more can be drawn.  apps/dxf_check
+// checks that both modes write the same drawing.
+//
+// Groups become layers.  Since the layer table has to come first when
+// streaming, layers should be named up front (in either mode); a group that
+// wasn't is still written on a layer of that name, which readers create
+// with default properties.
 class DXFCanvas : public mssm::Canvas2d {
+public:
+    enum class Mode {
+        Document,
+        Streaming
+    };
 private:
+    struct Layer {
+        std::string name;
+        const dimeLayer* layer;  // null in streaming mode
+    };
+
     int m_width;
     int m_height;
     mssm::Color m_backgroundColor;
     dimeModel m_model;
-    dimeEntitiesSection* m_entitiesSection;
-    dimeHeaderSection* m_headerSection;
-    dimeTable* m_layerTable;
+    dimeEntitiesSection* m_entitiesSection{nullptr};
+    dimeHeaderSection* m_headerSection{nullptr};
+    dimeTable* m_layerTable{nullptr};
     std::string m_filename;
-    std::vector<const dimeLayer*> m_layerStack;
+    std::vector<Layer> m_layerStack;
     int m_nextLayerColor;
-    
+
+    // streaming mode
+    std::unique_ptr<DXFStreamWriter> m_stream;
+    bool m_finished{false};     // EOF written
+    unsigned m_nextHandle{1};
+    std::vector<Vec2d> m_run;   // connected lines not yet written
+    mssm::Color m_runColor;
+
     // Helper methods
     void addEntity(dimeEntity* entity);
     int colorToDxfColorIndex(const mssm::Color& color) const;
@@ -52,12 +85,26 @@ private:
     void addHeaderEntry(const std::string& name, int group, int value);
     void addHeaderEntry(const std::string& name, int group, double value);
     void addHeaderEntry(const std::string& name, int group, const std::string& value);
-    
+    void addHeaderPoint(const std::string& name, double x, double y, double z);
+    static std::string layerName(const std::string& groupName, int colorIndex);
+
+    // Streaming mode output
+    void streamHeader(const std::vector<std::string>& layers);
+    void entityHeader(std::string_view type, mssm::Color c);
+    void beginEntity(std::string_view type, mssm::Color c);
+    void streamPolyline(const Vec2d* points, size_t count, mssm::Color c, bool closed);
+    void flushRun();
+
 public:
-    DXFCanvas(int width, int height, const std::string& filename = "output.dxf");
+    // layers are added to the layer table (as by pushGroup) before anything is drawn
+    DXFCanvas(int width, int height, const std::string& filename = "output.dxf",
+              Mode mode = Mode::Document, const std::vector<std::string>& layers = {});
     ~DXFCanvas();
-    
-    // Save the DXF file
+
+    DXFCanvas(const DXFCanvas&) = delete;
+    DXFCanvas& operator=(const DXFCanvas&) = delete;
+
+    // Save the DXF file (or in Streaming mode, finish it)
     void save();
     
     // Canvas2d interface implementation
@@ -93,14 +140,14 @@ public:
     std::vector<double> getCharacterXOffsets(const FontInfo& sizeAndFace, double startX, const std::string& text) override;
     
     void point(Vec2d pos, mssm::Color c) override;
-    void image(Vec2d pos, const mssm::Image& img) override;
-    void image(Vec2d pos, const mssm::Image& img, Vec2d src, int srcw, int srch) override;
-    void image(Vec2d pos, double w, double h, const mssm::Image& img) override;
-    void image(Vec2d pos, double w, double h, const mssm::Image& img, Vec2d src, int srcw, int srch) override;
-    void imageC(Vec2d center, double angle, const mssm::Image& img) override;
-    void imageC(Vec2d center, double angle, const mssm::Image& img, Vec2d src, int srcw, int srch) override;
-    void imageC(Vec2d center, double angle, double w, double h, const mssm::Image& img) override;
-    void imageC(Vec2d center, double angle, double w, double h, const mssm::Image& img, Vec2d src, int srcw, int srch) override;
+    void image(Vec2d pos, const mssm::Image& img, double alpha = 1.0) override;
+    void image(Vec2d pos, const mssm::Image& img, Vec2d src, int srcw, int srch, double alpha = 1.0) override;
+    void image(Vec2d pos, double w, double h, const mssm::Image& img, double alpha = 1.0) override;
+    void image(Vec2d pos, double w, double h, const mssm::Image& img, Vec2d src, int srcw, int srch, double alpha = 1.0) override;
+    void imageC(Vec2d center, double angle, const mssm::Image& img, double alpha = 1.0) override;
+    void imageC(Vec2d center, double angle, const mssm::Image& img, Vec2d src, int srcw, int srch, double alpha = 1.0) override;
+    void imageC(Vec2d center, double angle, double w, double h, const mssm::Image& img, double alpha = 1.0) override;
+    void imageC(Vec2d center, double angle, double w, double h, const mssm::Image& img, Vec2d src, int srcw, int srch, double alpha = 1.0) override;
     
     bool isClipped(Vec2d pos) const override;
     void pushClip(int x, int y, int w, int h, bool replace) override;
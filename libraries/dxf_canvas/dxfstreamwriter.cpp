@@ -0,0 +1,38 @@
+#include "dxfstreamwriter.h"
+
+void DXFStreamWriter::group(int code, std::string_view value)
+{
+    number(code, 3);
+    write('\n');
+    write(value);
+    write('\n');
+}
+
+void DXFStreamWriter::group(int code, int value)
+{
+    number(code, 3);
+    write('\n');
+    number(value, 6);
+    write('\n');
+}
+
+void DXFStreamWriter::group(int code, double value)
+{
+    number(code, 3);
+    write('\n');
+    number(value);
+    write('\n');
+}
+
+void DXFStreamWriter::point(int code, double x, double y)
+{
+    group(code, x);
+    group(code + 10, y);
+}
+
+void DXFStreamWriter::point(int code, double x, double y, double z)
+{
+    group(code, x);
+    group(code + 10, y);
+    group(code + 20, z);
+}
@@ -0,0 +1,29 @@
+#ifndef DXFSTREAMWRITER_H
+#define DXFSTREAMWRITER_H
+
+#include "canvasStreamWriter.h"
+#include <string>
+#include <string_view>
+
+// CanvasStreamWriter for ASCII DXF group code / value pairs.  Values are laid
+// out the way dimeOutput writes them: group codes right aligned in three
+// columns, integers in six, and reals as printf's %g would
+class DXFStreamWriter : private CanvasStreamWriter
+{
+public:
+    DXFStreamWriter(const std::string& filename, size_t bufferSize = 1 << 20)
+        : CanvasStreamWriter(filename, NumberFormat::general(6), bufferSize) {}
+
+    void group(int code, std::string_view value);
+    void group(int code, const char* value) { group(code, std::string_view(value)); }
+    void group(int code, int value);
+    void group(int code, double value);
+
+    // 10/20/30 style coordinate pairs, starting at code
+    void point(int code, double x, double y);
+    void point(int code, double x, double y, double z);
+
+    using CanvasStreamWriter::flush;
+};
+
+#endif // DXFSTREAMWRITER_H
@@ -0,0 +1,174 @@
+#ifndef ELEMENTPOOL_H
+#define ELEMENTPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Chunked slab storage for mesh elements.
+//
+// Elements are addressed by a 32 bit handle (chunk index in the high bits, slot
+// in the low bits).  They never move while alive, so pointers and references
+// to them stay valid until they are destroyed.  Freed slots are reused (most
+// recently freed first) before the pool grows.
+//
+// Elements created one after another are adjacent in memory, so walking a pool
+// in handle order (foreach) reads memory sequentially, and destroying the pool
+// releases whole chunks rather than individual elements.
+template <typename T, int ChunkBits = 12>
+class ElementPool {
+public:
+    static constexpr uint32_t chunkSize = 1u << ChunkBits;
+    static constexpr uint32_t slotMask = chunkSize - 1;
+private:
+    struct alignas(T) Chunk {
+        std::byte storage[sizeof(T) * chunkSize];
+    };
+
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    std::vector<uint8_t> live;          // indexed by handle
+    std::vector<uint32_t> freeHandles;
+    size_t count{0};
+    mutable int iterating{0}; // foreach calls in progress; create doesn't reuse freed slots while > 0
+
+    // counts a foreach in progress, until it returns or throws
+    class IterationScope {
+        int& depth;
+    public:
+        explicit IterationScope(int& depth) : depth{depth} { depth++; }
+        ~IterationScope() { depth--; }
+    };
+
+public:
+    ElementPool() = default;
+    ElementPool(const ElementPool& other) = delete;
+    ElementPool& operator=(const ElementPool& other) = delete;
+    ElementPool(ElementPool&& other) noexcept { swap(other); }
+    ElementPool& operator=(ElementPool&& other) noexcept { clear(); swap(other); return *this; }
+   ~ElementPool() { clear(); }
+
+    void swap(ElementPool& other) noexcept;
+
+    template <typename... Args>
+    T* create(uint32_t& handle, Args&&... args);
+    void destroy(uint32_t handle);
+
+    T* at(uint32_t handle) const {
+        return std::launder(reinterpret_cast<T*>(chunks[handle >> ChunkBits]->storage) + (handle & slotMask));
+    }
+    bool isLive(uint32_t handle) const { return handle < live.size() && live[handle]; }
+
+    size_t size() const { return count; }
+    uint32_t handleLimit() const { return live.size(); } // all handles issued so far are below this
+
+    void reserve(size_t n);
+    void clear();
+
+    // visit the elements that are live when the call starts, in handle order.
+    // f may create and destroy elements: those it destroys before reaching
+    // them are skipped, and those it creates are not visited
+    template <typename F>
+    void foreach(F&& f) const;
+    template <typename F>
+    bool foreachWhileTrue(F&& f) const;
+};
+
+template <typename T, int ChunkBits>
+void ElementPool<T, ChunkBits>::swap(ElementPool &other) noexcept
+{
+    chunks.swap(other.chunks);
+    live.swap(other.live);
+    freeHandles.swap(other.freeHandles);
+    std::swap(count, other.count);
+    std::swap(iterating, other.iterating);
+}
+
+template <typename T, int ChunkBits>
+template <typename... Args>
+T* ElementPool<T, ChunkBits>::create(uint32_t& handle, Args&&... args)
+{
+    if (!freeHandles.empty() && iterating == 0) {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
+    else {
+        handle = live.size();
+        if ((handle >> ChunkBits) >= chunks.size()) {
+            chunks.push_back(std::make_unique<Chunk>());
+        }
+        live.push_back(0);
+    }
+    T* element = new (at(handle)) T(std::forward<Args>(args)...);
+    live[handle] = 1;
+    count++;
+    return element;
+}
+
+template <typename T, int ChunkBits>
+void ElementPool<T, ChunkBits>::destroy(uint32_t handle)
+{
+    at(handle)->~T();
+    live[handle] = 0;
+    freeHandles.push_back(handle);
+    count--;
+}
+
+template <typename T, int ChunkBits>
+void ElementPool<T, ChunkBits>::reserve(size_t n)
+{
+    size_t neededChunks = (n + chunkSize - 1) >> ChunkBits;
+    while (chunks.size() < neededChunks) {
+        chunks.push_back(std::make_unique<Chunk>());
+    }
+    live.reserve(n);
+}
+
+template <typename T, int ChunkBits>
+void ElementPool<T, ChunkBits>::clear()
+{
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        for (uint32_t h = 0; h < live.size(); h++) {
+            if (live[h]) {
+                at(h)->~T();
+            }
+        }
+    }
+    chunks.clear();
+    live.clear();
+    freeHandles.clear();
+    count = 0;
+}
+
+template <typename T, int ChunkBits>
+template <typename F>
+void ElementPool<T, ChunkBits>::foreach(F&& f) const
+{
+    // new elements get handles past limit, since freed slots aren't reused meanwhile
+    IterationScope scope{iterating};
+    const uint32_t limit = live.size();
+    for (uint32_t h = 0; h < limit; h++) {
+        if (live[h]) {
+            f(*at(h));
+        }
+    }
+}
+
+template <typename T, int ChunkBits>
+template <typename F>
+bool ElementPool<T, ChunkBits>::foreachWhileTrue(F&& f) const
+{
+    IterationScope scope{iterating};
+    const uint32_t limit = live.size();
+    for (uint32_t h = 0; h < limit; h++) {
+        if (live[h] && !f(*at(h))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif // ELEMENTPOOL_H
@@ -8,87 +8,53 @@ namespace tinyobj {
     struct material_t;
 }
 
-template<typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
-class VMeshEdgeHE : public VMeshEdge {
-    Mesh<EBase, VBase, FBase>::Edge* edge;
-public:
-    VMeshEdgeHE(Mesh<EBase, VBase, FBase>::Edge* edge) : edge(edge) {}
-    void linkTwin(VMeshEdgeHE* twin) {
-        edge->setTwin(twin->edge);
-    }
-};
-
-template<typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
-class VMeshFaceHE : public VMeshFace {
-public:
-    Mesh<EBase, VBase, FBase>::Face* face;
-public:
-    VMeshFaceHE(Mesh<EBase, VBase, FBase>::Face* face) : face(face) {}
-    virtual std::vector<VMeshEdge*> getEdges() override;
-};
-
-template<typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
-class VMeshVertexHE : public VMeshVertex {
-public:
-    Mesh<EBase, VBase, FBase>::Vertex* vertex;
-public:
-    VMeshVertexHE(Mesh<EBase, VBase, FBase>::Vertex* vertex) : vertex(vertex) {}
-};
-
 template<typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
 class VMeshHE : public VMesh {
 public:
     Mesh<EBase, VBase, FBase>* mesh;
+private:
+    std::vector<typename Mesh<EBase, VBase, FBase>::Vertex*> faceVerts;
 public:
     VMeshHE(Mesh<EBase, VBase, FBase>* mesh) : mesh(mesh) {}
 
-    virtual VMeshVertex* createVertex(Vec3d pos, Vec2f uv);
-    virtual VMeshFace* createFace(std::vector<VMeshVertex*> verts);
-    virtual void linkEdges(VMeshEdge* e1, VMeshEdge* e2);
-    virtual void repairNonManifoldEdges();
+    virtual uint32_t createVertex(Vec3d pos, Vec2f uv) override;
+    virtual uint32_t createFace(const std::vector<uint32_t>& verts, std::vector<uint32_t>& edges) override;
+    virtual void linkEdges(uint32_t e1, uint32_t e2) override;
+    virtual void repairNonManifoldEdges() override;
 };
 
 template<typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
-inline std::vector<VMeshEdge *> VMeshFaceHE<EBase, VBase, FBase>::getEdges()
-{
-    std::vector<VMeshEdge *> edges;
-    for (auto& e : face->edges()) {
-        VMeshEdgeHE<EBase, VBase, FBase> *edge = new VMeshEdgeHE<EBase, VBase, FBase>(&e);
-        edges.push_back(edge);
-    }
-    return edges;
-}
-
-template<typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
-VMeshVertex *VMeshHE<EBase, VBase, FBase>::createVertex(Vec3d pos, Vec2f uv)
+uint32_t VMeshHE<EBase, VBase, FBase>::createVertex(Vec3d pos, Vec2f uv)
 {
     VBase vdata;
     vdata.pos = decltype(vdata.pos){pos};
     if constexpr (requires { vdata.uv; }) {
         vdata.uv = uv;
     }
-    auto& mv = mesh->createVertex(vdata);
-    return new VMeshVertexHE<EBase, VBase, FBase>(&mv);
+    return mesh->createVertex(vdata).handle();
 }
 
 template<typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
-VMeshFace *VMeshHE<EBase, VBase, FBase>::createFace(std::vector<VMeshVertex *> verts)
+uint32_t VMeshHE<EBase, VBase, FBase>::createFace(const std::vector<uint32_t>& verts, std::vector<uint32_t>& edges)
 {
-    std::vector<typename Mesh<EBase, VBase, FBase>::Vertex*> mVerts;
+    faceVerts.clear();
     for (auto v : verts) {
-        auto vhe = static_cast<VMeshVertexHE<EBase, VBase, FBase>*>(v);
-        mVerts.push_back(vhe->vertex);
+        faceVerts.push_back(&mesh->vertexAt(v));
+    }
+    auto& mf = mesh->createFace(faceVerts);
+    for (auto& e : mf.edges()) {
+        edges.push_back(e.handle());
     }
-    auto& mf = mesh->createFace(mVerts);
-    return new VMeshFaceHE<EBase, VBase, FBase>(&mf);
+    return mf.handle();
 }
 
 template<typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
-void VMeshHE<EBase, VBase, FBase>::linkEdges(VMeshEdge *e1, VMeshEdge *e2)
+void VMeshHE<EBase, VBase, FBase>::linkEdges(uint32_t e1, uint32_t e2)
 {
-    auto e1he = static_cast<VMeshEdgeHE<EBase, VBase, FBase>*>(e1);
-    auto e2he = static_cast<VMeshEdgeHE<EBase, VBase, FBase>*>(e2);
-    e1he->linkTwin(e2he);
+    auto& edge1 = mesh->edgeAt(e1);
+    auto& edge2 = mesh->edgeAt(e2);
+    edge1.setTwin(&edge2);
+    edge2.setTwin(&edge1);
 }
 
 template<typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
@@ -97,24 +63,13 @@ void VMeshHE<EBase, VBase, FBase>::repairNonManifoldEdges()
     mesh->repairNonManifoldEdges();
 }
 
-#include "meshloader.h"
-#include "mesh.h"
-#include <optional>
-
-namespace tinyobj {
-    struct material_t;
-}
-
-void loadMesh(VMesh& mesh, const std::string& filename, bool triangulate, std::function<void(VMeshFace&, std::optional<const tinyobj::material_t*>)> populator);
-
 template<typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
 void loadMesh(Mesh<EBase, VBase, FBase>& mesh, const std::string& filename, bool triangulate, std::function<void(typename Mesh<EBase, VBase, FBase>::Face&, std::optional<const tinyobj::material_t*>)> populator)
 {
     VMeshHE heMesh(&mesh);
 
-    auto vmesh_populator = [&populator](VMeshFace& face, std::optional<const tinyobj::material_t*> mat) {
-        auto heFace = static_cast<VMeshFaceHE<EBase, VBase, FBase>*>(&face);
-        populator(*heFace->face, mat);
+    auto vmesh_populator = [&mesh, &populator](uint32_t face, std::optional<const tinyobj::material_t*> mat) {
+        populator(mesh.faceAt(face), mat);
     };
 
     loadMesh(heMesh, filename, triangulate, vmesh_populator);
@@ -212,19 +212,21 @@ public:
         }
         count--;
     }
-    // Calls delete on all elements and clears the list
+    // Empties the list.  The elements belong to whoever created them (the mesh's
+    // pools), so they are only unlinked
     void clear() {
-        if (this->first) {
-            auto* ptr = this->first->getNext();
-            while (ptr != this->first) {
-                auto next = ptr->getNext();
-                delete ptr;
-                count--;
-                ptr = next;
-            }
-            delete this->first;
-            count--;
-            this->first = nullptr;
+        this->first = nullptr;
+        count = 0;
+    }
+
+    // Empties the list, passing each element to release (e.g. a lambda that
+    // destroys it in its pool) after it has been unlinked
+    template <typename F>
+    void clear(F&& release) {
+        while (this->first) {
+            T* element = this->first;
+            remove(element);
+            release(element);
         }
     }
 
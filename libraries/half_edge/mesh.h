@@ -2,8 +2,13 @@
 #define MESH_H
 
 #include <list>
+#include <cmath>
 #include <functional>
+#include <memory>
+#include <unordered_map>
 
+#include "elementpool.h"
+#include "spatialgrid.h"
 #include "loopiterable.h"
 #include "geometry.h"
 
@@ -50,6 +55,24 @@
 /// // add a second triangle, making a square
 /// auto& v4 = mesh.extrudeVertex(v3.firstEdge(), {0,1});
 /// mesh.join(v4.firstEdge(), v1.firstEdge());
+///
+/// Storage:
+///
+/// Vertices, edges and faces live in chunked pools (see ElementPool) rather than
+/// being allocated individually.  Each element has a 32 bit handle() that stays
+/// valid until the element is removed, and can be looked up with vertexAt(),
+/// edgeAt() and faceAt().  After many removals, compact() packs the survivors
+/// (edges of a face next to each other) and renumbers them; this invalidates all
+/// element references, pointers and handles.
+///
+/// Spatial queries:
+///
+/// closestVertex(), closestEdge() and enclosingFace() scan every element unless
+/// enableSpatialIndex() has been called.  With the index enabled they (and the
+/// closestVertices / verticesWithin / edgesWithin queries) only look at nearby
+/// grid cells.  The index is updated as the mesh is edited through Mesh
+/// functions; if you change a vertex position yourself, use moveVertex() or
+/// call invalidateSpatialIndex() afterwards.  The index only looks at x and y.
 
 
 class MeshBase {
@@ -114,6 +137,7 @@ public:
         Vertex* next{}; // next in list of vertices on the mesh (this is consequence of allocation strategy, not part of the half edge ADT)
         Vertex* prev{}; // prev in list of vertices on the mesh (this is consequence of allocation strategy, not part of the half edge ADT)
         Edge* edge{}; // one of the "outgoing" edges from this vertex
+        uint32_t id{}; // handle in the mesh's vertex pool
     public:
         Vertex(const VBase& vdata) : VBase{vdata} {}
         Vertex(const Vertex& other) = delete;
@@ -125,6 +149,7 @@ public:
 
         Vertex* getNext() const { return next; }
         Vertex* getPrev() const { return prev; }
+        uint32_t handle() const { return id; }
 
         VertexVertices vertices() const { return {edge->twin}; }
         VertexPoints points() const { return {edge}; }
@@ -151,6 +176,7 @@ public:
         Face* fp{};    // face that this is an edge of
         Edge* next{};  // next edge in loop (next ccw order)
         Edge* prev{};  // prev edge in loop (next cw edge)
+        uint32_t id{}; // handle in the mesh's edge pool
     public:
         Edge(Vertex* v1) : v{v1} {}
         Edge(const Edge& other) = delete;
@@ -162,6 +188,7 @@ public:
 
         Edge* getNext() const { return next; }
         Edge* getPrev() const { return prev; }
+        uint32_t handle() const { return id; }
 
         Edges edgeLoop() const { return { const_cast<Edge*>(this)}; }
         FaceVertices vertexLoop() const { return { const_cast<Edge*>(this)}; }
@@ -201,6 +228,7 @@ public:
         Edge* edge{}; // one of the edges of this face
         Face* next{}; // next in list of faces on the mesh (this is consequence of allocation strategy, not part of the half edge ADT)
         Face* prev{}; // prev in list of faces on the mesh (this is consequence of allocation strategy, not part of the half edge ADT)
+        uint32_t id{}; // handle in the mesh's face pool
     public:
         Face(Edge* edge) : edge{edge} { }
         Face(const Face& other) = delete;
@@ -212,6 +240,7 @@ public:
 
         Face* getNext() const { return next; }
         Face* getPrev() const { return prev; }
+        uint32_t handle() const { return id; }
 
         Edges edges() const { return {edge}; }
         FaceVertices vertices() const { return {edge}; }
@@ -231,28 +260,44 @@ public:
     };
 
 private:
+    // element storage (owns the elements; removed elements' slots are reused)
+    ElementPool<Vertex> vertexPool;
+    ElementPool<Edge> edgePool;
+    ElementPool<Face> facePool;
+
     CircularList<Vertex> vertexList;
     CircularList<Face> faceList;
 
-    // cache deleted elements for reuse
-    // TODO: think about how to make allocation scheme composable
-    CircularList<Edge> deletedEdges;
-    CircularList<Vertex> deletedVertices;
-    CircularList<Face> deletedFaces;
+    // optional acceleration for the spatial queries (see enableSpatialIndex)
+    class SpatialIndex {
+    public:
+        SpatialGrid vertexGrid;
+        SpatialGrid edgeGrid;  // half edges that belong to a face
+        SpatialGrid faceGrid;  // ccw faces only (enclosingFace ignores cw faces)
+        std::vector<uint32_t> pendingVertices; // created or moved since the last query
+        std::vector<uint32_t> pendingFaces;    // created or reshaped since the last query (edges included)
+        bool needsRebuild{true};
+        size_t builtForVertices{0};
+    };
 
-    // TODO: remove... testing only
-    int reusedEdges{};
-    int reusedVertices{};
-    int reusedFaces{};
+    mutable std::unique_ptr<SpatialIndex> spatialIndex;
 
 public:
     Mesh() {}
     Mesh(const Mesh& other) = delete;
     Mesh& operator= (const Mesh& other) = delete;
-   ~Mesh();
+   ~Mesh() = default;
 
     size_t numFaces() const { return faceList.size(); }
     size_t numVertices() const { return vertexList.size(); }
+    size_t numEdges() const { return edgePool.size(); } // half edges
+
+    Vertex& vertexAt(uint32_t handle) const { return *vertexPool.at(handle); }
+    Edge& edgeAt(uint32_t handle) const { return *edgePool.at(handle); }
+    Face& faceAt(uint32_t handle) const { return *facePool.at(handle); }
+
+    void reserve(size_t vertices, size_t halfEdges, size_t faces); // avoid chunk growth during bulk construction
+    void compact(); // renumber elements densely; invalidates all element references and handles
 
     const CircularList<Face>& faces() const { return faceList; }
     const CircularList<Vertex>& vertices() const { return vertexList; }
@@ -283,8 +328,19 @@ public:
     Vertex* closestVertex(posType pos) const;
     Edge* closestEdge(posType pos) const;
     Face* enclosingFace(posType pos) const; // note: assumes 2d
+    std::vector<Vertex*> closestVertices(posType pos, size_t k) const; // up to k vertices, nearest first
+    std::vector<Vertex*> verticesWithin(posType pos, double radius) const;
+    std::vector<Edge*> edgesWithin(posType pos, double radius) const;
+
+    void enableSpatialIndex(bool enable = true);
+    bool hasSpatialIndex() const { return spatialIndex != nullptr; }
+    void invalidateSpatialIndex(); // call after changing vertex positions directly
+    void moveVertex(Vertex& v, posType pos); // keeps the spatial index up to date
     Edge* edgeBetween(Vertex& v1, Vertex& v2) const; // find an edge from v1 to v2
 
+    // Edges that have a face, in storage order (roughly creation order), not
+    // face by face.  Only edges that existed when the call started are
+    // visited, so the visitor may split or add edges.
     void iterateEdges(std::function<void(Edge& e)> visitor) const;
     bool iterateEdgesWhileTrue(std::function<bool(Edge& e)> visitor)  const;
 
@@ -293,8 +349,8 @@ public:
     Edge& createEdge(Vertex& vertex);
     Face& createFace(Edge& edge);
 
-    Face& createFace(std::vector<Edge*> edges);
-    Face& createFace(std::vector<Vertex*> vertices);
+    Face& createFace(const std::vector<Edge*>& edges);
+    Face& createFace(const std::vector<Vertex*>& vertices);
 
     void repairNonManifoldEdges();
 
@@ -310,8 +366,16 @@ private:
     bool validate(Edge& e);
     void removeTail(Edge& e, Vertex& v);
 
-    Edge* findTwinlessEdge();
-    std::vector<Edge*> buildTwinlessEdgeLoop(Edge *start);
+    using TwinlessEdges = std::unordered_map<uint32_t, std::vector<Edge*>>; // by end vertex handle
+    std::vector<Edge*> buildTwinlessEdgeLoop(Edge *start, const TwinlessEdges& byEnd, size_t twinlessCount);
+
+    void touchVertex(Vertex& v) { if (spatialIndex) { spatialIndex->pendingVertices.push_back(v.id); } }
+    void touchFace(Face* f) { if (spatialIndex && f) { spatialIndex->pendingFaces.push_back(f->id); } }
+    void syncSpatialIndex() const;
+    void rebuildSpatialIndex() const;
+    void indexFace(Face& f) const;
+    template <typename F>
+    void searchOutward(const SpatialGrid& grid, posType pos, const double& bound, F&& visit) const;
 };
 
 template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
@@ -385,47 +449,33 @@ void Mesh<EBase, VBase, FBase>::Face::getTriVerts(posType &p1, posType &p2, posT
     p3 = e->p1();
 }
 
-template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
-Mesh<EBase, VBase, FBase>::~Mesh()
-{
-    // delete edges via faces
-    for (auto& f : faceList) {
-        if (f.edge) {
-            Edge* prev = f.edge;
-            Edge* e = prev->next;
-            prev->next = nullptr;
-            while (e) {
-                Edge* next = e->next;
-                delete e;
-                e = next;
-            }
-        }
-    }
-
-    deletedEdges.clear();
-    deletedFaces.clear();
-    deletedVertices.clear();
-    vertexList.clear();
-}
-
 template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
 void Mesh<EBase, VBase, FBase>::deleteVertex(Vertex &v)
 {
+    if (spatialIndex) {
+        spatialIndex->vertexGrid.remove(v.id);
+    }
     vertexList.remove(&v);
-    deletedVertices.push_back(&v);
+    vertexPool.destroy(v.id);
 }
 
 template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
 void Mesh<EBase, VBase, FBase>::deleteFace(Face &f)
 {
+    if (spatialIndex) {
+        spatialIndex->faceGrid.remove(f.id);
+    }
     faceList.remove(&f);
-    deletedFaces.push_back(&f);
+    facePool.destroy(f.id);
 }
 
 template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
 void Mesh<EBase, VBase, FBase>::deleteEdge(Edge &e)
 {
-    deletedEdges.push_back(&e);
+    if (spatialIndex) {
+        spatialIndex->edgeGrid.remove(e.id);
+    }
+    edgePool.destroy(e.id);
 }
 
 template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
@@ -476,6 +526,8 @@ Mesh<EBase, VBase, FBase>::Vertex& Mesh<EBase, VBase, FBase>::initPoint(posType
     e.twin = &e;
     v.edge = &e;
 
+    touchFace(&f);
+
     return v;
 }
 
@@ -670,7 +722,7 @@ Mesh<EBase, VBase, FBase>::Vertex& Mesh<EBase, VBase, FBase>::extrudeVertex(Edge
 
         newOld.fp = corner.fp;
 
-
+        touchFace(corner.fp);
 
         return newV;
     }
@@ -700,6 +752,8 @@ Mesh<EBase, VBase, FBase>::Vertex& Mesh<EBase, VBase, FBase>::extrudeVertex(Edge
     oldNew.fp = corner.fp;
     newOld.fp = corner.fp;
 
+    touchFace(corner.fp);
+
     return newV;
 }
 
@@ -803,6 +857,8 @@ Mesh<EBase, VBase, FBase>::Edge& Mesh<EBase, VBase, FBase>::join(Edge &corner1,
         }
     }
 
+    touchFace(oldFace);
+
     return v1v2;
 }
 
@@ -835,6 +891,9 @@ Mesh<EBase, VBase, FBase>::Vertex& Mesh<EBase, VBase, FBase>::insertVertexBetwee
     oldNew.fp = e1.fp;
     newOld.fp = e2.fp;  // TODO: e1.fp should be equal to e2.fp (assert?)
 
+    touchFace(e1.fp);
+    touchFace(e2.fp);
+
     return newV;
 }
 
@@ -944,6 +1003,9 @@ Mesh<EBase, VBase, FBase>::Vertex& Mesh<EBase, VBase, FBase>::divideEdge(Edge &e
     e23.twin = &e32;
     e32.twin = &e23;
 
+    touchFace(e12.fp);
+    touchFace(e32.fp);
+
     return v2;
 }
 
@@ -1025,6 +1087,8 @@ Mesh<EBase, VBase, FBase>::Face* Mesh<EBase, VBase, FBase>::removeEdge(Edge &e)
     deleteEdge(twin);
     deleteEdge(e);
 
+    touchFace(remainingFace);
+
     return remainingFace;
 }
 
@@ -1078,6 +1142,20 @@ Mesh<EBase, VBase, FBase>::Vertex *Mesh<EBase, VBase, FBase>::closestVertex(posT
 {
     Mesh::Vertex* best = nullptr;
     double mindist = std::numeric_limits<double>::max();
+
+    if (spatialIndex) {
+        syncSpatialIndex();
+        searchOutward(spatialIndex->vertexGrid, pos, mindist, [&](uint32_t h) {
+            Vertex& v = *vertexPool.at(h);
+            double dist = (v.pos - pos).magnitude();
+            if (dist < mindist) {
+                mindist = dist;
+                best = &v;
+            }
+        });
+        return best;
+    }
+
     for (auto& v : vertexList) {
         double dist = (v.pos - pos).magnitude();
         if (dist < mindist) {
@@ -1093,6 +1171,20 @@ Mesh<EBase, VBase, FBase>::Edge *Mesh<EBase, VBase, FBase>::closestEdge(posType
 {
     Edge* best{nullptr};
     double mindist = std::numeric_limits<double>::max();
+
+    if (spatialIndex) {
+        syncSpatialIndex();
+        searchOutward(spatialIndex->edgeGrid, pos, mindist, [&](uint32_t h) {
+            Edge& e = *edgePool.at(h);
+            double dist = distanceToSegment(pos, e.v1().pos, e.v2().pos);
+            if (dist < mindist) {
+                mindist = dist;
+                best = &e;
+            }
+        });
+        return best;
+    }
+
     iterateEdges([&best, &mindist, &pos](Edge& e) {
         double dist = distanceToSegment(pos, e.v1().pos, e.v2().pos);
         if (dist < mindist) {
@@ -1106,6 +1198,24 @@ Mesh<EBase, VBase, FBase>::Edge *Mesh<EBase, VBase, FBase>::closestEdge(posType
 template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
 Mesh<EBase, VBase, FBase>::Face *Mesh<EBase, VBase, FBase>::enclosingFace(posType pos) const
 {
+    if (spatialIndex) {
+        syncSpatialIndex();
+        const SpatialGrid& grid = spatialIndex->faceGrid;
+        SpatialGrid::Box at{pos.x, pos.y, pos.x, pos.y};
+        if (!grid.covers(at)) {
+            return nullptr; // every ccw face lies inside the grid
+        }
+        Face* found{nullptr};
+        grid.beginSearch();
+        grid.foreachInBox(at, [&](uint32_t h) {
+            Face& f = *facePool.at(h);
+            if (!found && pointInPolygon(pos, f.points())) {
+                found = &f;
+            }
+        });
+        return found;
+    }
+
     for (auto& f : faceList) {
         if (f.isCW()) {
             continue;
@@ -1118,94 +1228,440 @@ Mesh<EBase, VBase, FBase>::Face *Mesh<EBase, VBase, FBase>::enclosingFace(posTyp
 }
 
 template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
-Mesh<EBase, VBase, FBase>::Edge *Mesh<EBase, VBase, FBase>::edgeBetween(Vertex &v1, Vertex &v2) const
+std::vector<typename Mesh<EBase, VBase, FBase>::Vertex*> Mesh<EBase, VBase, FBase>::closestVertices(posType pos, size_t k) const
 {
-    for (auto& e : v1.outgoingEdges()) {
-        if (&e.v2() == &v2) {
-            return &e;
+    using Candidate = std::pair<double, Vertex*>;
+
+    std::vector<Candidate> heap; // max heap on distance, holding the best k so far
+    heap.reserve(k + 1);
+
+    double bound = k > 0 ? std::numeric_limits<double>::max() : 0;
+
+    auto consider = [&](Vertex& v) {
+        double dist = (v.pos - pos).magnitude();
+        if (heap.size() < k || dist < heap.front().first) {
+            heap.emplace_back(dist, &v);
+            std::push_heap(heap.begin(), heap.end());
+            if (heap.size() > k) {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.pop_back();
+            }
+            if (heap.size() == k) {
+                bound = heap.front().first;
+            }
         }
+    };
+
+    if (k == 0) {
+        return {};
     }
-    return nullptr;
+
+    if (spatialIndex) {
+        syncSpatialIndex();
+        searchOutward(spatialIndex->vertexGrid, pos, bound, [&](uint32_t h) { consider(*vertexPool.at(h)); });
+    }
+    else {
+        for (auto& v : vertexList) {
+            consider(v);
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end());
+
+    std::vector<Vertex*> result;
+    result.reserve(heap.size());
+    for (auto& c : heap) {
+        result.push_back(c.second);
+    }
+    return result;
 }
 
 template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
-void Mesh<EBase, VBase, FBase>::iterateEdges(std::function<void (Edge &)> visitor) const
+std::vector<typename Mesh<EBase, VBase, FBase>::Vertex*> Mesh<EBase, VBase, FBase>::verticesWithin(posType pos, double radius) const
 {
-    for (auto& f : faceList) {
-        for (auto& e : f.edges()) {
-            visitor(e);
+    std::vector<Vertex*> result;
+
+    auto consider = [&](Vertex& v) {
+        if ((v.pos - pos).magnitude() <= radius) {
+            result.push_back(&v);
+        }
+    };
+
+    if (spatialIndex) {
+        syncSpatialIndex();
+        const SpatialGrid& grid = spatialIndex->vertexGrid;
+        grid.beginSearch();
+        grid.foreachInBox(SpatialGrid::Box{pos.x, pos.y, pos.x, pos.y}.expanded(radius),
+                          [&](uint32_t h) { consider(*vertexPool.at(h)); });
+    }
+    else {
+        for (auto& v : vertexList) {
+            consider(v);
         }
     }
+
+    return result;
 }
 
 template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
-bool Mesh<EBase, VBase, FBase>::iterateEdgesWhileTrue(std::function<bool (Edge &)> visitor) const
+std::vector<typename Mesh<EBase, VBase, FBase>::Edge*> Mesh<EBase, VBase, FBase>::edgesWithin(posType pos, double radius) const
 {
-    for (auto& f : faceList) {
-        for (auto& e : f.edges()) {
-            if (!visitor(e)) {
-                return false;
+    std::vector<Edge*> result;
+
+    auto consider = [&](Edge& e) {
+        if (distanceToSegment(pos, e.v1().pos, e.v2().pos) <= radius) {
+            result.push_back(&e);
+        }
+    };
+
+    if (spatialIndex) {
+        syncSpatialIndex();
+        const SpatialGrid& grid = spatialIndex->edgeGrid;
+        grid.beginSearch();
+        grid.foreachInBox(SpatialGrid::Box{pos.x, pos.y, pos.x, pos.y}.expanded(radius),
+                          [&](uint32_t h) { consider(*edgePool.at(h)); });
+    }
+    else {
+        iterateEdges(consider);
+    }
+
+    return result;
+}
+
+template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
+void Mesh<EBase, VBase, FBase>::enableSpatialIndex(bool enable)
+{
+    static_assert(!requires (posType p) { p.z; }, "the mesh spatial index only supports 2d positions");
+
+    if (!enable) {
+        spatialIndex.reset();
+    }
+    else if (!spatialIndex) {
+        spatialIndex = std::make_unique<SpatialIndex>(); // built on the first query
+    }
+}
+
+template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
+void Mesh<EBase, VBase, FBase>::invalidateSpatialIndex()
+{
+    if (spatialIndex) {
+        spatialIndex->needsRebuild = true;
+        spatialIndex->pendingVertices.clear();
+        spatialIndex->pendingFaces.clear();
+    }
+}
+
+template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
+void Mesh<EBase, VBase, FBase>::moveVertex(Vertex &v, posType pos)
+{
+    v.pos = pos;
+    if (!spatialIndex) {
+        return;
+    }
+    touchVertex(v);
+    if (v.edge) {
+        // the edges into and out of v all belong to the faces of its outgoing edges
+        for (auto& e : v.outgoingEdges()) {
+            touchFace(e.fp);
+        }
+    }
+}
+
+template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
+void Mesh<EBase, VBase, FBase>::syncSpatialIndex() const
+{
+    SpatialIndex& si = *spatialIndex;
+
+    // keep cells at around one vertex each as the mesh grows or shrinks
+    size_t n = vertexPool.size();
+    if (n > 4 * si.builtForVertices + 64 || 4 * n + 64 < si.builtForVertices) {
+        si.needsRebuild = true;
+    }
+
+    if (!si.needsRebuild) {
+        for (uint32_t h : si.pendingVertices) {
+            if (!vertexPool.isLive(h)) {
+                continue; // removed again since
+            }
+            const posType& p = vertexPool.at(h)->pos;
+            SpatialGrid::Box box{p.x, p.y, p.x, p.y};
+            if (!si.vertexGrid.covers(box)) {
+                si.needsRebuild = true; // outgrew the grid
+                break;
             }
+            si.vertexGrid.insert(h, box);
         }
     }
-    return true;
+
+    if (!si.needsRebuild) {
+        // edges and faces lie within the bounds of their vertices, so they fit too
+        for (uint32_t h : si.pendingFaces) {
+            if (facePool.isLive(h)) {
+                indexFace(*facePool.at(h));
+            }
+        }
+    }
+
+    si.pendingVertices.clear();
+    si.pendingFaces.clear();
+
+    if (si.needsRebuild) {
+        rebuildSpatialIndex();
+    }
 }
 
+template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
+void Mesh<EBase, VBase, FBase>::rebuildSpatialIndex() const
+{
+    SpatialIndex& si = *spatialIndex;
+
+    double x0 = std::numeric_limits<double>::max();
+    double y0 = std::numeric_limits<double>::max();
+    double x1 = std::numeric_limits<double>::lowest();
+    double y1 = std::numeric_limits<double>::lowest();
+
+    for (auto& v : vertexList) {
+        x0 = std::min<double>(x0, v.pos.x);
+        y0 = std::min<double>(y0, v.pos.y);
+        x1 = std::max<double>(x1, v.pos.x);
+        y1 = std::max<double>(y1, v.pos.y);
+    }
+
+    if (vertexList.empty()) {
+        x0 = y0 = x1 = y1 = 0;
+    }
+
+    // leave room around the mesh so it can grow a little before the next rebuild
+    double pad = std::max(x1 - x0, y1 - y0) * 0.25;
+    if (pad <= 0) {
+        pad = 1;
+    }
+    SpatialGrid::Box bounds = SpatialGrid::Box{x0, y0, x1, y1}.expanded(pad);
+
+    size_t n = std::max<size_t>(vertexList.size(), 1);
+    double cellSize = std::sqrt((bounds.x1 - bounds.x0) * (bounds.y1 - bounds.y0) / n);
+
+    si.vertexGrid.reset(bounds, cellSize);
+    si.edgeGrid.reset(bounds, cellSize);
+    si.faceGrid.reset(bounds, cellSize);
+
+    for (auto& v : vertexList) {
+        si.vertexGrid.insert(v.id, SpatialGrid::Box{v.pos.x, v.pos.y, v.pos.x, v.pos.y});
+    }
+
+    for (auto& f : faceList) {
+        indexFace(f);
+    }
+
+    si.builtForVertices = vertexList.size();
+    si.needsRebuild = false;
+}
 
 template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
-Mesh<EBase, VBase, FBase>::Vertex &Mesh<EBase, VBase, FBase>::createVertex(const VBase& vdata)
+void Mesh<EBase, VBase, FBase>::indexFace(Face &f) const
 {
-    if (deletedVertices.empty()) {
-        vertexList.push_back(new Vertex(vdata));
-        return vertexList.back();
+    SpatialIndex& si = *spatialIndex;
+
+    SpatialGrid::Box faceBox{std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
+                             std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
+
+    for (auto& e : f.edges()) {
+        const posType& p1 = e.p1();
+        const posType& p2 = e.p2();
+        SpatialGrid::Box edgeBox{std::min<double>(p1.x, p2.x), std::min<double>(p1.y, p2.y),
+                                 std::max<double>(p1.x, p2.x), std::max<double>(p1.y, p2.y)};
+        si.edgeGrid.insert(e.id, edgeBox);
+        faceBox.x0 = std::min(faceBox.x0, edgeBox.x0);
+        faceBox.y0 = std::min(faceBox.y0, edgeBox.y0);
+        faceBox.x1 = std::max(faceBox.x1, edgeBox.x1);
+        faceBox.y1 = std::max(faceBox.y1, edgeBox.y1);
     }
-    auto& v = deletedVertices.pop_front();
 
-    v = vdata;  // set base to defaults
+    if (f.isCCW()) {
+        si.faceGrid.insert(f.id, faceBox);
+    }
+    else {
+        si.faceGrid.remove(f.id);
+    }
+}
 
-    vertexList.push_back(&v);
-    reusedVertices++;
-    return v;
+// visit the ids in grid cells in rings of increasing distance from pos, until
+// the rings are further away than bound (which visit may lower as it goes)
+template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
+template <typename F>
+void Mesh<EBase, VBase, FBase>::searchOutward(const SpatialGrid& grid, posType pos, const double& bound, F&& visit) const
+{
+    if (grid.isEmpty()) {
+        return;
+    }
+    int col = grid.colOf(pos.x);
+    int row = grid.rowOf(pos.y);
+    int lastRing = grid.maxRing(col, row);
+    grid.beginSearch();
+    for (int ring = 0; ring <= lastRing; ring++) {
+        if (grid.ringLowerBound(pos.x, pos.y, col, row, ring) >= bound) {
+            break;
+        }
+        grid.foreachInRing(col, row, ring, visit);
+    }
 }
 
 template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
-Mesh<EBase, VBase, FBase>::Edge &Mesh<EBase, VBase, FBase>::createEdge(Vertex &vertex)
+Mesh<EBase, VBase, FBase>::Edge *Mesh<EBase, VBase, FBase>::edgeBetween(Vertex &v1, Vertex &v2) const
 {
-    if (deletedEdges.empty()) {
-        return *new Edge(&vertex);
+    for (auto& e : v1.outgoingEdges()) {
+        if (&e.v2() == &v2) {
+            return &e;
+        }
     }
-    auto& e = deletedEdges.pop_front();
+    return nullptr;
+}
+
+template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
+void Mesh<EBase, VBase, FBase>::iterateEdges(std::function<void (Edge &)> visitor) const
+{
+    // walk the edge pool in memory order rather than chasing face loops;
+    // edges without a face are not part of any face loop, so skip them.
+    // Edges the visitor creates are not visited (see ElementPool::foreach)
+    edgePool.foreach([&visitor](Edge& e) {
+        if (e.fp) {
+            visitor(e);
+        }
+    });
+}
+
+template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
+bool Mesh<EBase, VBase, FBase>::iterateEdgesWhileTrue(std::function<bool (Edge &)> visitor) const
+{
+    return edgePool.foreachWhileTrue([&visitor](Edge& e) {
+        return !e.fp || visitor(e);
+    });
+}
 
-    EBase base{};
-    e = base;  // set base to defaults
 
-    e.v = &vertex;
-    reusedEdges++;
+template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
+Mesh<EBase, VBase, FBase>::Vertex &Mesh<EBase, VBase, FBase>::createVertex(const VBase& vdata)
+{
+    uint32_t handle;
+    Vertex* v = vertexPool.create(handle, vdata);
+    v->id = handle;
+    vertexList.push_back(v);
+    touchVertex(*v);
+    return *v;
+}
 
-    return e;
+template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
+Mesh<EBase, VBase, FBase>::Edge &Mesh<EBase, VBase, FBase>::createEdge(Vertex &vertex)
+{
+    uint32_t handle;
+    Edge* e = edgePool.create(handle, &vertex);
+    e->id = handle;
+    return *e;
 }
 
 template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
 Mesh<EBase, VBase, FBase>::Face &Mesh<EBase, VBase, FBase>::createFace(Edge &edge)
 {
-    if (deletedFaces.empty()) {
-        faceList.push_back(new Face(&edge));
-        return faceList.back();
+    uint32_t handle;
+    Face* f = facePool.create(handle, &edge);
+    f->id = handle;
+    faceList.push_back(f);
+    touchFace(f);
+    return *f;
+}
+
+template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
+void Mesh<EBase, VBase, FBase>::reserve(size_t vertices, size_t halfEdges, size_t faces)
+{
+    vertexPool.reserve(vertices);
+    edgePool.reserve(halfEdges);
+    facePool.reserve(faces);
+}
+
+template <typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
+void Mesh<EBase, VBase, FBase>::compact()
+{
+    ElementPool<Vertex> newVertices;
+    ElementPool<Edge> newEdges;
+    ElementPool<Face> newFaces;
+
+    newVertices.reserve(vertexPool.size());
+    newEdges.reserve(edgePool.size());
+    newFaces.reserve(facePool.size());
+
+    // old handle -> new element
+    std::vector<Vertex*> vmap(vertexPool.handleLimit(), nullptr);
+    std::vector<Edge*> emap(edgePool.handleLimit(), nullptr);
+    std::vector<Face*> fmap(facePool.handleLimit(), nullptr);
+
+    uint32_t handle;
+
+    auto copyEdge = [&](Edge& e) {
+        if (!emap[e.id]) {
+            Edge* ne = newEdges.create(handle, nullptr);
+            ne->id = handle;
+            *ne = static_cast<const EBase&>(e);
+            emap[e.id] = ne;
+        }
+    };
+
+    for (auto& v : vertexList) {
+        Vertex* nv = newVertices.create(handle, static_cast<const VBase&>(v));
+        nv->id = handle;
+        vmap[v.id] = nv;
     }
-    auto& f = deletedFaces.pop_front();
 
-    FBase base{};
-    f = base;  // set base to defaults
+    // faces in list order, each followed by its edge loop, so face traversal is sequential
+    for (auto& f : faceList) {
+        Face* nf = newFaces.create(handle, nullptr);
+        nf->id = handle;
+        *nf = static_cast<const FBase&>(f);
+        fmap[f.id] = nf;
+        for (auto& e : f.edges()) {
+            copyEdge(e);
+        }
+    }
 
-    f.edge = &edge;
-    faceList.push_back(&f);
-    reusedFaces++;
+    // edges not (yet) in a face loop
+    edgePool.foreach(copyEdge);
 
-    return f;
+    auto mapEdge = [&emap](Edge* e) { return e ? emap[e->id] : nullptr; };
+
+    CircularList<Vertex> newVertexList;
+    CircularList<Face> newFaceList;
+
+    for (auto& v : vertexList) {
+        Vertex* nv = vmap[v.id];
+        nv->edge = mapEdge(v.edge);
+        newVertexList.push_back(nv);
+    }
+
+    for (auto& f : faceList) {
+        Face* nf = fmap[f.id];
+        nf->edge = mapEdge(f.edge);
+        newFaceList.push_back(nf);
+    }
+
+    edgePool.foreach([&](Edge& e) {
+        Edge* ne = emap[e.id];
+        ne->v = e.v ? vmap[e.v->id] : nullptr;
+        ne->twin = mapEdge(e.twin);
+        ne->next = mapEdge(e.next);
+        ne->prev = mapEdge(e.prev);
+        ne->fp = e.fp ? fmap[e.fp->id] : nullptr;
+    });
+
+    vertexPool = std::move(newVertices);
+    edgePool = std::move(newEdges);
+    facePool = std::move(newFaces);
+    vertexList = newVertexList;
+    faceList = newFaceList;
+
+    invalidateSpatialIndex(); // every handle changed
 }
 
 template<typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
-inline Mesh<EBase, VBase, FBase>::Face &Mesh<EBase, VBase, FBase>::createFace(std::vector<Edge *> edges)
+inline Mesh<EBase, VBase, FBase>::Face &Mesh<EBase, VBase, FBase>::createFace(const std::vector<Edge *>& edges)
 {
     auto& f = createFace(*edges[0]);
     for (int i = 0; i < edges.size(); i++) {
@@ -1219,7 +1675,7 @@ inline Mesh<EBase, VBase, FBase>::Face &Mesh<EBase, VBase, FBase>::createFace(st
 }
 
 template<typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
-inline Mesh<EBase, VBase, FBase>::Face &Mesh<EBase, VBase, FBase>::createFace(std::vector<Vertex *> vertices)
+inline Mesh<EBase, VBase, FBase>::Face &Mesh<EBase, VBase, FBase>::createFace(const std::vector<Vertex *>& vertices)
 {
     std::vector<Edge *> edges;
     for (auto v : vertices) {
@@ -1233,37 +1689,10 @@ inline Mesh<EBase, VBase, FBase>::Face &Mesh<EBase, VBase, FBase>::createFace(st
 }
 
 template<typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
-Mesh<EBase, VBase, FBase>::Edge *Mesh<EBase, VBase, FBase>::findTwinlessEdge()
-{
-    Edge* e1{nullptr};
-
-    for (auto& f : faces()) {
-        for (auto& e : f.edges()) {
-            if (!e.twin) {
-                e1 = &e;
-                break;
-            }
-            // found an edge without a twin
-        }
-        if (e1) {
-            break;
-        }
-    }
-
-    return e1;
-}
-
-template<typename EBase, typename VBase, typename FBase> requires hasPosField<VBase>
-std::vector<typename Mesh<EBase, VBase, FBase>::Edge *> Mesh<EBase, VBase, FBase>::buildTwinlessEdgeLoop(Edge *start)
+std::vector<typename Mesh<EBase, VBase, FBase>::Edge *> Mesh<EBase, VBase, FBase>::buildTwinlessEdgeLoop(Edge *start, const TwinlessEdges& byEnd, size_t twinlessCount)
 {
     // start is a twinless edge, try to build a loop of twinless edges
 
-    int edgeCount = 0;
-
-    this->iterateEdges([&edgeCount](Edge& e) {
-        edgeCount++;
-    });
-
     std::vector<Edge*> loop;
 
     loop.push_back(start);
@@ -1275,13 +1704,15 @@ std::vector<typename Mesh<EBase, VBase, FBase>::Edge *> Mesh<EBase, VBase, FBase
         eCurr = eNext;
         eNext = nullptr;
         // find a twinless edge that ends on eCurr's vertex
-        this->iterateEdgesWhileTrue([eCurr, &eNext](Edge& e) {
-            if (&e.v2() == &eCurr->v1() && e.twin == nullptr) {
-                eNext = &e;
-                return false; // stop iteration
+        auto candidates = byEnd.find(eCurr->v1().id);
+        if (candidates != byEnd.end()) {
+            for (Edge* e : candidates->second) {
+                if (e->twin == nullptr) {
+                    eNext = e;
+                    break;
+                }
             }
-            return true; // keep searching
-        });
+        }
         if (eNext) {
             // found the next edge
             if (eNext == loop.front()) {
@@ -1289,7 +1720,7 @@ std::vector<typename Mesh<EBase, VBase, FBase>::Edge *> Mesh<EBase, VBase, FBase
                 break;
             }
             loop.push_back(eNext);
-            if (loop.size() > edgeCount) {
+            if (loop.size() > twinlessCount) {
                 throw std::runtime_error("Cannot repair non manifold mesh");
             }
         }
@@ -1307,15 +1738,25 @@ void Mesh<EBase, VBase, FBase>::repairNonManifoldEdges()
     // when one is found, try to find a loop of twinless edges, keeping track of the vertices
     // if a loop is found, create a new face using those vertices
 
-    while (true) {
-        Edge* e1 = findTwinlessEdge();
+    // gather the twinless edges up front (by end vertex) so following a loop
+    // doesn't mean searching every edge of the mesh at each step
+    std::vector<Edge*> twinless;
+    TwinlessEdges byEnd;
 
-        if (!e1) {
-            // no twinless edges found
-            return;
+    iterateEdges([&twinless, &byEnd](Edge& e) {
+        if (!e.twin) {
+            twinless.push_back(&e);
+            byEnd[e.v2().id].push_back(&e);
         }
+    });
 
-        auto loop = buildTwinlessEdgeLoop(e1);
+    for (Edge* e1 : twinless) {
+        if (e1->twin) {
+            // already closed off as part of an earlier loop
+            continue;
+        }
+
+        auto loop = buildTwinlessEdgeLoop(e1, byEnd, twinless.size());
 
         std::vector<Vertex*> loopVerts;
 
@@ -1338,5 +1779,4 @@ void Mesh<EBase, VBase, FBase>::repairNonManifoldEdges()
     }
 }
 
-
 #endif // MESH_H
@@ -0,0 +1,673 @@
+#include "meshcache.h"
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <spanstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string &filename)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot open " + filename);
+    }
+    fileHandle = file;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        close();
+        throw std::runtime_error("Cannot read " + filename);
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+    if (size == 0) {
+        return;
+    }
+    mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle) {
+        data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (!data) {
+        close();
+        throw std::runtime_error("Cannot map " + filename);
+    }
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + filename);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot read " + filename);
+    }
+    size = static_cast<size_t>(info.st_size);
+    if (size > 0) {
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            size = 0;
+            throw std::runtime_error("Cannot map " + filename);
+        }
+        data = static_cast<const char*>(mapped);
+    }
+    ::close(fd); // the mapping stays valid
+#endif
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other) {
+        close();
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+#ifdef _WIN32
+        fileHandle = std::exchange(other.fileHandle, nullptr);
+        mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle) {
+        CloseHandle(fileHandle);
+    }
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#else
+    if (data) {
+        munmap(const_cast<char*>(data), size);
+    }
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+class MeshCache::Header {
+public:
+    class BlockRange {
+    public:
+        uint64_t offset;
+        uint64_t size;  // in bytes
+    };
+
+    char       magic[4];
+    uint32_t   version;
+    uint64_t   sourceSize;
+    uint64_t   sourceHash;
+    BlockRange blocks[BlockCount];
+};
+
+namespace {
+
+constexpr char cacheMagic[4] = { 'M', 'S', 'M', 'C' };
+constexpr uint64_t blockAlignment = 16;
+
+uint64_t alignBlock(uint64_t offset)
+{
+    return (offset + blockAlignment - 1) & ~(blockAlignment - 1);
+}
+
+// 64 bit hash of a whole file. Four independent lanes keep the multiplier busy,
+// so checking a large OBJ costs a small fraction of parsing it
+uint64_t hashBytes(std::span<const char> bytes)
+{
+    constexpr uint64_t k1 = 0x9E3779B97F4A7C15ull;
+    constexpr uint64_t k2 = 0xC2B2AE3D27D4EB4Full;
+
+    uint64_t lanes[4] = { k1, k2, ~k1, ~k2 };
+
+    const char* p = bytes.data();
+    size_t n = bytes.size();
+    size_t i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        for (int l = 0; l < 4; l++) {
+            uint64_t word;
+            std::memcpy(&word, p + i + 8 * l, 8);
+            lanes[l] = std::rotl(lanes[l] ^ (word * k2), 31) * k1;
+        }
+    }
+
+    uint64_t h = n * k1;
+    for (uint64_t lane : lanes) {
+        h = std::rotl(h ^ lane, 27) * k2;
+    }
+    for (; i < n; i++) {
+        h = (h ^ static_cast<unsigned char>(p[i])) * k1;
+    }
+
+    h ^= h >> 33;
+    h *= k2;
+    h ^= h >> 29;
+    return h;
+}
+
+template<typename T>
+std::span<const char> bytesOf(const std::vector<T>& v)
+{
+    return { reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T) };
+}
+
+// OBJ indices are 1 based, or negative to count back from the last element so far
+// returns a 0 based index, or -1 if absent (0) or out of range
+int resolveObjIndex(int raw, size_t count)
+{
+    if (raw > 0) {
+        return static_cast<size_t>(raw) <= count ? raw - 1 : -1;
+    }
+    if (raw < 0) {
+        return static_cast<size_t>(-raw) <= count ? static_cast<int>(count) + raw : -1;
+    }
+    return -1;
+}
+
+// one distinct position/texcoord/normal combination (a mesh vertex)
+struct ObjCorner {
+    int v;
+    int vt;
+    int vn;
+    bool operator==(const ObjCorner& other) const = default;
+};
+
+struct ObjCornerHash {
+    size_t operator()(const ObjCorner& c) const {
+        uint64_t h = static_cast<uint32_t>(c.v);
+        h = h * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(c.vt);
+        h = h * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(c.vn);
+        return static_cast<size_t>(h ^ (h >> 31));
+    }
+};
+
+// Loads .mtl files as tinyobj asks for them and remembers which ones succeeded,
+// so the same materials can be read again when the cache is used
+class RecordingMaterialReader : public tinyobj::MaterialReader {
+public:
+    tinyobj::MaterialFileReader reader;
+    std::vector<char>& loadedFiles;  // names, each followed by a 0
+public:
+    RecordingMaterialReader(const std::string& folder, std::vector<char>& loadedFiles)
+        : reader{folder}, loadedFiles{loadedFiles} {}
+
+    bool operator()(const std::string& matId,
+                    std::vector<tinyobj::material_t>* materials,
+                    std::map<std::string, int>* matMap,
+                    std::string* warn, std::string* err) override
+    {
+        bool ok = reader(matId, materials, matMap, warn, err);
+        if (ok) {
+            loadedFiles.insert(loadedFiles.end(), matId.begin(), matId.end());
+            loadedFiles.push_back(0);
+        }
+        return ok;
+    }
+};
+
+} // namespace
+
+// The OBJ file is parsed with tiny_obj_loader's callback interface: each v/vt/vn/f
+// line is handed to MeshCache::Builder as it is read and faces go straight into the
+// cache blocks.  Only the raw attributes and two hash maps are kept on the side.
+class MeshCache::Builder {
+public:
+    static constexpr uint32_t noVertex = std::numeric_limits<uint32_t>::max();
+
+    Data& data;
+    bool findTwins;
+
+    std::vector<Vec3f> positions;
+    std::vector<Vec3f> colors;
+    std::vector<Vec3f> normals;
+    std::vector<Vec2f> texcoords;
+
+    int materialId{-1};
+
+    // mesh vertex for each corner; most files use one texcoord/normal per position, so the
+    // first corner at each position is found by index and only the others are hashed
+    class PositionCorner {
+    public:
+        uint32_t vertex{noVertex};
+        int vt{-1};
+        int vn{-1};
+    };
+    std::vector<PositionCorner> firstCorners; // by position index
+    std::unordered_map<ObjCorner, uint32_t, ObjCornerHash> otherCorners;
+    std::unordered_map<uint64_t, uint32_t> openEdges;  // (from, to) mesh vertices -> corner still waiting for its twin
+
+    std::vector<ObjCorner> polygon; // reused for every face
+
+    size_t skippedFaces{0};
+public:
+    Builder(Data& data, bool findTwins) : data{data}, findTwins{findTwins} {}
+
+    tinyobj::callback_t callbacks();
+private:
+    uint32_t vertexFor(const ObjCorner& corner);
+    void addPolygon(const tinyobj::index_t* indices, int count);
+    void pairEdges(uint32_t faceStart, uint32_t faceEnd);
+    static uint64_t edgeKey(uint32_t from, uint32_t to) { return (static_cast<uint64_t>(from) << 32) | to; }
+};
+
+tinyobj::callback_t MeshCache::Builder::callbacks()
+{
+    tinyobj::callback_t cb;
+    cb.vertex_color_cb = [](void* self, tinyobj::real_t x, tinyobj::real_t y, tinyobj::real_t z,
+                            tinyobj::real_t r, tinyobj::real_t g, tinyobj::real_t b, bool) {
+        auto builder = static_cast<Builder*>(self);
+        builder->positions.push_back({x, y, z});
+        builder->colors.push_back({r, g, b}); // 1,1,1 when the file has no colors
+    };
+    cb.texcoord_cb = [](void* self, tinyobj::real_t x, tinyobj::real_t y, tinyobj::real_t) {
+        static_cast<Builder*>(self)->texcoords.push_back({x, y});
+    };
+    cb.normal_cb = [](void* self, tinyobj::real_t x, tinyobj::real_t y, tinyobj::real_t z) {
+        static_cast<Builder*>(self)->normals.push_back({x, y, z});
+    };
+    cb.index_cb = [](void* self, tinyobj::index_t* indices, int count) {
+        static_cast<Builder*>(self)->addPolygon(indices, count);
+    };
+    cb.usemtl_cb = [](void* self, const char*, int materialId) {
+        static_cast<Builder*>(self)->materialId = materialId;
+    };
+    return cb;
+}
+
+uint32_t MeshCache::Builder::vertexFor(const ObjCorner &corner)
+{
+    auto create = [this, &corner]() {
+        uint8_t attributes = 0;
+        Vec3f normal;
+        Vec2f uv{0, 0};
+        if (corner.vn >= 0) {
+            normal = normals[corner.vn];
+            attributes |= hasNormal;
+        }
+        if (corner.vt >= 0) {
+            uv = texcoords[corner.vt];
+            attributes |= hasTexcoord;
+        }
+        data.positions.push_back(positions[corner.v]);
+        data.normals.push_back(normal);
+        data.texcoords.push_back(uv);
+        data.colors.push_back(colors[corner.v]);
+        data.attributes.push_back(attributes);
+        return static_cast<uint32_t>(data.positions.size() - 1);
+    };
+
+    if (firstCorners.size() <= static_cast<size_t>(corner.v)) {
+        firstCorners.resize(positions.size());
+    }
+
+    PositionCorner& first = firstCorners[corner.v];
+
+    if (first.vertex == noVertex) {
+        first = { create(), corner.vt, corner.vn };
+        return first.vertex;
+    }
+
+    if (first.vt == corner.vt && first.vn == corner.vn) {
+        return first.vertex;
+    }
+
+    auto [it, inserted] = otherCorners.try_emplace(corner, noVertex);
+    if (inserted) {
+        it->second = create();
+    }
+    return it->second;
+}
+
+void MeshCache::Builder::addPolygon(const tinyobj::index_t *indices, int count)
+{
+    polygon.clear();
+    for (int i = 0; i < count; i++) {
+        ObjCorner corner{ resolveObjIndex(indices[i].vertex_index, positions.size()),
+                          resolveObjIndex(indices[i].texcoord_index, texcoords.size()),
+                          resolveObjIndex(indices[i].normal_index, normals.size()) };
+        if (corner.v < 0) {
+            skippedFaces++;
+            return;
+        }
+        polygon.push_back(corner);
+    }
+
+    if (polygon.size() < 3) {
+        skippedFaces++;
+        return;
+    }
+
+    uint32_t faceStart = static_cast<uint32_t>(data.corners.size());
+
+    for (auto& corner : polygon) {
+        data.corners.push_back(vertexFor(corner));
+    }
+
+    uint32_t faceEnd = static_cast<uint32_t>(data.corners.size());
+
+    data.faceStarts.push_back(faceEnd);
+    data.faceMaterials.push_back(materialId);
+
+    // triangle fan (same as LoadObj's triangulation for convex polygons)
+    for (uint32_t i = faceStart + 1; i + 1 < faceEnd; i++) {
+        data.triangles.insert(data.triangles.end(), { data.corners[faceStart], data.corners[i], data.corners[i + 1] });
+    }
+
+    if (findTwins) {
+        pairEdges(faceStart, faceEnd);
+    }
+}
+
+void MeshCache::Builder::pairEdges(uint32_t faceStart, uint32_t faceEnd)
+{
+    // pair each edge with the opposite one from an earlier face, or leave it waiting
+    data.twins.resize(faceEnd, noCorner);
+    for (uint32_t c = faceStart; c < faceEnd; c++) {
+        uint32_t from = data.corners[c];
+        uint32_t to = data.corners[c + 1 < faceEnd ? c + 1 : faceStart];
+        auto twin = openEdges.find(edgeKey(to, from));
+        if (twin != openEdges.end()) {
+            data.twins[c] = twin->second;
+            data.twins[twin->second] = c;
+            openEdges.erase(twin);
+        }
+        else {
+            openEdges.emplace(edgeKey(from, to), c); // a repeated directed edge (non-manifold) stays unpaired
+        }
+    }
+}
+
+MeshCache::MeshCache(const std::string &objFilename, Connectivity connectivity)
+{
+    MappedFile source(objFilename);
+
+    uint64_t sourceHash = hashBytes(source.bytes());
+
+    if (openCache(objFilename, source.bytes().size(), sourceHash, connectivity)) {
+        loadedFromCache = true;
+        return;
+    }
+
+    parse(objFilename, source.bytes(), connectivity);
+    writeCache(objFilename, source.bytes().size(), sourceHash);
+    useData();
+}
+
+const tinyobj::material_t *MeshCache::material(int32_t materialId) const
+{
+    if (materialId >= 0 && static_cast<size_t>(materialId) < materialList.size()) {
+        return &materialList[materialId];
+    }
+    return nullptr;
+}
+
+bool MeshCache::openCache(const std::string &objFilename, uint64_t sourceSize, uint64_t sourceHash, Connectivity connectivity)
+{
+    std::string cacheName = cacheFilename(objFilename);
+
+    std::error_code ec;
+    if (!std::filesystem::exists(cacheName, ec)) {
+        return false;
+    }
+
+    MappedFile file;
+    try {
+        file = MappedFile(cacheName);
+    }
+    catch (std::exception&) {
+        return false;
+    }
+
+    auto bytes = file.bytes();
+
+    Header header;
+    if (bytes.size() < sizeof(Header)) {
+        return false;
+    }
+    std::memcpy(&header, bytes.data(), sizeof(Header));
+
+    if (std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 ||
+        header.version != version ||
+        header.sourceSize != sourceSize ||
+        header.sourceHash != sourceHash) {
+        return false;
+    }
+
+    bool valid = true;
+
+    auto blockSpan = [&]<typename T>(Block block, std::span<const T>& span) {
+        auto range = header.blocks[block];
+        if (range.offset % blockAlignment != 0 ||
+            range.offset > bytes.size() ||
+            range.size > bytes.size() - range.offset ||
+            range.size % sizeof(T) != 0) {
+            valid = false;
+            return;
+        }
+        span = { reinterpret_cast<const T*>(bytes.data() + range.offset), range.size / sizeof(T) };
+    };
+
+    blockSpan(Positions, positionSpan);
+    blockSpan(Normals, normalSpan);
+    blockSpan(Texcoords, texcoordSpan);
+    blockSpan(Colors, colorSpan);
+    blockSpan(Attributes, attributeSpan);
+    blockSpan(FaceStarts, faceStartSpan);
+    blockSpan(FaceMaterials, faceMaterialSpan);
+    blockSpan(Corners, cornerSpan);
+    blockSpan(Twins, twinSpan);
+    blockSpan(Triangles, triangleSpan);
+
+    std::span<const char> materialFiles;
+    blockSpan(MaterialFiles, materialFiles);
+
+    // a damaged cache must not hand out indices past the end of the vertices
+    size_t vertices = positionSpan.size();
+    size_t corners = cornerSpan.size();
+
+    valid = valid &&
+            normalSpan.size() == vertices &&
+            texcoordSpan.size() == vertices &&
+            colorSpan.size() == vertices &&
+            attributeSpan.size() == vertices &&
+            faceStartSpan.size() == faceMaterialSpan.size() + 1 &&
+            faceStartSpan.front() == 0 &&
+            faceStartSpan.back() == corners &&
+            (twinSpan.empty() || twinSpan.size() == corners) &&
+            triangleSpan.size() % 3 == 0 &&
+            (materialFiles.empty() || materialFiles.back() == 0);
+
+    if (!valid) {
+        return false;
+    }
+
+    if (connectivity == Connectivity::Twins && twinSpan.size() != corners) {
+        return false; // written without connectivity: rebuild with it
+    }
+
+    for (size_t f = 1; f < faceStartSpan.size(); f++) {
+        if (faceStartSpan[f] < faceStartSpan[f - 1] + 3) {
+            return false;
+        }
+    }
+
+    auto outOfRange = [](std::span<const uint32_t> indices, size_t limit) {
+        uint32_t bad = 0;
+        for (uint32_t i : indices) {
+            bad |= (i >= limit);
+        }
+        return bad != 0;
+    };
+
+    if (outOfRange(cornerSpan, vertices) || outOfRange(triangleSpan, vertices)) {
+        return false;
+    }
+
+    for (uint32_t twin : twinSpan) {
+        if (twin >= corners && twin != noCorner) {
+            return false;
+        }
+    }
+
+    cacheFile = std::move(file);
+    loadMaterials(objFilename, materialFiles);
+    return true;
+}
+
+void MeshCache::parse(const std::string &objFilename, std::span<const char> source, Connectivity connectivity)
+{
+    std::string err;
+
+    // materials are looked up relative to the folder containing the obj file
+    std::string folder = objFilename.substr(0, objFilename.find_last_of("/\\") + 1);
+
+    std::ispanstream in(source);
+
+    Builder builder(data, connectivity == Connectivity::Twins);
+    RecordingMaterialReader materialReader(folder, data.materialFiles);
+
+    bool ok = tinyobj::LoadObjWithCallback(in, builder.callbacks(), &builder, &materialReader, &warningText, &err);
+
+    if (builder.skippedFaces > 0) {
+        warningText += "Skipped " + std::to_string(builder.skippedFaces) + " faces with missing or invalid vertex indices\n";
+    }
+
+    if (!ok) {
+        throw std::runtime_error("Failed to load/parse " + objFilename + ": " + err);
+    }
+
+    if (!err.empty()) {
+        warningText += err;
+    }
+
+    loadMaterials(objFilename, data.materialFiles);
+}
+
+void MeshCache::writeCache(const std::string &objFilename, uint64_t sourceSize, uint64_t sourceHash) const
+{
+    std::span<const char> blockBytes[BlockCount];
+
+    blockBytes[Positions]     = bytesOf(data.positions);
+    blockBytes[Normals]       = bytesOf(data.normals);
+    blockBytes[Texcoords]     = bytesOf(data.texcoords);
+    blockBytes[Colors]        = bytesOf(data.colors);
+    blockBytes[Attributes]    = bytesOf(data.attributes);
+    blockBytes[FaceStarts]    = bytesOf(data.faceStarts);
+    blockBytes[FaceMaterials] = bytesOf(data.faceMaterials);
+    blockBytes[Corners]       = bytesOf(data.corners);
+    blockBytes[Twins]         = bytesOf(data.twins);
+    blockBytes[Triangles]     = bytesOf(data.triangles);
+    blockBytes[MaterialFiles] = bytesOf(data.materialFiles);
+
+    Header header{};
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = version;
+    header.sourceSize = sourceSize;
+    header.sourceHash = sourceHash;
+
+    uint64_t offset = alignBlock(sizeof(Header));
+    for (int b = 0; b < BlockCount; b++) {
+        header.blocks[b] = { offset, blockBytes[b].size() };
+        offset = alignBlock(offset + blockBytes[b].size());
+    }
+
+    // written under a temporary name so a reader never sees half a cache.
+    // failing to write it (read only folder, etc) is not an error: the mesh just loads slowly next time
+    std::string cacheName = cacheFilename(objFilename);
+    std::string tempName = cacheName + ".tmp";
+
+    {
+        std::ofstream out(tempName, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return;
+        }
+
+        const char padding[blockAlignment]{};
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        uint64_t written = sizeof(Header);
+        for (int b = 0; b < BlockCount; b++) {
+            out.write(padding, header.blocks[b].offset - written);
+            out.write(blockBytes[b].data(), blockBytes[b].size());
+            written = header.blocks[b].offset + blockBytes[b].size();
+        }
+
+        if (!out) {
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(tempName, ec);
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempName, cacheName, ec);
+    if (ec) {
+        std::filesystem::remove(tempName, ec);
+    }
+}
+
+void MeshCache::loadMaterials(const std::string &objFilename, std::span<const char> materialFiles)
+{
+    std::string folder = objFilename.substr(0, objFilename.find_last_of("/\\") + 1);
+
+    tinyobj::MaterialFileReader reader(folder);
+    std::map<std::string, int> materialMap;
+    std::string warn;
+    std::string err;
+
+    materialList.clear();
+
+    // read in the same order as the OBJ did, so material ids still match
+    for (const char* name = materialFiles.data(); name < materialFiles.data() + materialFiles.size(); name += std::strlen(name) + 1) {
+        reader(name, &materialList, &materialMap, &warn, &err);
+    }
+
+    if (!err.empty()) {
+        warningText += err;
+    }
+}
+
+void MeshCache::useData()
+{
+    positionSpan = data.positions;
+    normalSpan = data.normals;
+    texcoordSpan = data.texcoords;
+    colorSpan = data.colors;
+    attributeSpan = data.attributes;
+    faceStartSpan = data.faceStarts;
+    faceMaterialSpan = data.faceMaterials;
+    cornerSpan = data.corners;
+    twinSpan = data.twins;
+    triangleSpan = data.triangles;
+}
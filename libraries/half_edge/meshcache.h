@@ -0,0 +1,160 @@
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <vector>
+#include "vec3d.h"
+#include "vec2d.h"
+#include "tiny_obj_loader.h"
+
+// Read only view of a whole file, memory mapped
+class MappedFile {
+private:
+    const char* data{nullptr};
+    size_t size{0};
+#ifdef _WIN32
+    void* fileHandle{nullptr};
+    void* mappingHandle{nullptr};
+#endif
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& filename); // throws if the file can't be opened
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    std::span<const char> bytes() const { return { data, size }; }
+private:
+    void close();
+};
+
+// The contents of an OBJ file, deduplicated into mesh vertices (one per distinct
+// position/texcoord/normal combination, numbered in order of first use) and
+// polygons over those vertices.
+//
+// Parsing the OBJ text is slow, so the result is saved in a binary cache file
+// next to the source (name.obj -> name.obj.mcache) and later loads map that file
+// instead.  The cache records the size and a hash of the OBJ it was built from
+// and is rebuilt whenever those don't match, or when its version is out of date.
+//
+// Layout of the cache file: a header, then each block at the offset the
+// header gives for it (16 byte aligned), stored as plain arrays.
+//
+// Materials are not cached: the .mtl files the OBJ loaded are recorded by name
+// and read again when the cache is opened.
+class MeshCache {
+public:
+    static constexpr uint32_t version = 1;
+    static constexpr uint32_t noCorner = std::numeric_limits<uint32_t>::max();
+
+    // per vertex flags: which attributes the OBJ gave it (the others are zero)
+    static constexpr uint8_t hasNormal = 1;
+    static constexpr uint8_t hasTexcoord = 2;
+
+    enum class Connectivity {
+        None,
+        Twins   // also find the opposite half edge of each polygon edge
+    };
+private:
+    enum Block {
+        Positions,
+        Normals,
+        Texcoords,
+        Colors,
+        Attributes,
+        FaceStarts,
+        FaceMaterials,
+        Corners,
+        Twins,
+        Triangles,
+        MaterialFiles,
+        BlockCount
+    };
+
+    // what a freshly parsed OBJ is held in (and written from)
+    class Data {
+    public:
+        std::vector<Vec3f>    positions;
+        std::vector<Vec3f>    normals;
+        std::vector<Vec2f>    texcoords;
+        std::vector<Vec3f>    colors;
+        std::vector<uint8_t>  attributes;
+        std::vector<uint32_t> faceStarts{0};
+        std::vector<int32_t>  faceMaterials;
+        std::vector<uint32_t> corners;
+        std::vector<uint32_t> twins;
+        std::vector<uint32_t> triangles;
+        std::vector<char>     materialFiles;
+    };
+
+    class Header;
+    class Builder;
+
+    MappedFile cacheFile;
+    Data data;  // empty when loaded from the cache
+    bool loadedFromCache{false};
+
+    std::span<const Vec3f>    positionSpan;
+    std::span<const Vec3f>    normalSpan;
+    std::span<const Vec2f>    texcoordSpan;
+    std::span<const Vec3f>    colorSpan;
+    std::span<const uint8_t>  attributeSpan;
+    std::span<const uint32_t> faceStartSpan;
+    std::span<const int32_t>  faceMaterialSpan;
+    std::span<const uint32_t> cornerSpan;
+    std::span<const uint32_t> twinSpan;
+    std::span<const uint32_t> triangleSpan;
+
+    std::vector<tinyobj::material_t> materialList;
+    std::string warningText;
+public:
+    // throws if the OBJ file can't be read or parsed
+    explicit MeshCache(const std::string& objFilename, Connectivity connectivity = Connectivity::None);
+    MeshCache(const MeshCache&) = delete;
+    MeshCache& operator=(const MeshCache&) = delete;
+
+    static std::string cacheFilename(const std::string& objFilename) { return objFilename + ".mcache"; }
+
+    bool fromCache() const { return loadedFromCache; }
+
+    size_t vertexCount() const { return positionSpan.size(); }
+    size_t faceCount() const { return faceMaterialSpan.size(); }
+
+    std::span<const Vec3f>    positions() const { return positionSpan; }
+    std::span<const Vec3f>    normals() const { return normalSpan; }
+    std::span<const Vec2f>    texcoords() const { return texcoordSpan; } // as in the file: 0,0 is bottom-left
+    std::span<const Vec3f>    colors() const { return colorSpan; }       // 1,1,1 when the file has none
+    std::span<const uint8_t>  attributes() const { return attributeSpan; }
+
+    // corners of face f are corners()[faceStarts()[f]] up to corners()[faceStarts()[f + 1]]
+    std::span<const uint32_t> faceStarts() const { return faceStartSpan; }
+    std::span<const int32_t>  faceMaterials() const { return faceMaterialSpan; } // -1 for none
+    std::span<const uint32_t> corners() const { return cornerSpan; }
+
+    // for each corner, the corner whose edge (to the next corner of its face) runs
+    // the opposite way, or noCorner. Empty unless built with Connectivity::Twins
+    std::span<const uint32_t> twins() const { return twinSpan; }
+
+    // the faces fan triangulated (convex polygons), three vertex indices per triangle
+    std::span<const uint32_t> triangles() const { return triangleSpan; }
+
+    const std::vector<tinyobj::material_t>& materials() const { return materialList; }
+    const tinyobj::material_t* material(int32_t materialId) const; // nullptr if out of range
+
+    // problems found while parsing the OBJ or reading its materials
+    const std::string& warnings() const { return warningText; }
+private:
+    bool openCache(const std::string& objFilename, uint64_t sourceSize, uint64_t sourceHash, Connectivity connectivity);
+    void parse(const std::string& objFilename, std::span<const char> source, Connectivity connectivity);
+    void writeCache(const std::string& objFilename, uint64_t sourceSize, uint64_t sourceHash) const;
+    void loadMaterials(const std::string& objFilename, std::span<const char> materialFiles);
+    void useData();
+};
+
+#endif // MESHCACHE_H
@@ -1,235 +1,110 @@
 #include "meshloader.h"
-#include "vec3d.h"
-#include "vec2d.h"
-#include <list>
+#include "meshcache.h"
 #include <iostream>
-#include <functional>
-#include <map>
 #include <optional>
 
 #define TINYOBJLOADER_IMPLEMENTATION // define this in only *one* .cc
 
 #include "tiny_obj_loader.h"
 
-// TODO: use tiny_obj_loader's callback interface to avoid copying data
-
-class ObjFace;
-
-class ObjVert {
-public:
-    VMeshVertex* meshVertex{nullptr};
-    Vec3d pos;
-    Vec2f uv;
-    bool visited{false};
-    std::set<ObjFace*> faces;
-public:
-    ~ObjVert();
-};
-
-class ObjFace {
-public:
-    bool visited{false};
-    VMeshFace* meshFace{nullptr};
-    VMeshEdge* corner{nullptr};
-    std::vector<ObjVert*> verts;
-    std::vector<VMeshEdge*> edges;
-    std::set<ObjFace*> adjFaces;
-    int material_id{-1};
-public:
-    ~ObjFace();
-    VMeshEdge *oppositeEdge(int idx);
-    int findEdge(ObjVert* v1, ObjVert* v2);
-};
-
-int ObjFace::findEdge(ObjVert *v1, ObjVert *v2)
-{
-    for (int i = 0; i < verts.size(); i++) {
-        if (verts[i] == v1) {
-            if (verts[(i+1) % verts.size()] == v2) {
-                return i;
-            }
-        }
-    }
-    return -1;
-}
+// The OBJ is read through MeshCache, which parses it once and afterwards maps
+// the binary cache next to it.  Either way the cache already has the vertices
+// deduplicated and the twin of every polygon edge, so building the mesh is a
+// straight walk over its arrays with no lookups.
 
-VMeshEdge* ObjFace::oppositeEdge(int idx)
+void loadMesh(VMesh& mesh, const std::string& filename, bool triangulate, VMeshFacePopulator populator)
 {
-    ObjVert* v1 = verts[idx];
-    ObjVert* v2 = verts[(idx+1) % verts.size()];
+    std::optional<MeshCache> cache;
 
-    for (auto& f : adjFaces) {
-        int idx2 = f->findEdge(v2, v1);
-        if (idx2 != -1) {
-            return f->edges[idx2];
-        }
-    }
-    return nullptr;
-}
-
-class ObjMesh {
-public:
-    std::list<ObjFace> faces;
-    std::list<ObjVert> verts;
-    std::vector<ObjVert*> vertPtrs;
-public:
-    ~ObjMesh();
-    void reserveTotalVerts(int n) {};
-    void reserveTotalFaces(int n) {};
-    void startShape(std::string name, int numFaces) {};
-    ObjVert* addVert(Vec3d pos, Vec2f uv);
-    void addFace(int shapeIdx, std::vector<ObjVert*> vertIndices, int material_id);
-    void linkFaces();
-    void buildMesh(VMesh& mesh, const std::vector<tinyobj::material_t>& materials, std::function<void(VMeshFace&, std::optional<const tinyobj::material_t*>)> populator);
-};
-
-ObjVert* ObjMesh::addVert(Vec3d pos, Vec2f uv)
-{
-    ObjVert& v = verts.emplace_back();
-    v.pos = pos;
-    v.uv = uv;
-    vertPtrs.push_back(&verts.back());
-    return &v;
-}
-
-void ObjMesh::addFace(int shapeIdx, std::vector<ObjVert*> vertIndices, int material_id)
-{
-    ObjFace& f = faces.emplace_back();
-    f.material_id = material_id;
-    for (auto i : vertIndices) {
-        f.verts.push_back(i);
+    try {
+        cache.emplace(filename, MeshCache::Connectivity::Twins);
     }
-    for (auto v : f.verts) {
-        v->faces.insert(&faces.back());
+    catch (std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        std::cerr << "Failed to load/parse .obj file" << std::endl;
+        return;
     }
-}
 
-void ObjMesh::linkFaces()
-{
-    for (auto& f : faces) {
-        for (auto& v : f.verts) {
-            for (auto& f2 : v->faces) {
-                if (&f != f2) {
-                    f.adjFaces.insert(f2);
-                }
-            }
-        }
+    if (!cache->warnings().empty()) {
+        std::cerr << cache->warnings() << std::endl;
     }
-}
 
-void ObjMesh::buildMesh(VMesh &mesh, const std::vector<tinyobj::material_t>& materials, std::function<void(VMeshFace&, std::optional<const tinyobj::material_t*>)> populator)
-{
-    for (auto& v : verts) {
-        v.meshVertex = mesh.createVertex(v.pos, v.uv);
-    }
+    auto positions = cache->positions();
+    auto texcoords = cache->texcoords();
+    auto faceStarts = cache->faceStarts();
+    auto faceMaterials = cache->faceMaterials();
+    auto corners = cache->corners();
+    auto twins = cache->twins();
 
-    for (ObjFace& f : faces) {
-        std::vector<VMeshVertex*> meshVerts;
-        for (auto& v : f.verts) {
-            meshVerts.push_back(v->meshVertex);
-        }
-        f.meshFace = mesh.createFace(meshVerts);
-        f.edges = f.meshFace->getEdges();
+    std::vector<uint32_t> vertices(positions.size());
 
-        if (f.material_id >= 0 && f.material_id < materials.size()) {
-            populator(*f.meshFace, &materials[f.material_id]);
-        }
-        else {
-            populator(*f.meshFace, std::nullopt);
-        }
+    for (size_t i = 0; i < positions.size(); i++) {
+        Vec2f uv = texcoords[i];
+        vertices[i] = mesh.createVertex(Vec3d{positions[i]}, {uv.x, 1 - uv.y}); // OBJ format has 0,0 at bottom-left, so flip y
     }
 
-    for (ObjFace& f : faces) {
-        for (int i = 0; i < f.edges.size(); i++) {
-            auto edge = f.edges[i];
-            auto otherEdge = f.oppositeEdge(i);
-            if (otherEdge) {
-                mesh.linkEdges(edge, otherEdge);
-            }
-        }
-    }
-}
-
-namespace std {
-    template<> struct less<tinyobj::index_t> {
-        bool operator()(const tinyobj::index_t& a, const tinyobj::index_t& b) const {
-            if (a.vertex_index < b.vertex_index) return true;
-            if (a.vertex_index > b.vertex_index) return false;
-            if (a.normal_index < b.normal_index) return true;
-            if (a.normal_index > b.normal_index) return false;
-            if (a.texcoord_index < b.texcoord_index) return true;
-            if (a.texcoord_index > b.texcoord_index) return false;
-            return false;
-        }
-    };
-}
+    std::vector<uint32_t> cornerEdges(corners.size()); // half edge running from each corner to the next one of its polygon
 
-void loadMesh(VMesh& mesh, const std::string& filename, bool triangulate, std::function<void(VMeshFace&, std::optional<const tinyobj::material_t*>)> populator)
-{
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
+    // reused for every face
+    std::vector<uint32_t> faceVerts;
+    std::vector<uint32_t> faceEdges;
 
-    std::string warn;
-    std::string err;
+    for (size_t f = 0; f + 1 < faceStarts.size(); f++) {
+        uint32_t start = faceStarts[f];
+        uint32_t count = faceStarts[f + 1] - start;
 
-    // material_t loading is not working correctly because the path is not being passed in
-    // correctly.  The path should be the path to the file, not the path to the folder.
-    // So we need to get the path to the folder from the filename.
-    std::string folder = filename.substr(0, filename.find_last_of("/\\") + 1);
+        std::optional<const tinyobj::material_t*> material = std::nullopt;
+        if (auto m = cache->material(faceMaterials[f])) {
+            material = m;
+        }
 
-    bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename.c_str(), folder.c_str(), triangulate);
+        if (!triangulate || count == 3) {
+            faceVerts.clear();
+            faceEdges.clear();
+            for (uint32_t c = start; c < start + count; c++) {
+                faceVerts.push_back(vertices[corners[c]]);
+            }
+            uint32_t face = mesh.createFace(faceVerts, faceEdges);
+            std::copy(faceEdges.begin(), faceEdges.end(), cornerEdges.begin() + start);
+            populator(face, material);
+            continue;
+        }
 
-    ObjMesh objMesh;
+        // fan triangulation (convex polygons). Triangle i is corners 0, i, i+1: its middle
+        // edge is polygon edge i, and the edges from/to corner 0 are the polygon's first and
+        // last edges or diagonals shared with the neighbouring triangles
+        uint32_t diagonal = 0; // closing edge of the previous triangle
+        for (uint32_t i = 1; i + 1 < count; i++) {
+            faceVerts.assign({ vertices[corners[start]], vertices[corners[start + i]], vertices[corners[start + i + 1]] });
+            faceEdges.clear();
+            uint32_t face = mesh.createFace(faceVerts, faceEdges);
+
+            if (i == 1) {
+                cornerEdges[start] = faceEdges[0];
+            }
+            else {
+                mesh.linkEdges(faceEdges[0], diagonal);
+            }
 
-    if (!warn.empty()) {
-        std::cerr << warn << std::endl;
-    }
+            cornerEdges[start + i] = faceEdges[1];
 
-    if (!err.empty()) {
-        std::cerr << err << std::endl;
-    }
+            if (i + 2 == count) {
+                cornerEdges[start + i + 1] = faceEdges[2];
+            }
+            else {
+                diagonal = faceEdges[2];
+            }
 
-    if (!ret) {
-        std::cerr << "Failed to load/parse .obj file" << std::endl;
-        return;
+            populator(face, material);
+        }
     }
 
-    std::map<tinyobj::index_t, ObjVert*> unique_vertices;
-
-    for (size_t s = 0; s < shapes.size(); s++) {
-        objMesh.startShape(shapes[s].name, shapes[s].mesh.num_face_vertices.size());
-
-        size_t index_offset = 0;
-        for (size_t f = 0; f < shapes[s].mesh.num_face_vertices.size(); f++) {
-            size_t fv = size_t(shapes[s].mesh.num_face_vertices[f]);
-            
-            std::vector<ObjVert*> face_verts;
-            for (size_t v = 0; v < fv; v++) {
-                tinyobj::index_t idx = shapes[s].mesh.indices[index_offset + v];
-
-                if (unique_vertices.find(idx) == unique_vertices.end()) {
-                    tinyobj::real_t vx = attrib.vertices[3 * idx.vertex_index + 0];
-                    tinyobj::real_t vy = attrib.vertices[3 * idx.vertex_index + 1];
-                    tinyobj::real_t vz = attrib.vertices[3 * idx.vertex_index + 2];
-                    
-                    tinyobj::real_t tx = 0, ty = 0;
-                    if (idx.texcoord_index >= 0) {
-                        tx = attrib.texcoords[2 * idx.texcoord_index + 0];
-                        ty = attrib.texcoords[2 * idx.texcoord_index + 1];
-                    }
-
-                    unique_vertices[idx] = objMesh.addVert({vx, vy, vz}, {tx, 1-ty}); // OBJ format has 0,0 at bottom-left, so flip y
-                }
-                face_verts.push_back(unique_vertices[idx]);
-            }
-            objMesh.addFace(s, face_verts, shapes[s].mesh.material_ids[f]);
-            index_offset += fv;
+    for (uint32_t c = 0; c < twins.size(); c++) {
+        if (twins[c] != MeshCache::noCorner && c < twins[c]) {
+            mesh.linkEdges(cornerEdges[c], cornerEdges[twins[c]]);
         }
     }
 
-    objMesh.linkFaces();
-    objMesh.buildMesh(mesh, materials, populator);
     try {
         mesh.repairNonManifoldEdges();
     }
@@ -237,18 +112,3 @@ void loadMesh(VMesh& mesh, const std::string& filename, bool triangulate, std::f
         std::cerr << e.what() << std::endl;
     }
 }
-
-ObjVert::~ObjVert()
-{
-    delete meshVertex;
-}
-
-ObjFace::~ObjFace()
-{
-    delete meshFace;
-}
-
-ObjMesh::~ObjMesh()
-{
-
-}
@@ -1,6 +1,10 @@
 #ifndef MESHLOADER_H
 #define MESHLOADER_H
 
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
 #include <vector>
 #include "vec3d.h"
 #include "vec2d.h"
@@ -9,32 +13,23 @@ namespace tinyobj {
 struct material_t;
 }
 
-class VMeshEdge {
-public:
-    virtual ~VMeshEdge() {}
-};
-
-class VMeshFace {
-public:
-    virtual ~VMeshFace() {}
-    virtual std::vector<VMeshEdge*> getEdges() = 0;
-};
-
-class VMeshVertex {
-public:
-    virtual ~VMeshVertex() {}
-};
-
+// Destination for loadMesh.  The loader walks the OBJ's MeshCache and calls
+// these, so elements are created directly in the final mesh.  Vertices, faces
+// and half edges are identified by the handles the mesh hands back.
 class VMesh {
 public:
     virtual ~VMesh() {}
-    virtual VMeshVertex* createVertex(Vec3d pos, Vec2f uv) = 0;
-    virtual VMeshFace* createFace(std::vector<VMeshVertex*> verts) = 0;
-    virtual void linkEdges(VMeshEdge* e1, VMeshEdge* e2) = 0;
+    virtual uint32_t createVertex(Vec3d pos, Vec2f uv) = 0;
+    // create a face around verts (in order) and append its half edges to edges,
+    // edges[i] running from verts[i] to verts[i+1]
+    virtual uint32_t createFace(const std::vector<uint32_t>& verts, std::vector<uint32_t>& edges) = 0;
+    virtual void linkEdges(uint32_t e1, uint32_t e2) = 0;
     virtual void repairNonManifoldEdges() = 0;
 };
 
-void loadMesh(VMesh& mesh, const std::string& filename, bool triangulate);
+using VMeshFacePopulator = std::function<void(uint32_t face, std::optional<const tinyobj::material_t*> material)>;
+
+void loadMesh(VMesh& mesh, const std::string& filename, bool triangulate, VMeshFacePopulator populator);
 
 
 #endif // MESHLOADER_H
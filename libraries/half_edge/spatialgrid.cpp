@@ -0,0 +1,109 @@
+#include <cmath>
+
+#include "spatialgrid.h"
+
+void SpatialGrid::reset(const Box &b, double size)
+{
+    bounds = b;
+    cellSize = size > 0 ? size : 1;
+    cols = std::max(1, static_cast<int>(std::ceil((bounds.x1 - bounds.x0) / cellSize)));
+    rows = std::max(1, static_cast<int>(std::ceil((bounds.y1 - bounds.y0) / cellSize)));
+    cells.assign(static_cast<size_t>(cols) * rows, {});
+    ranges.clear();
+    stamps.clear();
+    stamp = 0;
+    count = 0;
+}
+
+bool SpatialGrid::covers(const Box &box) const
+{
+    return !isEmpty() &&
+           box.x0 >= bounds.x0 && box.x1 <= bounds.x1 &&
+           box.y0 >= bounds.y0 && box.y1 <= bounds.y1;
+}
+
+int SpatialGrid::colOf(double x) const
+{
+    return std::clamp(static_cast<int>(std::floor((x - bounds.x0) / cellSize)), 0, cols - 1);
+}
+
+int SpatialGrid::rowOf(double y) const
+{
+    return std::clamp(static_cast<int>(std::floor((y - bounds.y0) / cellSize)), 0, rows - 1);
+}
+
+SpatialGrid::CellRange SpatialGrid::rangeOf(const Box &box) const
+{
+    return { colOf(box.x0), rowOf(box.y0), colOf(box.x1), rowOf(box.y1) };
+}
+
+void SpatialGrid::insert(uint32_t id, const Box &box)
+{
+    if (id < ranges.size() && !ranges[id].empty()) {
+        CellRange r = rangeOf(box);
+        CellRange& old = ranges[id];
+        if (r.c0 == old.c0 && r.r0 == old.r0 && r.c1 == old.c1 && r.r1 == old.r1) {
+            return; // moved, but still in the same cells
+        }
+        remove(id);
+    }
+    if (id >= ranges.size()) {
+        ranges.resize(id + 1);
+        stamps.resize(id + 1, 0);
+    }
+    CellRange r = rangeOf(box);
+    for (int row = r.r0; row <= r.r1; row++) {
+        for (int col = r.c0; col <= r.c1; col++) {
+            cells[row * cols + col].push_back(id);
+        }
+    }
+    ranges[id] = r;
+    count++;
+}
+
+void SpatialGrid::remove(uint32_t id)
+{
+    if (id >= ranges.size() || ranges[id].empty()) {
+        return;
+    }
+    CellRange r = ranges[id];
+    for (int row = r.r0; row <= r.r1; row++) {
+        for (int col = r.c0; col <= r.c1; col++) {
+            auto& cell = cells[row * cols + col];
+            auto it = std::find(cell.begin(), cell.end(), id);
+            *it = cell.back();
+            cell.pop_back();
+        }
+    }
+    ranges[id] = CellRange{};
+    count--;
+}
+
+void SpatialGrid::beginSearch() const
+{
+    if (++stamp == 0) {
+        // wrapped: forget old stamps so nothing is wrongly treated as seen
+        std::fill(stamps.begin(), stamps.end(), 0);
+        stamp = 1;
+    }
+}
+
+double SpatialGrid::ringLowerBound(double x, double y, int col, int row, int ring) const
+{
+    if (ring == 0) {
+        return 0;
+    }
+    // everything in ring or beyond lies outside the square of cells covered by
+    // the inner rings, so is at least as far away as the edge of that square
+    double left   = bounds.x0 + (col - ring + 1) * cellSize;
+    double right  = bounds.x0 + (col + ring) * cellSize;
+    double top    = bounds.y0 + (row - ring + 1) * cellSize;
+    double bottom = bounds.y0 + (row + ring) * cellSize;
+    double d = std::min({ x - left, right - x, y - top, bottom - y });
+    return std::max(0.0, d);
+}
+
+int SpatialGrid::maxRing(int col, int row) const
+{
+    return std::max({ col, cols - 1 - col, row, rows - 1 - row });
+}
@@ -0,0 +1,131 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Uniform grid of element ids keyed by 2d bounding box, used by Mesh to answer
+// nearest / radius / containment queries without scanning every element.
+// An id is stored in every cell its box overlaps, and can be moved or removed
+// individually, so the grid can be kept up to date as the mesh is edited.
+// Boxes must lie within the bounds given to reset() (see covers()).
+class SpatialGrid {
+public:
+    class Box {
+    public:
+        double x0;
+        double y0;
+        double x1;
+        double y1;
+        Box expanded(double d) const { return {x0 - d, y0 - d, x1 + d, y1 + d}; }
+    };
+private:
+    class CellRange {
+    public:
+        int c0{0};
+        int r0{0};
+        int c1{-1};
+        int r1{-1};
+        bool empty() const { return c1 < c0; }
+    };
+
+    Box bounds{0, 0, 0, 0};
+    double cellSize{1};
+    int cols{0};
+    int rows{0};
+    std::vector<std::vector<uint32_t>> cells;
+    std::vector<CellRange> ranges; // by id, empty if the id is not in the grid
+    size_t count{0};
+
+    // each search reports an id once even if it spans several cells
+    mutable std::vector<uint32_t> stamps;
+    mutable uint32_t stamp{0};
+public:
+    void reset(const Box& bounds, double cellSize);
+    bool covers(const Box& box) const;
+    void insert(uint32_t id, const Box& box); // replaces any previous entry for id
+    void remove(uint32_t id);
+    size_t size() const { return count; }
+    bool isEmpty() const { return cols == 0; }
+
+    int colOf(double x) const;
+    int rowOf(double y) const;
+
+    void beginSearch() const;
+
+    // ids whose box overlaps the cells covering box (call beginSearch first)
+    template <typename F>
+    void foreachInBox(const Box& box, F&& f) const;
+
+    // ids in the cells exactly `ring` cells away from (col, row) (call beginSearch first)
+    template <typename F>
+    void foreachInRing(int col, int row, int ring, F&& f) const;
+
+    // nothing first reached at ring or beyond is closer to (x, y) than this
+    double ringLowerBound(double x, double y, int col, int row, int ring) const;
+    int maxRing(int col, int row) const;
+private:
+    CellRange rangeOf(const Box& box) const;
+    template <typename F>
+    void visitCell(int col, int row, F& f) const;
+};
+
+template <typename F>
+void SpatialGrid::visitCell(int col, int row, F& f) const
+{
+    for (uint32_t id : cells[row * cols + col]) {
+        if (stamps[id] != stamp) {
+            stamps[id] = stamp;
+            f(id);
+        }
+    }
+}
+
+template <typename F>
+void SpatialGrid::foreachInBox(const Box &box, F&& f) const
+{
+    if (isEmpty()) {
+        return;
+    }
+    CellRange r = rangeOf(box);
+    for (int row = r.r0; row <= r.r1; row++) {
+        for (int col = r.c0; col <= r.c1; col++) {
+            visitCell(col, row, f);
+        }
+    }
+}
+
+template <typename F>
+void SpatialGrid::foreachInRing(int col, int row, int ring, F&& f) const
+{
+    if (isEmpty()) {
+        return;
+    }
+    if (ring == 0) {
+        visitCell(col, row, f);
+        return;
+    }
+    int r0 = row - ring;
+    int r1 = row + ring;
+    int c0 = col - ring;
+    int c1 = col + ring;
+    for (int c = std::max(c0, 0); c <= std::min(c1, cols - 1); c++) {
+        if (r0 >= 0) {
+            visitCell(c, r0, f);
+        }
+        if (r1 < rows) {
+            visitCell(c, r1, f);
+        }
+    }
+    for (int r = std::max(r0 + 1, 0); r <= std::min(r1 - 1, rows - 1); r++) {
+        if (c0 >= 0) {
+            visitCell(c0, r, f);
+        }
+        if (c1 < cols) {
+            visitCell(c1, r, f);
+        }
+    }
+}
+
+#endif // SPATIALGRID_H
@@ -2,6 +2,7 @@
 #define IMAGE_H
 
 #include "color.h"
+#include <algorithm>
 #include <memory>
 #include <string>
 
@@ -13,6 +14,30 @@ namespace mssm {
         int w;
         int h;
         Color* pixels{nullptr};
+
+        // The part of pixels changed since the last updatePixels, as far as
+        // it's known: setPixel adds to it, handing out pixels() makes it all.
+        // Empty when dirtyX0 >= dirtyX1
+        int dirtyX0{0};
+        int dirtyY0{0};
+        int dirtyX1{0};
+        int dirtyY1{0};
+
+        bool hasDirty() const { return dirtyX0 < dirtyX1 && dirtyY0 < dirtyY1; }
+        void clearDirty() { dirtyX0 = dirtyY0 = dirtyX1 = dirtyY1 = 0; }
+        void markDirty(int x, int y, int width, int height) {
+            if (!hasDirty()) {
+                dirtyX0 = x;
+                dirtyY0 = y;
+                dirtyX1 = x + width;
+                dirtyY1 = y + height;
+                return;
+            }
+            dirtyX0 = std::min(dirtyX0, x);
+            dirtyY0 = std::min(dirtyY0, y);
+            dirtyX1 = std::max(dirtyX1, x + width);
+            dirtyY1 = std::max(dirtyY1, y + height);
+        }
     public:
         virtual ~ImageInternal() {}
         constexpr int width() const { return w; };
@@ -24,8 +49,11 @@ namespace mssm {
     private:
 //        virtual void freeCachedPixels() = 0;
         virtual void updatePixels() = 0;
+        // only the given rectangle has changed
+        virtual void updatePixels(int /*x*/, int /*y*/, int /*width*/, int /*height*/) { updatePixels(); }
         void setPixel(int x, int y, Color c) {
             pixels[y*w+x] = c;
+            markDirty(x, y, 1, 1);
         }
         Color getPixel(int x, int y) {
             return pixels[y*w+x];
@@ -57,10 +85,11 @@ namespace mssm {
         ~Image();
         void set(int width, int height, mssm::Color c, bool cachePixels = false);        void load(const std::string& fileName, bool cachePixels = false);
         void save(const std::string& pngFileName);
-        Color* pixels() { return img->pixels; } // changes won't take effect until updatePixels
+        Color* pixels() { img->markDirty(0, 0, img->w, img->h); return img->pixels; } // changes won't take effect until updatePixels
         void  setPixel(int x, int y, Color c) { img->setPixel(x, y, c); } // won't take effect until updatePixels
         Color getPixel(int x, int y)          { return img->getPixel(x, y); }
         void updatePixels() { img->updatePixels(); }
+        void updatePixels(int x, int y, int width, int height) { img->updatePixels(x, y, width, height); }
         int width() const { return img->width(); }
         int height() const { return img->height(); }
         uint32_t textureIndex() const { return img->textureIndex(); }
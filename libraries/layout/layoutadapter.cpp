@@ -13,12 +13,12 @@ void LayoutAdapter::draw(const PropertyBag& parentProps, mssm::Canvas2d &g)
     child->draw(parentProps, g);
 }
 
-SizeBound2d LayoutAdapter::getBound(const PropertyBag& parentProps)
+SizeBound2d LayoutAdapter::getBoundImpl(const PropertyBag& parentProps)
 {
     return child->getBound(parentProps);
 }
 
-void LayoutAdapter::resize(const PropertyBag& parentProps, const RectI& rect)
+void LayoutAdapter::resizeImpl(const PropertyBag& parentProps, const RectI& rect)
 {
     child->resize(parentProps, rect);
     setRect(rect);
@@ -43,14 +43,14 @@ LayoutAdapterPadded::LayoutAdapterPadded(Private privateTag,
 
 }
 
-SizeBound2d LayoutAdapterPadded::getBound(const PropertyBag& parentProps)
+SizeBound2d LayoutAdapterPadded::getBoundImpl(const PropertyBag& parentProps)
 {
     auto bound = child->getBound(parentProps);
     grow(bound, padding);
     return bound;
 }
 
-void LayoutAdapterPadded::resize(const PropertyBag& parentProps, const RectI& rect)
+void LayoutAdapterPadded::resizeImpl(const PropertyBag& parentProps, const RectI& rect)
 {
     child->resize(parentProps, shrunk(rect, padding));
     setRect(rect);
@@ -86,3 +86,55 @@ LayoutBase::EvtRes LayoutAdapterClickable::onMouse(const PropertyBag& parentProp
 
     return EvtRes::consumed;
 }
+
+
+LayoutCached::LayoutCached(Private privateTag, LayoutContext *context, LayoutPtr child)
+    : LayoutAdapter{privateTag, context, child}
+{
+}
+
+void LayoutCached::invalidate()
+{
+    displayList.clear();
+    recorded = false;
+}
+
+void LayoutCached::resizeImpl(const PropertyBag &parentProps, const RectI &rect)
+{
+    // only runs when the rect or something in the subtree changed
+    invalidate();
+    LayoutAdapter::resizeImpl(parentProps, rect);
+}
+
+void LayoutCached::draw(const PropertyBag &parentProps, mssm::Canvas2d &g)
+{
+    if (context->getHoverElement(getDepth()) == this || isFocusWithin()) {
+        // hover/press/edit state (and hover animations) can change every frame
+        invalidate();
+        child->draw(parentProps, g);
+        return;
+    }
+
+    RectI clip = context->getDrawClip();
+
+    if (recorded && (!clip.exactlyEquals(recordedClip) || !parentProps.sameAs(recordedProps))) {
+        // what was culled, or how the subtree was styled, may differ
+        invalidate();
+    }
+    else if (recorded) {
+        // an equal bag rebuilt by the parent: keep it, so the next frame
+        // compares layer pointers and the old layers are released
+        recordedProps = parentProps;
+    }
+
+    if (recorded) {
+        displayList.replay(g);
+        return;
+    }
+
+    DisplayListRecorder recorder(g, displayList);
+    child->draw(parentProps, recorder);
+    recorded = true;
+    recordedProps = parentProps;
+    recordedClip = clip;
+}
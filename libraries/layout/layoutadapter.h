@@ -1,6 +1,7 @@
 #ifndef LAYOUTADAPTER_H
 #define LAYOUTADAPTER_H
 
+#include "canvasDisplayList.h"
 #include "layoutcore.h"
 
 class LayoutAdapter : public LayoutBase {
@@ -10,8 +11,8 @@ public:
     LayoutAdapter(Private privateTag, LayoutContext *context, LayoutPtr child);
     std::string getTypeStr() const override { return "Adapter"; }
     void draw(const PropertyBag& parentProps, mssm::Canvas2d& g) override;
-    SizeBound2d getBound(const PropertyBag& parentProps) override;
-    void resize(const PropertyBag& parentProps, const RectI& rect) override;
+    SizeBound2d getBoundImpl(const PropertyBag& parentProps) override;
+    void resizeImpl(const PropertyBag& parentProps, const RectI& rect) override;
     void foreachChildImpl(std::function<void(LayoutBase *)> f,
                           ForeachContext context,
                           bool includeOverlay,
@@ -28,8 +29,8 @@ public:
     LayoutAdapterPadded(Private privateTag, LayoutContext *context, LayoutPtr child, Padding padding);
     static std::shared_ptr<LayoutAdapterPadded> make(LayoutContext* context, LayoutPtr child, Padding padding) { return std::make_shared<LayoutAdapterPadded>(Private{}, context, child, padding); }
     std::string getTypeStr() const override { return "AdapterPadded"; }
-    SizeBound2d getBound(const PropertyBag& parentProps) override;
-    void resize(const PropertyBag& parentProps, const RectI& rect) override;
+    SizeBound2d getBoundImpl(const PropertyBag& parentProps) override;
+    void resizeImpl(const PropertyBag& parentProps, const RectI& rect) override;
 };
 
 
@@ -45,5 +46,28 @@ public:
     EvtRes onMouse(const PropertyBag& parentProps, MouseEventReason reason, const MouseEvt &evt) override;
 };
 
+// Opt-in draw caching for mostly static subtrees.  The first draw records the
+// child's canvas calls; later frames replay the recording without visiting the
+// subtree.  The recording is dropped when the subtree is laid out again, when
+// the draw clip or properties differ from the recorded ones, on setNeedsRedraw()
+// anywhere in the subtree, and while the pointer or a focus is inside it (so
+// hover and press feedback is always drawn live).
+class LayoutCached : public LayoutAdapter {
+protected:
+    DisplayList displayList;
+    bool recorded{false};
+    PropertyBag recordedProps;
+    RectI recordedClip;
+public:
+    LayoutCached(Private privateTag, LayoutContext *context, LayoutPtr child);
+    static std::shared_ptr<LayoutCached> make(LayoutContext* context, LayoutPtr child) { return std::make_shared<LayoutCached>(Private{}, context, child); }
+    std::string getTypeStr() const override { return "Cached"; }
+    void draw(const PropertyBag& parentProps, mssm::Canvas2d& g) override;
+    void resizeImpl(const PropertyBag& parentProps, const RectI& rect) override;
+    void invalidate();
+    bool isRecorded() const { return recorded; }
+protected:
+    void onNeedsRedraw() override { invalidate(); }
+};
 
 #endif // LAYOUTADAPTER_H
@@ -33,6 +33,7 @@ void LayoutButtonBase::setChecked(bool newChecked)
         return;
     }
     checked = newChecked;
+    setNeedsRedraw();
 }
 
 LayoutBase::EvtRes LayoutButtonBase::onMouse(const PropertyBag& parentProps, MouseEventReason reason, const MouseEvt &evt)
@@ -286,14 +287,14 @@ void LayoutButton::drawRadio(const PropertyBag &parentProps, mssm::Canvas2d &g,
     child->draw(parentProps, g);
 }
 
-SizeBound2d LayoutButton::getBound(const PropertyBag& parentProps)
+SizeBound2d LayoutButton::getBoundImpl(const PropertyBag& parentProps)
 {
     auto bound = child->getBound(parentProps);
     bound.grow(roundRadius/2,roundRadius/2);
     return bound;
 }
 
-void LayoutButton::resize(const PropertyBag& parentProps, const RectI& rect)
+void LayoutButton::resizeImpl(const PropertyBag& parentProps, const RectI& rect)
 {
     setRect(rect);
     if (child) {
@@ -33,7 +33,7 @@ void LayoutStacked::draw(const PropertyBag& parentProps, mssm::Canvas2d& g)
     popClip(g);
 }
 
-SizeBound2d LayoutStacked::getBound(const PropertyBag& parentProps)
+SizeBound2d LayoutStacked::getBoundImpl(const PropertyBag& parentProps)
 {
     if (children.empty()) {
         throw std::logic_error("empty children in getBound");
@@ -199,7 +199,7 @@ std::pair<std::vector<int>, std::vector<int>> LayoutCross(CrossJustify justify,
     return {sizes, offsets};
 }
 
-void LayoutStacked::resize(const PropertyBag& parentProps, const RectI &newRect)
+void LayoutStacked::resizeImpl(const PropertyBag& parentProps, const RectI &newRect)
 {
     std::vector<SizeBound> bounds;
     std::vector<SizeBound> crossBounds;
@@ -286,7 +286,7 @@ LayoutSplitter::LayoutSplitter(Private privateTag,
     setParentsOfChildren();
 }
 
-SizeBound2d LayoutSplitter::getBound(const PropertyBag& parentProps)
+SizeBound2d LayoutSplitter::getBoundImpl(const PropertyBag& parentProps)
 {
     if (isHorizontal) {
         SizeBound2d bound = hStack(children[0]->getBound(parentProps), children[1]->getBound(parentProps));
@@ -311,7 +311,7 @@ int preferredSize(int oldFirst, int oldSecond, int desiredTotal)
     return scale * std::max(0, oldFirst);
 }
 
-void LayoutSplitter::resize(const PropertyBag& parentProps, const RectI &newRect)
+void LayoutSplitter::resizeImpl(const PropertyBag& parentProps, const RectI &newRect)
 {
     if (isHorizontal) {
         bool widthChanged = newRect.widthDiffers(*this);
@@ -355,7 +355,7 @@ void LayoutSplitter::dragSplit(Vec2d pos)
         auto top = children[0]->thisRect();
         desiredSplitPos = std::max(0.0, pos.y - top.pos.y); // TODO: account for margins?
     }
-    context->setNeedsResize();
+    setNeedsResize();
 }
 
 LayoutBase::EvtRes LayoutSplitter::onMouse(const PropertyBag& parentProps, MouseEventReason reason, const MouseEvt &evt)
@@ -556,7 +556,7 @@ LayoutGridRow::LayoutGridRow(Private privateTag,
     setParentsOfChildren();
 }
 
-void LayoutGridRow::resize(const PropertyBag& parentProps, const RectI& rect)
+void LayoutGridRow::resizeImpl(const PropertyBag& parentProps, const RectI& rect)
 {
     throw std::logic_error("Should call resize with column widths instead of this method");
 }
@@ -575,6 +575,7 @@ void LayoutGridRow::resize(const PropertyBag& parentProps, const RectI &newRect,
     width = newRect.width;
     height = newRect.height;
     pos = newRect.pos;
+    markLaidOut(newRect);
 }
 
 void LayoutGridRow::draw(const PropertyBag& parentProps, mssm::Canvas2d& g)
@@ -584,7 +585,7 @@ void LayoutGridRow::draw(const PropertyBag& parentProps, mssm::Canvas2d& g)
     popClip(g);
 }
 
-SizeBound2d LayoutGridRow::getBound(const PropertyBag& parentProps)
+SizeBound2d LayoutGridRow::getBoundImpl(const PropertyBag& parentProps)
 {
     if (children.empty()) {
         throw std::logic_error("empty children in getBound");
@@ -625,7 +626,7 @@ void LayoutGrid::draw(const PropertyBag& parentProps, mssm::Canvas2d& g)
     popClip(g);
 }
 
-void LayoutGrid::resize(const PropertyBag& parentProps, const RectI &newRect)
+void LayoutGrid::resizeImpl(const PropertyBag& parentProps, const RectI &newRect)
 {
     getBound(parentProps); // force recalc columnbounds, etc?
 
@@ -659,7 +660,7 @@ void LayoutGrid::resize(const PropertyBag& parentProps, const RectI &newRect)
     pos = newRect.pos;
 }
 
-SizeBound2d LayoutGrid::getBound(const PropertyBag& parentProps)
+SizeBound2d LayoutGrid::getBoundImpl(const PropertyBag& parentProps)
 {
     columnBounds.clear();
     columnBounds.resize(numColumns);
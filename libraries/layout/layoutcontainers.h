@@ -34,8 +34,8 @@ public:
     LayoutSplitter(Private privateTag, LayoutContext* context, bool isHorizontal, LayoutPtr first, LayoutPtr second);
     static std::shared_ptr<LayoutSplitter> make(LayoutContext* context, bool isHorizontal, LayoutPtr first, LayoutPtr second) { return std::make_shared<LayoutSplitter>(Private{}, context, isHorizontal, first, second); }
     std::string getTypeStr() const override { return "Splitter"; }
-    SizeBound2d getBound(const PropertyBag& parentProps) override;
-    void resize(const PropertyBag& parentProps, const RectI& rect) override;
+    SizeBound2d getBoundImpl(const PropertyBag& parentProps) override;
+    void resizeImpl(const PropertyBag& parentProps, const RectI& rect) override;
     void dragSplit(Vec2d pos);
     EvtRes onMouse(const PropertyBag& parentProps, MouseEventReason reason, const MouseEvt &evt) override;
     void draw(const PropertyBag& parentProps, mssm::Canvas2d& g) override;
@@ -74,8 +74,8 @@ public:
     static std::shared_ptr<LayoutStacked> make(LayoutContext* context, bool isHorizontal, Justify justify, CrossJustify crossJustify, std::vector<LayoutPtr> children) { return std::make_shared<LayoutStacked>(Private{}, context, isHorizontal, justify, crossJustify, children); }
     std::string getTypeStr() const override { return "Stacked"; }
     void draw(const PropertyBag& parentProps, mssm::Canvas2d& g) override;
-    void resize(const PropertyBag& parentProps, const RectI& rect) override;
-    SizeBound2d getBound(const PropertyBag& parentProps) override;
+    void resizeImpl(const PropertyBag& parentProps, const RectI& rect) override;
+    SizeBound2d getBoundImpl(const PropertyBag& parentProps) override;
 };
 
 
@@ -109,18 +109,27 @@ template<typename CHILD>
 void LayoutWithChildren<CHILD>::appendChild(CHILD child)
 {
     children.push_back(child);
+    child->setParent(this);
+    child->updateLayer(getLayer(), getDepth() + 1);
+    child->setNeedsResizeRecursive(); // may have been laid out somewhere else
+    this->setNeedsResize();
 }
 
 template<typename CHILD>
 void LayoutWithChildren<CHILD>::insertChild(CHILD child, int index)
 {
     children.insert(children.begin() + index, child);
+    child->setParent(this);
+    child->updateLayer(getLayer(), getDepth() + 1);
+    child->setNeedsResizeRecursive(); // may have been laid out somewhere else
+    this->setNeedsResize();
 }
 
 template<typename CHILD>
 void LayoutWithChildren<CHILD>::removeChild(int index)
 {
     children.erase(children.begin()+index);
+    this->setNeedsResize();
 }
 
 
@@ -134,12 +143,12 @@ public:
     LayoutGridRow(Private privateTag, LayoutContext* context, std::vector<LayoutPtr> children);
     static LayoutGridRowPtr make(LayoutContext* context, std::vector<LayoutPtr> children) { return std::make_shared<LayoutGridRow>(Private{}, context, children); }
     std::string getTypeStr() const override { return "GridRow"; }
-    void resize(const PropertyBag& parentProps, const RectI& rect) override;
+    void resizeImpl(const PropertyBag& parentProps, const RectI& rect) override;
     virtual void resize(const PropertyBag &parentProps, const RectI& rect, std::vector<int> columnOffsets, std::vector<int> columnWidths);
     void draw(const PropertyBag& parentProps, mssm::Canvas2d& g) override;
     int numColumns() const { return children.size(); }
 
-    SizeBound2d getBound(const PropertyBag& parentProps) override;
+    SizeBound2d getBoundImpl(const PropertyBag& parentProps) override;
 
     friend class LayoutGrid;
 };
@@ -156,9 +165,9 @@ public:
     static std::shared_ptr<LayoutGrid> make(LayoutContext* context, std::vector<LayoutGridRowPtr> rows) { return std::make_shared<LayoutGrid>(Private{}, context, rows); }
     std::string getTypeStr() const override { return "Grid"; }
     void draw(const PropertyBag& parentProps, mssm::Canvas2d& g) override;
-    void resize(const PropertyBag& parentProps, const RectI& rect) override;
+    void resizeImpl(const PropertyBag& parentProps, const RectI& rect) override;
 
-    SizeBound2d getBound(const PropertyBag& parentProps) override;
+    SizeBound2d getBoundImpl(const PropertyBag& parentProps) override;
 };
 
 
@@ -388,6 +388,17 @@ void LayoutContext::updateHoverTimes(double elapsedTimeS)
     }
 }
 
+void LayoutContext::dropFromHoverChain(const LayoutBase *element)
+{
+    for (size_t i = 0; i < hoverChain.size(); i++) {
+        if (hoverChain[i].element.get() == element) {
+            hoverChain.resize(i);
+            break;
+        }
+    }
+    validateHoverChain("postDropFromHoverChain");
+}
+
 double LayoutContext::getHoverTime(const LayoutBase *element) const
 {
     for (auto& e : hoverChain) {
@@ -408,6 +419,24 @@ void LayoutContext::truncateHoverChain(const PropertyBag& parentProps, int depth
     validateHoverChain("postTruncateHoverChain");
 }
 
+void LayoutContext::resetDrawClip(const RectI &rect)
+{
+    drawClipStack.clear();
+    drawClipStack.push_back(rect);
+}
+
+void LayoutContext::pushDrawClip(const RectI &rect, bool replace)
+{
+    drawClipStack.push_back(replace ? rect : ::intersect(getDrawClip(), rect));
+}
+
+void LayoutContext::popDrawClip()
+{
+    if (drawClipStack.size() > 1) {
+        drawClipStack.pop_back();
+    }
+}
+
 void LayoutContext::resizeOverlays(const PropertyBag &parentProps, const RectI &rect)
 {
     for (int i = 0; i < overlays.size(); i++) {
@@ -7,6 +7,7 @@
 #include "textgeometry.h"
 #include "vec2d.h"
 #include "windowevents.h"
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -72,6 +73,14 @@ public:
 };
 
 class LayoutContext : public TextMetrics {
+public:
+    // counts of layout work actually performed (cache misses), reset each frame
+    struct LayoutCounters {
+        uint64_t boundsComputed{0};
+        uint64_t nodesResized{0};
+        uint64_t nodesCulled{0};
+    };
+private:
     enum class OverlayMutationType {
         push,
         remove
@@ -91,6 +100,9 @@ class LayoutContext : public TextMetrics {
     LayoutPtr keyFocus{};
     LayoutPtr dragFocus{};
     bool needsResize{true};
+    bool needsFullResize{true};
+    LayoutCounters layoutCounters;
+    std::vector<RectI> drawClipStack; // mirrors the canvas clip stack during draw, used for culling
     RectI windowRect;
     bool debug{false};
     std::vector<HoverItem> hoverChain;
@@ -109,6 +121,7 @@ public:
     bool hasDragFocus(LayoutPtr focusElement) const { return dragFocus == focusElement; }
     bool isAnyKeyboardFocus() const { return static_cast<bool>(keyFocus); }
     bool isAnyDragFocus() const { return static_cast<bool>(dragFocus); }
+    LayoutBase* getDragFocus() const { return dragFocus.get(); }
 
     void setDebug(bool debug) { this->debug = debug; }
     bool getDebug() const { return debug; }
@@ -131,9 +144,29 @@ public:
 
     virtual void debugMouse(const RectI& rect, MouseEventReason reason, const MouseEvt& evt) = 0;
 
+    // setNeedsResize schedules a layout pass.  Only elements that called
+    // LayoutBase::setNeedsResize (or whose rect changes) are re-measured.
+    // setNeedsFullResize additionally discards every cached bound and recomputes
+    // layers and depths.  Adding, removing, showing or hiding children doesn't need
+    // it: the containers dirty just the parent's path and set the child's layer.
     void setNeedsResize() { needsResize = true; }
+    void setNeedsFullResize() { needsResize = true; needsFullResize = true; }
     bool getNeedsResize() const { return needsResize; }
-    void clearNeedsResize() { needsResize = false; }
+    bool getNeedsFullResize() const { return needsFullResize; }
+    void clearNeedsResize() { needsResize = false; needsFullResize = false; }
+
+    void countBoundComputed() { layoutCounters.boundsComputed++; }
+    void countResize() { layoutCounters.nodesResized++; }
+    void countCulled() { layoutCounters.nodesCulled++; }
+    const LayoutCounters& getLayoutCounters() const { return layoutCounters; }
+    void resetLayoutCounters() { layoutCounters = {}; }
+
+    // draw clip tracking (see LayoutBase::pushClip)
+    void resetDrawClip(const RectI& rect);
+    void pushDrawClip(const RectI& rect, bool replace);
+    void popDrawClip();
+    RectI getDrawClip() const { return drawClipStack.empty() ? windowRect : drawClipStack.back(); }
+    bool isDrawClipped(const RectI& rect) const { return !getDrawClip().intersects(rect); }
 
     void pushOverlay(LayoutPtr overlay);
     void removeOverlay(LayoutPtr overlay);
@@ -144,7 +177,9 @@ public:
     void iterateHoverChain(std::function<void(LayoutBase*)> f);
     void iterateHoverChain(std::function<void(LayoutBase*,double)> f); // passes hoverTime as second parameter
     void updateHoverTimes(double elapsedTimeS);
+    void dropFromHoverChain(const LayoutBase* element); // element and everything under it leave the chain, without exit events
     double getHoverTime(const LayoutBase *element) const;
+    LayoutBase* getHoverElement(int depth) const { return depth >= 0 && static_cast<size_t>(depth) < hoverChain.size() ? hoverChain[depth].element.get() : nullptr; }
 
     virtual void resizeOverlays(const PropertyBag& parentProps, const RectI& rect);
 
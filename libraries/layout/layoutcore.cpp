@@ -1,5 +1,6 @@
 #include "layoutcore.h"
 #include "layoutcalcs.h"
+#include <algorithm>
 #include <sstream>
 
 
@@ -121,13 +122,95 @@ std::shared_ptr<LayoutBase> LayoutBase::getLocalRoot()
 
 void LayoutBase::foreachChild(std::function<void (LayoutBase *)> f, ForeachContext context, bool includeOverlay, bool includeCollapsed)
 {
-    foreachChildImpl(f, context, includeOverlay, includeCollapsed);
+    if (context == ForeachContext::drawing) {
+        // skip children that lie entirely outside the current clip (and so their whole subtree)
+        LayoutContext* ctx = this->context;
+        foreachChildImpl([&f, ctx](LayoutBase* child) {
+            if (ctx->isDrawClipped(child->thisRect())) {
+                ctx->countCulled();
+                return;
+            }
+            f(child);
+        }, context, includeOverlay, includeCollapsed);
+    }
+    else {
+        foreachChildImpl(f, context, includeOverlay, includeCollapsed);
+    }
 
     if (includeOverlay && overlayElement) {
         f(overlayElement.get());
     }
 }
 
+SizeBound2d LayoutBase::getBound(const PropertyBag &parentProps)
+{
+    if (!cachedBound || !parentProps.sameAs(boundProps)) {
+        context->countBoundComputed();
+        cachedBound = getBoundImpl(parentProps);
+        boundProps = parentProps;
+    }
+    return *cachedBound;
+}
+
+void LayoutBase::resize(const PropertyBag &parentProps, const RectI &rect)
+{
+    if (!layoutDirty && !descendantLayoutDirty && lastLayoutRect && lastLayoutRect->exactlyEquals(rect) &&
+        parentProps.sameAs(layoutProps)) {
+        // nothing in this subtree changed and it is being given the same space as last time
+        return;
+    }
+    context->countResize();
+    resizeImpl(parentProps, rect);
+    markLaidOut(rect);
+    layoutProps = parentProps;
+}
+
+void LayoutBase::markLaidOut(const RectI &rect)
+{
+    // children that were not resized (collapsed, inactive tabs) keep their own dirty
+    // flags, and will be laid out when they become visible and their parent is dirtied
+    layoutDirty = false;
+    descendantLayoutDirty = false;
+    lastLayoutRect = rect;
+    childIndex.reset();
+}
+
+void LayoutBase::setNeedsResize()
+{
+    // Cached bounds of ancestors are derived from ours, so they are discarded as well.
+    // On the next layout pass each ancestor re-arranges its direct children from their
+    // cached bounds, but siblings whose rect comes out unchanged are skipped by resize(),
+    // so only the dirty path (and whatever actually moved) is re-measured.
+    layoutDirty = true;
+    cachedBound.reset();
+    childIndex.reset();
+    foreachAncestor([](LayoutBase* ancestor) {
+        ancestor->descendantLayoutDirty = true;
+        ancestor->cachedBound.reset();
+    });
+    context->setNeedsResize();
+}
+
+void LayoutBase::setNeedsRedraw()
+{
+    // nothing is redrawn selectively; this only lets elements that cache drawing
+    // (LayoutCached) know that what they recorded is stale
+    onNeedsRedraw();
+    foreachAncestor([](LayoutBase* ancestor) {
+        ancestor->onNeedsRedraw();
+    });
+}
+
+void LayoutBase::setNeedsResizeRecursive()
+{
+    traversePreOrder([](LayoutBase* element) {
+        element->layoutDirty = true;
+        element->descendantLayoutDirty = true;
+        element->cachedBound.reset();
+        element->childIndex.reset();
+    }, ForeachContext::other, true, true);
+}
+
 LayoutPtr LayoutBase::findByName(std::string nm)
 {
     if (nm == name) {
@@ -181,10 +264,20 @@ std::string LayoutBase::trail() const
 }
 
 void LayoutBase::setCollapsed(bool collapsed)
+{
+    if (isCollapsed != collapsed) {
+        // the parent arranges its children differently; layers and depths count
+        // collapsed elements too, so they don't change
+        setNeedsResize();
+    }
+    setCollapsedFlags(collapsed);
+}
+
+void LayoutBase::setCollapsedFlags(bool collapsed)
 {
     isCollapsed = collapsed;
     foreachChild([collapsed](LayoutBase* child) {
-        child->setCollapsed(collapsed);
+        child->setCollapsedFlags(collapsed);
     }, ForeachContext::other, true, false);
 }
 
@@ -297,11 +390,13 @@ void LayoutBase::localReleaseMouseAndKeyboard()  // on subtree
 void LayoutBase::pushClip(mssm::Canvas2d &g, const RectI &rect, bool replace)
 {
     g.pushClip(rect.pos.x, rect.pos.y, rect.width, rect.height, replace);
+    context->pushDrawClip(rect, replace);
 }
 
 void LayoutBase::popClip(mssm::Canvas2d &g)
 {
     g.popClip();
+    context->popDrawClip();
 }
 
 LayoutBase::EvtRes LayoutBase::propagateMouse(const PropertyBag& parentProps, EvtProp prop, const RectI &clip, MouseEvt &evt)
@@ -392,12 +487,12 @@ LayoutBase::EvtRes LayoutBase::propagateMouse(const PropertyBag& parentProps, Ev
 
     }
 
-    foreachChild([&evt, &newClip, &prop, &parentProps](LayoutBase* child) {
+    foreachMouseChild(evt.pos, [&evt, &newClip, &prop, &parentProps](LayoutBase* child) {
         EvtRes res = child->propagateMouse(parentProps, prop, newClip, evt);
         if (res != EvtRes::propagate) {
             prop = EvtProp::hover;
         }
-    }, ForeachContext::events, false, false);
+    });
 
     if (reason != MouseEventReason::hoverOnly) {
         res = onMouseDeferred(parentProps, reason, evt);
@@ -406,6 +501,70 @@ LayoutBase::EvtRes LayoutBase::propagateMouse(const PropertyBag& parentProps, Ev
     return res;
 }
 
+// Children that propagateMouse would visit to no effect (not under the pointer,
+// not in the hover chain, not holding the grab) are skipped.  For elements with
+// many children the ones under the pointer come from a spatial index, so a mouse
+// move costs roughly the depth of the tree rather than its size.
+void LayoutBase::foreachMouseChild(Vec2d pos, std::function<void (LayoutBase *)> f)
+{
+    if (!childIndex) {
+        int count = 0;
+        foreachChild([&count](LayoutBase*) { count++; }, ForeachContext::events, false, false);
+        if (count < LayoutSpatialIndex::minChildren) {
+            // too few to index: don't allocate anything, just visit them all
+            foreachChild(f, ForeachContext::events, false, false);
+            return;
+        }
+        std::vector<LayoutPtr> kids;
+        kids.reserve(count);
+        foreachChild([&kids](LayoutBase* child) {
+            kids.push_back(child->shared_from_this());
+        }, ForeachContext::events, false, false);
+        childIndex = std::make_unique<LayoutSpatialIndex>();
+        childIndex->build(std::move(kids));
+    }
+
+    if (!childIndex->isIndexed()) {
+        foreachChild(f, ForeachContext::events, false, false);
+        return;
+    }
+
+    std::vector<int> hits;
+    childIndex->query(pos, hits);
+
+    // the child on the path to a descendant must also see the event, so it can
+    // send exit notifications or deliver the event to the grab
+    auto addPathTo = [this, &hits](LayoutBase* descendant) {
+        while (descendant && descendant->layer == layer && descendant->depth > depth + 1) {
+            descendant = descendant->parent;
+        }
+        if (descendant && descendant->parent == this) {
+            if (int ordinal = childIndex->ordinalOf(descendant); ordinal >= 0) {
+                hits.push_back(ordinal);
+            }
+        }
+    };
+
+    addPathTo(context->getHoverElement(depth + 1));
+    if (containsDragFocusElement) {
+        addPathTo(context->getDragFocus());
+    }
+
+    std::sort(hits.begin(), hits.end());
+    hits.erase(std::unique(hits.begin(), hits.end()), hits.end());
+
+    // handlers may relayout (which drops the index), so hold the children locally
+    std::vector<LayoutPtr> targets;
+    targets.reserve(hits.size());
+    for (int ordinal : hits) {
+        targets.push_back(childIndex->child(ordinal));
+    }
+
+    for (auto& child : targets) {
+        f(child.get());
+    }
+}
+
 LayoutBase::EvtRes LayoutBase::propagateKey(const PropertyBag& parentProps, EvtProp prop, const RectI &clip, KeyEvt &evt)
 {
     auto newClip = ::intersect(clip, thisRect());
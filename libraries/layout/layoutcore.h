@@ -3,6 +3,7 @@
 
 #include "canvas2d.h"
 #include "layoutcontext.h"
+#include "layoutspatialindex.h"
 #include "propertybag.h"
 #include "recti.h"
 #include "sizebound.h"
@@ -334,8 +335,20 @@ private:
 
     int layer{0};  // 0 is base layer, 1+ are overlays
     int depth{0};  // 0 for base layer root or for roots of overlays
+
+    // incremental layout state (see setNeedsResize)
+    bool layoutDirty{true};           // this element must re-measure and re-arrange
+    bool descendantLayoutDirty{true}; // some element below this one is layoutDirty
+    std::optional<SizeBound2d> cachedBound;
+    PropertyBag boundProps;              // parentProps cachedBound was computed with
+    std::optional<RectI> lastLayoutRect; // rect passed to the last resize
+    PropertyBag layoutProps;             // parentProps passed to the last resize
+    std::unique_ptr<LayoutSpatialIndex> childIndex; // built on demand by foreachMouseChild, dropped on relayout
 protected:
     LayoutBase(LayoutContext* context) : context{context} { id = nextId++; }
+    void markLaidOut(const RectI& rect);
+    void setCollapsedFlags(bool collapsed);
+    virtual void onNeedsRedraw() {} // setNeedsRedraw was called on this element or a descendant
 public:
     virtual ~LayoutBase() = default;
     virtual std::string getTypeStr() const = 0;
@@ -349,8 +362,19 @@ public:
     virtual void draw(const PropertyBag& parentProps, mssm::Canvas2d& g) = 0;
     constexpr RectI thisRect() const { return *this; }
     RectRegion region(Vec2d pos, int innerBorder, int outerBorder) const { return RectI::region(pos.x, pos.y, innerBorder, outerBorder); }
-    virtual SizeBound2d getBound(const PropertyBag& parentProps) = 0;
-    virtual void resize(const PropertyBag& parentProps, const RectI& rect) = 0;
+
+    // getBound and resize are cached: the Impl versions only run when this element
+    // (or one of its descendants) has called setNeedsResize, or when the rect or
+    // the properties passed down change
+    SizeBound2d getBound(const PropertyBag& parentProps);
+    void resize(const PropertyBag& parentProps, const RectI& rect);
+    virtual SizeBound2d getBoundImpl(const PropertyBag& parentProps) = 0;
+    virtual void resizeImpl(const PropertyBag& parentProps, const RectI& rect) = 0;
+
+    void setNeedsResize(); // call when something changes that affects this element's bound or arrangement
+    void setNeedsResizeRecursive(); // discard all cached layout state in this subtree (and overlays)
+    bool getNeedsResize() const { return layoutDirty || descendantLayoutDirty; }
+    void setNeedsRedraw(); // call when something changes that affects only how this element looks
 
     virtual void onSetKeyFocus();
     virtual void onClearKeyFocus();
@@ -362,6 +386,7 @@ public:
 
     constexpr bool hasKeyFocus() const { return isKeyFocusElement; }
     constexpr bool hasDragFocus() const { return isDragFocusElement; }
+    constexpr bool isFocusWithin() const { return isKeyFocusElement || containsKeyFocusElement || isDragFocusElement || containsDragFocusElement; }
 
     double distance(Vec2d pos);
 
@@ -432,6 +457,7 @@ public:
     void popClip(mssm::Canvas2d& g);
 
     virtual EvtRes propagateMouse(const PropertyBag& parentProps, EvtProp prop, const RectI& clip, MouseEvt& evt);
+    void foreachMouseChild(Vec2d pos, std::function<void(LayoutBase*)> f); // children propagateMouse needs to visit
     virtual EvtRes onMouse(const PropertyBag& parentProps, MouseEventReason reason, const MouseEvt& evt);
     virtual EvtRes onMouseDeferred(const PropertyBag& parentProps, MouseEventReason reason, const MouseEvt& evt);
 
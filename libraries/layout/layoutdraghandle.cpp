@@ -58,12 +58,12 @@ void LayoutDragHandle::draw(const PropertyBag& parentProps, mssm::Canvas2d& g)
     drawRect(g, thisRect(), WHITE, BLUE);
 }
 
-SizeBound2d LayoutDragHandle::getBound(const PropertyBag& parentProps)
+SizeBound2d LayoutDragHandle::getBoundImpl(const PropertyBag& parentProps)
 {
     return bound;
 }
 
-void LayoutDragHandle::resize(const PropertyBag& parentProps, const RectI& rect)
+void LayoutDragHandle::resizeImpl(const PropertyBag& parentProps, const RectI& rect)
 {
     setRect(rect);
 }
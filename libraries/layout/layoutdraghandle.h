@@ -21,8 +21,8 @@ public:
     std::string getTypeStr() const override { return "DragHandle"; }
     EvtRes onMouse(const PropertyBag& parentProps, MouseEventReason reason, const MouseEvt &evt) override;
     void draw(const PropertyBag& parentProps, mssm::Canvas2d& g) override;
-    SizeBound2d getBound(const PropertyBag& parentProps) override;
-    void resize(const PropertyBag& parentProps, const RectI& rect) override;
+    SizeBound2d getBoundImpl(const PropertyBag& parentProps) override;
+    void resizeImpl(const PropertyBag& parentProps, const RectI& rect) override;
     void foreachChildImpl(std::function<void(LayoutBase*)> f, ForeachContext context, bool includeOverlay, bool includeCollapsed) override;
 };
 
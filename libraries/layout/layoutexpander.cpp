@@ -10,10 +10,10 @@ LayoutExpander::LayoutExpander(Private privateTag, LayoutContext *context, Layou
     setParentsOfChildren();
 }
 
-SizeBound2d LayoutExpander::getBound(const PropertyBag& parentProps)
+SizeBound2d LayoutExpander::getBoundImpl(const PropertyBag& parentProps)
 {
     COWPropertyBag childProps{parentProps};
-    childProps.setProperty("Checked", expanded);
+    childProps.setProperty(PropertyKeys::checked, expanded);
 
     if (expanded) {
         auto buttonBound = header->getBound(childProps);
@@ -29,13 +29,13 @@ SizeBound2d LayoutExpander::getBound(const PropertyBag& parentProps)
 void LayoutExpander::onClickHeader()
 {
     expanded = !expanded;
-    context->setNeedsResize();
+    setNeedsResize();
 }
 
-void LayoutExpander::resize(const PropertyBag& parentProps, const RectI& rect)
+void LayoutExpander::resizeImpl(const PropertyBag& parentProps, const RectI& rect)
 {
     COWPropertyBag childProps{parentProps};
-    childProps.setProperty("Checked", expanded);
+    childProps.setProperty(PropertyKeys::checked, expanded);
 
     if (expanded) {
         auto buttonBound = header->getBound(childProps);
@@ -53,7 +53,7 @@ void LayoutExpander::resize(const PropertyBag& parentProps, const RectI& rect)
 void LayoutExpander::draw(const PropertyBag& parentProps, mssm::Canvas2d &g)
 {
     COWPropertyBag childProps{parentProps};
-    childProps.setProperty("Checked", expanded);
+    childProps.setProperty(PropertyKeys::checked, expanded);
 
     if (expanded) {
         header->draw(childProps, g);
@@ -177,6 +177,31 @@ Scroll::operator Builder() const
     };
 }
 
+Cached::operator Builder() const
+{
+    Builder child = this->child;
+    auto config = this->config;
+    return [child, config](LayoutContext *context) {
+        auto widget = LayoutCached::make(context, child(context));
+        config.applyTo(widget);
+        return widget;
+    };
+}
+
+VirtualList::operator Builder() const
+{
+    int rowCount = this->rowCount;
+    int rowHeight = this->rowHeight;
+    Builder rowFactory = this->rowFactory;
+    auto rowBinder = this->rowBinder;
+    auto config = this->config;
+    return [rowCount, rowHeight, rowFactory, rowBinder, config](LayoutContext *context) {
+        auto widget = LayoutVirtualList::make(context, rowCount, rowHeight, rowFactory, rowBinder);
+        config.applyTo(widget);
+        return widget;
+    };
+}
+
 Panel::operator Builder() const
 {
     mssm::Color color = this->color;
@@ -230,6 +230,30 @@ public:
     operator Builder() const override;
 };
 
+class VirtualList : public BuilderBase<LayoutVirtualList>  {
+private:
+    int rowCount;
+    int rowHeight;
+    Builder rowFactory;
+    LayoutVirtualList::RowBinder rowBinder;
+public:
+    VirtualList(LayoutConfig<LayoutVirtualList> config, int rowCount, int rowHeight, Wrapper rowFactory, LayoutVirtualList::RowBinder rowBinder)
+        : BuilderBase{config}, rowCount{rowCount}, rowHeight{rowHeight}, rowFactory{rowFactory}, rowBinder{rowBinder} {}
+    VirtualList(int rowCount, int rowHeight, Wrapper rowFactory, LayoutVirtualList::RowBinder rowBinder)
+        : rowCount{rowCount}, rowHeight{rowHeight}, rowFactory{rowFactory}, rowBinder{rowBinder} {}
+    operator Builder() const override;
+};
+
+// draws its content from a recorded display list until something in it changes (see LayoutCached)
+class Cached : public BuilderBase<LayoutCached>  {
+private:
+    Builder child;
+public:
+    Cached(LayoutConfig<LayoutCached> config, Wrapper child) : BuilderBase{config}, child{child} {}
+    Cached(Wrapper child) : child{child} {}
+    operator Builder() const override;
+};
+
 // `a | b` creates a horizontal split, `a / b` creates a vertical split.
 Builder operator|(Wrapper aw, Wrapper bw);
 Builder operator/(Wrapper aw, Wrapper bw);
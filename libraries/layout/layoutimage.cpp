@@ -17,6 +17,7 @@ LayoutImage::~LayoutImage()
 void LayoutImage::updateImage(mssm::Image img)
 {
     image = img;
+    setNeedsRedraw();
 }
 
 void LayoutImage::draw(const PropertyBag &parentProps, mssm::Canvas2d &g)
@@ -25,12 +26,12 @@ void LayoutImage::draw(const PropertyBag &parentProps, mssm::Canvas2d &g)
     g.image(pos, width, height, image);
 }
 
-SizeBound2d LayoutImage::getBound(const PropertyBag &parentProps)
+SizeBound2d LayoutImage::getBoundImpl(const PropertyBag &parentProps)
 {
     return bound;
 }
 
-void LayoutImage::resize(const PropertyBag &parentProps, const RectI &rect)
+void LayoutImage::resizeImpl(const PropertyBag &parentProps, const RectI &rect)
 {
     setRect(rect);
     // contentRect.pos = rect.pos;
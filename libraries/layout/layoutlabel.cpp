@@ -17,6 +17,16 @@ LayoutLabel::~LayoutLabel()
 {
 }
 
+void LayoutLabel::setText(std::string newText)
+{
+    if (text == newText) {
+        return;
+    }
+    text = std::move(newText);
+    setNeedsResize();
+    setNeedsRedraw();
+}
+
 void LayoutLabel::draw(const PropertyBag& parentProps, mssm::Canvas2d& g)
 {
     Vec2d tPos = textPos(thisRect(), hAlign, vAlign);
@@ -26,7 +36,7 @@ void LayoutLabel::draw(const PropertyBag& parentProps, mssm::Canvas2d& g)
     g.text(tPos, sizeAndFace, text, textColor, hAlign, vAlign);
 }
 
-SizeBound2d LayoutLabel::getBound(const PropertyBag& parentProps)
+SizeBound2d LayoutLabel::getBoundImpl(const PropertyBag& parentProps)
 {
     TextExtents extents;
     context->textExtents(sizeAndFace, text, extents);
@@ -37,7 +47,7 @@ SizeBound2d LayoutLabel::getBound(const PropertyBag& parentProps)
     //    return {SizeBound(extents.textWidth+padding.left+padding.right), SizeBound(extents.fontHeight + , extents.fontHeight + 4)};
 }
 
-void LayoutLabel::resize(const PropertyBag& parentProps, const RectI& rect)
+void LayoutLabel::resizeImpl(const PropertyBag& parentProps, const RectI& rect)
 {
     setRect(rect);
 }
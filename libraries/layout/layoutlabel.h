@@ -18,9 +18,11 @@ public:
     virtual ~LayoutLabel();
     static std::shared_ptr<LayoutLabel> make(LayoutContext* context, std::string text, int fontSize = 20) { return std::make_shared<LayoutLabel>(Private{}, context, text, fontSize); }
     std::string getTypeStr() const override { return "Label"; }
+    const std::string& getText() const { return text; }
+    void setText(std::string newText);
     void draw(const PropertyBag& parentProps, mssm::Canvas2d& g) override;
-    SizeBound2d getBound(const PropertyBag& parentProps) override;
-    void resize(const PropertyBag& parentProps, const RectI& rect) override;
+    SizeBound2d getBoundImpl(const PropertyBag& parentProps) override;
+    void resizeImpl(const PropertyBag& parentProps, const RectI& rect) override;
     void foreachChildImpl(std::function<void(LayoutBase*)> f, ForeachContext context, bool includeOverlay, bool includeCollapsed) override;
 };
 
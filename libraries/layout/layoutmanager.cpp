@@ -124,6 +124,7 @@ void LayoutManager::draw(mssm::CoreWindow& window, mssm::Canvas2d &g)
     stats.eventsProcessed = 0;
     stats.overlayCount = context->overlays.size();
     stats.resizedThisFrame = false;
+    context->resetLayoutCounters();
 
     PropertyBag parentProps;
 
@@ -131,10 +132,9 @@ void LayoutManager::draw(mssm::CoreWindow& window, mssm::Canvas2d &g)
 
     context->updateWindowRect(screenRect);
 
-    // TODO: is this just debugging?
+#ifndef NDEBUG
     layout->traversePreOrder(
         [&](LayoutBase *element) {
-            stats.nodesVisited++;
             if (element->getDepth() > 0) {
                 auto pp = element->getParentPtr();
                 if (pp) {
@@ -146,7 +146,8 @@ void LayoutManager::draw(mssm::CoreWindow& window, mssm::Canvas2d &g)
                 }
             }
         },
-        LayoutBase::ForeachContext::drawing, false, true);
+        LayoutBase::ForeachContext::other, false, true);
+#endif
 
     propagateEvents(parentProps, window.elapsedSeconds());
 
@@ -169,10 +170,12 @@ void LayoutManager::draw(mssm::CoreWindow& window, mssm::Canvas2d &g)
         }
 
         g.resetClip();
+        context->resetDrawClip(screenRect);
 
         layout->draw(parentProps, g);
 
         g.resetClip();
+        context->resetDrawClip(screenRect);
 
         for (LayoutPtr overlay : context->overlays) {
             overlay->draw(parentProps, g);
@@ -188,6 +191,11 @@ void LayoutManager::draw(mssm::CoreWindow& window, mssm::Canvas2d &g)
         if (layout->hasDragFocus()) {
             g.rect({0, 0}, g.width() - 1, g.height() - 1, mssm::RED);
         }
+
+        stats.boundsComputed = context->getLayoutCounters().boundsComputed;
+        stats.nodesResized = context->getLayoutCounters().nodesResized;
+        stats.nodesCulled = context->getLayoutCounters().nodesCulled;
+        stats.nodesVisited = stats.boundsComputed + stats.nodesResized;
     }
 
     if (window.isAltKeyPressed()) {
@@ -214,7 +222,11 @@ void LayoutManager::draw(mssm::CoreWindow& window, mssm::Canvas2d &g)
         yPos += 18;
         g.text({10, yPos}, 16, "events: " + std::to_string(stats.eventsProcessed));
         yPos += 18;
-        g.text({10, yPos}, 16, "nodes: " + std::to_string(stats.nodesVisited));
+        g.text({10, yPos}, 16, "nodes: " + std::to_string(stats.nodesVisited)
+                                   + " (bounds: " + std::to_string(stats.boundsComputed)
+                                   + " resized: " + std::to_string(stats.nodesResized) + ")");
+        yPos += 18;
+        g.text({10, yPos}, 16, "culled: " + std::to_string(stats.nodesCulled));
         yPos += 18;
         g.text({10, yPos}, 16, "overlays: " + std::to_string(stats.overlayCount));
         yPos += 18;
@@ -265,9 +277,19 @@ void LayoutManager::propagateKey(const PropertyBag &parentProps, const RectI &cl
 
 void LayoutManager::resize(const PropertyBag &parentProps, const RectI &rect)
 {
+    // Elements that called setNeedsResize (and their ancestors) are re-measured,
+    // clean subtrees that keep the same rect are skipped by LayoutBase::resize
+    bool fullResize = context->getNeedsFullResize();
+    if (fullResize) {
+        layout->setNeedsResizeRecursive();
+        for (auto& overlay : context->overlays) {
+            overlay->setNeedsResizeRecursive();
+        }
+    }
     context->resizeOverlays(parentProps, rect);
     layout->resize(parentProps, rect);
     context->clearNeedsResize();
-    layout->updateLayer(0, 0);
-
+    if (fullResize) {
+        layout->updateLayer(0, 0);
+    }
 }
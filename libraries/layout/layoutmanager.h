@@ -10,7 +10,10 @@ class LayoutManager
 public:
     struct FrameStats {
         uint64_t frameIndex{0};
-        uint64_t nodesVisited{0};
+        uint64_t nodesVisited{0};    // nodes whose bound or layout was actually recomputed
+        uint64_t boundsComputed{0};  // getBound cache misses
+        uint64_t nodesResized{0};    // resize calls that were not skipped
+        uint64_t nodesCulled{0};     // subtrees skipped while drawing because they were outside the clip
         uint64_t eventsProcessed{0};
         uint64_t overlayCount{0};
         bool resizedThisFrame{false};
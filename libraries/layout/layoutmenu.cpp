@@ -7,13 +7,13 @@ LayoutMenuItem::LayoutMenuItem(Private privateTag, LayoutContext *context, Layou
 {
 }
 
-SizeBound2d LayoutMenuItem::getBound(const PropertyBag &parentProps)
+SizeBound2d LayoutMenuItem::getBoundImpl(const PropertyBag &parentProps)
 {
     auto bound = child->getBound(parentProps);
     return bound;
 }
 
-void LayoutMenuItem::resize(const PropertyBag &parentProps, const RectI &rect)
+void LayoutMenuItem::resizeImpl(const PropertyBag &parentProps, const RectI &rect)
 {
     auto bound = getBound(parentProps);
 
@@ -97,13 +97,13 @@ void LayoutMenu::draw(const PropertyBag& parentProps, mssm::Canvas2d& g)
     buttonSet.checkClickOnHover(parentProps);
 }
 
-void LayoutMenu::resize(const PropertyBag& parentProps, const RectI& rect)
+void LayoutMenu::resizeImpl(const PropertyBag& parentProps, const RectI& rect)
 {
     tabBar->resize(parentProps, rect);
     setRect(rect);
 }
 
-SizeBound2d LayoutMenu::getBound(const PropertyBag& parentProps)
+SizeBound2d LayoutMenu::getBoundImpl(const PropertyBag& parentProps)
 {
     return tabBar->getBound(parentProps);
 }
@@ -14,8 +14,8 @@ public:
     static std::shared_ptr<LayoutMenuItem> make(LayoutContext* context, LayoutPtr child, LayoutButton* button, bool isHorizontal) { return std::make_shared<LayoutMenuItem>(Private{}, context, child, button, isHorizontal); }
     std::string getTypeStr() const override { return "LayoutMenuItem"; }
 
-    SizeBound2d getBound(const PropertyBag &parentProps) override;
-    void resize(const PropertyBag &parentProps, const RectI &rect) override;
+    SizeBound2d getBoundImpl(const PropertyBag &parentProps) override;
+    void resizeImpl(const PropertyBag &parentProps, const RectI &rect) override;
 
     EvtRes onMouse(const PropertyBag &parentProps, MouseEventReason reason, const MouseEvt &evt) override;
 };
@@ -42,8 +42,8 @@ public:
     static std::shared_ptr<LayoutMenu> make(LayoutContext* context, bool isHorizontal, std::vector<Item> children) { return std::make_shared<LayoutMenu>(Private{}, context, isHorizontal, children); }
     std::string getTypeStr() const override { return "Menu"; }
     void draw(const PropertyBag& parentProps, mssm::Canvas2d& g) override;
-    void resize(const PropertyBag& parentProps, const RectI& rect) override;
-    SizeBound2d getBound(const PropertyBag& parentProps) override;
+    void resizeImpl(const PropertyBag& parentProps, const RectI& rect) override;
+    SizeBound2d getBoundImpl(const PropertyBag& parentProps) override;
     void setOuterMargins(int left, int right, int top, int bottom) override;
     void foreachChildImpl(std::function<void (LayoutBase *)> f, ForeachContext context, bool includeOverlay, bool includeCollapsed) override;
     void openMenu(int buttonIdx);
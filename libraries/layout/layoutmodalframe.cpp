@@ -17,12 +17,12 @@ LayoutBase::EvtRes LayoutModalFrame::onKeyDeferred(const PropertyBag &parentProp
     return EvtRes::consumed;
 }
 
-SizeBound2d LayoutModalFrame::getBound(const PropertyBag &parentProps)
+SizeBound2d LayoutModalFrame::getBoundImpl(const PropertyBag &parentProps)
 {
     return SizeBound2d(width, height, width, height);
 }
 
-void LayoutModalFrame::resize(const PropertyBag &parentProps, const RectI &rect)
+void LayoutModalFrame::resizeImpl(const PropertyBag &parentProps, const RectI &rect)
 {
     RectI newRect{{0, 0}, width, height};
     setRect(newRect.centered(rect));
@@ -18,8 +18,8 @@ public:
     EvtRes onMouseDeferred(const PropertyBag &parentProps, MouseEventReason reason, const MouseEvt &evt) override;
     EvtRes onKeyDeferred(const PropertyBag &parentProps, const KeyEvt &evt) override;
     
-    SizeBound2d getBound(const PropertyBag &parentProps) override;
-    void resize(const PropertyBag &parentProps, const RectI &rect) override;
+    SizeBound2d getBoundImpl(const PropertyBag &parentProps) override;
+    void resizeImpl(const PropertyBag &parentProps, const RectI &rect) override;
 };
 
 #endif // LAYOUTMODALFRAME_H
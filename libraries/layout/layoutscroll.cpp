@@ -39,19 +39,26 @@ LayoutBase::EvtRes LayoutScroll::onMouseDeferred(const PropertyBag &parentProps,
         break;
     case MouseEvt::Action::none:
     case MouseEvt::Action::move:
+    case MouseEvt::Action::exit:
+    case MouseEvt::Action::enter:
+        break;
     case MouseEvt::Action::drag:
     case MouseEvt::Action::press:
     case MouseEvt::Action::release:
-    case MouseEvt::Action::exit:
-    case MouseEvt::Action::enter:
-        
+        // a scrollbar was dragged or clicked, reposition content
+        if (hScroll->value != xScroll || vScroll->value != yScroll) {
+            setNeedsResize();
+        }
         break;
     case MouseEvt::Action::scroll:
         if (!vScroll->within(evt.pos) && !hScroll->within(evt.pos)) {
             vScroll->applyWheel(evt.dragDelta.y);
-            context->setNeedsResize();
+            setNeedsResize();
             return EvtRes::consumed;
         }
+        if (hScroll->value != xScroll || vScroll->value != yScroll) {
+            setNeedsResize();
+        }
         break;
     }
     
@@ -73,17 +80,19 @@ void LayoutScroll::draw(const PropertyBag& parentProps, mssm::Canvas2d& g)
     constexpr const int scrollGutter = 2;
     int vScrollWidth = vScroll->width ? vScroll->width + scrollGutter : 0;
     int hScrollHeight = hScroll->height ? hScroll->height + scrollGutter : 0;
-    g.pushClip(left(), top(), std::max(0,width-vScrollWidth), std::max(0,height-hScrollHeight), false);
+    pushClip(g, {pos, std::max(0,width-vScrollWidth), std::max(0,height-hScrollHeight)}, false);
+    // descendants drawn through foreachChild are culled against this viewport clip
     child->draw(parentProps, g);
     popClip(g);
+    popClip(g);
 }
 
-SizeBound2d LayoutScroll::getBound(const PropertyBag& parentProps)
+SizeBound2d LayoutScroll::getBoundImpl(const PropertyBag& parentProps)
 {
     return {SizeBound(0), SizeBound(0)};
 }
 
-void LayoutScroll::resize(const PropertyBag& parentProps, const RectI& rect)
+void LayoutScroll::resizeImpl(const PropertyBag& parentProps, const RectI& rect)
 {
     setRect(rect);
     
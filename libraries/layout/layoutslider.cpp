@@ -18,7 +18,8 @@ LayoutSlider::LayoutSlider(Private privateTag,
 LayoutBase::EvtRes LayoutSlider::onMouse(const PropertyBag& parentProps, MouseEventReason reason, const MouseEvt &evt)
 {
     const int dragThreshold = 10;
-    
+    bool wasHovering = hovering;
+
     switch (evt.action) {
     case MouseEvt::Action::exitOverlayParent:
         break;
@@ -37,7 +38,7 @@ LayoutBase::EvtRes LayoutSlider::onMouse(const PropertyBag& parentProps, MouseEv
             int dragDistPixels = isHorizontal ? evt.dragDelta.x : evt.dragDelta.y;
             auto origPos = posFromValue(dragStartValue);
             auto newPos = origPos + dragDistPixels;
-            value = valueFromPos(newPos);
+            setValue(valueFromPos(newPos));
         }
         break;
     case MouseEvt::Action::press:
@@ -59,7 +60,10 @@ LayoutBase::EvtRes LayoutSlider::onMouse(const PropertyBag& parentProps, MouseEv
         }
         break;
     }
-    
+
+    if (hovering != wasHovering) {
+        setNeedsRedraw();
+    }
     return EvtRes::propagate;
 }
 
@@ -79,12 +83,12 @@ void LayoutSlider::draw(const PropertyBag& parentProps, mssm::Canvas2d& g)
     drawRect(g, handleRect, TRANS, hovering ? ltGrey : medGrey);
 }
 
-SizeBound2d LayoutSlider::getBound(const PropertyBag& parentProps)
+SizeBound2d LayoutSlider::getBoundImpl(const PropertyBag& parentProps)
 {
     return SizeBound2d{SizeBound{50}, SizeBound{30}};
 }
 
-void LayoutSlider::resize(const PropertyBag& parentProps, const RectI& rect)
+void LayoutSlider::resizeImpl(const PropertyBag& parentProps, const RectI& rect)
 {
     setRect(rect);
 }
@@ -93,12 +97,21 @@ void LayoutSlider::foreachChildImpl(std::function<void(LayoutBase *)> f, Foreach
 {
 }
 
+void LayoutSlider::setValue(double newValue)
+{
+    if (value == newValue) {
+        return;
+    }
+    value = newValue;
+    setNeedsRedraw();
+}
+
 void LayoutSlider::stepValue(int count)
 {
     double t = tFromValue(value);
     t += count * clickStep;
     t = std::clamp(t, 0., 1.);
-    value = valueFromT(t);
+    setValue(valueFromT(t));
 }
 
 void LayoutSlider::applyWheel(int count)
@@ -106,5 +119,5 @@ void LayoutSlider::applyWheel(int count)
     double t = tFromValue(value);
     t -= count * wheelStep;
     t = std::clamp(t, 0., 1.);
-    value = valueFromT(t);
+    setValue(valueFromT(t));
 }
@@ -14,6 +14,7 @@ public:
     // int sliderLength{}   // width of control for now
     
     // next three values describe the current and range of possible values
+    // (change value with setValue, so cached drawing of the slider is updated)
     double value{0};
     double minValue{0};
     double maxValue{100};
@@ -29,9 +30,10 @@ public:
     std::string getTypeStr() const override { return "Slider"; }
     EvtRes onMouse(const PropertyBag& parentProps, MouseEventReason reason, const MouseEvt &evt) override;
     void draw(const PropertyBag& parentProps, mssm::Canvas2d& g) override;
-    SizeBound2d getBound(const PropertyBag& parentProps) override;
-    void resize(const PropertyBag& parentProps, const RectI& rect) override;
+    SizeBound2d getBoundImpl(const PropertyBag& parentProps) override;
+    void resizeImpl(const PropertyBag& parentProps, const RectI& rect) override;
     void foreachChildImpl(std::function<void(LayoutBase*)> f, ForeachContext context, bool includeOverlay, bool includeCollapsed) override;
+    void setValue(double newValue);
     void stepValue(int count);
     void applyWheel(int count);
     constexpr double posMax() const { return isHorizontal ? (thisRect().width-handleSize) : (thisRect().height-handleSize); }
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include "layoutspatialindex.h"
+#include "layoutcore.h"
+
+bool LayoutSpatialIndex::build(std::vector<std::shared_ptr<LayoutBase>> kids)
+{
+    children = std::move(kids);
+    ordinals.clear();
+    cellStart.clear();
+    cellItems.clear();
+    cols = 0;
+    rows = 0;
+
+    int count = static_cast<int>(children.size());
+    if (count < minChildren) {
+        children.clear();
+        return false;
+    }
+
+    int minX = INT_MAX;
+    int minY = INT_MAX;
+    int maxX = INT_MIN;
+    int maxY = INT_MIN;
+    double totalWidth = 0;
+    double totalHeight = 0;
+    int nonEmpty = 0;
+
+    for (int i = 0; i < count; i++) {
+        const LayoutBase* c = children[i].get();
+        ordinals[c] = i;
+        if (c->width <= 0 || c->height <= 0) {
+            continue; // can never contain the pointer
+        }
+        minX = std::min(minX, c->pos.x);
+        minY = std::min(minY, c->pos.y);
+        maxX = std::max(maxX, c->pos.x + c->width);
+        maxY = std::max(maxY, c->pos.y + c->height);
+        totalWidth += c->width;
+        totalHeight += c->height;
+        nonEmpty++;
+    }
+
+    cols = 1;
+    rows = 1;
+
+    if (nonEmpty == 0) {
+        bounds = RectI{};
+        cellStart.assign(2, 0);
+        return true;
+    }
+
+    bounds = RectI{{minX, minY}, maxX - minX, maxY - minY};
+
+    // aim for cells about the size of an average child, with a cap on the total
+    // so a few large children can't blow up the grid
+    double avgWidth = std::max(1.0, totalWidth / nonEmpty);
+    double avgHeight = std::max(1.0, totalHeight / nonEmpty);
+    long maxCells = 4L * count;
+
+    cols = std::clamp(static_cast<int>(bounds.width / avgWidth), 1, static_cast<int>(maxCells));
+    rows = std::clamp(static_cast<int>(bounds.height / avgHeight), 1, static_cast<int>(maxCells));
+
+    while (static_cast<long>(cols) * rows > maxCells) {
+        cols = (cols + 1) / 2;
+        rows = (rows + 1) / 2;
+    }
+
+    cellWidth = static_cast<double>(bounds.width) / cols;
+    cellHeight = static_cast<double>(bounds.height) / rows;
+
+    // two passes (count, then fill) so the cells live in one flat array
+    auto foreachCell = [this](const LayoutBase* c, auto f) {
+        int c0 = colOf(c->left());
+        int c1 = colOf(c->right());
+        int r1 = rowOf(c->bottom());
+        for (int r = rowOf(c->top()); r <= r1; r++) {
+            for (int col = c0; col <= c1; col++) {
+                f(r * cols + col);
+            }
+        }
+    };
+
+    cellStart.assign(cols * rows + 1, 0);
+
+    for (auto& c : children) {
+        if (c->width > 0 && c->height > 0) {
+            foreachCell(c.get(), [this](int cell) { cellStart[cell + 1]++; });
+        }
+    }
+
+    for (size_t i = 1; i < cellStart.size(); i++) {
+        cellStart[i] += cellStart[i - 1];
+    }
+
+    cellItems.resize(cellStart.back());
+    std::vector<int> next(cellStart.begin(), cellStart.end() - 1);
+
+    for (int i = 0; i < count; i++) {
+        const LayoutBase* c = children[i].get();
+        if (c->width > 0 && c->height > 0) {
+            foreachCell(c, [this, &next, i](int cell) { cellItems[next[cell]++] = i; });
+        }
+    }
+
+    return true;
+}
+
+int LayoutSpatialIndex::ordinalOf(const LayoutBase *child) const
+{
+    auto it = ordinals.find(child);
+    return it == ordinals.end() ? -1 : it->second;
+}
+
+int LayoutSpatialIndex::colOf(double x) const
+{
+    return std::clamp(static_cast<int>(std::floor((x - bounds.pos.x) / cellWidth)), 0, cols - 1);
+}
+
+int LayoutSpatialIndex::rowOf(double y) const
+{
+    return std::clamp(static_cast<int>(std::floor((y - bounds.pos.y) / cellHeight)), 0, rows - 1);
+}
+
+void LayoutSpatialIndex::query(Vec2d pos, std::vector<int> &result) const
+{
+    if (!bounds.within(pos)) {
+        return;
+    }
+    int cell = rowOf(pos.y) * cols + colOf(pos.x);
+    result.insert(result.end(), cellItems.begin() + cellStart[cell], cellItems.begin() + cellStart[cell + 1]);
+}
@@ -0,0 +1,44 @@
+#ifndef LAYOUTSPATIALINDEX_H
+#define LAYOUTSPATIALINDEX_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "recti.h"
+
+class LayoutBase;
+
+// Uniform grid over the rects of one element's children.  Lets mouse dispatch
+// find the children under the pointer without visiting every child.
+// Cells are sized to roughly the average child, so a point query returns only
+// a handful of candidates whether the children form a long list or a grid.
+// An index describes one layout pass: LayoutBase drops it whenever it is laid
+// out again or calls setNeedsResize, and rebuilds it on the next mouse event.
+class LayoutSpatialIndex {
+    std::vector<std::shared_ptr<LayoutBase>> children; // in foreachChild order
+    std::unordered_map<const LayoutBase*, int> ordinals;
+    RectI bounds;               // union of the child rects
+    int cols{0};
+    int rows{0};
+    double cellWidth{1};
+    double cellHeight{1};
+    std::vector<int> cellStart; // cols*rows+1 offsets into cellItems
+    std::vector<int> cellItems; // child ordinals, ascending within each cell
+public:
+    static constexpr int minChildren = 16; // below this, visiting every child is as fast
+
+    // returns false (and indexes nothing) when there are too few children to bother
+    bool build(std::vector<std::shared_ptr<LayoutBase>> kids);
+
+    bool isIndexed() const { return cols > 0; }
+    const std::shared_ptr<LayoutBase>& child(int ordinal) const { return children[ordinal]; }
+    int ordinalOf(const LayoutBase* child) const; // -1 if not a child
+
+    // append the ordinals of children whose rect may contain pos (ascending, no duplicates)
+    void query(Vec2d pos, std::vector<int>& result) const;
+private:
+    int colOf(double x) const;
+    int rowOf(double y) const;
+};
+
+#endif // LAYOUTSPATIALINDEX_H
@@ -61,7 +61,7 @@ void LayoutTabs::draw(const PropertyBag& parentProps, mssm::Canvas2d& g)
     tabs[activeTab]->draw(parentProps, g);
 }
 
-void LayoutTabs::resize(const PropertyBag& parentProps, const RectI& rect)
+void LayoutTabs::resizeImpl(const PropertyBag& parentProps, const RectI& rect)
 {
     headerSize = isHorizontal ? tabBar->getBound(parentProps).yBound.minSize
                               : tabBar->getBound(parentProps).xBound.minSize;
@@ -72,7 +72,7 @@ void LayoutTabs::resize(const PropertyBag& parentProps, const RectI& rect)
     setRect(rect);
 }
 
-SizeBound2d LayoutTabs::getBound(const PropertyBag& parentProps)
+SizeBound2d LayoutTabs::getBoundImpl(const PropertyBag& parentProps)
 {
     headerSize = isHorizontal ? tabBar->getBound(parentProps).yBound.minSize
                               : tabBar->getBound(parentProps).xBound.minSize;
@@ -121,7 +121,7 @@ void LayoutTabs::selectTab(int tabIndex)
     tabs[activeTab]->setCollapsed(true);
     activeTab = tabIndex;
     tabs[activeTab]->setCollapsed(false);
-    context->setNeedsResize();
+    setNeedsResize();
 }
 
 
@@ -140,14 +140,14 @@ void LayoutTabFrame::draw(const PropertyBag& parentProps, mssm::Canvas2d &g)
     popClip(g);
 }
 
-SizeBound2d LayoutTabFrame::getBound(const PropertyBag& parentProps)
+SizeBound2d LayoutTabFrame::getBoundImpl(const PropertyBag& parentProps)
 {
     auto bound = child->getBound(parentProps);
     bound.grow(frameInset,frameInset);
     return bound;
 }
 
-void LayoutTabFrame::resize(const PropertyBag& parentProps, const RectI& rect)
+void LayoutTabFrame::resizeImpl(const PropertyBag& parentProps, const RectI& rect)
 {
     setRect(rect);
     contentRect = rect.makeInset(frameInset);
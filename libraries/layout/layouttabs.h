@@ -13,8 +13,8 @@ public:
     static std::shared_ptr<LayoutTabFrame> make(LayoutContext* context, LayoutPtr child) { return std::make_shared<LayoutTabFrame>(Private{}, context, child); }
     std::string getTypeStr() const override { return "TabFrame"; }
     void draw(const PropertyBag& parentProps, mssm::Canvas2d& g) override;
-    SizeBound2d getBound(const PropertyBag& parentProps) override;
-    void resize(const PropertyBag& parentProps, const RectI& rect) override;
+    SizeBound2d getBoundImpl(const PropertyBag& parentProps) override;
+    void resizeImpl(const PropertyBag& parentProps, const RectI& rect) override;
     void foreachChildImpl(std::function<void (LayoutBase *)> f, ForeachContext context, bool includeOverlay, bool includeCollapsed) override;
 };
 
@@ -39,8 +39,8 @@ public:
     static std::shared_ptr<LayoutTabs> make(LayoutContext* context, bool isHorizontal, std::vector<Tab> children) { return std::make_shared<LayoutTabs>(Private{}, context, isHorizontal, children); }
     std::string getTypeStr() const override { return "Tabs"; }
     void draw(const PropertyBag& parentProps, mssm::Canvas2d& g) override;
-    void resize(const PropertyBag& parentProps, const RectI& rect) override;
-    SizeBound2d getBound(const PropertyBag& parentProps) override;
+    void resizeImpl(const PropertyBag& parentProps, const RectI& rect) override;
+    SizeBound2d getBoundImpl(const PropertyBag& parentProps) override;
     void setOuterMargins(int left, int right, int top, int bottom) override;
     void foreachChildImpl(std::function<void (LayoutBase *)> f, ForeachContext context, bool includeOverlay, bool includeCollapsed) override;
     void selectTab(int tabIndex);
@@ -24,12 +24,14 @@ LayoutBase::EvtRes LayoutText::onMouse(const PropertyBag& parentProps, MouseEven
     case MouseEvt::Action::drag:
         if (hasDragFocus()) {
             editBox.onDrag(evt.pos);
+            setNeedsRedraw();
         }
         break;
     case MouseEvt::Action::press:
         if (editBox.onClick(evt.pos)) {
             grabKeyboard();
             grabMouse();
+            setNeedsRedraw();
         }
         break;
     case MouseEvt::Action::release:
@@ -52,6 +54,7 @@ LayoutBase::EvtRes LayoutText::onKey(const PropertyBag &parentProps, const KeyEv
         if (hasKeyFocus()) {
             if (std::isprint(key.key)) {
                 editBox.addChar(key.key, key.hasShift());
+                setNeedsRedraw();
                 return EvtRes::consumed;
             }
             else {
@@ -69,6 +72,7 @@ LayoutBase::EvtRes LayoutText::onKey(const PropertyBag &parentProps, const KeyEv
                     editBox.onBackspace();
                     break;
                 }
+                setNeedsRedraw();
             }
         }
         break;
@@ -80,15 +84,18 @@ LayoutBase::EvtRes LayoutText::onKey(const PropertyBag &parentProps, const KeyEv
 
 void LayoutText::draw(const PropertyBag& parentProps, mssm::Canvas2d& g)
 {
+    // through LayoutBase so the context's draw clip matches the canvas
+    pushClip(g, editBox.getRect(), false);
     editBox.draw(g, hasKeyFocus());
+    popClip(g);
 }
 
-SizeBound2d LayoutText::getBound(const PropertyBag& parentProps)
+SizeBound2d LayoutText::getBoundImpl(const PropertyBag& parentProps)
 {
     return {SizeBound(editBox.boxHeight()*2), SizeBound(editBox.boxHeight(), editBox.boxHeight())};
 }
 
-void LayoutText::resize(const PropertyBag& parentProps, const RectI& rect)
+void LayoutText::resizeImpl(const PropertyBag& parentProps, const RectI& rect)
 {
     setRect(rect);
     auto bound = getBound(parentProps);
@@ -12,7 +12,7 @@ LayoutToggle::LayoutToggle(Private privateTag, LayoutContext *context, ToggleSty
 
 void LayoutToggle::draw(const PropertyBag &parentProps, mssm::Canvas2d &g)
 {
-    bool checked = parentProps.getProperty<bool>("Checked");
+    bool checked = parentProps.getProperty<bool>(PropertyKeys::checked);
     switch (style) {
     case ToggleStyle::expander:
         if (checked) {
@@ -37,12 +37,12 @@ void LayoutToggle::draw(const PropertyBag &parentProps, mssm::Canvas2d &g)
     }
 }
 
-SizeBound2d LayoutToggle::getBound(const PropertyBag &parentProps)
+SizeBound2d LayoutToggle::getBoundImpl(const PropertyBag &parentProps)
 {
     return {SizeBound{20}, SizeBound{20}};
 }
 
-void LayoutToggle::resize(const PropertyBag &parentProps, const RectI &rect)
+void LayoutToggle::resizeImpl(const PropertyBag &parentProps, const RectI &rect)
 {
     setRect(rect);
 }
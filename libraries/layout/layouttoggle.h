@@ -17,8 +17,8 @@ public:
     static std::shared_ptr<LayoutToggle> make(LayoutContext* context, ToggleStyle style) { return std::make_shared<LayoutToggle>(Private{}, context, style); }
     std::string getTypeStr() const override { return "Toggle"; }
     void draw(const PropertyBag& parentProps, mssm::Canvas2d& g) override;
-    SizeBound2d getBound(const PropertyBag& parentProps) override;
-    void resize(const PropertyBag &parentProps, const RectI &rect) override;
+    SizeBound2d getBoundImpl(const PropertyBag& parentProps) override;
+    void resizeImpl(const PropertyBag &parentProps, const RectI &rect) override;
     void foreachChildImpl(std::function<void(LayoutBase *)> f,
                                         ForeachContext context,
                                         bool includeOverlay,
@@ -8,14 +8,14 @@ LayoutTooltipAnchor::LayoutTooltipAnchor(Private privateTag, LayoutContext *cont
     
 }
 
-SizeBound2d LayoutTooltipAnchor::getBound(const PropertyBag &parentProps)
+SizeBound2d LayoutTooltipAnchor::getBoundImpl(const PropertyBag &parentProps)
 {
     auto bound = child->getBound(parentProps);
     
     return bound;
 }
 
-void LayoutTooltipAnchor::resize(const PropertyBag &parentProps, const RectI &rect)
+void LayoutTooltipAnchor::resizeImpl(const PropertyBag &parentProps, const RectI &rect)
 {
     auto bound = getBound(parentProps);
     int tipWidth = std::max(bound.xBound.minSize, 20);
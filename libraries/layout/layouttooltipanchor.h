@@ -11,8 +11,8 @@ public:
     static std::shared_ptr<LayoutTooltipAnchor> make(LayoutContext* context, LayoutPtr child, Vec2d offset) { return std::make_shared<LayoutTooltipAnchor>(Private{}, context, child, offset); }
     std::string getTypeStr() const override { return "LayoutTooltipAnchor"; }
     
-    SizeBound2d getBound(const PropertyBag &parentProps) override;
-    void resize(const PropertyBag &parentProps, const RectI &rect) override;
+    SizeBound2d getBoundImpl(const PropertyBag &parentProps) override;
+    void resizeImpl(const PropertyBag &parentProps, const RectI &rect) override;
 };
 
 #endif // LAYOUTTOOLTIPANCHOR_H
@@ -0,0 +1,213 @@
+#include "layoutvirtuallist.h"
+
+LayoutVirtualList::LayoutVirtualList(Private privateTag,
+                                     LayoutContext *context,
+                                     int rowCount,
+                                     int rowHeight,
+                                     RowFactory rowFactory,
+                                     RowBinder rowBinder)
+    : LayoutBase{context}
+    , rowFactory{rowFactory}
+    , rowBinder{rowBinder}
+    , rowCount{std::max(0, rowCount)}
+    , rowHeight{std::max(1, rowHeight)}
+{
+    vScroll = LayoutSlider::make(context, false, 0, 0, 0);
+    setParentsOfChildren();
+}
+
+LayoutBase::EvtRes LayoutVirtualList::onMouseDeferred(const PropertyBag &parentProps, MouseEventReason reason, const MouseEvt &evt)
+{
+    switch (evt.action) {
+    case MouseEvt::Action::exitOverlayParent:
+    case MouseEvt::Action::none:
+    case MouseEvt::Action::move:
+    case MouseEvt::Action::exit:
+    case MouseEvt::Action::enter:
+        break;
+    case MouseEvt::Action::drag:
+    case MouseEvt::Action::press:
+    case MouseEvt::Action::release:
+        // scrollbar was dragged or clicked, bring in the newly visible rows
+        if (vScroll->value != yScroll) {
+            setNeedsResize();
+        }
+        break;
+    case MouseEvt::Action::scroll:
+        if (!vScroll->within(evt.pos)) {
+            vScroll->applyWheel(evt.dragDelta.y);
+            setNeedsResize();
+            return EvtRes::consumed;
+        }
+        if (vScroll->value != yScroll) {
+            setNeedsResize();
+        }
+        break;
+    }
+
+    return EvtRes::propagate;
+}
+
+void LayoutVirtualList::draw(const PropertyBag &parentProps, mssm::Canvas2d &g)
+{
+    pushClip(g, thisRect(), false);
+
+    if (extraY) {
+        vScroll->draw(parentProps, g);
+    }
+
+    pushClip(g, rowsRect, false);
+    for (auto& row : activeRows) {
+        // overscan rows are laid out but not drawn
+        if (context->isDrawClipped(row.widget->thisRect())) {
+            context->countCulled();
+            continue;
+        }
+        row.widget->draw(parentProps, g);
+    }
+    popClip(g);
+
+    popClip(g);
+}
+
+SizeBound2d LayoutVirtualList::getBoundImpl(const PropertyBag &parentProps)
+{
+    return {SizeBound(0), SizeBound(0)};
+}
+
+void LayoutVirtualList::resizeImpl(const PropertyBag &parentProps, const RectI &rect)
+{
+    constexpr const int scrollGutter = 2;
+
+    setRect(rect);
+
+    int contentHeight = rowCount * rowHeight;
+
+    extraY = std::max(0, contentHeight - rect.height);
+    yScroll = std::clamp(static_cast<int>(vScroll->value), 0, extraY);
+
+    rowsRect = rect;
+
+    if (extraY) {
+        auto bar = rightSubrect(barSize, 2);
+        vScroll->resize(parentProps, bar);
+        rowsRect.width = std::max(0, rect.width - vScroll->width - scrollGutter);
+    }
+    else {
+        vScroll->width = 0;
+    }
+
+    vScroll->proportion = double(rect.height) / std::max(1, contentHeight);
+    vScroll->minValue = 0;
+    vScroll->maxValue = extraY;
+    vScroll->value = yScroll;
+    if (extraY) {
+        // step by a few rows per wheel notch and by a page per click, regardless of list length
+        vScroll->wheelStep = std::min(1.0, 3.0 * rowHeight / extraY);
+        vScroll->clickStep = std::min(1.0, double(rect.height) / extraY);
+    }
+
+    int first = std::max(0, yScroll / rowHeight - overscan);
+    int last = std::min(rowCount, (yScroll + rect.height + rowHeight - 1) / rowHeight + overscan);
+
+    updateActiveRows(first, std::max(first, last));
+
+    for (auto& row : activeRows) {
+        RectI rowRect{{rowsRect.pos.x, rowsRect.pos.y + row.index * rowHeight - yScroll}, rowsRect.width, rowHeight};
+        row.widget->resize(parentProps, rowRect);
+    }
+}
+
+void LayoutVirtualList::foreachChildImpl(std::function<void (LayoutBase *)> f, ForeachContext context, bool includeOverlay, bool includeCollapsed)
+{
+    if (vScroll) {
+        f(vScroll.get());
+    }
+    for (auto& row : activeRows) {
+        f(row.widget.get());
+    }
+}
+
+void LayoutVirtualList::setRowCount(int count)
+{
+    rowCount = std::max(0, count);
+    for (int i = activeRows.size() - 1; i >= 0 && activeRows[i].index >= rowCount; i--) {
+        recycleRow(activeRows[i].widget);
+        activeRows.pop_back();
+    }
+    refresh();
+}
+
+void LayoutVirtualList::refresh()
+{
+    for (auto& row : activeRows) {
+        rowBinder(row.widget, row.index);
+        row.widget->setNeedsResizeRecursive();
+    }
+    setNeedsResize();
+}
+
+void LayoutVirtualList::scrollToRow(int index)
+{
+    vScroll->value = std::clamp(index, 0, std::max(0, rowCount - 1)) * rowHeight;
+    setNeedsResize();
+}
+
+LayoutPtr LayoutVirtualList::acquireRow()
+{
+    LayoutPtr row;
+    if (recycled.empty()) {
+        row = rowFactory(context);
+    }
+    else {
+        row = recycled.back();
+        recycled.pop_back();
+    }
+    row->setParent(this);
+    row->updateLayer(getLayer(), getDepth() + 1);
+    return row;
+}
+
+void LayoutVirtualList::recycleRow(LayoutPtr row)
+{
+    row->closeOverlayRecursive();
+    row->localReleaseMouseAndKeyboard();
+    context->dropFromHoverChain(row.get()); // the pooled row is no longer under the pointer
+    recycled.push_back(row);
+}
+
+void LayoutVirtualList::updateActiveRows(int first, int last)
+{
+    // rows that stay in the window keep their widget (no rebind), the rest are recycled
+    std::vector<ActiveRow> next;
+    next.reserve(last - first);
+
+    auto it = activeRows.begin();
+    for (int index = first; index < last; index++) {
+        while (it != activeRows.end() && it->index < index) {
+            recycleRow(it->widget);
+            ++it;
+        }
+        if (it != activeRows.end() && it->index == index) {
+            next.push_back(*it);
+            ++it;
+        }
+        else {
+            next.push_back({index, {}});
+        }
+    }
+    for (; it != activeRows.end(); ++it) {
+        recycleRow(it->widget);
+    }
+
+    // bind after recycling so widgets leaving the window can be reused immediately
+    for (auto& row : next) {
+        if (!row.widget) {
+            row.widget = acquireRow();
+            rowBinder(row.widget, row.index);
+            row.widget->setNeedsResizeRecursive();
+        }
+    }
+
+    activeRows = std::move(next);
+}
@@ -0,0 +1,58 @@
+#ifndef LAYOUTVIRTUALLIST_H
+#define LAYOUTVIRTUALLIST_H
+
+#include "layoutslider.h"
+
+// Vertically scrolling list of fixed height rows that only instantiates
+// and lays out the rows in (or near) the visible window.
+// Row widgets are created by rowFactory and recycled as they scroll out of view;
+// rowBinder is called whenever a row widget is (re)assigned to a data index.
+// The cost of layout, draw and event dispatch is proportional to the number of
+// visible rows, not to rowCount.
+class LayoutVirtualList : public LayoutBase {
+public:
+    using RowFactory = std::function<LayoutPtr(LayoutContext* context)>;
+    using RowBinder = std::function<void(LayoutPtr row, int index)>;
+private:
+    class ActiveRow {
+    public:
+        int index;
+        LayoutPtr widget;
+    };
+
+    RowFactory rowFactory;
+    RowBinder rowBinder;
+    int rowCount{0};
+    int rowHeight{24};
+    int overscan{2};   // rows laid out beyond each edge of the visible window
+    int barSize{10};
+    int yScroll{0};
+    int extraY{0};
+    RectI rowsRect;    // viewport for the rows (excludes the scrollbar)
+    std::shared_ptr<LayoutSlider> vScroll;
+    std::vector<ActiveRow> activeRows; // sorted by index
+    std::vector<LayoutPtr> recycled;
+public:
+    LayoutVirtualList(Private privateTag, LayoutContext* context, int rowCount, int rowHeight, RowFactory rowFactory, RowBinder rowBinder);
+    static std::shared_ptr<LayoutVirtualList> make(LayoutContext* context, int rowCount, int rowHeight, RowFactory rowFactory, RowBinder rowBinder)
+    { return std::make_shared<LayoutVirtualList>(Private{}, context, rowCount, rowHeight, rowFactory, rowBinder); }
+    std::string getTypeStr() const override { return "VirtualList"; }
+    EvtRes onMouseDeferred(const PropertyBag& parentProps, MouseEventReason reason, const MouseEvt &evt) override;
+    void draw(const PropertyBag& parentProps, mssm::Canvas2d& g) override;
+    SizeBound2d getBoundImpl(const PropertyBag& parentProps) override;
+    void resizeImpl(const PropertyBag& parentProps, const RectI& rect) override;
+    void foreachChildImpl(std::function<void (LayoutBase *)> f, ForeachContext context, bool includeOverlay, bool includeCollapsed) override;
+
+    int getRowCount() const { return rowCount; }
+    void setRowCount(int count);  // rebinds all visible rows
+    void refresh();               // data changed: rebind all visible rows
+    void scrollToRow(int index);
+    void setOverscan(int rows) { overscan = std::max(0, rows); setNeedsResize(); }
+    int firstVisibleRow() const { return rowHeight > 0 ? yScroll / rowHeight : 0; }
+private:
+    LayoutPtr acquireRow();
+    void recycleRow(LayoutPtr row);
+    void updateActiveRows(int first, int last);
+};
+
+#endif // LAYOUTVIRTUALLIST_H
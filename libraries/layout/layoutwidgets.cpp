@@ -31,12 +31,12 @@ void LayoutColor::draw(const PropertyBag& parentProps, mssm::Canvas2d& g)
     drawRoundedRect(g, *this, 0, 10, light(color), color);
 }
 
-SizeBound2d LayoutColor::getBound(const PropertyBag& parentProps)
+SizeBound2d LayoutColor::getBoundImpl(const PropertyBag& parentProps)
 {
     return bound;
 }
 
-void LayoutColor::resize(const PropertyBag& parentProps, const RectI& rect)
+void LayoutColor::resizeImpl(const PropertyBag& parentProps, const RectI& rect)
 {
     setRect(rect);
 }
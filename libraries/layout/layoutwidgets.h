@@ -5,6 +5,7 @@
 #include "texteditbox.h"
 #include "layoutadapter.h"
 #include "layoutscroll.h"
+#include "layoutvirtuallist.h"
 #include "layoutslider.h"
 #include "layoutdraghandle.h"
 #include "layoutbutton.h"
@@ -27,8 +28,8 @@ public:
     static std::shared_ptr<LayoutColor> make(LayoutContext* context, mssm::Color color) { return std::make_shared<LayoutColor>(Private{}, context, color); }
     std::string getTypeStr() const override { return "Color"; }
     void draw(const PropertyBag& parentProps, mssm::Canvas2d& g) override;
-    SizeBound2d getBound(const PropertyBag& parentProps) override;
-    void resize(const PropertyBag& parentProps, const RectI& rect) override;
+    SizeBound2d getBoundImpl(const PropertyBag& parentProps) override;
+    void resizeImpl(const PropertyBag& parentProps, const RectI& rect) override;
     void foreachChildImpl(std::function<void(LayoutBase*)> f, ForeachContext context, bool includeOverlay, bool includeCollapsed) override;
     EvtRes onMouse(const PropertyBag& parentProps, MouseEventReason reason, const MouseEvt &evt) override;
 };
@@ -1,9 +1,57 @@
+#include <algorithm>
+#include <deque>
 #include <iostream>
+#include <mutex>
+#include <functional>
 #include <string>
 #include <optional>
+#include <unordered_map>
 
 #include "propertybag.h"
 
+namespace {
+
+// lets ids be searched by string_view without making a string
+struct NameHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+};
+
+class PropertyKeyRegistry {
+public:
+    std::mutex mutex;
+    std::unordered_map<std::string, uint32_t, NameHash, std::equal_to<>> ids;
+    std::deque<std::string> names; // deque so references returned by name() stay valid
+};
+
+PropertyKeyRegistry& keyRegistry()
+{
+    static PropertyKeyRegistry registry;
+    return registry;
+}
+
+}
+
+PropertyKey::PropertyKey(std::string_view name)
+{
+    auto& registry = keyRegistry();
+    std::lock_guard lock(registry.mutex);
+    if (auto it = registry.ids.find(name); it != registry.ids.end()) {
+        id = it->second;
+        return;
+    }
+    id = registry.names.size();
+    registry.ids.emplace(std::string{name}, id);
+    registry.names.emplace_back(name);
+}
+
+const std::string &PropertyKey::name() const
+{
+    auto& registry = keyRegistry();
+    std::lock_guard lock(registry.mutex);
+    return registry.names[id];
+}
+
 // Static member initialization
 bool PropertyBag::loggingEnabled = false;
 
@@ -12,52 +60,275 @@ void PropertyBag::enableLogging(bool enable)
     loggingEnabled = enable;
 }
 
-void PropertyBag::setProperty(const std::string &key, const VariantProperty &value)
+static auto findEntry(auto& entries, PropertyKey key)
+{
+    return std::lower_bound(entries.begin(), entries.end(), key, [](const auto& entry, PropertyKey k) {
+        return entry.key < k;
+    });
+}
+
+namespace {
+
+uint64_t mixHash(uint64_t h, uint64_t v)
+{
+    // splitmix64 finaliser over the running hash and the new value
+    h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    return h ^ (h >> 31);
+}
+
+uint64_t entryHash(PropertyKey key, const std::optional<VariantProperty>& value)
+{
+    uint64_t h = mixHash(key.index(), value ? value->index() + 1 : 0);
+    if (value) {
+        h = mixHash(h, std::visit([](const auto& v) -> uint64_t {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, LazyVariant>) {
+                return 0; // never compared (see sameAs)
+            }
+            else if constexpr (std::is_same_v<T, mssm::Color>) {
+                return (uint32_t(v.r) << 24) | (uint32_t(v.g) << 16) | (uint32_t(v.b) << 8) | v.a;
+            }
+            else {
+                return std::hash<T>{}(v);
+            }
+        }, *value));
+    }
+    return h;
+}
+
+bool isLazy(const std::optional<VariantProperty>& value)
+{
+    return value && std::holds_alternative<LazyVariant>(*value);
+}
+
+}
+
+// called whenever a layer's entries change; layers are only changed while no
+// other bag or layer shares them, so the hashes above never go stale
+void PropertyBag::rehash(Layer& layer)
+{
+    uint64_t h = layer.parent ? layer.parent->hash : 0;
+    bool lazy = layer.parent && layer.parent->lazy;
+    for (const auto& entry : layer.entries) {
+        h = mixHash(h, entryHash(entry.key, entry.value));
+        lazy = lazy || isLazy(entry.value);
+    }
+    layer.hash = h;
+    layer.lazy = lazy;
+}
+
+uint64_t PropertyBag::contentHash() const
+{
+    uint64_t h = top ? top->hash : 0;
+    if (single) {
+        h = mixHash(h ^ 1, entryHash(single->key, single->value));
+    }
+    return h;
+}
+
+bool PropertyBag::hasLazy() const
+{
+    return (top && top->lazy) || (single && isLazy(single->value));
+}
+
+const VariantProperty *PropertyBag::find(PropertyKey key) const
+{
+    if (single && single->key == key) {
+        return single->value ? &*single->value : nullptr;
+    }
+    for (const Layer* layer = top.get(); layer; layer = layer->parent.get()) {
+        auto it = findEntry(layer->entries, key);
+        if (it != layer->entries.end() && it->key == key) {
+            return it->value ? &*it->value : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+PropertyBag::Layer &PropertyBag::writableLayer()
+{
+    if (!top) {
+        top = std::make_shared<Layer>();
+    }
+    else if (top.use_count() > 1) {
+        // shared with another bag (or a layer above us): add a layer rather than copying
+        auto layer = std::make_shared<Layer>();
+        layer->depth = top->depth + 1;
+        layer->parent = std::move(top);
+        top = std::move(layer);
+        if (top->depth > maxLayerDepth) {
+            auto flat = std::make_shared<Layer>();
+            flat->entries = flattened();
+            top = std::move(flat);
+        }
+        rehash(*top);
+    }
+    return *top;
+}
+
+// move the inline override into a layer of its own, before the layers change
+void PropertyBag::spillSingle()
+{
+    if (!single) {
+        return;
+    }
+    Entry entry = std::move(*single);
+    single.reset();
+
+    auto& layer = writableLayer();
+    auto it = findEntry(layer.entries, entry.key);
+    bool found = it != layer.entries.end() && it->key == entry.key;
+    if (!entry.value && !layer.parent) {
+        if (found) {
+            layer.entries.erase(it);
+        }
+    }
+    else if (found) {
+        it->value = std::move(entry.value);
+    }
+    else {
+        layer.entries.insert(it, std::move(entry));
+    }
+    rehash(layer);
+}
+
+std::vector<PropertyBag::Entry> PropertyBag::flattened() const
+{
+    std::vector<const Layer*> layers;
+    for (const Layer* layer = top.get(); layer; layer = layer->parent.get()) {
+        layers.push_back(layer);
+    }
+
+    // apply from the bottom layer up so higher layers win
+    std::vector<Entry> flat;
+    auto apply = [&flat](const Entry& entry) {
+        auto it = findEntry(flat, entry.key);
+        bool found = it != flat.end() && it->key == entry.key;
+        if (!entry.value) {
+            if (found) {
+                flat.erase(it);
+            }
+        }
+        else if (found) {
+            it->value = entry.value;
+        }
+        else {
+            flat.insert(it, entry);
+        }
+    };
+    for (auto layer = layers.rbegin(); layer != layers.rend(); ++layer) {
+        for (const auto& entry : (*layer)->entries) {
+            apply(entry);
+        }
+    }
+    if (single) {
+        apply(*single);
+    }
+    return flat;
+}
+
+void PropertyBag::setProperty(PropertyKey key, const VariantProperty &value)
 {
     if (loggingEnabled) {
-        std::cout << "Setting property: " << key << "\n";
+        std::cout << "Setting property: " << key.name() << "\n";
+    }
+    if (single && single->key == key) {
+        single->value = value;
+        return;
+    }
+    if (!single && (!top || top.use_count() > 1)) {
+        single = Entry{key, value}; // no layer needed yet
+        return;
     }
-    properties[key] = value;
+    spillSingle();
+    auto& layer = writableLayer();
+    auto& entries = layer.entries;
+    auto it = findEntry(entries, key);
+    if (it != entries.end() && it->key == key) {
+        it->value = value;
+    }
+    else {
+        entries.insert(it, {key, value});
+    }
+    rehash(layer);
 }
 
-bool PropertyBag::hasProperty(const std::string &key) const
+bool PropertyBag::hasProperty(PropertyKey key) const
 {
-    return properties.find(key) != properties.end();
+    return find(key) != nullptr;
 }
 
-void PropertyBag::removeProperty(const std::string &key)
+void PropertyBag::removeProperty(PropertyKey key)
 {
     if (loggingEnabled) {
-        std::cout << "Removing property: " << key << "\n";
+        std::cout << "Removing property: " << key.name() << "\n";
+    }
+    if (!hasProperty(key)) {
+        return;
+    }
+    if (single && single->key == key) {
+        single.reset();
+        if (hasProperty(key)) {
+            single = Entry{key, std::nullopt}; // mask the value in the layers
+        }
+        return;
+    }
+    if (!single && top.use_count() > 1) {
+        single = Entry{key, std::nullopt};
+        return;
     }
-    properties.erase(key);
+    spillSingle();
+    auto& layer = writableLayer();
+    auto it = findEntry(layer.entries, key);
+    bool found = it != layer.entries.end() && it->key == key;
+    if (!layer.parent) {
+        layer.entries.erase(it);
+    }
+    else if (found) {
+        it->value.reset(); // mask the value in lower layers
+    }
+    else {
+        layer.entries.insert(it, {key, std::nullopt});
+    }
+    rehash(layer);
 }
 
 void PropertyBag::merge(const PropertyBag &other, bool overrideExisting)
 {
-    for (const auto &[key, value] : other.properties) {
+    for (const auto &[key, value] : other.flattened()) {
         if (overrideExisting || !hasProperty(key)) {
             if (loggingEnabled) {
-                std::cout << "Merging property: " << key << "\n";
+                std::cout << "Merging property: " << key.name() << "\n";
             }
-            properties[key] = value;
+            setProperty(key, *value);
         }
     }
 }
 
-void PropertyBag::validate(const std::vector<std::string> &requiredKeys) const
+void PropertyBag::validate(const std::vector<PropertyKey> &requiredKeys) const
 {
     for (const auto &key : requiredKeys) {
         if (!hasProperty(key)) {
-            throw std::runtime_error("Missing required property: " + key);
+            throw std::runtime_error("Missing required property: " + key.name());
         }
     }
 }
 
+void PropertyBag::foreachProperty(std::function<void (PropertyKey, const VariantProperty &)> f) const
+{
+    for (const auto &[key, value] : flattened()) {
+        f(key, *value);
+    }
+}
+
 void PropertyBag::debugPrint() const
 {
-    for (const auto &[key, value] : properties) {
-        std::cout << "Property: " << key << " = ";
+    foreachProperty([](PropertyKey key, const VariantProperty& value) {
+        std::cout << "Property: " << key.name() << " = ";
         if (std::holds_alternative<int>(value)) {
             std::cout << std::get<int>(value);
         } else if (std::holds_alternative<float>(value)) {
@@ -70,24 +341,35 @@ void PropertyBag::debugPrint() const
             std::cout << "[Lazy property]";
         }
         std::cout << "\n";
+    });
+}
+
+bool PropertyBag::sameAs(const PropertyBag &other) const
+{
+    if (top == other.top && !single && !other.single) {
+        return true;
+    }
+    if (hasLazy() || other.hasLazy()) {
+        return false; // may evaluate differently each time
     }
+    // a 64 bit hash of the layers' contents: equal hashes are taken as equal bags
+    return contentHash() == other.contentHash();
 }
 
-// Create a modified copy of the PropertyBag
+// Create a modified PropertyBag: shares this bag's layers, with one change held
+// inline and more in a layer on top
 PropertyBag PropertyBag::withModifications(
-    const std::unordered_map<std::string, std::optional<VariantProperty>> &modifications) const
+    const std::vector<std::pair<PropertyKey, std::optional<VariantProperty>>> &modifications) const
 {
-    PropertyBag copy;             // Create an empty copy
-    copy.properties = properties; // Copy existing properties in one operation
+    PropertyBag copy{*this};
 
     for (const auto &[key, value] : modifications) {
         if (value.has_value()) {
-            copy.properties[key] = value.value(); // Add or update property
+            copy.setProperty(key, value.value()); // Add or update property
         } else {
-            copy.properties.erase(key); // Remove property
+            copy.removeProperty(key); // Remove property
         }
     }
 
     return copy;
 }
-
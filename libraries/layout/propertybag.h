@@ -1,10 +1,11 @@
 #ifndef PROPERTYBAG_H
 #define PROPERTYBAG_H
 
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <variant>
 #include <vector>
 #include <memory>
@@ -17,111 +18,160 @@ using VariantPropertyBase = std::variant<int, float, std::string, bool, mssm::Co
 using LazyVariant = std::function<VariantPropertyBase()>;
 using VariantProperty = std::variant<int, float, std::string, bool, LazyVariant, mssm::Color>;
 
+// Interned property name.  Keys are small integers, so comparing them is an
+// integer compare.  Constructing a key from a string interns it (a locked hash
+// lookup), so the constructors are explicit: declare each key once in
+// PropertyKeys below and use that, rather than passing strings around
+class PropertyKey {
+    uint32_t id{0};
+public:
+    explicit PropertyKey(std::string_view name);
+    explicit PropertyKey(const char* name) : PropertyKey(std::string_view{name}) {}
+    explicit PropertyKey(const std::string& name) : PropertyKey(std::string_view{name}) {}
+    uint32_t index() const { return id; }
+    const std::string& name() const;
+    auto operator<=>(const PropertyKey& other) const = default;
+};
+
+// every key the library uses
+namespace PropertyKeys {
+inline const PropertyKey checked{"Checked"}; // bool: the enclosing expander or button is checked/open
+}
+
+// PropertyBag is a persistent stack of small sorted layers.  Copying a bag
+// shares its layers; modifying a shared bag (or calling withModifications)
+// pushes one new layer instead of copying every property.  The first property
+// set over shared layers is held in the bag itself, so the usual one key
+// withModification doesn't allocate a layer at all.
+//
+// Each layer keeps a hash of its entries and those below it, updated as it's
+// written, so sameAs is a comparison of two numbers rather than of every
+// property.
 class PropertyBag {
 public:
     // Enable or disable logging
     static void enableLogging(bool enable);
 
     // Set a property
-    void setProperty(const std::string& key, const VariantProperty& value);
+    void setProperty(PropertyKey key, const VariantProperty& value);
 
     // Get a property
     template<typename T>
-    T getProperty(const std::string& key) const;
+    T getProperty(PropertyKey key) const;
 
     // Check if a property exists
-    bool hasProperty(const std::string& key) const;
+    bool hasProperty(PropertyKey key) const;
 
     // Remove a property
-    void removeProperty(const std::string& key);
+    void removeProperty(PropertyKey key);
 
     // Merge properties with optional override behavior
     void merge(const PropertyBag& other, bool overrideExisting = true);
 
     // Validate required properties
-    void validate(const std::vector<std::string>& requiredKeys) const;
+    void validate(const std::vector<PropertyKey>& requiredKeys) const;
 
     // Debug print all properties
     void debugPrint() const;
 
-    PropertyBag withModifications(const std::unordered_map<std::string, std::optional<VariantProperty>>& modifications) const;
+    // Visit every visible property in key order
+    void foreachProperty(std::function<void(PropertyKey key, const VariantProperty& value)> f) const;
+
+    // true if both bags hold the same properties with equal values, built up in
+    // the same layers (lazy values never compare equal).  Compares hashes, so
+    // takes the same time however many properties there are
+    bool sameAs(const PropertyBag& other) const;
+
+    PropertyBag withModifications(const std::vector<std::pair<PropertyKey, std::optional<VariantProperty>>>& modifications) const;
 
-    PropertyBag withModification(const std::string& key, const std::optional<VariantProperty>& value) const {
+    PropertyBag withModification(PropertyKey key, const std::optional<VariantProperty>& value) const {
         return withModifications({{key, value}});
     }
 
 private:
-    std::unordered_map<std::string, VariantProperty> properties; // Map of properties
+    class Entry {
+    public:
+        PropertyKey key;
+        std::optional<VariantProperty> value; // empty: removed in this layer
+    };
+
+    class Layer {
+    public:
+        std::shared_ptr<const Layer> parent;
+        std::vector<Entry> entries; // sorted by key
+        int depth{0};
+        uint64_t hash{0};  // of entries and the parent's hash (see rehash)
+        bool lazy{false};  // a lazy value here or below
+    };
+
+    // beyond this many layers lookups get slow enough that flattening pays off
+    static constexpr int maxLayerDepth = 8;
+
+    std::shared_ptr<Layer> top;
+    std::optional<Entry> single; // above top: the one override made since top was shared
     static bool loggingEnabled; // Logging flag
+
+    const VariantProperty* find(PropertyKey key) const;
+    Layer& writableLayer();
+    void spillSingle();
+    static void rehash(Layer& layer);
+    uint64_t contentHash() const;
+    bool hasLazy() const;
+    std::vector<Entry> flattened() const;
 };
 
 // Get a property
 template<typename T>
-T PropertyBag::getProperty(const std::string& key) const {
-    auto it = properties.find(key);
-    if (it != properties.end()) {
-        if (std::holds_alternative<LazyVariant>(it->second)) {
+T PropertyBag::getProperty(PropertyKey key) const {
+    if (auto value = find(key)) {
+        if (std::holds_alternative<LazyVariant>(*value)) {
             // Resolve lazy evaluation
             if (loggingEnabled) {
-                std::cout << "Resolving lazy property: " << key << "\n";
+                std::cout << "Resolving lazy property: " << key.name() << "\n";
             }
-            return std::get<T>(std::get<LazyVariant>(it->second)());
+            return std::get<T>(std::get<LazyVariant>(*value)());
         }
-        return std::get<T>(it->second);
+        return std::get<T>(*value);
     }
-    throw std::runtime_error("Property not found or incorrect type: " + key);
+    throw std::runtime_error("Property not found or incorrect type: " + key.name());
 }
 
+// Since PropertyBag copies share storage, this is just a PropertyBag whose first
+// modification adds a layer over the original
 class COWPropertyBag {
 public:
     // Constructor
     explicit COWPropertyBag(const PropertyBag& original)
-        : originalBag(&original), copyBag(nullptr) {}
+        : bag(original) {}
 
-    // Set a property (triggers copy-on-write)
-    void setProperty(const std::string& key, const VariantProperty& value) {
-        ensureCopy();
-        copyBag->setProperty(key, value);
+    // Set a property (adds a layer over the original)
+    void setProperty(PropertyKey key, const VariantProperty& value) {
+        bag.setProperty(key, value);
     }
 
-    // Remove a property (triggers copy-on-write)
-    void removeProperty(const std::string& key) {
-        ensureCopy();
-        copyBag->removeProperty(key);
+    // Remove a property (adds a layer over the original)
+    void removeProperty(PropertyKey key) {
+        bag.removeProperty(key);
     }
 
-    // Get a property (reads from the original or the copy)
+    // Get a property
     template<typename T>
-    const VariantProperty* getProperty(const std::string& key) const {
-        if (copyBag) {
-            return copyBag->getProperty<T>(key);
-        }
-        return originalBag->getProperty<T>(key);
+    T getProperty(PropertyKey key) const {
+        return bag.getProperty<T>(key);
     }
 
     // Check if a property exists
-    bool hasProperty(const std::string& key) const {
-        if (copyBag) {
-            return copyBag->hasProperty(key);
-        }
-        return originalBag->hasProperty(key);
+    bool hasProperty(PropertyKey key) const {
+        return bag.hasProperty(key);
     }
 
     // Cast operator to get a const reference to the underlying PropertyBag
     operator const PropertyBag&() const {
-        return copyBag ? *copyBag : *originalBag;
+        return bag;
     }
 
 private:
-    const PropertyBag* originalBag;         // Reference to the original bag
-    std::unique_ptr<PropertyBag> copyBag;  // Copy created on write
-
-    // Ensure a copy of the original bag exists before modifying
-    void ensureCopy() {
-        if (!copyBag) {
-            copyBag = std::make_unique<PropertyBag>(*originalBag);
-        }
-    }
+    PropertyBag bag;
 };
 
 #endif // PROPERTYBAG_H
@@ -885,6 +885,16 @@ struct RectBase {
         return !widthDiffers(other) && !heightDiffers(other);
     }
 
+    /**
+     * @brief Check if position and dimensions are identical between rectangles.
+     *
+     * @param other Rectangle to compare
+     * @return true if position, width and height are all the same
+     */
+    [[nodiscard]] constexpr bool exactlyEquals(const RectBase<V>& other) const noexcept {
+        return pos.exactlyEquals(other.pos) && sizeSame(other);
+    }
+
     //==============================================================================
     // Subrectangle Operations
     //==============================================================================
@@ -108,6 +108,11 @@ public:
         maxSize = addWithUpperLimit(maxSize, offset);
         return *this;
     }
+
+    /**
+     * @brief Compare two constraints for equality
+     */
+    [[nodiscard]] constexpr bool operator==(const SizeBound& other) const noexcept = default;
 };
 
 /**
@@ -292,6 +297,11 @@ public:
     constexpr SizeBound2d& grow(int offset) noexcept {
         return grow(offset, offset);
     }
+
+    /**
+     * @brief Compare two 2D constraints for equality
+     */
+    [[nodiscard]] constexpr bool operator==(const SizeBound2d& other) const noexcept = default;
 };
 
 /**
@@ -28,8 +28,6 @@ void TextEditBox::draw(Canvas2d &g, bool hasFocus)
 {
     Vec2d pos = cast<Vec2d>(rect.upperLeft()) + Vec2d{2,2};
 
-    g.pushClip(rect.left(), rect.top(), rect.width, rect.height, false);
-
     drawRect(g, rect, rgb(35, 35, 35), hasFocus ? BLACK : rgb(10,10,10));
 
     tg.update(pos.x+textOffset, pos.y, sizeAndFace, getText(), hAlign, vAlign);
@@ -84,8 +82,6 @@ void TextEditBox::draw(Canvas2d &g, bool hasFocus)
         g.line({x1+1, y1}, {x2+1, y2}, {128,128,255,alpha});
         //g.println("{}",sin(g.time())*0.5+0.5);
     }
-
-    g.popClip();
 }
 
 bool TextEditBox::onClick(Vec2d pos)
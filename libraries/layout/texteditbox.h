@@ -17,10 +17,11 @@ class TextEditBox : public TextEditLine
     FontInfo sizeAndFace;
 public:
     TextEditBox(TextMetrics& metrics, const FontInfo &sizeAndFace, std::string text = "");
-    void draw(mssm::Canvas2d &g, bool hasFocus);
+    void draw(mssm::Canvas2d &g, bool hasFocus); // the caller clips to getRect()
     bool onClick(Vec2d pos);
     void onDrag(Vec2d pos);
     void setRect(const RectI& location) { rect = location; }
+    const RectI& getRect() const { return rect; }
     int boxHeight() const { return tg.textExtents().fontHeight + 6; }
 };
 
@@ -1,4 +1,5 @@
 #include "camera.h"
+#include <algorithm>
 #include <cstdio>
 #include <string>
 #include <chrono>
@@ -138,38 +139,84 @@ void estimateFrameRate(CapContext ctx, int32_t streamID)
     printf("Measured fps=%5.2f\n", 1000.0f*frames/static_cast<float>(d.count()));
 }
 
-Camera::Camera(mssm::Graphics &g) : g{g}
+CapFrameSource::CapFrameSource(CapContext ctx, int32_t streamId, int width, int height)
+    : ctx{ctx}, streamId{streamId}, w{width}, h{height}
 {
-    uint32_t deviceFormatID = 0;
-    uint32_t deviceID       = 0;
+}
 
+bool CapFrameSource::grab(uint8_t *rgb, size_t size)
+{
+    // poll for a while, so the grab thread still notices when it's told to stop
+    for (int i = 0; i < 50; i++) {
+        if (Cap_hasNewFrame(ctx, streamId)) {
+            return Cap_captureFrame(ctx, streamId, rgb, static_cast<uint32_t>(size)) == CAPRESULT_OK;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    return false;
+}
+
+Camera::Camera(mssm::Graphics &g) : g{g}
+{
     ctx = Cap_createContext();
 
     deviceCount = Cap_getDeviceCount(ctx);
-
 }
 
 Camera::~Camera()
 {
-    if (streamId >= 0) {
-      Cap_closeStream(ctx, streamId);
-    }
+    close();
     Cap_releaseContext(ctx);
 }
 
-bool Camera::open(const FormatInfo &format)
+void Camera::close()
 {
+    grabber.reset(); // stop grabbing before the stream goes
     if (streamId >= 0) {
-      Cap_closeStream(ctx, streamId);
+        Cap_closeStream(ctx, streamId);
+        streamId = -1;
     }
+}
+
+bool Camera::open(const FormatInfo &format)
+{
+    close();
     openFormat = format;
     streamId = Cap_openStream(ctx, openFormat.deviceId, openFormat.formatId);
-    return isOpen();
+    if (streamId < 0) {
+        return false;
+    }
+    return start(std::make_unique<CapFrameSource>(ctx, streamId, openFormat.width, openFormat.height));
+}
+
+bool Camera::open(std::unique_ptr<FrameSource> source)
+{
+    close();
+    return start(std::move(source));
+}
+
+bool Camera::start(std::unique_ptr<FrameSource> source)
+{
+    if (!image || image->width() != source->width() || image->height() != source->height()) {
+        image.emplace(g, source->width(), source->height(), BLACK, true);
+    }
+
+    grabber = std::make_unique<FrameGrabber>(std::move(source));
+    return true;
 }
 
 bool Camera::isOpen()
 {
-    return streamId >= 0;
+    return grabber != nullptr;
+}
+
+bool Camera::update()
+{
+    if (!grabber || !grabber->latest(image->pixels())) {
+        return false;
+    }
+    image->updatePixels();
+    return true;
 }
 
 mssm::Image Camera::capture()
@@ -179,31 +226,11 @@ mssm::Image Camera::capture()
         return img;
     }
 
-    CapFormatInfo finfo;
-    Cap_getFormatInfo(ctx, openFormat.deviceId, openFormat.formatId, &finfo);
-
-    g.cout << "BytesPerPixel: " << finfo.bpp << endl;
-    g.cout << "Format: " << FourCCToString(finfo.fourcc) << endl;
-
-    std::vector<uint8_t> buffer;
-    buffer.resize(openFormat.width*openFormat.height*3);
-
-    Image img(g, openFormat.width, openFormat.height, RED, true);
-
-    if (Cap_captureFrame(ctx, streamId, &buffer[0], openFormat.width*openFormat.height*3) == CAPRESULT_OK)
-    {
-        Color *pixels = img.pixels();
-
-        for (int i = 0; i < buffer.size(); i+= 3) {
-            Color& c{pixels[i/3]};
-            c.r = buffer[i];
-            c.g = buffer[i+1];
-            c.b = buffer[i+2];
-        }
-
-        img.updatePixels();
-    }
+    update();
 
+    Image img(g, image->width(), image->height(), BLACK, true);
+    std::copy_n(image->img->getPixels(), static_cast<size_t>(image->width()) * image->height(), img.pixels());
+    img.updatePixels();
     return img;
 }
 
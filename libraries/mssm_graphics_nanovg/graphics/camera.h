@@ -1,6 +1,9 @@
 #ifndef CAMERA_H
 #define CAMERA_H
 
+#include <memory>
+#include <optional>
+#include "framegrabber.h"
 #include "graphics.h"
 #include "openpnp-capture.h"
 
@@ -36,6 +39,23 @@ public:
     void refresh();
 };
 
+// Frames from an openpnp-capture stream
+class CapFrameSource : public FrameSource {
+    CapContext ctx;
+    int32_t streamId;
+    int w;
+    int h;
+public:
+    CapFrameSource(CapContext ctx, int32_t streamId, int width, int height);
+    int width() const override { return w; }
+    int height() const override { return h; }
+    bool grab(uint8_t* rgb, size_t size) override;
+};
+
+// Grabs frames in the background (see FrameGrabber) into one image that's
+// reused for every frame, so drawing never waits for the camera and nothing
+// is allocated per frame (use update() and frame() for that; capture() makes
+// a copy).
 class Camera
 {
     mssm::Graphics& g;
@@ -44,12 +64,32 @@ class Camera
     int32_t streamId{-1};
     uint32_t deviceCount;
     FormatInfo openFormat;
+    std::unique_ptr<FrameGrabber> grabber;
+    std::optional<mssm::Image> image;
 public:
     Camera( mssm::Graphics& g);
     virtual ~Camera();
+    // either closes whatever was open first
     bool open(const FormatInfo& format);
+    bool open(std::unique_ptr<FrameSource> source); // a test pattern, say
     bool isOpen();
+
+    // Copy in the newest frame, if there is one since the last call (only
+    // frame() is updated).  Never waits.  False if the frame hasn't changed
+    bool update();
+
+    // The image frames go into: the same one every time, overwritten by each
+    // update().  Copies of it share its pixels, so they change too.  Only
+    // valid while the camera is open, and replaced if a source of a different
+    // size is opened
+    mssm::Image& frame() { return *image; }
+
+    // update(), then a new image holding the newest frame, which later frames
+    // don't change
     mssm::Image capture();
+private:
+    void close();
+    bool start(std::unique_ptr<FrameSource> source);
 };
 
 #endif // CAMERA_H
@@ -0,0 +1,142 @@
+#include "framegrabber.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define FRAME_X86 1
+#include <immintrin.h>
+#endif
+
+// SSSE3's byte shuffle isn't in every x86-64, so it's built per function and
+// picked at run time (GCC and Clang only)
+#if defined(FRAME_X86) && (defined(__GNUC__) || defined(__clang__))
+#define FRAME_SSSE3 1
+#endif
+
+namespace {
+
+void rgbToRgbaScalar(const uint8_t* rgb, mssm::Color* rgba, size_t pixels)
+{
+    for (size_t i = 0; i < pixels; i++) {
+        rgba[i] = mssm::Color(rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]);
+    }
+}
+
+#ifdef FRAME_SSSE3
+
+__attribute__((target("ssse3")))
+void rgbToRgbaSsse3(const uint8_t* rgb, mssm::Color* rgba, size_t pixels)
+{
+    // four pixels (12 bytes) at a time, spread out to 16 with alpha ORed in
+    const __m128i spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+    size_t i = 0;
+    // each load reads 16 bytes, 4 past the pixels used, so stop before the end
+    for (; i + 6 <= pixels; i += 4) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + i * 3));
+        __m128i out = _mm_or_si128(_mm_shuffle_epi8(in, spread), alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + i), out);
+    }
+
+    rgbToRgbaScalar(rgb + i * 3, rgba + i, pixels - i);
+}
+
+#endif
+
+using ConvertFunc = void (*)(const uint8_t* rgb, mssm::Color* rgba, size_t pixels);
+
+ConvertFunc pickConvert()
+{
+#ifdef FRAME_SSSE3
+    if (__builtin_cpu_supports("ssse3")) {
+        return rgbToRgbaSsse3;
+    }
+#endif
+    return rgbToRgbaScalar;
+}
+
+} // namespace
+
+void rgbToRgba(const uint8_t* rgb, mssm::Color* rgba, size_t pixels)
+{
+    static const ConvertFunc convert = pickConvert();
+    convert(rgb, rgba, pixels);
+}
+
+SyntheticFrameSource::SyntheticFrameSource(int width, int height, double framesPerSecond)
+    : w{width}, h{height},
+      period{std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / framesPerSecond))},
+      nextFrame{std::chrono::steady_clock::now()}
+{
+}
+
+bool SyntheticFrameSource::grab(uint8_t* rgb, size_t size)
+{
+    if (size < static_cast<size_t>(w) * h * 3) {
+        return false;
+    }
+
+    std::this_thread::sleep_until(nextFrame);
+    nextFrame += period;
+
+    static constexpr uint8_t bars[8][3] = {
+        { 255, 255, 255 }, { 255, 255, 0 }, { 0, 255, 255 }, { 0, 255, 0 },
+        { 255, 0, 255 },   { 255, 0, 0 },   { 0, 0, 255 },   { 0, 0, 0 }
+    };
+
+    // one row, then copies of it
+    int barWidth = std::max(1, w / 8);
+    for (int x = 0; x < w; x++) {
+        const uint8_t* bar = bars[((x + frame) / barWidth) % 8];
+        std::memcpy(rgb + x * 3, bar, 3);
+    }
+    for (int y = 1; y < h; y++) {
+        std::memcpy(rgb + static_cast<size_t>(y) * w * 3, rgb, static_cast<size_t>(w) * 3);
+    }
+
+    frame++;
+    return true;
+}
+
+FrameGrabber::FrameGrabber(std::unique_ptr<FrameSource> frameSource)
+    : source{std::move(frameSource)}, frameSize{static_cast<size_t>(source->width()) * source->height() * 3}
+{
+    for (auto& buffer : buffers) {
+        buffer.resize(frameSize);
+    }
+    thread = std::thread(&FrameGrabber::run, this);
+}
+
+FrameGrabber::~FrameGrabber()
+{
+    stopping = true;
+    thread.join();
+}
+
+void FrameGrabber::run()
+{
+    while (!stopping) {
+        if (!source->grab(buffers[writing].data(), frameSize)) {
+            continue;
+        }
+        grabbed++;
+        // publish it, and carry on in the buffer that held the one before
+        uint32_t previous = ready.exchange(writing | freshFrame, std::memory_order_acq_rel);
+        if (previous & freshFrame) {
+            dropped++;
+        }
+        writing = previous & ~freshFrame;
+    }
+}
+
+bool FrameGrabber::latest(mssm::Color* pixels)
+{
+    if (!(ready.load(std::memory_order_acquire) & freshFrame)) {
+        return false;
+    }
+
+    reading = ready.exchange(reading, std::memory_order_acq_rel) & ~freshFrame;
+    rgbToRgba(buffers[reading].data(), pixels, frameSize / 3);
+    return true;
+}
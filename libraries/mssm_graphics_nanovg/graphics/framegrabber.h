@@ -0,0 +1,81 @@
+#ifndef FRAMEGRABBER_H
+#define FRAMEGRABBER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "color.h"
+
+// A source of RGB frames: 3 bytes a pixel, rows top to bottom
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+    virtual int width() const = 0;
+    virtual int height() const = 0;
+
+    // fill rgb (width * height * 3 bytes) with the next frame, waiting a short
+    // while for it if need be.  False if none came
+    virtual bool grab(uint8_t* rgb, size_t size) = 0;
+};
+
+// Colour bars scrolling one pixel a frame, at a steady frame rate, for trying
+// things out without a camera
+class SyntheticFrameSource : public FrameSource {
+    int w;
+    int h;
+    std::chrono::steady_clock::duration period;
+    std::chrono::steady_clock::time_point nextFrame;
+    uint32_t frame{0};
+public:
+    SyntheticFrameSource(int width, int height, double framesPerSecond = 30);
+    int width() const override { return w; }
+    int height() const override { return h; }
+    bool grab(uint8_t* rgb, size_t size) override;
+};
+
+// Pulls frames from a FrameSource on a thread of its own, so a slow camera
+// never holds up drawing.  Frames land in three buffers allocated up front
+// and passed round without locks (triple buffering): the grabber always has
+// one to fill, the reader has one to convert, and the third holds the newest
+// complete frame.  A frame the reader never asked for is overwritten.
+class FrameGrabber {
+    static constexpr uint32_t freshFrame = 4; // flag on ready: not yet read
+
+    std::unique_ptr<FrameSource> source;
+    size_t frameSize;
+    std::array<std::vector<uint8_t>, 3> buffers;
+    std::atomic<uint32_t> ready{1};   // index of the newest frame, plus freshFrame
+    uint32_t writing{0};              // grab thread only
+    uint32_t reading{2};              // reader only
+    std::atomic<uint64_t> grabbed{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+public:
+    FrameGrabber(std::unique_ptr<FrameSource> source);
+    ~FrameGrabber();
+
+    FrameGrabber(const FrameGrabber&) = delete;
+    FrameGrabber& operator=(const FrameGrabber&) = delete;
+
+    int width() const { return source->width(); }
+    int height() const { return source->height(); }
+
+    // If a frame has come in since the last call, convert it into pixels (width
+    // * height of them) and return true.  Never waits for the grab thread
+    bool latest(mssm::Color* pixels);
+
+    uint64_t framesGrabbed() const { return grabbed; }
+    uint64_t framesDropped() const { return dropped; } // overwritten before being read
+private:
+    void run();
+};
+
+// rgb: 3 bytes a pixel.  Alpha is set to 255
+void rgbToRgba(const uint8_t* rgb, mssm::Color* rgba, size_t pixels);
+
+#endif // FRAMEGRABBER_H
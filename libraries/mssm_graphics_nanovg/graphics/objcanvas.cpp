@@ -1,15 +1,361 @@
 #include "objcanvas.h"
+#include "image.h"
+#include "polypartition.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
 
 using namespace mssm;
 using namespace std;
 
-constexpr const char* notImplMsg = "Function not yet implemented";
+namespace {
 
+constexpr int poolBits = 18;            // vertices remembered for sharing
+constexpr double curveTolerance = 0.25; // max distance from a curve to its segments
+constexpr auto objNumbers = CanvasStreamWriter::NumberFormat::fixed(6); // without trailing zeros
 
-ObjCanvas::ObjCanvas(string filename, int width, int height)
-    : w{width}, h{height}
+bool isConvex(const Vec2d* pts, size_t count)
 {
+    int turn = 0;
+    int xFlips = 0;
+    int yFlips = 0;
+    double lastDx = 0;
+    double lastDy = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        Vec2d a = pts[i];
+        Vec2d b = pts[(i + 1) % count];
+        Vec2d c = pts[(i + 2) % count];
+        double cross = (b.x - a.x) * (c.y - b.y) - (b.y - a.y) * (c.x - b.x);
+        if (cross != 0) {
+            int sign = cross > 0 ? 1 : -1;
+            if (turn != 0 && sign != turn) {
+                return false;
+            }
+            turn = sign;
+        }
+        // a star turns one way throughout too, but changes direction too often
+        double dx = b.x - a.x;
+        double dy = b.y - a.y;
+        if (dx != 0) {
+            xFlips += (lastDx != 0 && (dx > 0) != (lastDx > 0));
+            lastDx = dx;
+        }
+        if (dy != 0) {
+            yFlips += (lastDy != 0 && (dy > 0) != (lastDy > 0));
+            lastDy = dy;
+        }
+    }
+
+    return xFlips <= 2 && yFlips <= 2;
+}
+
+void writeMaterialName(CanvasStreamWriter& out, Color c)
+{
+    static constexpr char digits[] = "0123456789abcdef";
+    char name[9] = { 'c' };
+    uint8_t parts[4] = { c.r, c.g, c.b, c.a };
+    for (int i = 0; i < 4; i++) {
+        name[1 + i * 2] = digits[parts[i] >> 4];
+        name[2 + i * 2] = digits[parts[i] & 15];
+    }
+    out.write(string_view(name, sizeof(name)));
+}
+
+std::string mtlFilename(const std::string& filename)
+{
+    return std::filesystem::path(filename).replace_extension(".mtl").string();
+}
+
+} // namespace
+
+namespace mssm {
+
+// each three vertices pushed make a triangle, coloured by the first of them
+class ObjTriWriter : public ITriWriter<Vertex3dUV>
+{
+    ObjCanvas& canvas;
+    Vec3d tri[3];
+    Color color;
+    int count{0};
+public:
+    ObjTriWriter(ObjCanvas& canvas) : canvas{canvas} {}
+
+    virtual void push(const Vertex3dUV& v) override
+    {
+        if (count == 0) {
+            color = Color(static_cast<int>(std::lround(v.color.x * 255)),
+                          static_cast<int>(std::lround(v.color.y * 255)),
+                          static_cast<int>(std::lround(v.color.z * 255)),
+                          static_cast<int>(std::lround(v.color.w * 255)));
+        }
+        tri[count] = Vec3d{v.pos.x, v.pos.y, v.pos.z};
+        if (++count == 3) {
+            canvas.face3d(tri, 3, color);
+            count = 0;
+        }
+    }
+
+    virtual void push(const Vertex3dUV& v1, const Vertex3dUV& v2) override
+    {
+        push(v1);
+        push(v2);
+    }
+
+    virtual void push(const Vertex3dUV& v1, const Vertex3dUV& v2, const Vertex3dUV& v3) override
+    {
+        push(v1);
+        push(v2);
+        push(v3);
+    }
+
+    virtual void finish() override
+    {
+        count = 0; // drop any partial triangle
+    }
+};
+
+}
+
+ObjCanvas::ObjCanvas(string filename, int width, int height, bool materials)
+    : w{width}, h{height}, filename{filename}, out{filename, objNumbers},
+      pool(size_t{1} << poolBits), useMaterials{materials}
+{
+    out.write("# mssm ObjCanvas\n");
+    if (useMaterials) {
+        out.write("mtllib ");
+        out.write(std::filesystem::path(mtlFilename(filename)).filename().string());
+        out.write('\n');
+    }
+}
+
+mssm::ObjCanvas::~ObjCanvas()
+{
+    try {
+        save();
+    }
+    catch (...) {
+        // nowhere to report it from here
+    }
+}
+
+void mssm::ObjCanvas::save()
+{
+    if (finished) {
+        return;
+    }
+    finished = true;
+    out.flush();
+
+    if (useMaterials) {
+        CanvasStreamWriter mtl(mtlFilename(filename), objNumbers);
+        for (const Color& c : materials) {
+            mtl.write("newmtl ");
+            writeMaterialName(mtl, c);
+            mtl.write("\nKd ");
+            mtl.number(c.rD());
+            mtl.write(' ');
+            mtl.number(c.gD());
+            mtl.write(' ');
+            mtl.number(c.bD());
+            mtl.write("\nd ");
+            mtl.number(c.aD());
+            mtl.write("\n\n");
+        }
+        mtl.flush();
+    }
+}
+
+void mssm::ObjCanvas::checkOpen()
+{
+    if (finished) {
+        throw std::logic_error("ObjCanvas: drawing after save()");
+    }
+}
+
+// the index of a vertex at p, written now unless it was recently
+uint32_t mssm::ObjCanvas::vertex(Vec3d p)
+{
+    checkOpen();
+
+    uint64_t hash = std::bit_cast<uint64_t>(p.x) * 0x9E3779B97F4A7C15ull;
+    hash ^= std::bit_cast<uint64_t>(p.y) * 0xC2B2AE3D27D4EB4Full;
+    hash ^= std::bit_cast<uint64_t>(p.z) * 0x165667B19E3779F9ull;
+    PoolSlot& slot = pool[hash >> (64 - poolBits)];
+
+    if (slot.index != 0 && slot.pos.x == p.x && slot.pos.y == p.y && slot.pos.z == p.z) {
+        return slot.index;
+    }
+
+    out.write("v ");
+    out.number(p.x);
+    out.write(' ');
+    out.number(p.y);
+    out.write(' ');
+    out.number(p.z);
+    out.write('\n');
+
+    slot.pos = p;
+    slot.index = ++vertexCount;
+    return slot.index;
+}
+
+Vec3d mssm::ObjCanvas::transformed(Vec3d p) const
+{
+    if (!haveModel) {
+        return p;
+    }
+    // linmath matrices are column major
+    return Vec3d{ model[0][0] * p.x + model[1][0] * p.y + model[2][0] * p.z + model[3][0],
+                  model[0][1] * p.x + model[1][1] * p.y + model[2][1] * p.z + model[3][1],
+                  model[0][2] * p.x + model[1][2] * p.y + model[2][2] * p.z + model[3][2] };
+}
+
+void mssm::ObjCanvas::useMaterial(Color c)
+{
+    if (!useMaterials || (haveMaterial && c == currentMaterial)) {
+        return;
+    }
+    if (materialIds.try_emplace(c.toUIntRGBA(), static_cast<uint32_t>(materials.size())).second) {
+        materials.push_back(c);
+    }
+    currentMaterial = c;
+    haveMaterial = true;
+
+    out.write("usemtl ");
+    writeMaterialName(out, c);
+    out.write('\n');
+}
+
+// an f, l or p record of indices
+void mssm::ObjCanvas::writeIndices(char type, bool closed)
+{
+    out.write(type);
+    for (uint32_t index : indices) {
+        out.write(' ');
+        out.number(index);
+    }
+    if (closed) {
+        out.write(' ');
+        out.number(indices.front());
+    }
+    out.write('\n');
+}
+
+void mssm::ObjCanvas::shape(const Vec2d* pts, size_t count, Color border, Color fill, bool closed)
+{
+    if (closed && count > 2 && pts[count - 1].exactlyEquals(pts[0])) {
+        count--; // closing makes the repeated point
+    }
+
+    if (fill.a > 0 && count >= 3) {
+        fillPolygon(pts, count, fill);
+    }
+
+    if (border.a > 0 && count >= 2) {
+        indices.clear();
+        for (size_t i = 0; i < count; i++) {
+            indices.push_back(vertex(pts[i]));
+        }
+        useMaterial(border);
+        writeIndices('l', closed);
+    }
+}
+
+// faces wind counterclockwise once y is flipped
+void mssm::ObjCanvas::fillPolygon(const Vec2d* pts, size_t count, Color fill)
+{
+    indices.clear();
+    for (size_t i = 0; i < count; i++) {
+        indices.push_back(vertex(pts[i]));
+    }
+
+    if (isConvex(pts, count)) {
+        double area = 0;
+        for (size_t i = 0; i < count; i++) {
+            const Vec2d& a = pts[i];
+            const Vec2d& b = pts[(i + 1) % count];
+            area += a.x * b.y - b.x * a.y;
+        }
+        if (area > 0) {
+            std::reverse(indices.begin(), indices.end());
+        }
+        useMaterial(fill);
+        writeIndices('f', false);
+        return;
+    }
+
+    TPPLPoly poly;
+    poly.Init(static_cast<long>(count));
+    for (size_t i = 0; i < count; i++) {
+        auto& v = poly[static_cast<long>(i)];
+        v.x = pts[i].x;
+        v.y = pts[i].y;
+        v.id = static_cast<int>(i);
+    }
+    poly.SetOrientation(TPPL_ORIENTATION_CCW);
+
+    TPPLPartition pp;
+    TPPLPolyList list;
+    useMaterial(fill);
+
+    if (!pp.Triangulate_EC(&poly, &list)) {
+        writeIndices('f', false); // self intersecting; leave it to the reader
+        return;
+    }
+
+    for (auto& tri : list) {
+        out.write('f');
+        for (long i = tri.GetNumPoints() - 1; i >= 0; i--) {
+            out.write(' ');
+            out.number(indices[tri.GetPoint(i).id]);
+        }
+        out.write('\n');
+    }
+}
+
+// Points along an elliptical arc (angles in radians, counterclockwise as
+// seen) into outlinePts, preceded by the center for a pie.  A full ellipse
+// doesn't repeat its first point
+void mssm::ObjCanvas::ellipsePoints(Vec2d center, double w, double h, double a, double alen, bool withCenter)
+{
+    double rx = w / 2;
+    double ry = h / 2;
+    double r = std::max({std::abs(rx), std::abs(ry), curveTolerance});
+    double step = 2 * std::acos(std::max(-1.0, 1 - curveTolerance / r));
+    bool full = std::abs(alen) >= 2 * M_PI;
+    if (full) {
+        alen = 2 * M_PI;
+    }
+    int segments = std::clamp(static_cast<int>(std::ceil(std::abs(alen) / step)), full ? 8 : 1, 1024);
+
+    outlinePts.clear();
+    if (withCenter) {
+        outlinePts.push_back(center);
+    }
+    int last = full ? segments - 1 : segments;
+    for (int i = 0; i <= last; i++) {
+        double t = a + alen * i / segments;
+        outlinePts.push_back({center.x + rx * std::cos(t), center.y - ry * std::sin(t)});
+    }
+}
+
+void mssm::ObjCanvas::face3d(const Vec3d* pts, size_t count, Color fill)
+{
+    indices.clear();
+    for (size_t i = 0; i < count; i++) {
+        indices.push_back(vertex(transformed(pts[i])));
+    }
+    useMaterial(fill);
+    writeIndices('f', false);
+}
 
+bool mssm::ObjCanvas::isDrawable()
+{
+    return !finished;
 }
 
 int mssm::ObjCanvas::width()
@@ -28,38 +374,61 @@ void mssm::ObjCanvas::setBackground(Color c)
 
 void mssm::ObjCanvas::line(Vec2d p1, Vec2d p2, Color c)
 {
+    Vec2d pts[2] = { p1, p2 };
+    shape(pts, 2, c, TRANSPARENT, false);
 }
 
 void mssm::ObjCanvas::ellipse(Vec2d center, double w, double h, Color c, Color f)
 {
+    ellipsePoints(center, w, h, 0, 2 * M_PI, false);
+    shape(outlinePts.data(), outlinePts.size(), c, f, true);
 }
 
 void mssm::ObjCanvas::arc(Vec2d center, double w, double h, double a, double alen, Color c)
 {
+    ellipsePoints(center, w, h, a, alen, false);
+    shape(outlinePts.data(), outlinePts.size(), c, TRANSPARENT, false);
 }
 
 void mssm::ObjCanvas::chord(Vec2d center, double w, double h, double a, double alen, Color c, Color f)
 {
+    ellipsePoints(center, w, h, a, alen, false);
+    shape(outlinePts.data(), outlinePts.size(), c, f, true);
 }
 
 void mssm::ObjCanvas::pie(Vec2d center, double w, double h, double a, double alen, Color c, Color f)
 {
+    ellipsePoints(center, w, h, a, alen, true);
+    shape(outlinePts.data(), outlinePts.size(), c, f, true);
 }
 
 void mssm::ObjCanvas::rect(Vec2d corner, double w, double h, Color c, Color f)
 {
+    Vec2d pts[4] = { corner, {corner.x + w, corner.y}, {corner.x + w, corner.y + h}, {corner.x, corner.y + h} };
+    shape(pts, 4, c, f, true);
 }
 
 void mssm::ObjCanvas::polygon(const std::vector<Vec2d> &points, Color border, Color fill)
 {
+    shape(points.data(), points.size(), border, fill, true);
 }
 
 void mssm::ObjCanvas::polyline(const std::vector<Vec2d> &points, Color color)
 {
+    shape(points.data(), points.size(), color, TRANSPARENT, false);
 }
 
 void mssm::ObjCanvas::points(const std::vector<Vec2d> &points, Color c)
 {
+    if (points.empty() || c.a == 0) {
+        return;
+    }
+    indices.clear();
+    for (const auto& p : points) {
+        indices.push_back(vertex(p));
+    }
+    useMaterial(c);
+    writeIndices('p', false);
 }
 
 #ifdef SUPPORT_MSSM_ARRAY
@@ -81,12 +450,12 @@ void mssm::ObjCanvas::points(const Array<Vec2d> &pts, Color c)
 
 void mssm::ObjCanvas::polygon(std::initializer_list<Vec2d> pts, Color border, Color fill)
 {
-    polygon(vector<Vec2d>(pts), border, fill);
+    shape(pts.begin(), pts.size(), border, fill, true);
 }
 
 void mssm::ObjCanvas::polyline(std::initializer_list<Vec2d> pts, Color color)
 {
-    polyline(vector<Vec2d>(pts), color);
+    shape(pts.begin(), pts.size(), color, TRANSPARENT, false);
 }
 
 void mssm::ObjCanvas::points(std::initializer_list<Vec2d> pts, Color c)
@@ -98,47 +467,219 @@ void mssm::ObjCanvas::text(Vec2d pos, const FontInfo &sizeAndFace, const string
 {
 }
 
+// there are no fonts here, so text is measured roughly
 void mssm::ObjCanvas::textExtents(const FontInfo &sizeAndFace, const string &str, TextExtents &extents)
 {
+    extents.textWidth = textWidth(sizeAndFace, str);
+    extents.textAdvance = extents.textWidth;
+    extents.fontHeight = sizeAndFace.getSize();
+    extents.textHeight = extents.fontHeight;
+    extents.fontAscent = sizeAndFace.getSize() * 0.8;
+    extents.fontDescent = sizeAndFace.getSize() * 0.2;
 }
 
 double mssm::ObjCanvas::textWidth(const FontInfo &sizeAndFace, const string &str)
 {
-    throw std::logic_error(notImplMsg);
+    return str.length() * sizeAndFace.getSize() * 0.6;
+}
+
+std::vector<double> mssm::ObjCanvas::getCharacterXOffsets(const FontInfo &sizeAndFace, double startX, const std::string &text)
+{
+    std::vector<double> offsets;
+    offsets.reserve(text.length() + 1);
+    for (size_t i = 0; i <= text.length(); i++) {
+        offsets.push_back(startX + i * sizeAndFace.getSize() * 0.6);
+    }
+    return offsets;
 }
 
 void mssm::ObjCanvas::point(Vec2d pos, Color c)
 {
+    if (c.a == 0) {
+        return;
+    }
+    indices.clear();
+    indices.push_back(vertex(pos));
+    useMaterial(c);
+    writeIndices('p', false);
 }
 
+// images are exported as their outline
+
 void mssm::ObjCanvas::image(Vec2d pos, const Image &img, double alpha)
 {
+    rect(pos, img.width(), img.height(), WHITE, TRANSPARENT);
 }
 
 void mssm::ObjCanvas::image(Vec2d pos, const Image &img, Vec2d src, int srcw, int srch, double alpha)
 {
+    rect(pos, srcw, srch, WHITE, TRANSPARENT);
 }
 
 void mssm::ObjCanvas::image(Vec2d pos, double w, double h, const Image &img, double alpha)
 {
+    rect(pos, w, h, WHITE, TRANSPARENT);
 }
 
 void mssm::ObjCanvas::image(Vec2d pos, double w, double h, const Image &img, Vec2d src, int srcw, int srch, double alpha)
 {
+    rect(pos, w, h, WHITE, TRANSPARENT);
 }
 
 void mssm::ObjCanvas::imageC(Vec2d center, double angle, const Image &img, double alpha)
 {
+    imageC(center, angle, img.width(), img.height(), img, alpha);
 }
 
 void mssm::ObjCanvas::imageC(Vec2d center, double angle, const Image &img, Vec2d src, int srcw, int srch, double alpha)
 {
+    imageC(center, angle, srcw, srch, img, alpha);
 }
 
 void mssm::ObjCanvas::imageC(Vec2d center, double angle, double w, double h, const Image &img, double alpha)
 {
+    Vec2d pts[4] = { {-w/2, -h/2}, {w/2, -h/2}, {w/2, h/2}, {-w/2, h/2} };
+    for (auto& p : pts) {
+        p = center + p.rotated(angle);
+    }
+    shape(pts, 4, WHITE, TRANSPARENT, true);
 }
 
 void mssm::ObjCanvas::imageC(Vec2d center, double angle, double w, double h, const Image &img, Vec2d src, int srcw, int srch, double alpha)
 {
+    imageC(center, angle, w, h, img, alpha);
+}
+
+bool mssm::ObjCanvas::isClipped(Vec2d pos) const
+{
+    return pos.x < 0 || pos.y < 0 || pos.x >= w || pos.y >= h;
+}
+
+// nothing is clipped in the exported geometry
+
+void mssm::ObjCanvas::pushClip(int x, int y, int w, int h, bool replace)
+{
+}
+
+void mssm::ObjCanvas::popClip()
+{
+}
+
+void mssm::ObjCanvas::setClip(int x, int y, int w, int h)
+{
+}
+
+void mssm::ObjCanvas::resetClip()
+{
+}
+
+void mssm::ObjCanvas::setViewport(int x, int y, int w, int h)
+{
+}
+
+void mssm::ObjCanvas::resetViewport()
+{
+}
+
+void mssm::ObjCanvas::pushGroup(std::string groupName)
+{
+    checkOpen();
+    // a space would start another group name
+    std::replace(groupName.begin(), groupName.end(), ' ', '_');
+    if (groupName.empty()) {
+        groupName = "group" + std::to_string(groups.size() + 1);
+    }
+    groups.push_back(groupName);
+    out.write("g ");
+    out.write(groupName);
+    out.write('\n');
+}
+
+void mssm::ObjCanvas::popGroup()
+{
+    checkOpen();
+    if (groups.empty()) {
+        return;
+    }
+    groups.pop_back();
+    out.write("g ");
+    out.write(groups.empty() ? "default" : groups.back());
+    out.write('\n');
+}
+
+void mssm::ObjCanvas::polygonPattern(const std::vector<Vec2d> &points, Color c, Color f)
+{
+    polygon(points, c, f);
+}
+
+void mssm::ObjCanvas::polygonPattern(std::initializer_list<Vec2d> points, Color c, Color f)
+{
+    polygon(points, c, f);
+}
+
+void mssm::ObjCanvas::line3d(Vec3d p1, Vec3d p2, Color c)
+{
+    if (c.a == 0) {
+        return;
+    }
+    indices.clear();
+    indices.push_back(vertex(transformed(p1)));
+    indices.push_back(vertex(transformed(p2)));
+    useMaterial(c);
+    writeIndices('l', false);
+}
+
+void mssm::ObjCanvas::polygon3d(const std::vector<Vec3d> &points, Color border, Color fill)
+{
+    if (fill.a > 0 && points.size() >= 3) {
+        face3d(points.data(), points.size(), fill);
+    }
+    if (border.a > 0 && points.size() >= 2) {
+        indices.clear();
+        for (const auto& p : points) {
+            indices.push_back(vertex(transformed(p)));
+        }
+        useMaterial(border);
+        writeIndices('l', true);
+    }
+}
+
+void mssm::ObjCanvas::setModelMatrix(mat4x4 &model)
+{
+    std::memcpy(this->model, model, sizeof(mat4x4));
+    haveModel = true;
+}
+
+void mssm::ObjCanvas::resetModelMatrix()
+{
+    haveModel = false;
+}
+
+// the exported geometry doesn't depend on the view or lighting
+
+void mssm::ObjCanvas::setCameraParams(const CameraParams &params)
+{
+}
+
+void mssm::ObjCanvas::setCameraParams(Vec3d eye, Vec3d target, Vec3d up, double near, double far)
+{
+}
+
+void mssm::ObjCanvas::setLightParams(Vec3d pos, Color color)
+{
+}
+
+// a StaticMesh's geometry is only on the GPU, so there's nothing to write
+
+void mssm::ObjCanvas::drawMesh(const StaticMesh &mesh, const mat4x4 &modelMatrix)
+{
+}
+
+void mssm::ObjCanvas::drawMesh(const StaticMeshLod &mesh, const mat4x4 &modelMatrix)
+{
+}
+
+std::unique_ptr<ITriWriter<Vertex3dUV>> mssm::ObjCanvas::getTriangleWriter(uint32_t triCount)
+{
+    return std::make_unique<ObjTriWriter>(*this);
 }
@@ -1,19 +1,82 @@
 #ifndef OBJCANVAS_H
 #define OBJCANVAS_H
 
-#include "canvas2d.h"
+#include "canvas3d.h"
+#include "canvasStreamWriter.h"
+#include <unordered_map>
 
 namespace mssm {
 
-    class ObjCanvas : public mssm::Canvas2d
+    class ObjTriWriter;
+
+    // Writes what's drawn to a Wavefront OBJ file as it's drawn, through a
+    // fixed size buffer.  Fills become faces (concave ones are triangulated),
+    // outlines and lines become "l" records and points "p" records.  2d
+    // drawing is flipped so y is up, at z = 0; 3d drawing is transformed by
+    // the model matrix.  Vertices are shared through a fixed size pool of
+    // recently written ones, so memory use doesn't grow with the drawing.
+    //
+    // With materials on, each colour becomes a material in filename's .mtl
+    // file, written by save().  Groups become OBJ groups.  Text, meshes (which
+    // only live on the GPU) and the camera and lights aren't exported.
+    class ObjCanvas : public mssm::Canvas3d
     {
+        friend class ObjTriWriter;
+
+        struct PoolSlot {
+            Vec3d pos;
+            uint32_t index{0}; // 0 when empty
+        };
+
         int w;
         int h;
+        std::string filename;
+        CanvasStreamWriter out;
+        bool finished{false};
+
+        std::vector<PoolSlot> pool;
+        uint32_t vertexCount{0};
+
+        bool useMaterials;
+        std::unordered_map<unsigned int, uint32_t> materialIds; // by toUIntRGBA
+        std::vector<Color> materials;
+        Color currentMaterial{0, 0, 0, 0};
+        bool haveMaterial{false};
+
+        std::vector<std::string> groups;
+
+        mat4x4 model;
+        bool haveModel{false};
+
+        // scratch space, kept to save allocating it for each shape
+        std::vector<Vec2d> outlinePts;
+        std::vector<uint32_t> indices;
+
     public:
-        ObjCanvas(std::string filename, int width, int height);
+        ObjCanvas(std::string filename, int width, int height, bool materials = false);
+        ~ObjCanvas();
+
+        ObjCanvas(const ObjCanvas&) = delete;
+        ObjCanvas& operator=(const ObjCanvas&) = delete;
+
+        // finish the OBJ (and write the MTL) file; nothing can be drawn after
+        void save();
+
+    private:
+        void checkOpen();
+        uint32_t vertex(Vec3d p);
+        uint32_t vertex(Vec2d p) { return vertex(Vec3d{p.x, h - p.y, 0}); }
+        Vec3d transformed(Vec3d p) const;
+        void useMaterial(Color c);
+        void writeIndices(char type, bool closed);
+        void shape(const Vec2d* pts, size_t count, Color border, Color fill, bool closed);
+        void fillPolygon(const Vec2d* pts, size_t count, Color fill);
+        void ellipsePoints(Vec2d center, double w, double h, double a, double alen, bool withCenter);
+        void face3d(const Vec3d* pts, size_t count, Color fill);
 
         // Canvas interface
     public:
+        virtual bool isDrawable() override;
         virtual int width() override;
         virtual int height() override;
         virtual void setBackground(Color c) override;
@@ -37,6 +100,7 @@ namespace mssm {
         virtual void text(Vec2d pos, const FontInfo &sizeAndFace, const std::string &str, Color textColor, HAlign hAlign, VAlign vAlign) override;
         virtual void textExtents(const FontInfo &sizeAndFace, const std::string &str, TextExtents &extents) override;
         virtual double textWidth(const FontInfo &sizeAndFace, const std::string &str) override;
+        virtual std::vector<double> getCharacterXOffsets(const FontInfo &sizeAndFace, double startX, const std::string &text) override;
         virtual void point(Vec2d pos, Color c) override;
         virtual void image(Vec2d pos, const Image &img, double alpha = 1.0) override;
         virtual void image(Vec2d pos, const Image &img, Vec2d src, int srcw, int srch, double alpha = 1.0) override;
@@ -46,6 +110,30 @@ namespace mssm {
         virtual void imageC(Vec2d center, double angle, const Image &img, Vec2d src, int srcw, int srch, double alpha = 1.0) override;
         virtual void imageC(Vec2d center, double angle, double w, double h, const Image &img, double alpha = 1.0) override;
         virtual void imageC(Vec2d center, double angle, double w, double h, const Image &img, Vec2d src, int srcw, int srch, double alpha = 1.0) override;
+        virtual bool isClipped(Vec2d pos) const override;
+        virtual void pushClip(int x, int y, int w, int h, bool replace) override;
+        virtual void popClip() override;
+        virtual void setClip(int x, int y, int w, int h) override;
+        virtual void resetClip() override;
+        virtual void setViewport(int x, int y, int w, int h) override;
+        virtual void resetViewport() override;
+        virtual void pushGroup(std::string groupName) override;
+        virtual void popGroup() override;
+        virtual void polygonPattern(const std::vector<Vec2d> &points, Color c, Color f) override;
+        virtual void polygonPattern(std::initializer_list<Vec2d> points, Color c, Color f) override;
+
+        // Canvas3d interface
+    public:
+        virtual void line3d(Vec3d p1, Vec3d p2, Color c) override;
+        virtual void polygon3d(const std::vector<Vec3d> &points, Color border, Color fill) override;
+        virtual void setModelMatrix(mat4x4 &model) override;
+        virtual void resetModelMatrix() override;
+        virtual void setCameraParams(const CameraParams& params) override;
+        virtual void setCameraParams(Vec3d eye, Vec3d target, Vec3d up, double near, double far) override;
+        virtual void setLightParams(Vec3d pos, Color color) override;
+        virtual void drawMesh(const StaticMesh& mesh, const mat4x4& modelMatrix) override;
+        virtual void drawMesh(const StaticMeshLod& mesh, const mat4x4& modelMatrix) override;
+        virtual std::unique_ptr<ITriWriter<Vertex3dUV>> getTriangleWriter(uint32_t triCount) override;
     };
 }
 
@@ -0,0 +1,1021 @@
+#include "rastercanvas.h"
+#include "colorblend.h"
+#include "colorspan.h"
+#include "paths.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+extern "C" {
+#include "fontstash.h"
+}
+
+using namespace mssm;
+using namespace std;
+
+static_assert(sizeof(Color) == 4, "pixels are blended four bytes at a time");
+
+namespace {
+
+constexpr int bandHeight = 16;          // rows rasterized together, by one thread
+constexpr double curveTolerance = 0.25; // max distance from a curve to its segments
+constexpr int initialAtlasSize = 512;
+constexpr int maxAtlasSize = 4096;
+
+const char* fontNames[3] = { "sans", "sans-bold", "sans-light" };
+const char* fontFiles[3] = { "Roboto-Regular.ttf", "Roboto-Bold.ttf", "Roboto-Light.ttf" };
+
+using colorblend::div255;
+using colorblend::blendPixel;
+
+// c over count pixels, weighted by a
+void blendSolid(Color* dst, int count, Color c, uint32_t a)
+{
+    if (count > 0) {
+        colorspan::blend({dst, static_cast<size_t>(count)}, Color(c.r, c.g, c.b, static_cast<uint8_t>(a)));
+    }
+}
+
+// c over count pixels, each weighted by its coverage (0..255) in mask
+void blendMask(Color* dst, const uint8_t* mask, int count, Color c)
+{
+    const Color opaque(c.r, c.g, c.b, uint8_t{255});
+    int i = 0;
+#if defined(COLORBLEND_SSE2)
+    using colorblend::blendLanes;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i src = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(c.r | (c.g << 8) | (c.b << 16) | 0xFF000000u)), zero);
+    const __m128i ca = _mm_set1_epi16(c.a);
+    for (; i + 4 <= count; i += 4) {
+        uint32_t m;
+        std::memcpy(&m, mask + i, 4);
+        if (m == 0) {
+            continue;
+        }
+        if (m == 0xFFFFFFFFu && c.a == 255) {
+            std::fill_n(dst + i, 4, opaque);
+            continue;
+        }
+        __m128i a = div255(_mm_mullo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(m)), zero), ca));
+        a = _mm_unpacklo_epi16(a, a);
+        __m128i* p = reinterpret_cast<__m128i*>(dst + i);
+        __m128i d = _mm_loadu_si128(p);
+        __m128i lo = blendLanes(_mm_unpacklo_epi8(d, zero), src, _mm_unpacklo_epi32(a, a));
+        __m128i hi = blendLanes(_mm_unpackhi_epi8(d, zero), src, _mm_unpackhi_epi32(a, a));
+        _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < count; i++) {
+        if (mask[i] != 0) {
+            blendPixel(dst[i], c, div255(mask[i] * c.a));
+        }
+    }
+}
+
+// Adds the edge's signed area to the rows [y0, y1) of acc, so a running sum
+// along a row gives each pixel's winding-weighted coverage, and widens each
+// row's [touched0, touched1) to the columns changed.  Columns are clamped to
+// [0, maxX]: everything left of the target lands in column 0
+void accumulate(float* acc, int stride, int y0, int y1, const RasterCanvas::Edge& e, float maxX,
+                int* touched0, int* touched1)
+{
+    if (e.y0 == e.y1) {
+        return;
+    }
+    float dir = 1;
+    float ex0 = e.x0, ey0 = e.y0, ex1 = e.x1, ey1 = e.y1;
+    if (ey0 > ey1) {
+        std::swap(ex0, ex1);
+        std::swap(ey0, ey1);
+        dir = -1;
+    }
+    float top = std::max(ey0, static_cast<float>(y0));
+    float bottom = std::min(ey1, static_cast<float>(y1));
+    if (top >= bottom) {
+        return;
+    }
+
+    float dxdy = (ex1 - ex0) / (ey1 - ey0);
+    float x = ex0 + (top - ey0) * dxdy;
+
+    for (int y = static_cast<int>(top); y < bottom; y++) {
+        float dy = std::min(static_cast<float>(y + 1), bottom) - std::max(static_cast<float>(y), top);
+        float xnext = x + dxdy * dy;
+        float d = dy * dir;
+        float* row = acc + (y - y0) * stride;
+
+        float xa = std::clamp(std::min(x, xnext), 0.0f, maxX);
+        float xb = std::clamp(std::max(x, xnext), 0.0f, maxX);
+        float xaFloor = std::floor(xa);
+        int xai = static_cast<int>(xaFloor);
+        float xbCeil = std::ceil(xb);
+        int xbi = static_cast<int>(xbCeil);
+        touched0[y - y0] = std::min(touched0[y - y0], xai);
+        touched1[y - y0] = std::max(touched1[y - y0], std::max(xai, xbi) + 1);
+
+        if (xbi <= xai + 1) {
+            // within one column: split by the mean x
+            float xm = 0.5f * (xa + xb) - xaFloor;
+            row[xai] += d - d * xm;
+            row[xai + 1] += d * xm;
+        }
+        else {
+            float s = 1 / (xb - xa);
+            float xaf = xa - xaFloor;
+            float a0 = 0.5f * s * (1 - xaf) * (1 - xaf);
+            float xbf = xb - xbCeil + 1;
+            float am = 0.5f * s * xbf * xbf;
+            row[xai] += d * a0;
+            if (xbi == xai + 2) {
+                row[xai + 1] += d * (1 - a0 - am);
+            }
+            else {
+                float a1 = s * (1.5f - xaf);
+                row[xai + 1] += d * (a1 - a0);
+                for (int xi = xai + 2; xi < xbi - 1; xi++) {
+                    row[xi] += d * s;
+                }
+                float a2 = a1 + (xbi - xai - 3) * s;
+                row[xbi - 1] += d * (1 - a2 - am);
+            }
+            row[xbi] += d * am;
+        }
+        x = xnext;
+    }
+}
+
+// how much of [i, i + 1) is inside [lo, hi)
+inline float overlap(int i, float lo, float hi)
+{
+    return std::clamp(std::min(i + 1.0f, hi) - std::max(static_cast<float>(i), lo), 0.0f, 1.0f);
+}
+
+inline uint32_t toCoverage(float f)
+{
+    return static_cast<uint32_t>(f * 255 + 0.5f);
+}
+
+void fillRect(Color* pixels, int stride, const RasterCanvas::Command& cmd, int y0, int y1)
+{
+    // columns wholly inside the rectangle; the rest are partly covered
+    int in0 = static_cast<int>(std::ceil(std::clamp(cmd.left, float(cmd.x0), float(cmd.x1))));
+    int in1 = static_cast<int>(std::floor(std::clamp(cmd.right, float(cmd.x0), float(cmd.x1))));
+    if (in0 >= in1) {
+        in0 = in1 = cmd.x1;
+    }
+
+    for (int y = y0; y < y1; y++) {
+        Color* row = pixels + y * stride;
+        float cy = overlap(y, cmd.top, cmd.bottom);
+        for (int x = cmd.x0; x < in0; x++) {
+            blendPixel(row[x], cmd.color, div255(toCoverage(overlap(x, cmd.left, cmd.right) * cy) * cmd.color.a));
+        }
+        blendSolid(row + in0, in1 - in0, cmd.color, div255(toCoverage(cy) * cmd.color.a));
+        for (int x = in1; x < cmd.x1; x++) {
+            blendPixel(row[x], cmd.color, div255(toCoverage(overlap(x, cmd.left, cmd.right) * cy) * cmd.color.a));
+        }
+    }
+}
+
+// Sums a row of acc from column x0 to x1 into coverage, clearing it, and
+// blends c over the pixels in [clip0, clip1) by it.  Between the columns
+// edges touched the coverage doesn't change, so runs of those are blended
+// as spans; outside [x0, x1) it's zero, the edges of a closed path cancelling
+void sweepRow(float* acc, int x0, int x1, Color* dst, int clip0, int clip1, Color c)
+{
+    float sum = 0;
+    int x = x0;
+    while (x < x1) {
+        int end = x;
+#if defined(COLORBLEND_SSE2)
+        while (end + 4 <= x1 && _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(acc + end), _mm_setzero_ps())) == 0xF) {
+            end += 4;
+        }
+#endif
+        while (end < x1 && acc[end] == 0) {
+            end++;
+        }
+        uint32_t a = div255(toCoverage(std::min(1.0f, std::abs(sum))) * c.a);
+        blendSolid(dst + std::max(x, clip0), std::min(end, clip1) - std::max(x, clip0), c, a);
+        for (x = end; x < x1 && acc[x] != 0; x++) {
+            sum += acc[x];
+            acc[x] = 0;
+            if (x >= clip0 && x < clip1) {
+                uint32_t a = div255(toCoverage(std::min(1.0f, std::abs(sum))) * c.a);
+                if (a != 0) {
+                    blendPixel(dst[x], c, a);
+                }
+            }
+        }
+    }
+}
+
+void drawImage(Color* pixels, int stride, const RasterCanvas::ImageDraw& d, int x0, int x1, int y0, int y1)
+{
+    const Color* src = d.img->getPixels();
+    int srcStride = d.img->width();
+    for (int y = y0; y < y1; y++) {
+        Color* row = pixels + y * stride;
+        double py = y + 0.5;
+        double u = d.ux * (x0 + 0.5) + d.uy * py + d.u0;
+        double v = d.vx * (x0 + 0.5) + d.vy * py + d.v0;
+        for (int x = x0; x < x1; x++, u += d.ux, v += d.vx) {
+            int sx = static_cast<int>(std::floor(u));
+            int sy = static_cast<int>(std::floor(v));
+            if (sx < d.srcX0 || sx >= d.srcX1 || sy < d.srcY0 || sy >= d.srcY1) {
+                continue;
+            }
+            Color c = src[sy * srcStride + sx];
+            uint32_t a = d.alpha == 255 ? c.a : div255(c.a * d.alpha);
+            if (a != 0) {
+                blendPixel(row[x], c, a);
+            }
+        }
+    }
+}
+
+inline int pixelFloor(float v, int limit)
+{
+    return static_cast<int>(std::floor(std::clamp(v, -1.0f, limit + 1.0f)));
+}
+
+inline int pixelCeil(float v, int limit)
+{
+    return static_cast<int>(std::ceil(std::clamp(v, -1.0f, limit + 1.0f)));
+}
+
+} // namespace
+
+RasterCanvas::RasterCanvas(Color* pixels, int width, int height, unsigned threads)
+    : pixels{pixels}, w{width}, h{height}, threads{threads}
+{
+    if (!pixels || w <= 0 || h <= 0) {
+        throw std::logic_error("RasterCanvas needs pixels to draw on");
+    }
+}
+
+RasterCanvas::RasterCanvas(Image& target, unsigned threads)
+    : pixels{nullptr}, w{target.width()}, h{target.height()}, threads{threads}, target{&target}
+{
+    if (!target.img || !target.img->getPixels()) {
+        throw std::logic_error("RasterCanvas can only draw on an image with cached pixels");
+    }
+    pixels = target.pixels();
+}
+
+RasterCanvas::~RasterCanvas()
+{
+    try {
+        flush();
+    }
+    catch (...) {
+        // nowhere to report it from here
+    }
+    if (fonts) {
+        fonsDeleteInternal(fonts);
+    }
+}
+
+void RasterCanvas::flush()
+{
+    if (commands.empty()) {
+        return;
+    }
+
+    if (fonts) {
+        int atlasHeight;
+        atlas = fonsGetTextureData(fonts, &atlasWidth, &atlasHeight);
+    }
+
+    const int stride = w + 2;
+    const int bands = (h + bandHeight - 1) / bandHeight;
+    unsigned workers = threads;
+    if (workers == 0) {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers = std::min<unsigned>(workers, bands);
+
+    // a band at a time for each thread, each with its own scratch space
+    if (coverage.size() < size_t(workers) * stride * bandHeight) {
+        coverage.assign(size_t(workers) * stride * bandHeight, 0.0f);
+    }
+
+    std::atomic<int> next{0};
+    std::exception_ptr error;
+    std::atomic<bool> failed{false};
+
+    auto work = [&](unsigned worker) {
+        float* acc = coverage.data() + size_t(worker) * stride * bandHeight;
+        for (int band = next++; band < bands && !failed; band = next++) {
+            try {
+                renderBand(band, acc);
+            }
+            catch (...) {
+                if (!failed.exchange(true)) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < workers; t++) {
+        pool.emplace_back(work, t);
+    }
+    work(0);
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    commands.clear();
+    edges.clear();
+    glyphs.clear();
+    images.clear();
+
+    if (target) {
+        target->pixels(); // all changed, as far as the image knows
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void RasterCanvas::renderBand(int band, float* acc)
+{
+    const int stride = w + 2;
+    const int by0 = band * bandHeight;
+    const int by1 = std::min(h, by0 + bandHeight);
+
+    for (const auto& cmd : commands) {
+        int y0 = std::max(cmd.y0, by0);
+        int y1 = std::min(cmd.y1, by1);
+        if (y0 >= y1) {
+            continue;
+        }
+
+        switch (cmd.kind) {
+        case Command::Kind::Clear:
+            for (int y = y0; y < y1; y++) {
+                std::fill_n(pixels + y * w + cmd.x0, cmd.x1 - cmd.x0, cmd.color);
+            }
+            break;
+        case Command::Kind::Rect:
+            fillRect(pixels, w, cmd, y0, y1);
+            break;
+        case Command::Kind::Path: {
+            int touched0[bandHeight];
+            int touched1[bandHeight];
+            std::fill_n(touched0, y1 - y0, stride);
+            std::fill_n(touched1, y1 - y0, 0);
+            for (uint32_t i = cmd.first; i < cmd.first + cmd.count; i++) {
+                accumulate(acc, stride, y0, y1, edges[i], static_cast<float>(w), touched0, touched1);
+            }
+            for (int y = y0; y < y1; y++) {
+                sweepRow(acc + (y - y0) * stride, touched0[y - y0], touched1[y - y0],
+                         pixels + y * w, cmd.x0, cmd.x1, cmd.color);
+            }
+            break;
+        }
+        case Command::Kind::Glyphs:
+            for (uint32_t i = cmd.first; i < cmd.first + cmd.count; i++) {
+                const Glyph& g = glyphs[i];
+                int gx0 = std::max(cmd.x0, g.x);
+                int gx1 = std::min(cmd.x1, g.x + g.w);
+                int gy0 = std::max(y0, g.y);
+                int gy1 = std::min(y1, g.y + g.h);
+                for (int y = gy0; y < gy1; y++) {
+                    const uint8_t* src = atlas + (g.atlasY + y - g.y) * atlasWidth + g.atlasX + gx0 - g.x;
+                    blendMask(pixels + y * w + gx0, src, gx1 - gx0, cmd.color);
+                }
+            }
+            break;
+        case Command::Kind::Image:
+            drawImage(pixels, w, images[cmd.first], cmd.x0, cmd.x1, y0, y1);
+            break;
+        }
+    }
+}
+
+void RasterCanvas::clipBounds(Command& cmd) const
+{
+    cmd.x0 = std::max(cmd.x0, 0);
+    cmd.y0 = std::max(cmd.y0, 0);
+    cmd.x1 = std::min(cmd.x1, w);
+    cmd.y1 = std::min(cmd.y1, h);
+    if (scissored) {
+        cmd.x0 = std::max(cmd.x0, scissor.x);
+        cmd.y0 = std::max(cmd.y0, scissor.y);
+        cmd.x1 = std::min(cmd.x1, scissor.x + scissor.w);
+        cmd.y1 = std::min(cmd.y1, scissor.y + scissor.h);
+    }
+}
+
+void RasterCanvas::beginPath()
+{
+    pathStart = static_cast<uint32_t>(edges.size());
+    pathLeft = pathTop = std::numeric_limits<float>::max();
+    pathRight = pathBottom = std::numeric_limits<float>::lowest();
+}
+
+void RasterCanvas::endPath(Color c)
+{
+    uint32_t count = static_cast<uint32_t>(edges.size()) - pathStart;
+    if (count == 0) {
+        return;
+    }
+    Command cmd{Command::Kind::Path, c,
+                pixelFloor(pathLeft, w), pixelFloor(pathTop, h), pixelCeil(pathRight, w), pixelCeil(pathBottom, h),
+                pathLeft, pathTop, pathRight, pathBottom, pathStart, count};
+    clipBounds(cmd);
+    if (cmd.x0 >= cmd.x1 || cmd.y0 >= cmd.y1) {
+        edges.resize(pathStart);
+        return;
+    }
+    commands.push_back(cmd);
+}
+
+void RasterCanvas::addEdge(Vec2d p0, Vec2d p1)
+{
+    Edge e{static_cast<float>(p0.x), static_cast<float>(p0.y), static_cast<float>(p1.x), static_cast<float>(p1.y)};
+    if (e.y0 == e.y1 || !std::isfinite(e.x0 + e.y0 + e.x1 + e.y1)) {
+        return; // adds nothing to any row
+    }
+    pathLeft = std::min({pathLeft, e.x0, e.x1});
+    pathRight = std::max({pathRight, e.x0, e.x1});
+    pathTop = std::min({pathTop, e.y0, e.y1});
+    pathBottom = std::max({pathBottom, e.y0, e.y1});
+    edges.push_back(e);
+}
+
+void RasterCanvas::addPolygon(const Vec2d* pts, size_t count, bool reversed)
+{
+    for (size_t i = 0; i < count; i++) {
+        size_t j = i + 1 == count ? 0 : i + 1;
+        if (reversed) {
+            addEdge(pts[j], pts[i]);
+        }
+        else {
+            addEdge(pts[i], pts[j]);
+        }
+    }
+}
+
+// A rectangle width wide along p0 to p1, lengthened by extend0 and extend1 to
+// fill the gaps where it joins others.  They all wind the same way, so they
+// don't cancel where they overlap
+void RasterCanvas::addSegment(Vec2d p0, Vec2d p1, double width, double extend0, double extend1)
+{
+    double dx = p1.x - p0.x;
+    double dy = p1.y - p0.y;
+    double len = std::sqrt(dx * dx + dy * dy);
+    if (len == 0) {
+        return;
+    }
+    dx /= len;
+    dy /= len;
+    p0 = {p0.x - dx * extend0, p0.y - dy * extend0};
+    p1 = {p1.x + dx * extend1, p1.y + dy * extend1};
+    double nx = -dy * width / 2;
+    double ny = dx * width / 2;
+    Vec2d quad[4] = { {p0.x + nx, p0.y + ny}, {p1.x + nx, p1.y + ny}, {p1.x - nx, p1.y - ny}, {p0.x - nx, p0.y - ny} };
+    addPolygon(quad, 4, false);
+}
+
+void RasterCanvas::fillPolygon(const Vec2d* pts, size_t count, Color fill)
+{
+    if (fill.a == 0 || count < 3) {
+        return;
+    }
+    beginPath();
+    addPolygon(pts, count, false);
+    endPath(fill);
+}
+
+void RasterCanvas::strokePolyline(const Vec2d* pts, size_t count, bool closed, Color c)
+{
+    if (c.a == 0 || count < 2) {
+        return;
+    }
+    beginPath();
+    size_t segments = closed ? count : count - 1;
+    for (size_t i = 0; i < segments; i++) {
+        bool joinedBefore = closed || i > 0;
+        bool joinedAfter = closed || i + 1 < segments;
+        addSegment(pts[i], pts[(i + 1) % count], 1, joinedBefore ? 0.5 : 0, joinedAfter ? 0.5 : 0);
+    }
+    endPath(c);
+}
+
+void RasterCanvas::shape(const Vec2d* pts, size_t count, Color border, Color fill, bool closed)
+{
+    if (closed) {
+        fillPolygon(pts, count, fill);
+    }
+    strokePolyline(pts, count, closed, border);
+}
+
+void RasterCanvas::ellipsePoints(Vec2d center, double w, double h, double a, double alen, bool withCenter)
+{
+    double rx = w / 2;
+    double ry = h / 2;
+    double r = std::max({std::abs(rx), std::abs(ry), curveTolerance});
+    double step = 2 * std::acos(std::max(-1.0, 1 - curveTolerance / r));
+    bool full = std::abs(alen) >= 2 * M_PI;
+    if (full) {
+        alen = 2 * M_PI;
+    }
+    int segments = std::clamp(static_cast<int>(std::ceil(std::abs(alen) / step)), full ? 8 : 1, 1024);
+
+    outlinePts.clear();
+    if (withCenter) {
+        outlinePts.push_back(center);
+    }
+    int last = full ? segments - 1 : segments;
+    for (int i = 0; i <= last; i++) {
+        double t = a + alen * i / segments;
+        outlinePts.push_back({center.x + rx * std::cos(t), center.y - ry * std::sin(t)});
+    }
+}
+
+void RasterCanvas::addPoints(const Vec2d* pts, size_t count, Color c)
+{
+    if (c.a == 0 || count == 0) {
+        return;
+    }
+    // the short thick line the NanoVG window draws for a point
+    beginPath();
+    for (size_t i = 0; i < count; i++) {
+        addSegment({pts[i].x - 1, pts[i].y - 1}, {pts[i].x + 1, pts[i].y + 1}, 3, 0, 0);
+    }
+    endPath(c);
+}
+
+// Draws the srcw x srch part of img at src, stretched to dw x dh and turned
+// by angle about center.  A negative size flips it
+void RasterCanvas::addImage(const Image& img, Vec2d center, double angle, double dw, double dh,
+                            Vec2d src, double srcw, double srch, double alpha)
+{
+    if (!img.img || !img.img->getPixels()) {
+        throw std::logic_error("RasterCanvas can only draw images with cached pixels");
+    }
+    auto a = static_cast<uint8_t>(std::lround(std::clamp(alpha, 0.0, 1.0) * 255));
+    if (a == 0 || dw == 0 || dh == 0 || srcw <= 0 || srch <= 0) {
+        return;
+    }
+
+    double cs = std::cos(angle);
+    double sn = std::sin(angle);
+
+    ImageDraw d;
+    d.img = img.img;
+    d.ux = cs * srcw / dw;
+    d.uy = sn * srcw / dw;
+    d.u0 = src.x + srcw / 2 - (center.x * d.ux + center.y * d.uy);
+    d.vx = -sn * srch / dh;
+    d.vy = cs * srch / dh;
+    d.v0 = src.y + srch / 2 - (center.x * d.vx + center.y * d.vy);
+    d.srcX0 = std::max(0, static_cast<int>(std::floor(src.x)));
+    d.srcY0 = std::max(0, static_cast<int>(std::floor(src.y)));
+    d.srcX1 = std::min(img.width(), static_cast<int>(std::ceil(src.x + srcw)));
+    d.srcY1 = std::min(img.height(), static_cast<int>(std::ceil(src.y + srch)));
+    d.alpha = a;
+    if (d.srcX0 >= d.srcX1 || d.srcY0 >= d.srcY1) {
+        return;
+    }
+
+    float ex = static_cast<float>(std::abs(cs * dw) / 2 + std::abs(sn * dh) / 2);
+    float ey = static_cast<float>(std::abs(sn * dw) / 2 + std::abs(cs * dh) / 2);
+    float cx = static_cast<float>(center.x);
+    float cy = static_cast<float>(center.y);
+    Command cmd{Command::Kind::Image, WHITE,
+                pixelFloor(cx - ex, w), pixelFloor(cy - ey, h), pixelCeil(cx + ex, w), pixelCeil(cy + ey, h),
+                cx - ex, cy - ey, cx + ex, cy + ey, static_cast<uint32_t>(images.size()), 1};
+    clipBounds(cmd);
+    if (cmd.x0 >= cmd.x1 || cmd.y0 >= cmd.y1) {
+        return;
+    }
+    images.push_back(std::move(d));
+    commands.push_back(cmd);
+}
+
+FONScontext* RasterCanvas::fontContext(const FontInfo& sizeAndFace)
+{
+    if (!fonts) {
+        FONSparams params{};
+        params.width = initialAtlasSize;
+        params.height = initialAtlasSize;
+        params.flags = FONS_ZERO_TOPLEFT;
+        fonts = fonsCreateInternal(&params);
+        if (!fonts) {
+            throw std::runtime_error("RasterCanvas couldn't create its font atlas");
+        }
+        fonsSetErrorCallback(fonts, [](void* canvas, int error, int) {
+            if (error == FONS_ATLAS_FULL) {
+                static_cast<RasterCanvas*>(canvas)->atlasFull();
+            }
+        }, this);
+        for (int i = 0; i < 3; i++) {
+            fontIds[i] = fonsAddFont(fonts, fontNames[i], Paths::findAsset(fontFiles[i]).c_str(), 0);
+            if (fontIds[i] == FONS_INVALID) {
+                throw std::runtime_error(std::string("RasterCanvas couldn't load ") + fontFiles[i]);
+            }
+        }
+    }
+
+    int face = sizeAndFace.getFaceIdx();
+    fonsSetFont(fonts, fontIds[face >= 0 && face < 3 ? face : 0]);
+    fonsSetSize(fonts, sizeAndFace.getSize());
+    return fonts;
+}
+
+// Grows the atlas while it can.  Once it can't, what's been drawn is
+// rendered so the atlas can start again
+void RasterCanvas::atlasFull()
+{
+    int aw, ah;
+    fonsGetAtlasSize(fonts, &aw, &ah);
+    if (aw < maxAtlasSize || ah < maxAtlasSize) {
+        fonsExpandAtlas(fonts, std::min(aw * 2, maxAtlasSize), std::min(ah * 2, maxAtlasSize));
+        return;
+    }
+    flush();
+    fonsResetAtlas(fonts, aw, ah);
+    atlasResets++;
+}
+
+bool RasterCanvas::isDrawable()
+{
+    return true;
+}
+
+int RasterCanvas::width()
+{
+    return w;
+}
+
+int RasterCanvas::height()
+{
+    return h;
+}
+
+void RasterCanvas::setBackground(Color c)
+{
+    // it covers everything drawn before
+    commands.clear();
+    edges.clear();
+    glyphs.clear();
+    images.clear();
+    commands.push_back(Command{Command::Kind::Clear, c, 0, 0, w, h, 0, 0, float(w), float(h), 0, 0});
+}
+
+void RasterCanvas::line(Vec2d p1, Vec2d p2, Color c)
+{
+    Vec2d pts[2] = { p1, p2 };
+    strokePolyline(pts, 2, false, c);
+}
+
+void RasterCanvas::ellipse(Vec2d center, double w, double h, Color c, Color f)
+{
+    if (f.a != 0) {
+        ellipsePoints(center, w, h, 0, 2 * M_PI, false);
+        fillPolygon(outlinePts.data(), outlinePts.size(), f);
+    }
+    if (c.a != 0) {
+        // a ring between ellipses half a pixel either side of the outline
+        w = std::abs(w);
+        h = std::abs(h);
+        beginPath();
+        ellipsePoints(center, w + 1, h + 1, 0, 2 * M_PI, false);
+        addPolygon(outlinePts.data(), outlinePts.size(), false);
+        ellipsePoints(center, w - 1, h - 1, 0, 2 * M_PI, false);
+        addPolygon(outlinePts.data(), outlinePts.size(), true);
+        endPath(c);
+    }
+}
+
+void RasterCanvas::arc(Vec2d center, double w, double h, double a, double alen, Color c)
+{
+    ellipsePoints(center, w, h, a, alen, false);
+    shape(outlinePts.data(), outlinePts.size(), c, TRANSPARENT, false);
+}
+
+void RasterCanvas::chord(Vec2d center, double w, double h, double a, double alen, Color c, Color f)
+{
+    ellipsePoints(center, w, h, a, alen, false);
+    shape(outlinePts.data(), outlinePts.size(), c, f, true);
+}
+
+void RasterCanvas::pie(Vec2d center, double w, double h, double a, double alen, Color c, Color f)
+{
+    ellipsePoints(center, w, h, a, alen, true);
+    shape(outlinePts.data(), outlinePts.size(), c, f, true);
+}
+
+void RasterCanvas::rect(Vec2d corner, double w, double h, Color c, Color f)
+{
+    double x0 = std::min(corner.x, corner.x + w);
+    double y0 = std::min(corner.y, corner.y + h);
+    double x1 = std::max(corner.x, corner.x + w);
+    double y1 = std::max(corner.y, corner.y + h);
+
+    if (f.a != 0) {
+        float l = static_cast<float>(x0);
+        float t = static_cast<float>(y0);
+        float r = static_cast<float>(x1);
+        float b = static_cast<float>(y1);
+        Command cmd{Command::Kind::Rect, f, pixelFloor(l, this->w), pixelFloor(t, this->h),
+                    pixelCeil(r, this->w), pixelCeil(b, this->h), l, t, r, b, 0, 0};
+        clipBounds(cmd);
+        if (cmd.x0 < cmd.x1 && cmd.y0 < cmd.y1) {
+            commands.push_back(cmd);
+        }
+    }
+    if (c.a != 0) {
+        // a ring between rectangles half a pixel either side of the outline
+        Vec2d outer[4] = { {x0 - 0.5, y0 - 0.5}, {x1 + 0.5, y0 - 0.5}, {x1 + 0.5, y1 + 0.5}, {x0 - 0.5, y1 + 0.5} };
+        Vec2d inner[4] = { {x0 + 0.5, y0 + 0.5}, {x1 - 0.5, y0 + 0.5}, {x1 - 0.5, y1 - 0.5}, {x0 + 0.5, y1 - 0.5} };
+        beginPath();
+        addPolygon(outer, 4, false);
+        addPolygon(inner, 4, true);
+        endPath(c);
+    }
+}
+
+void RasterCanvas::polygon(const std::vector<Vec2d> &points, Color border, Color fill)
+{
+    shape(points.data(), points.size(), border, fill, true);
+}
+
+void RasterCanvas::polyline(const std::vector<Vec2d> &points, Color color)
+{
+    shape(points.data(), points.size(), color, TRANSPARENT, false);
+}
+
+void RasterCanvas::points(const std::vector<Vec2d> &points, Color c)
+{
+    addPoints(points.data(), points.size(), c);
+}
+
+#ifdef SUPPORT_MSSM_ARRAY
+void RasterCanvas::polygon(const Array<Vec2d> &pts, Color border, Color fill)
+{
+    polygon(pts.asVector(), border, fill);
+}
+
+void RasterCanvas::polyline(const Array<Vec2d> &pts, Color color)
+{
+    polyline(pts.asVector(), color);
+}
+
+void RasterCanvas::points(const Array<Vec2d> &pts, Color c)
+{
+    points(pts.asVector(), c);
+}
+#endif
+
+void RasterCanvas::polygon(std::initializer_list<Vec2d> pts, Color border, Color fill)
+{
+    shape(pts.begin(), pts.size(), border, fill, true);
+}
+
+void RasterCanvas::polyline(std::initializer_list<Vec2d> pts, Color color)
+{
+    shape(pts.begin(), pts.size(), color, TRANSPARENT, false);
+}
+
+void RasterCanvas::points(std::initializer_list<Vec2d> pts, Color c)
+{
+    addPoints(pts.begin(), pts.size(), c);
+}
+
+void RasterCanvas::text(Vec2d pos, const FontInfo &sizeAndFace, const string &str, Color textColor, HAlign hAlign, VAlign vAlign)
+{
+    if (textColor.a == 0 || str.empty()) {
+        return;
+    }
+    FONScontext* fs = fontContext(sizeAndFace);
+    fonsSetAlign(fs, static_cast<int>(hAlign) | static_cast<int>(vAlign));
+
+    // glyphs are placed in the atlas as they're met; if that means starting
+    // the atlas again, the ones already met are gone, so start again too
+    for (;;) {
+        int resets = atlasResets;
+        auto first = static_cast<uint32_t>(glyphs.size());
+        int x0 = std::numeric_limits<int>::max();
+        int y0 = std::numeric_limits<int>::max();
+        int x1 = std::numeric_limits<int>::min();
+        int y1 = std::numeric_limits<int>::min();
+
+        FONStextIter iter;
+        FONSquad q;
+        fonsTextIterInit(fs, &iter, pos.x, pos.y, str.c_str(), str.c_str() + str.size(), FONS_GLYPH_BITMAP_REQUIRED);
+        while (fonsTextIterNext(fs, &iter, &q)) {
+            if (iter.prevGlyphIndex == -1 || q.x1 <= q.x0 || q.y1 <= q.y0) {
+                continue; // no glyph, or nothing to draw
+            }
+            int aw, ah;
+            fonsGetAtlasSize(fs, &aw, &ah);
+            Glyph g{static_cast<int>(q.x0), static_cast<int>(q.y0),
+                    static_cast<int>(q.x1 - q.x0), static_cast<int>(q.y1 - q.y0),
+                    static_cast<int>(std::lround(q.s0 * aw)), static_cast<int>(std::lround(q.t0 * ah))};
+            glyphs.push_back(g);
+            x0 = std::min(x0, g.x);
+            y0 = std::min(y0, g.y);
+            x1 = std::max(x1, g.x + g.w);
+            y1 = std::max(y1, g.y + g.h);
+        }
+
+        if (resets != atlasResets) {
+            glyphs.clear(); // the flush took everything from before
+            continue;
+        }
+
+        auto count = static_cast<uint32_t>(glyphs.size()) - first;
+        if (count == 0) {
+            return;
+        }
+        Command cmd{Command::Kind::Glyphs, textColor, x0, y0, x1, y1,
+                    float(x0), float(y0), float(x1), float(y1), first, count};
+        clipBounds(cmd);
+        if (cmd.x0 >= cmd.x1 || cmd.y0 >= cmd.y1) {
+            glyphs.resize(first);
+            return;
+        }
+        commands.push_back(cmd);
+        return;
+    }
+}
+
+void RasterCanvas::textExtents(const FontInfo &sizeAndFace, const string &str, TextExtents &extents)
+{
+    float metrics[4];
+
+    FONScontext* fs = fontContext(sizeAndFace);
+    fonsSetAlign(fs, FONS_ALIGN_LEFT | FONS_ALIGN_BASELINE);
+    auto s = str.c_str();
+    float advance = fonsTextBounds(fs, 0, 0, s, s + str.length(), metrics);
+
+    extents.textHeight = metrics[3] - metrics[1];  // ymax-ymin
+    extents.textWidth  = metrics[2] - metrics[0];  // xmax-xmin
+
+    extents.textAdvance = advance;
+    fonsVertMetrics(fs, &extents.fontAscent, &extents.fontDescent, &extents.fontHeight);
+}
+
+double RasterCanvas::textWidth(const FontInfo &sizeAndFace, const string &str)
+{
+    float metrics[4];
+
+    FONScontext* fs = fontContext(sizeAndFace);
+    fonsSetAlign(fs, FONS_ALIGN_LEFT | FONS_ALIGN_BASELINE);
+    auto s = str.c_str();
+    fonsTextBounds(fs, 0, 0, s, s + str.length(), metrics);
+
+    return metrics[2] - metrics[0];  // xmax-xmin
+}
+
+std::vector<double> RasterCanvas::getCharacterXOffsets(const FontInfo &sizeAndFace, double startX, const std::string &text)
+{
+    FONScontext* fs = fontContext(sizeAndFace);
+    fonsSetAlign(fs, FONS_ALIGN_LEFT | FONS_ALIGN_BASELINE);
+
+    std::string measured = text + '_'; // Add a char at the end to get the last character's x position
+
+    std::vector<double> xOffsets;
+    FONStextIter iter;
+    FONSquad q;
+    fonsTextIterInit(fs, &iter, startX, 0, measured.c_str(), measured.c_str() + measured.size(), FONS_GLYPH_BITMAP_OPTIONAL);
+    while (fonsTextIterNext(fs, &iter, &q)) {
+        xOffsets.push_back(iter.x);
+    }
+
+    return xOffsets;
+}
+
+void RasterCanvas::point(Vec2d pos, Color c)
+{
+    addPoints(&pos, 1, c);
+}
+
+void RasterCanvas::image(Vec2d pos, const Image &img, double alpha)
+{
+    image(pos, img.width(), img.height(), img, {0, 0}, img.width(), img.height(), alpha);
+}
+
+void RasterCanvas::image(Vec2d pos, const Image &img, Vec2d src, int srcw, int srch, double alpha)
+{
+    image(pos, srcw, srch, img, src, srcw, srch, alpha);
+}
+
+void RasterCanvas::image(Vec2d pos, double w, double h, const Image &img, double alpha)
+{
+    image(pos, w, h, img, {0, 0}, img.width(), img.height(), alpha);
+}
+
+void RasterCanvas::image(Vec2d pos, double w, double h, const Image &img, Vec2d src, int srcw, int srch, double alpha)
+{
+    addImage(img, {pos.x + std::abs(w) / 2, pos.y + std::abs(h) / 2}, 0, w, h, src, srcw, srch, alpha);
+}
+
+void RasterCanvas::imageC(Vec2d center, double angle, const Image &img, double alpha)
+{
+    addImage(img, center, angle, img.width(), img.height(), {0, 0}, img.width(), img.height(), alpha);
+}
+
+void RasterCanvas::imageC(Vec2d center, double angle, const Image &img, Vec2d src, int srcw, int srch, double alpha)
+{
+    addImage(img, center, angle, srcw, srch, src, srcw, srch, alpha);
+}
+
+void RasterCanvas::imageC(Vec2d center, double angle, double w, double h, const Image &img, double alpha)
+{
+    addImage(img, center, angle, w, h, {0, 0}, img.width(), img.height(), alpha);
+}
+
+void RasterCanvas::imageC(Vec2d center, double angle, double w, double h, const Image &img, Vec2d src, int srcw, int srch, double alpha)
+{
+    addImage(img, center, angle, w, h, src, srcw, srch, alpha);
+}
+
+bool RasterCanvas::isClipped(Vec2d pos) const
+{
+    if (clipRects.empty()) {
+        return false;
+    }
+    auto& clip = clipRects.back();
+    return pos.x < clip.x ||
+           pos.y < clip.y ||
+           pos.x >= clip.x + clip.w ||
+           pos.y >= clip.y + clip.h;
+}
+
+void RasterCanvas::pushClip(int x, int y, int w, int h, bool replace)
+{
+    w = std::max(0, w);
+    h = std::max(0, h);
+    Scissor rect = {x, y, w, h};
+    if (!replace && !clipRects.empty()) {
+        // intersect with current clip
+        Scissor& prev = clipRects.back();
+        rect.x = std::max(prev.x, x);
+        rect.y = std::max(prev.y, y);
+        rect.w = std::max(0, std::min(prev.x + prev.w, x + w) - rect.x);
+        rect.h = std::max(0, std::min(prev.y + prev.h, y + h) - rect.y);
+    }
+    clipRects.push_back(rect);
+    setClip(rect.x, rect.y, rect.w, rect.h);
+}
+
+void RasterCanvas::popClip()
+{
+    clipRects.pop_back();
+    if (clipRects.empty()) {
+        resetClip();
+    }
+    else {
+        auto& rect = clipRects.back();
+        setClip(rect.x, rect.y, rect.w, rect.h);
+    }
+}
+
+void RasterCanvas::setClip(int x, int y, int w, int h)
+{
+    scissor = {x, y, std::max(0, w), std::max(0, h)};
+    scissored = true;
+}
+
+void RasterCanvas::resetClip()
+{
+    scissored = false;
+}
+
+void RasterCanvas::setViewport(int /*x*/, int /*y*/, int /*w*/, int /*h*/)
+{
+}
+
+void RasterCanvas::resetViewport()
+{
+}
+
+void RasterCanvas::pushGroup(std::string /*groupName*/)
+{
+}
+
+void RasterCanvas::popGroup()
+{
+}
+
+void RasterCanvas::polygonPattern(const std::vector<Vec2d> &/*points*/, Color /*c*/, Color /*f*/)
+{
+    throw std::logic_error("Not implemented");
+}
+
+void RasterCanvas::polygonPattern(std::initializer_list<Vec2d> /*points*/, Color /*c*/, Color /*f*/)
+{
+    throw std::logic_error("Not implemented");
+}
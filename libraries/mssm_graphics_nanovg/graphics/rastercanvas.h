@@ -0,0 +1,188 @@
+#ifndef RASTERCANVAS_H
+#define RASTERCANVAS_H
+
+#include "canvas2d.h"
+#include "image.h"
+#include <memory>
+
+struct FONScontext;
+
+namespace mssm {
+
+    // Draws into a buffer of pixels on the CPU, for rendering without a GPU:
+    // thumbnails, server side rendering, and tests that compare pixels.
+    //
+    // Drawing is recorded, then rasterized by flush() (or the destructor) in
+    // bands of rows shared out between threads.  Shapes are antialiased from
+    // their exact coverage of each pixel, with the nonzero fill rule; outlines
+    // and lines are a pixel wide, like the NanoVG window draws them.  Text uses
+    // the same Roboto fonts through fontstash.  Images need cached pixels, and
+    // are sampled nearest neighbour.
+    //
+    // Colours are blended by their alpha, which is exact over an opaque
+    // background.  The result doesn't depend on the number of threads, or on
+    // whether SIMD was used.
+    class RasterCanvas : public mssm::Canvas2d
+    {
+        struct Scissor {
+            int x;
+            int y;
+            int w;
+            int h;
+        };
+
+    public:
+        struct Edge {
+            float x0;
+            float y0;
+            float x1;
+            float y1;
+        };
+
+        // a glyph's coverage, copied from the font atlas
+        struct Glyph {
+            int x;
+            int y;
+            int w;
+            int h;
+            int atlasX;
+            int atlasY;
+        };
+
+        struct ImageDraw {
+            std::shared_ptr<ImageInternal> img;
+            // source pixel coordinates of a destination pixel's centre (x, y)
+            // are (ux*x + uy*y + u0, vx*x + vy*y + v0)
+            double ux, uy, u0;
+            double vx, vy, v0;
+            int srcX0, srcY0, srcX1, srcY1;
+            uint8_t alpha;
+        };
+
+        struct Command {
+            enum class Kind : uint8_t { Clear, Rect, Path, Glyphs, Image };
+            Kind kind;
+            Color color;
+            // the pixels it may touch, clipped: [x0, x1) x [y0, y1)
+            int x0, y0, x1, y1;
+            // Rect: the rectangle.  Path: the bounds of its edges
+            float left, top, right, bottom;
+            // into edges, glyphs or images
+            uint32_t first;
+            uint32_t count;
+        };
+
+    private:
+        Color* pixels;
+        int w;
+        int h;
+        unsigned threads;
+        Image* target{nullptr};
+
+        std::vector<Command> commands;
+        std::vector<Edge> edges;
+        std::vector<Glyph> glyphs;
+        std::vector<ImageDraw> images;
+
+        std::vector<Scissor> clipRects;
+        Scissor scissor;
+        bool scissored{false};
+
+        FONScontext* fonts{nullptr};
+        int fontIds[3];
+        int atlasResets{0};
+
+        // the path being added
+        uint32_t pathStart{0};
+        float pathLeft, pathTop, pathRight, pathBottom;
+
+        // the font atlas as it was at the start of flush
+        const uint8_t* atlas{nullptr};
+        int atlasWidth{0};
+
+        // scratch space, kept to save allocating it for each shape or flush
+        std::vector<Vec2d> outlinePts;
+        std::vector<float> coverage; // a band's worth per thread, zero between paths
+
+    public:
+        // threads = 0 uses one per core
+        RasterCanvas(Color* pixels, int width, int height, unsigned threads = 0);
+        // draws into target's cached pixels; updatePixels() then shows them
+        RasterCanvas(Image& target, unsigned threads = 0);
+        ~RasterCanvas();
+
+        RasterCanvas(const RasterCanvas&) = delete;
+        RasterCanvas& operator=(const RasterCanvas&) = delete;
+
+        // rasterize everything drawn since the last flush
+        void flush();
+
+    private:
+        void clipBounds(Command& cmd) const;
+        void beginPath();
+        void endPath(Color c);
+        void addEdge(Vec2d p0, Vec2d p1);
+        void addPolygon(const Vec2d* pts, size_t count, bool reversed);
+        void addSegment(Vec2d p0, Vec2d p1, double width, double extend0, double extend1);
+        void fillPolygon(const Vec2d* pts, size_t count, Color fill);
+        void strokePolyline(const Vec2d* pts, size_t count, bool closed, Color c);
+        void shape(const Vec2d* pts, size_t count, Color border, Color fill, bool closed);
+        void ellipsePoints(Vec2d center, double w, double h, double a, double alen, bool withCenter);
+        void addPoints(const Vec2d* pts, size_t count, Color c);
+        void addImage(const Image& img, Vec2d center, double angle, double dw, double dh,
+                      Vec2d src, double srcw, double srch, double alpha);
+        FONScontext* fontContext(const FontInfo& sizeAndFace);
+        void atlasFull();
+        void renderBand(int band, float* acc);
+
+        // Canvas interface
+    public:
+        virtual bool isDrawable() override;
+        virtual int width() override;
+        virtual int height() override;
+        virtual void setBackground(Color c) override;
+        virtual void line(Vec2d p1, Vec2d p2, Color c) override;
+        virtual void ellipse(Vec2d center, double w, double h, Color c, Color f) override;
+        virtual void arc(Vec2d center, double w, double h, double a, double alen, Color c) override;
+        virtual void chord(Vec2d center, double w, double h, double a, double alen, Color c, Color f) override;
+        virtual void pie(Vec2d center, double w, double h, double a, double alen, Color c, Color f) override;
+        virtual void rect(Vec2d corner, double w, double h, Color c, Color f) override;
+        virtual void polygon(const std::vector<Vec2d> &points, Color border, Color fill) override;
+        virtual void polyline(const std::vector<Vec2d> &points, Color color) override;
+        virtual void points(const std::vector<Vec2d> &points, Color c) override;
+#ifdef SUPPORT_MSSM_ARRAY
+        virtual void polygon(const Array<Vec2d> &points, Color border, Color fill) override;
+        virtual void polyline(const Array<Vec2d> &points, Color color) override;
+        virtual void points(const Array<Vec2d> &points, Color c) override;
+#endif
+        virtual void polygon(std::initializer_list<Vec2d> points, Color border, Color fill) override;
+        virtual void polyline(std::initializer_list<Vec2d> points, Color color) override;
+        virtual void points(std::initializer_list<Vec2d> points, Color c) override;
+        virtual void text(Vec2d pos, const FontInfo &sizeAndFace, const std::string &str, Color textColor, HAlign hAlign, VAlign vAlign) override;
+        virtual void textExtents(const FontInfo &sizeAndFace, const std::string &str, TextExtents &extents) override;
+        virtual double textWidth(const FontInfo &sizeAndFace, const std::string &str) override;
+        virtual std::vector<double> getCharacterXOffsets(const FontInfo &sizeAndFace, double startX, const std::string &text) override;
+        virtual void point(Vec2d pos, Color c) override;
+        virtual void image(Vec2d pos, const Image &img, double alpha = 1.0) override;
+        virtual void image(Vec2d pos, const Image &img, Vec2d src, int srcw, int srch, double alpha = 1.0) override;
+        virtual void image(Vec2d pos, double w, double h, const Image &img, double alpha = 1.0) override;
+        virtual void image(Vec2d pos, double w, double h, const Image &img, Vec2d src, int srcw, int srch, double alpha = 1.0) override;
+        virtual void imageC(Vec2d center, double angle, const Image &img, double alpha = 1.0) override;
+        virtual void imageC(Vec2d center, double angle, const Image &img, Vec2d src, int srcw, int srch, double alpha = 1.0) override;
+        virtual void imageC(Vec2d center, double angle, double w, double h, const Image &img, double alpha = 1.0) override;
+        virtual void imageC(Vec2d center, double angle, double w, double h, const Image &img, Vec2d src, int srcw, int srch, double alpha = 1.0) override;
+        virtual bool isClipped(Vec2d pos) const override;
+        virtual void pushClip(int x, int y, int w, int h, bool replace) override;
+        virtual void popClip() override;
+        virtual void setClip(int x, int y, int w, int h) override;
+        virtual void resetClip() override;
+        virtual void setViewport(int x, int y, int w, int h) override;
+        virtual void resetViewport() override;
+        virtual void pushGroup(std::string groupName) override;
+        virtual void popGroup() override;
+        virtual void polygonPattern(const std::vector<Vec2d> &points, Color c, Color f) override;
+        virtual void polygonPattern(std::initializer_list<Vec2d> points, Color c, Color f) override;
+    };
+}
+
+#endif // RASTERCANVAS_H
@@ -46,19 +46,64 @@ using namespace mssm;
 #undef max
 #undef min
 
-int nvgCreateImageCache(NVGcontext* ctx, unsigned char*& cachedImg, const char* filename, int imageFlags)
+int TexturePoolVG::create(int width, int height, int flags, const unsigned char* rgba)
 {
-    int w, h, n, image;
-    stbi_set_unpremultiply_on_load(1);
-    stbi_convert_iphone_png_to_rgb(1);
-    cachedImg = stbi_load(filename, &w, &h, &n, 4);
-    if (cachedImg == NULL) {
-        //		printf("Failed to load %s - %s\n", filename, stbi_failure_reason());
-        return 0;
+    // mipmaps aren't regenerated by nvgUpdateImage
+    if (!(flags & NVG_IMAGE_GENERATE_MIPMAPS)) {
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->releasedFrame + framesInFlight > frame) {
+                break; // the rest were released more recently
+            }
+            if (it->width == width && it->height == height && it->flags == flags) {
+                int idx = it->idx;
+                bytes -= size_t(width) * height * 4;
+                entries.erase(it);
+                nvgUpdateImage(vg, idx, rgba);
+                return idx;
+            }
+        }
+    }
+    return nvgCreateImageRGBA(vg, width, height, flags, rgba);
+}
+
+void TexturePoolVG::release(int idx, int width, int height, int flags)
+{
+    if (!vg) {
+        return; // the context, and its textures, are gone
+    }
+    if (flags & NVG_IMAGE_GENERATE_MIPMAPS) {
+        nvgDeleteImage(vg, idx);
+        return;
+    }
+    entries.push_back({idx, width, height, flags, frame});
+    bytes += size_t(width) * height * 4;
+    while (bytes > maxBytes) {
+        deleteOldest();
+    }
+}
+
+void TexturePoolVG::endFrame()
+{
+    frame++;
+    while (!entries.empty() && entries.front().releasedFrame + maxIdleFrames < frame) {
+        deleteOldest();
     }
-    image = nvgCreateImageRGBA(ctx, w, h, imageFlags, cachedImg);
-    //stbi_image_free(img);
-    return image;
+}
+
+void TexturePoolVG::detach()
+{
+    while (!entries.empty()) {
+        deleteOldest();
+    }
+    vg = nullptr;
+}
+
+void TexturePoolVG::deleteOldest()
+{
+    auto& entry = entries.front();
+    nvgDeleteImage(vg, entry.idx);
+    bytes -= size_t(entry.width) * entry.height * 4;
+    entries.pop_front();
 }
 
 // void Image::set(int width, int height, Color c, bool cachePixels)
@@ -81,23 +126,25 @@ int nvgCreateImageCache(NVGcontext* ctx, unsigned char*& cachedImg, const char*
 std::shared_ptr<mssm::ImageInternal> NanovgWindow::loadImg(std::string filename, bool cachePixels)
 {
     auto fpath = Paths::findAsset(filename);
-    unsigned char* cachedImage = nullptr;
-    int idx;
 
-    if (cachePixels) {
-        idx = nvgCreateImageCache(vg, cachedImage, fpath.c_str(), 0);
-    }
-    else {
-        idx = nvgCreateImage(vg, fpath.c_str(), 0);
-    }
+    int w;
+    int h;
+    int n;
+    stbi_set_unpremultiply_on_load(1);
+    stbi_convert_iphone_png_to_rgb(1);
+    unsigned char* loaded = stbi_load(fpath.c_str(), &w, &h, &n, 4);
+
+    int idx = loaded ? texturePool->create(w, h, 0, loaded) : 0;
 
     if (idx) {
-        int w;
-        int h;
-        nvgImageSize(vg, idx, &w, &h);
-        return std::make_shared<ImageInternalVG>(vg, idx, w, h, reinterpret_cast<Color*>(cachedImage));
+        if (!cachePixels) {
+            stbi_image_free(loaded);
+            loaded = nullptr;
+        }
+        return std::make_shared<ImageInternalVG>(texturePool, idx, w, h, 0, reinterpret_cast<Color*>(loaded));
     }
     else {
+        stbi_image_free(loaded);
         throw std::runtime_error("failed to load texture image!");
         // if (cachedImage) {
         //     stbi_image_free(cachedImage);
@@ -117,9 +164,9 @@ std::shared_ptr<ImageInternal> NanovgWindow::createImg(int width,
         pixels[i] = c;
     }
 
-    int idx = nvgCreateImageRGBA(vg, width, height, NVG_IMAGE_NEAREST, reinterpret_cast<const unsigned char*>(pixels));
+    int idx = texturePool->create(width, height, NVG_IMAGE_NEAREST, reinterpret_cast<const unsigned char*>(pixels));
 
-    auto img = std::make_shared<ImageInternalVG>(vg, idx, width, height, cachePixels ? pixels : nullptr);
+    auto img = std::make_shared<ImageInternalVG>(texturePool, idx, width, height, NVG_IMAGE_NEAREST, cachePixels ? pixels : nullptr);
 
     if (!cachePixels) {
         free(pixels);
@@ -133,9 +180,9 @@ std::shared_ptr<ImageInternal> NanovgWindow::initImg(int width,
                                                      mssm::Color *pixels,
                                                      bool cachePixels)
 {
-    int idx = nvgCreateImageRGBA(vg, width, height, NVG_IMAGE_NEAREST, reinterpret_cast<const unsigned char*>(pixels));
+    int idx = texturePool->create(width, height, NVG_IMAGE_NEAREST, reinterpret_cast<const unsigned char*>(pixels));
 
-    auto img = std::make_shared<ImageInternalVG>(vg, idx, width, height, cachePixels ? pixels : nullptr);
+    auto img = std::make_shared<ImageInternalVG>(texturePool, idx, width, height, NVG_IMAGE_NEAREST, cachePixels ? pixels : nullptr);
 
     if (!cachePixels) {
         delete [] pixels;
@@ -152,9 +199,7 @@ void NanovgWindow::saveImg(std::shared_ptr<mssm::ImageInternal> img, std::string
 
 void NanovgWindow::queueForDestruction(std::shared_ptr<mssm::ImageInternal> img)
 {
-  //  std::cout << "Not implemented NanovgWindow::queueForDestruction" << std::endl;
-    // TODO: what should we do here
-//    throw std::logic_error("Not implemented NanovgWindow::queueForDestruction");
+    destructionQueue.push_back(img);
 }
 
 void NanovgWindow::polygonPattern(const std::vector<Vec2d> &points, mssm::Color c, mssm::Color f)
@@ -184,8 +229,8 @@ void NanovgWindow::setBackground(mssm::Color c)
 
 }
 
-ImageInternalVG::ImageInternalVG(NVGcontext* vg, int idx, int width, int height, Color *cached)
-    : vg{vg}, vgImageIdx{idx}
+ImageInternalVG::ImageInternalVG(std::shared_ptr<TexturePoolVG> pool, int idx, int width, int height, int flags, Color *cached)
+    : pool{pool}, vgImageIdx{idx}, flags{flags}
 {
     w = width;
     h = height;
@@ -195,7 +240,7 @@ ImageInternalVG::ImageInternalVG(NVGcontext* vg, int idx, int width, int height,
 ImageInternalVG::~ImageInternalVG()
 {
     if (vgImageIdx) {
-        nvgDeleteImage(vg, vgImageIdx);
+        pool->release(vgImageIdx, w, h, flags);
     }
     freeCachedPixels();
 }
@@ -209,11 +254,28 @@ void ImageInternalVG::freeCachedPixels()
 }
 
 void ImageInternalVG::updatePixels()
+{
+    if (!hasDirty()) {
+        markDirty(0, 0, w, h); // changed some way that wasn't tracked
+    }
+    updatePixels(dirtyX0, dirtyY0, dirtyX1 - dirtyX0, dirtyY1 - dirtyY0);
+}
+
+void ImageInternalVG::updatePixels(int x, int y, int width, int height)
 {
     if (!pixels) {
         throw std::logic_error("Cannot updatePixels unless image pixels are cached!");
     }
-    nvgUpdateImage(vg, vgImageIdx, reinterpret_cast<const unsigned char*>(pixels));
+    clearDirty();
+
+    int x1 = std::min(x + width, w);
+    int y1 = std::min(y + height, h);
+    x = std::max(x, 0);
+    y = std::max(y, 0);
+    if (x >= x1 || y >= y1 || !pool->context()) {
+        return;
+    }
+    nvgUpdateImageRegion(pool->context(), vgImageIdx, x, y, x1 - x, y1 - y, reinterpret_cast<const unsigned char*>(pixels));
 }
 
 NanovgWindow::NanovgWindow(std::string title, int width, int height)
@@ -225,6 +287,10 @@ NanovgWindow::NanovgWindow(std::string title, int width, int height)
 NanovgWindow::~NanovgWindow()
 {
     keepImages.clear();
+    destructionQueue.clear();
+    if (texturePool) {
+        texturePool->detach();
+    }
     nvgDeleteGL3(vg);
 #ifdef INCLUDE_SOUND
     soundPlayer.deinit();
@@ -317,6 +383,8 @@ void NanovgWindow::configure()
         return;
     }
 
+    texturePool = std::make_shared<TexturePoolVG>(vg);
+
     fontRegular = nvgCreateFont(vg, "sans", Paths::findAsset("Roboto-Regular.ttf").c_str());
     if (fontRegular == -1) {
         printf("Could not add font italic.\n");
@@ -333,11 +401,13 @@ void NanovgWindow::configure()
 
 void NanovgWindow::setClip(int x, int y, int w, int h)
 {
+    flushBatch();
     nvgScissor(vg, x, y, w, h);
 }
 
 void NanovgWindow::resetClip()
 {
+    flushBatch();
     nvgResetScissor(vg);
 }
 
@@ -514,15 +584,93 @@ bool NanovgWindow::beginDrawing(bool wasResized)
 
     nvgBeginFrame(vg, winWidth, winHeight, pxRatio);
 
+    // nvgBeginFrame resets the fill and stroke
+    fillColorSet = false;
+    strokeColorSet = false;
+    strokeWidth = -1;
+
     return true;
 }
 
 void NanovgWindow::endDrawing(bool isClosing)
 {
+    flushBatch();
+
+    auto gl = static_cast<GLNVGcontext*>(nvgInternalParams(vg)->userPtr);
+
+    lastFrameStats.paths = gl->npaths;
+    lastFrameStats.calls = gl->ncalls;
 
     nvgEndFrame(vg);
 
+    lastFrameStats.glDraws = gl->drawCalls;
+
     keepImages.clear();
+    destructionQueue.clear();
+    texturePool->endFrame();
+}
+
+void NanovgWindow::setFillColor(Color c)
+{
+    if (!fillColorSet || fillColor != c) {
+        nvgFillColor(vg, nvgRGBA(c.r, c.g, c.b, c.a));
+        fillColor = c;
+        fillColorSet = true;
+    }
+}
+
+void NanovgWindow::setStrokeColor(Color c)
+{
+    if (!strokeColorSet || strokeColor != c) {
+        nvgStrokeColor(vg, nvgRGBA(c.r, c.g, c.b, c.a));
+        strokeColor = c;
+        strokeColorSet = true;
+    }
+}
+
+void NanovgWindow::setStrokeWidth(float width)
+{
+    if (strokeWidth != width) {
+        nvgStrokeWidth(vg, width);
+        strokeWidth = width;
+    }
+}
+
+// Start adding to a batch of this kind and colour, unless that's the one
+// already being added to
+void NanovgWindow::batchPath(Batch kind, Color c)
+{
+    if (batch != kind || batchColor != c) {
+        flushBatch();
+        nvgBeginPath(vg);
+        batch = kind;
+        batchColor = c;
+    }
+}
+
+void NanovgWindow::flushBatch()
+{
+    switch (batch) {
+    case Batch::None:
+        return;
+    case Batch::Fill:
+        setFillColor(batchColor);
+        nvgFill(vg);
+        break;
+    case Batch::FillStroke:
+        setFillColor(batchColor);
+        nvgFill(vg);
+        setStrokeWidth(1);
+        setStrokeColor(batchColor);
+        nvgStroke(vg);
+        break;
+    case Batch::Points:
+        setStrokeWidth(3);
+        setStrokeColor(batchColor);
+        nvgStroke(vg);
+        break;
+    }
+    batch = Batch::None;
 }
 
 // bool NanovgWindow::draw()
@@ -590,6 +738,7 @@ void NanovgWindow::endDrawing(bool isClosing)
 
 void NanovgWindow::image(Vec2d pos, const mssm::Image& img, double alpha)
 {
+    flushBatch();
     keepImages.push_back(img.img);
 
     const float w = img.width();
@@ -605,6 +754,7 @@ void NanovgWindow::image(Vec2d pos, const mssm::Image& img, double alpha)
 
 void NanovgWindow::image(Vec2d pos, const mssm::Image& img, Vec2d src, int srcw, int srch, double alpha)
 {
+    flushBatch();
     keepImages.push_back(img.img);
 
     const float w = img.width();
@@ -628,6 +778,7 @@ void NanovgWindow::image(Vec2d pos, const mssm::Image& img, Vec2d src, int srcw,
 
 void NanovgWindow::image(Vec2d pos, double w, double h, const mssm::Image& img, double alpha)
 {
+    flushBatch();
     keepImages.push_back(img.img);
 
     if (w < 0) {
@@ -649,6 +800,7 @@ void NanovgWindow::image(Vec2d pos, double w, double h, const mssm::Image& img,
 
 void NanovgWindow::image(Vec2d pos, double w, double h, const mssm::Image& img, Vec2d src, int srcw, int srch, double alpha)
 {
+    flushBatch();
     keepImages.push_back(img.img);
 
     if (w < 0) {
@@ -676,6 +828,7 @@ void NanovgWindow::image(Vec2d pos, double w, double h, const mssm::Image& img,
 
 void NanovgWindow::imageC(Vec2d center, double angle, const mssm::Image& img, double alpha)
 {
+    flushBatch();
     keepImages.push_back(img.img);
 
     const float w = img.width();
@@ -697,6 +850,7 @@ void NanovgWindow::imageC(Vec2d center, double angle, const mssm::Image& img, do
 
 void NanovgWindow::imageC(Vec2d center, double angle, const mssm::Image& img, Vec2d src, int srcw, int srch, double alpha)
 {
+    flushBatch();
     keepImages.push_back(img.img);
 
     //   _checkAlignPixelsAdjust(&dx, &dy);
@@ -724,6 +878,7 @@ void NanovgWindow::imageC(Vec2d center, double angle, const mssm::Image& img, Ve
 
 void NanovgWindow::imageC(Vec2d center, double angle, double w, double h, const mssm::Image& img, double alpha)
 {
+    flushBatch();
     keepImages.push_back(img.img);
 
     const float offx = -w/2;
@@ -743,6 +898,7 @@ void NanovgWindow::imageC(Vec2d center, double angle, double w, double h, const
 
 void NanovgWindow::imageC(Vec2d center, double angle, double w, double h, const mssm::Image &img, Vec2d src, int srcw, int srch, double alpha)
 {
+    flushBatch();
     keepImages.push_back(img.img);
 
     //   _checkAlignPixelsAdjust(&dx, &dy);
@@ -819,67 +975,114 @@ void NanovgWindow::popClip()
     }
 }
 
+// Opaque fills outlined in the same colour, or not at all, look the same
+// drawn one at a time or together as one path
+static bool batchable(Color c, Color fill)
+{
+    return fill.a == 255 && (c.a == 0 || c == fill);
+}
+
 void NanovgWindow::line(Vec2d p1, Vec2d p2, Color c)
 {
+    flushBatch();
+    if (c.a == 0) {
+        return;
+    }
     nvgBeginPath(vg);
     nvgMoveTo(vg, p1.x, p1.y);
     nvgLineTo(vg, p2.x, p2.y);
-    nvgStrokeColor(vg, nvgRGBA(c.r, c.g, c.b, c.a));
+    setStrokeWidth(1);
+    setStrokeColor(c);
     nvgStroke(vg);
 }
 
 void NanovgWindow::ellipse(Vec2d pos, double w, double h, Color c, Color fill)
 {
+    if (batchable(c, fill)) {
+        batchPath(c.a > 0 ? Batch::FillStroke : Batch::Fill, fill);
+        nvgEllipse(vg, pos.x, pos.y, w/2.0, h/2.0);
+        return;
+    }
+    flushBatch();
     nvgBeginPath(vg);
-    nvgStrokeColor(vg, nvgRGBA(c.r, c.g, c.b, c.a));
-    nvgFillColor(vg, nvgRGBA(fill.r, fill.g, fill.b, fill.a));
     nvgEllipse(vg, pos.x, pos.y, w/2.0, h/2.0);
-    nvgFill(vg);
-    nvgStroke(vg);
+    if (fill.a > 0) {
+        setFillColor(fill);
+        nvgFill(vg);
+    }
+    if (c.a > 0) {
+        setStrokeWidth(1);
+        setStrokeColor(c);
+        nvgStroke(vg);
+    }
 }
 //d nvgArc2(NVGcontext* ctx, float cx, float cy, float rx, float ry, float a0, float a1, int dir);
 
 void NanovgWindow::arc(Vec2d pos, double w, double h, double a, double alen, Color c)
 {
+    flushBatch();
+    if (c.a == 0) {
+        return;
+    }
     nvgBeginPath(vg);
-    nvgStrokeColor(vg, nvgRGBA(c.r, c.g, c.b, c.a));
     nvgArc2(vg, pos.x, pos.y, w/2.0, h/2.0, -a, -a-alen, NVG_CCW);
+    setStrokeWidth(1);
+    setStrokeColor(c);
     nvgStroke(vg);
 }
 
 void NanovgWindow::chord(Vec2d pos, double w, double h, double a, double alen, Color c, Color fill)
 {
+    flushBatch();
     nvgBeginPath(vg);
-    nvgStrokeColor(vg, nvgRGBA(c.r, c.g, c.b, c.a));
-    nvgFillColor(vg, nvgRGBA(fill.r, fill.g, fill.b, fill.a));
     nvgArc2(vg, pos.x, pos.y, w/2.0, h/2.0, -a, -a-alen, NVG_CCW);
     nvgClosePath(vg);
-    nvgFill(vg);
-    nvgStroke(vg);
+    if (fill.a > 0) {
+        setFillColor(fill);
+        nvgFill(vg);
+    }
+    if (c.a > 0) {
+        setStrokeWidth(1);
+        setStrokeColor(c);
+        nvgStroke(vg);
+    }
 }
 
 void NanovgWindow::pie(Vec2d pos, double w, double h, double a, double alen, Color c, Color fill)
 {
+    flushBatch();
     nvgBeginPath(vg);
-    nvgStrokeColor(vg, nvgRGBA(c.r, c.g, c.b, c.a));
-    nvgFillColor(vg, nvgRGBA(fill.r, fill.g, fill.b, fill.a));
     nvgMoveTo(vg, pos.x,pos.y);
     nvgArc2(vg, pos.x, pos.y, w/2.0, h/2.0, -a, -a-alen, NVG_CCW);
     nvgLineTo(vg, pos.x,pos.y);
-    nvgFill(vg);
-    nvgStroke(vg);
+    if (fill.a > 0) {
+        setFillColor(fill);
+        nvgFill(vg);
+    }
+    if (c.a > 0) {
+        setStrokeWidth(1);
+        setStrokeColor(c);
+        nvgStroke(vg);
+    }
 }
 
 void NanovgWindow::rect(Vec2d corner, double w, double h, Color c, Color fill)
 {
+    if (batchable(c, fill)) {
+        batchPath(c.a > 0 ? Batch::FillStroke : Batch::Fill, fill);
+        nvgRect(vg, corner.x, corner.y, w, h);
+        return;
+    }
+    flushBatch();
     nvgBeginPath(vg);
     nvgRect(vg, corner.x, corner.y, w, h);
     if (fill.a > 0) {
-        nvgFillColor(vg, nvgRGBA(fill.r, fill.g, fill.b, fill.a));
+        setFillColor(fill);
         nvgFill(vg);
     }
     if (c.a > 0) {
-        nvgStrokeColor(vg, nvgRGBA(c.r, c.g, c.b, c.a));
+        setStrokeWidth(1);
+        setStrokeColor(c);
         nvgStroke(vg);
     }
 }
@@ -887,12 +1090,13 @@ void NanovgWindow::rect(Vec2d corner, double w, double h, Color c, Color fill)
 
 void NanovgWindow::text(Vec2d pos, const FontInfo& sizeAndFace, const std::string &str, Color c, HAlign hAlign, VAlign vAlign)
 {
+    flushBatch();
     nvgFontSize(vg, sizeAndFace.getSize());
     //nvgFontFace(vg, "sans");
     nvgFontFaceId(vg, sizeAndFace.getFaceIdx());
     nvgTextAlign(vg, static_cast<int>(hAlign) | static_cast<int>(vAlign));
     // nvgFontBlur(vg,2);
-    nvgFillColor(vg, nvgRGBA(c.r, c.g, c.b, c.a));
+    setFillColor(c);
     auto s = str.c_str();
     nvgText(vg, pos.x, pos.y, s, s+str.length());
 }
@@ -957,21 +1161,37 @@ std::vector<double> NanovgWindow::getCharacterXOffsets(const FontInfo &sizeAndFa
     return ::getCharacterXOffsets(vg, sizeAndFace, startX, text);
 }
 
-void NanovgWindow::point(Vec2d p, Color c)
+// a translucent point on its own, so where it overlaps others it's blended twice
+void NanovgWindow::strokePoint(Vec2d p, Color c)
 {
     nvgBeginPath(vg);
-    nvgStrokeWidth(vg, 3);
-    nvgStrokeColor(vg, nvgRGBA(c.r, c.g, c.b, c.a));
     nvgMoveTo(vg, p.x-1, p.y-1);
     nvgLineTo(vg, p.x+1, p.y+1);
+    setStrokeWidth(3);
+    setStrokeColor(c);
     nvgStroke(vg);
-    nvgStrokeWidth(vg, 1);
+}
+
+void NanovgWindow::point(Vec2d p, Color c)
+{
+    if (c.a != 255) {
+        flushBatch();
+        if (c.a > 0) {
+            strokePoint(p, c);
+        }
+        return;
+    }
+    batchPath(Batch::Points, c);
+    nvgMoveTo(vg, p.x-1, p.y-1);
+    nvgLineTo(vg, p.x+1, p.y+1);
 }
 
 
 template<typename T>
 void NanovgWindow::t_polygon(T points, Color border, Color fill)
 {
+    flushBatch();
+
     bool first = true;
 
     for (auto& p : points) {
@@ -989,14 +1209,13 @@ void NanovgWindow::t_polygon(T points, Color border, Color fill)
         nvgClosePath(vg);
 
         if (fill.a > 0) {
-            if (fill.a > 0) {
-                nvgFillColor(vg, nvgRGBA(fill.r, fill.g, fill.b, fill.a));
-                nvgFill(vg);
-            }
+            setFillColor(fill);
+            nvgFill(vg);
         }
 
         if (border.a > 0) {
-            nvgStrokeColor(vg, nvgRGBA(border.r, border.g, border.b, border.a));
+            setStrokeWidth(1);
+            setStrokeColor(border);
             nvgStroke(vg);
         }
     }
@@ -1005,6 +1224,8 @@ void NanovgWindow::t_polygon(T points, Color border, Color fill)
 template<typename T>
 void NanovgWindow::t_polyline(T points, Color color, bool closed)
 {
+    flushBatch();
+
     bool first = true;
 
     for (auto& p : points) {
@@ -1020,7 +1241,8 @@ void NanovgWindow::t_polyline(T points, Color color, bool closed)
 
     if (!first) {
         if (color.a > 0) {
-            nvgStrokeColor(vg, nvgRGBA(color.r, color.g, color.b, color.a));
+            setStrokeWidth(1);
+            setStrokeColor(color);
             nvgStroke(vg);
         }
     }
@@ -1032,15 +1254,20 @@ inline void NanovgWindow::t_points(T points, Color c)
     if (points.size() == 0) {
         return;
     }
-    nvgBeginPath(vg);
-    nvgStrokeWidth(vg, 3);
-    nvgStrokeColor(vg, nvgRGBA(c.r, c.g, c.b, c.a));
+    if (c.a != 255) {
+        flushBatch();
+        if (c.a > 0) {
+            for (auto& p : points) {
+                strokePoint(p, c);
+            }
+        }
+        return;
+    }
+    batchPath(Batch::Points, c);
     for (auto& p : points) {
         nvgMoveTo(vg, p.x-1,p.y-1);
         nvgLineTo(vg, p.x+1,p.y+1);
     }
-    nvgStroke(vg);
-    nvgStrokeWidth(vg, 1);
 }
 
 
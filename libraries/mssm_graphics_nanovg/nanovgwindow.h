@@ -7,17 +7,58 @@
 #include "image.h"
 
 #include "nanovg.h"
+#include <deque>
+
+// nanovg images that are no longer used, kept for new images of the same size
+// and flags, since uploading into a texture is cheaper than allocating one.
+// A texture isn't reused until framesInFlight frames after it was released,
+// so the GPU is done drawing with it.  Textures unused for maxIdleFrames are
+// deleted, and the oldest are deleted when the pool holds more than maxBytes.
+class TexturePoolVG {
+    struct Entry {
+        int idx;
+        int width;
+        int height;
+        int flags;
+        int64_t releasedFrame;
+    };
 
-class ImageInternalVG : public mssm::ImageInternal {
     NVGcontext* vg;
+    std::deque<Entry> entries; // oldest first
+    size_t bytes{0};
+    int64_t frame{0};
+public:
+    static constexpr int framesInFlight = 2;
+    static constexpr int maxIdleFrames = 120;
+    static constexpr size_t maxBytes = 64 << 20;
+
+    TexturePoolVG(NVGcontext* vg) : vg{vg} {}
+
+    NVGcontext* context() const { return vg; }
+
+    // returns 0 if nanovg couldn't create the image
+    int create(int width, int height, int flags, const unsigned char* rgba);
+    void release(int idx, int width, int height, int flags);
+    void endFrame();
+
+    // deletes the pooled textures; vg is about to be deleted
+    void detach();
+private:
+    void deleteOldest();
+};
+
+class ImageInternalVG : public mssm::ImageInternal {
+    std::shared_ptr<TexturePoolVG> pool;
     int vgImageIdx;
+    int flags;
 public:
-    ImageInternalVG(NVGcontext* vg, int idx, int width, int height, mssm::Color* cached);
+    ImageInternalVG(std::shared_ptr<TexturePoolVG> pool, int idx, int width, int height, int flags, mssm::Color* cached);
     ~ImageInternalVG();
     uint32_t textureIndex() const override { return vgImageIdx; };
 private:
     void freeCachedPixels();
     void updatePixels() override;
+    void updatePixels(int x, int y, int width, int height) override;
     // void setPixel(int x, int y, mssm::Color c = mssm::WHITE) {
     //     pixels[y*w+x] = c;
     // }
@@ -31,7 +72,27 @@ private:
 
 class NanovgWindow : public mssm::CoreWindowGLFW, public mssm::ImageLoader, public mssm::Canvas2d
 {
+public:
+    // What a frame drew: nanovg paths, the render calls they were grouped
+    // into (each with its own uniforms and GL state setup) and the GL draw
+    // calls those made
+    struct FrameStats {
+        int paths{0};
+        int calls{0};
+        int glDraws{0};
+    };
 protected:
+    // Consecutive opaque rect and ellipse fills of one colour, and
+    // consecutive opaque points of one colour, are added to one path that's
+    // drawn when something else is.  Translucent ones are drawn one at a time,
+    // as nanovg draws overlaps within a path only once
+    enum class Batch {
+        None,
+        Fill,
+        FillStroke,  // outlined in the fill colour
+        Points
+    };
+
     struct Scissor {
         int x;
         int y;
@@ -44,9 +105,24 @@ protected:
     int fontBold;
     int fontLight;
     std::vector<std::shared_ptr<mssm::ImageInternal>> keepImages;
+    std::shared_ptr<TexturePoolVG> texturePool;
+    // images whose last Image has gone, kept until the end of the frame
+    std::vector<std::shared_ptr<mssm::ImageInternal>> destructionQueue;
     std::vector<Scissor> clipRects;
     mssm::Color backgroundColor{mssm::BLACK};
 
+    Batch batch{Batch::None};
+    mssm::Color batchColor;
+
+    // fill and stroke settings as last sent to vg, so they aren't sent again
+    mssm::Color fillColor;
+    mssm::Color strokeColor;
+    bool fillColorSet{false};
+    bool strokeColorSet{false};
+    float strokeWidth{-1};
+
+    FrameStats lastFrameStats;
+
 public:
     NanovgWindow(std::string title, int width, int height);
     virtual ~NanovgWindow();
@@ -56,6 +132,16 @@ protected:
     bool beginDrawing(bool wasResized) override;
     void endDrawing(bool isClosing) override;
 
+    void setFillColor(mssm::Color c);
+    void setStrokeColor(mssm::Color c);
+    void setStrokeWidth(float width);
+    void batchPath(Batch kind, mssm::Color c);
+    void flushBatch();
+    void strokePoint(Vec2d p, mssm::Color c);
+
+public:
+    const FrameStats& frameStats() const { return lastFrameStats; }
+
     // Canvas2d interface
 public:
     bool isDrawable() override;
@@ -260,6 +260,14 @@ struct GLNVGcontext {
 	int cuniforms;
 	int nuniforms;
 
+	// Scratch arrays for glMultiDrawArrays
+	GLint* multiFirsts;
+	GLsizei* multiCounts;
+	int cmulti;
+
+	// GL draw calls made by the last flush
+	int drawCalls;
+
 	// cached state
 	#if NANOVG_GL_USE_STATE_FILTER
 	GLuint boundTexture;
@@ -1009,10 +1017,54 @@ static void glnvg__renderViewport(void* uptr, float width, float height, float d
 	gl->view[1] = height;
 }
 
+// Draws the fill fans (or the stroke strips) of a call's paths, with one
+// glMultiDrawArrays where it's available.
+static void glnvg__drawPaths(GLNVGcontext* gl, GLenum mode, GLNVGpath* paths, int npaths, int fills)
+{
+	int i;
+#if defined NANOVG_GL2 || defined NANOVG_GL3
+	if (npaths > 1) {
+		int n = 0;
+		if (npaths > gl->cmulti) {
+			int cmulti = glnvg__maxi(npaths, 128) + gl->cmulti/2; // 1.5x Overallocate
+			GLint* firsts;
+			GLsizei* counts;
+			firsts = (GLint*)realloc(gl->multiFirsts, sizeof(GLint) * cmulti);
+			if (firsts != NULL) gl->multiFirsts = firsts;
+			counts = (GLsizei*)realloc(gl->multiCounts, sizeof(GLsizei) * cmulti);
+			if (counts != NULL) gl->multiCounts = counts;
+			if (firsts != NULL && counts != NULL) gl->cmulti = cmulti;
+		}
+		if (npaths <= gl->cmulti) {
+			for (i = 0; i < npaths; i++) {
+				int count = fills ? paths[i].fillCount : paths[i].strokeCount;
+				if (count > 0) {
+					gl->multiFirsts[n] = fills ? paths[i].fillOffset : paths[i].strokeOffset;
+					gl->multiCounts[n] = count;
+					n++;
+				}
+			}
+			if (n > 0) {
+				glMultiDrawArrays(mode, gl->multiFirsts, gl->multiCounts, n);
+				gl->drawCalls++;
+			}
+			return;
+		}
+	}
+#endif
+	for (i = 0; i < npaths; i++) {
+		if (fills)
+			glDrawArrays(mode, paths[i].fillOffset, paths[i].fillCount);
+		else
+			glDrawArrays(mode, paths[i].strokeOffset, paths[i].strokeCount);
+		gl->drawCalls++;
+	}
+}
+
 static void glnvg__fill(GLNVGcontext* gl, GLNVGcall* call)
 {
 	GLNVGpath* paths = &gl->paths[call->pathOffset];
-	int i, npaths = call->pathCount;
+	int npaths = call->pathCount;
 
 	// Draw shapes
 	glEnable(GL_STENCIL_TEST);
@@ -1027,8 +1079,7 @@ static void glnvg__fill(GLNVGcontext* gl, GLNVGcall* call)
 	glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_INCR_WRAP);
 	glStencilOpSeparate(GL_BACK, GL_KEEP, GL_KEEP, GL_DECR_WRAP);
 	glDisable(GL_CULL_FACE);
-	for (i = 0; i < npaths; i++)
-		glDrawArrays(GL_TRIANGLE_FAN, paths[i].fillOffset, paths[i].fillCount);
+	glnvg__drawPaths(gl, GL_TRIANGLE_FAN, paths, npaths, 1);
 	glEnable(GL_CULL_FACE);
 
 	// Draw anti-aliased pixels
@@ -1041,14 +1092,14 @@ static void glnvg__fill(GLNVGcontext* gl, GLNVGcall* call)
 		glnvg__stencilFunc(gl, GL_EQUAL, 0x00, 0xff);
 		glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
 		// Draw fringes
-		for (i = 0; i < npaths; i++)
-			glDrawArrays(GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
+		glnvg__drawPaths(gl, GL_TRIANGLE_STRIP, paths, npaths, 0);
 	}
 
 	// Draw fill
 	glnvg__stencilFunc(gl, GL_NOTEQUAL, 0x0, 0xff);
 	glStencilOp(GL_ZERO, GL_ZERO, GL_ZERO);
 	glDrawArrays(GL_TRIANGLE_STRIP, call->triangleOffset, call->triangleCount);
+	gl->drawCalls++;
 
 	glDisable(GL_STENCIL_TEST);
 }
@@ -1056,24 +1107,31 @@ static void glnvg__fill(GLNVGcontext* gl, GLNVGcall* call)
 static void glnvg__convexFill(GLNVGcontext* gl, GLNVGcall* call)
 {
 	GLNVGpath* paths = &gl->paths[call->pathOffset];
-	int i, npaths = call->pathCount;
+	int npaths = call->pathCount;
 
 	glnvg__setUniforms(gl, call->uniformOffset, call->image);
 	glnvg__checkError(gl, "convex fill");
 
-	for (i = 0; i < npaths; i++) {
-		glDrawArrays(GL_TRIANGLE_FAN, paths[i].fillOffset, paths[i].fillCount);
+	if (npaths == 1) {
+		glDrawArrays(GL_TRIANGLE_FAN, paths[0].fillOffset, paths[0].fillCount);
+		gl->drawCalls++;
 		// Draw fringes
-		if (paths[i].strokeCount > 0) {
-			glDrawArrays(GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
+		if (paths[0].strokeCount > 0) {
+			glDrawArrays(GL_TRIANGLE_STRIP, paths[0].strokeOffset, paths[0].strokeCount);
+			gl->drawCalls++;
 		}
+	} else {
+		// Several paths are only drawn this way when they're opaque, so the
+		// fringes can go after all the fills
+		glnvg__drawPaths(gl, GL_TRIANGLE_FAN, paths, npaths, 1);
+		glnvg__drawPaths(gl, GL_TRIANGLE_STRIP, paths, npaths, 0);
 	}
 }
 
 static void glnvg__stroke(GLNVGcontext* gl, GLNVGcall* call)
 {
 	GLNVGpath* paths = &gl->paths[call->pathOffset];
-	int npaths = call->pathCount, i;
+	int npaths = call->pathCount;
 
 	if (gl->flags & NVG_STENCIL_STROKES) {
 
@@ -1085,23 +1143,20 @@ static void glnvg__stroke(GLNVGcontext* gl, GLNVGcall* call)
 		glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
 		glnvg__setUniforms(gl, call->uniformOffset + gl->fragSize, call->image);
 		glnvg__checkError(gl, "stroke fill 0");
-		for (i = 0; i < npaths; i++)
-			glDrawArrays(GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
+		glnvg__drawPaths(gl, GL_TRIANGLE_STRIP, paths, npaths, 0);
 
 		// Draw anti-aliased pixels.
 		glnvg__setUniforms(gl, call->uniformOffset, call->image);
 		glnvg__stencilFunc(gl, GL_EQUAL, 0x00, 0xff);
 		glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
-		for (i = 0; i < npaths; i++)
-			glDrawArrays(GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
+		glnvg__drawPaths(gl, GL_TRIANGLE_STRIP, paths, npaths, 0);
 
 		// Clear stencil buffer.
 		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
 		glnvg__stencilFunc(gl, GL_ALWAYS, 0x0, 0xff);
 		glStencilOp(GL_ZERO, GL_ZERO, GL_ZERO);
 		glnvg__checkError(gl, "stroke fill 1");
-		for (i = 0; i < npaths; i++)
-			glDrawArrays(GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
+		glnvg__drawPaths(gl, GL_TRIANGLE_STRIP, paths, npaths, 0);
 		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 
 		glDisable(GL_STENCIL_TEST);
@@ -1112,8 +1167,7 @@ static void glnvg__stroke(GLNVGcontext* gl, GLNVGcall* call)
 		glnvg__setUniforms(gl, call->uniformOffset, call->image);
 		glnvg__checkError(gl, "stroke fill");
 		// Draw Strokes
-		for (i = 0; i < npaths; i++)
-			glDrawArrays(GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
+		glnvg__drawPaths(gl, GL_TRIANGLE_STRIP, paths, npaths, 0);
 	}
 }
 
@@ -1123,6 +1177,7 @@ static void glnvg__triangles(GLNVGcontext* gl, GLNVGcall* call)
 	glnvg__checkError(gl, "triangles fill");
 
 	glDrawArrays(GL_TRIANGLES, call->triangleOffset, call->triangleCount);
+	gl->drawCalls++;
 }
 
 static void glnvg__renderCancel(void* uptr) {
@@ -1182,6 +1237,8 @@ static void glnvg__renderFlush(void* uptr)
 	GLNVGcontext* gl = (GLNVGcontext*)uptr;
 	int i;
 
+	gl->drawCalls = 0;
+
 	if (gl->ncalls > 0) {
 
 		// Setup require GL state.
@@ -1354,6 +1411,24 @@ static void glnvg__vset(NVGvertex* vtx, float x, float y, float u, float v)
 	vtx->v = v;
 }
 
+// Convex solid paths filled with an opaque paint can be drawn one after
+// another without the stencil: where they overlap, the paint is just drawn
+// over itself.
+static int glnvg__opaqueConvex(NVGpaint* paint, NVGcompositeOperationState op, const NVGpath* paths, int npaths)
+{
+	int i;
+	if (paint->image != 0 || paint->innerColor.a < 1.0f || paint->outerColor.a < 1.0f)
+		return 0;
+	if (op.srcRGB != NVG_ONE || op.dstRGB != NVG_ONE_MINUS_SRC_ALPHA ||
+		op.srcAlpha != NVG_ONE || op.dstAlpha != NVG_ONE_MINUS_SRC_ALPHA)
+		return 0;
+	for (i = 0; i < npaths; i++) {
+		if (!paths[i].convex || paths[i].winding != NVG_SOLID)
+			return 0;
+	}
+	return 1;
+}
+
 static void glnvg__renderFill(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe,
 							  const float* bounds, const NVGpath* paths, int npaths)
 {
@@ -1373,7 +1448,7 @@ static void glnvg__renderFill(void* uptr, NVGpaint* paint, NVGcompositeOperation
 	call->image = paint->image;
 	call->blendFunc = glnvg__blendCompositeOperation(compositeOperation);
 
-	if (npaths == 1 && paths[0].convex)
+	if ((npaths == 1 && paths[0].convex) || glnvg__opaqueConvex(paint, compositeOperation, paths, npaths))
 	{
 		call->type = GLNVG_CONVEXFILL;
 		call->triangleCount = 0;	// Bounding box fill quad not needed for convex fill
@@ -1556,6 +1631,8 @@ static void glnvg__renderDelete(void* uptr)
 	free(gl->verts);
 	free(gl->uniforms);
 	free(gl->calls);
+	free(gl->multiFirsts);
+	free(gl->multiCounts);
 
 	free(gl);
 }
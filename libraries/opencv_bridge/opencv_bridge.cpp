@@ -1,7 +1,12 @@
 #include "opencv_bridge.h"
 
+#include <opencv2/imgproc.hpp>
 #include <stdexcept>
 
+// Conversions go through cv::Mat views of the image's pixels (mssm::Color is
+// laid out as RGBA bytes, so they're CV_8UC4) and cv::cvtColor, which uses
+// the CPU's SIMD instructions and splits large images between threads.
+
 namespace {
 void validateImageForRead(mssm::Image& img)
 {
@@ -20,41 +25,49 @@ void validateImageForWrite(mssm::Image& img, int width, int height)
         throw std::invalid_argument("mssm::Image dimensions do not match source cv::Mat.");
     }
 }
+
+static_assert(sizeof(mssm::Color) == 4, "mssm::Color must be 4 bytes to view pixels as CV_8UC4");
 }
 
-cv::Mat mssm::opencv_bridge::toMatRGBA(mssm::Image& img)
+cv::Mat mssm::opencv_bridge::viewRGBA(mssm::Image& img)
 {
     validateImageForRead(img);
 
-    cv::Mat out(img.height(), img.width(), CV_8UC4);
-    const auto* src = img.pixels();
-    for (int y = 0; y < img.height(); ++y) {
-        auto* row = out.ptr<cv::Vec4b>(y);
-        for (int x = 0; x < img.width(); ++x) {
-            const auto& c = src[y * img.width() + x];
-            row[x] = cv::Vec4b(c.r, c.g, c.b, c.a);
-        }
-    }
+    return cv::Mat(img.height(), img.width(), CV_8UC4, img.pixels());
+}
+
+cv::Mat mssm::opencv_bridge::toMatRGBA(mssm::Image& img)
+{
+    cv::Mat out;
+    toMatRGBA(img, out);
     return out;
 }
 
 cv::Mat mssm::opencv_bridge::toMatBGR(mssm::Image& img)
 {
-    validateImageForRead(img);
-
-    cv::Mat bgr(img.height(), img.width(), CV_8UC3);
-    const auto* src = img.pixels();
-    for (int y = 0; y < img.height(); ++y) {
-        auto* row = bgr.ptr<cv::Vec3b>(y);
-        for (int x = 0; x < img.width(); ++x) {
-            const auto& c = src[y * img.width() + x];
-            row[x] = cv::Vec3b(c.b, c.g, c.r);
-        }
-    }
+    cv::Mat bgr;
+    toMatBGR(img, bgr);
     return bgr;
 }
 
 cv::Mat mssm::opencv_bridge::rgbBufferToMat(const uint8_t* rgb, int width, int height)
+{
+    cv::Mat out;
+    rgbBufferToMat(rgb, width, height, out);
+    return out;
+}
+
+void mssm::opencv_bridge::toMatRGBA(mssm::Image& img, cv::Mat& out)
+{
+    viewRGBA(img).copyTo(out);
+}
+
+void mssm::opencv_bridge::toMatBGR(mssm::Image& img, cv::Mat& out)
+{
+    cv::cvtColor(viewRGBA(img), out, cv::COLOR_RGBA2BGR);
+}
+
+void mssm::opencv_bridge::rgbBufferToMat(const uint8_t* rgb, int width, int height, cv::Mat& out)
 {
     if (!rgb) {
         throw std::invalid_argument("rgbBufferToMat received null RGB buffer.");
@@ -64,7 +77,7 @@ cv::Mat mssm::opencv_bridge::rgbBufferToMat(const uint8_t* rgb, int width, int h
     }
 
     cv::Mat view(height, width, CV_8UC3, const_cast<uint8_t*>(rgb));
-    return view.clone();
+    view.copyTo(out);
 }
 
 void mssm::opencv_bridge::fromMat(const cv::Mat& src, mssm::Image& dst)
@@ -75,46 +88,17 @@ void mssm::opencv_bridge::fromMat(const cv::Mat& src, mssm::Image& dst)
 
     validateImageForWrite(dst, src.cols, src.rows);
 
-    auto* dstPixels = dst.pixels();
+    // the right size and type already, so these write into dst's pixels
+    cv::Mat view = viewRGBA(dst);
     switch (src.type()) {
     case CV_8UC1:
-        for (int y = 0; y < dst.height(); ++y) {
-            const auto* row = src.ptr<uint8_t>(y);
-            for (int x = 0; x < dst.width(); ++x) {
-                auto& c = dstPixels[y * dst.width() + x];
-                const uint8_t v = row[x];
-                c.r = v;
-                c.g = v;
-                c.b = v;
-                c.a = 255;
-            }
-        }
+        cv::cvtColor(src, view, cv::COLOR_GRAY2RGBA);
         break;
     case CV_8UC3:
-        for (int y = 0; y < dst.height(); ++y) {
-            const auto* row = src.ptr<cv::Vec3b>(y);
-            for (int x = 0; x < dst.width(); ++x) {
-                auto& c = dstPixels[y * dst.width() + x];
-                const auto& px = row[x];
-                c.r = px[2];
-                c.g = px[1];
-                c.b = px[0];
-                c.a = 255;
-            }
-        }
+        cv::cvtColor(src, view, cv::COLOR_BGR2RGBA);
         break;
     case CV_8UC4:
-        for (int y = 0; y < dst.height(); ++y) {
-            const auto* row = src.ptr<cv::Vec4b>(y);
-            for (int x = 0; x < dst.width(); ++x) {
-                auto& c = dstPixels[y * dst.width() + x];
-                const auto& px = row[x];
-                c.r = px[0];
-                c.g = px[1];
-                c.b = px[2];
-                c.a = px[3];
-            }
-        }
+        src.copyTo(view);
         break;
     default:
         throw std::invalid_argument("fromMat supports only CV_8UC1, CV_8UC3, and CV_8UC4.");
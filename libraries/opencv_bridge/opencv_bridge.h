@@ -8,10 +8,21 @@
 
 namespace mssm::opencv_bridge {
 
+// A CV_8UC4 (RGBA) cv::Mat over img's cached pixels, without copying them.
+// Changes through it are img's changes (call img.updatePixels() to show
+// them); it's only valid while img keeps those pixels.
+cv::Mat viewRGBA(mssm::Image& img);
+
 cv::Mat toMatRGBA(mssm::Image& img);
 cv::Mat toMatBGR(mssm::Image& img);
 cv::Mat rgbBufferToMat(const uint8_t* rgb, int width, int height);
 
+// As above, into out, reusing its buffer when it's already the right size
+// and type (as it is for each frame of a video)
+void toMatRGBA(mssm::Image& img, cv::Mat& out);
+void toMatBGR(mssm::Image& img, cv::Mat& out);
+void rgbBufferToMat(const uint8_t* rgb, int width, int height, cv::Mat& out);
+
 void fromMat(const cv::Mat& src, mssm::Image& dst);
 void applyMatToImage(const cv::Mat& src, mssm::Image& dst);
 
@@ -1,4 +1,5 @@
 #include "staticmesh.h"
+#include <stdexcept>
 
 
 FaceData::FaceData()
@@ -31,3 +32,35 @@ StaticMesh::~StaticMesh()
         meshLoader.queueForDestruction(internal);
     }
 }
+
+StaticMeshLod::StaticMeshLod(MeshLoader& meshLoader, const MeshLods<Vertex3dUV>& lods)
+    : errors{lods.errors}, center{lods.center}, radius{lods.radius}
+{
+    if (lods.levels.empty()) {
+        throw std::invalid_argument("StaticMeshLod needs at least one level");
+    }
+    for (auto& level : lods.levels) {
+        levels.push_back(std::make_unique<StaticMesh>(meshLoader, level));
+    }
+}
+
+StaticMeshLod::StaticMeshLod(MeshLoader& meshLoader, const MeshLods<Vertex3dUV>& lods, const mssm::Image& texture)
+    : errors{lods.errors}, center{lods.center}, radius{lods.radius}
+{
+    if (lods.levels.empty()) {
+        throw std::invalid_argument("StaticMeshLod needs at least one level");
+    }
+    for (auto& level : lods.levels) {
+        levels.push_back(std::make_unique<StaticMesh>(meshLoader, level, texture));
+    }
+}
+
+const StaticMesh& StaticMeshLod::select(double pixelsPerUnit) const
+{
+    // errors only grow with the level, so the last one that's good enough is the coarsest
+    size_t level = 0;
+    while (level + 1 < levels.size() && errors[level + 1] * pixelsPerUnit <= maxPixelError) {
+        level++;
+    }
+    return *levels[level];
+}
@@ -6,6 +6,8 @@
 #include "vec2d.h"
 #include <memory>
 #include <string>
+#include <vector>
+#include "meshlod.h"
 #include "triangularmesh.h"
 #include "vertex3duv.h"
 
@@ -75,4 +77,24 @@ public:
     ~StaticMesh();
 };
 
+// A StaticMesh at several levels of detail (see buildMeshLods).  drawMesh picks
+// the coarsest level whose error, projected to the screen, is within
+// maxPixelError, so distant copies of a model cost a fraction of the triangles.
+// The errors measure how far vertices moved, not the surface between them, so
+// this is close to a bound rather than a guarantee
+class StaticMeshLod {
+public:
+    std::vector<std::unique_ptr<StaticMesh>> levels; // finest first
+    std::vector<double> errors;                      // model units, per level (MeshLods::errors)
+    Vec3d center;                                    // bounding sphere, model space
+    double radius{0};
+    double maxPixelError{1.0};
+public:
+    StaticMeshLod(MeshLoader& meshLoader, const MeshLods<Vertex3dUV>& lods);
+    StaticMeshLod(MeshLoader& meshLoader, const MeshLods<Vertex3dUV>& lods, const mssm::Image& texture);
+
+    // level to draw when one model unit covers pixelsPerUnit pixels
+    const StaticMesh& select(double pixelsPerUnit) const;
+};
+
 #endif // STATICMESH_H
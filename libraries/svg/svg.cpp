@@ -3,14 +3,23 @@
 #include "vec2d.h"
 #include "color.h"
 
-#include <functional>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+// most a flattened curve may stray from the real one, in pixels
+constexpr double flatness = 0.25;
 
 template <is2dVector V>
-constexpr float distPtSeg(const V& p, const V& a, const V& b) {
+constexpr double distPtSeg(const V& p, const V& a, const V& b) {
     auto ab = b - a;
     auto ap = p - a;
-    float d = ab.magSquared();
-    float t = ap.dot(ab);
+    double d = ab.magSquared();
+    double t = ap.dot(ab);
 
     if (d > 0) t /= d;
     if (t < 0) t = 0;
@@ -22,43 +31,55 @@ constexpr float distPtSeg(const V& p, const V& a, const V& b) {
     return diff.magSquared();
 }
 
-template <is2dVector VIN>
-void cubicBezier(const VIN& p1, const VIN& p2, const VIN& p3, const VIN& p4,
-                 float tol, int level, std::function<void(const VIN&)> appendPoint) {
-    if (level > 12) return;
-
-    // Compute midpoints
-    auto p12 = (p1 + p2) * 0.5f;
-    auto p23 = (p2 + p3) * 0.5f;
-    auto p34 = (p3 + p4) * 0.5f;
-    auto p123 = (p12 + p23) * 0.5f;
-    auto p234 = (p23 + p34) * 0.5f;
-    auto p1234 = (p123 + p234) * 0.5f;
-
-    // Check if the curve is flat enough
-    float d = distPtSeg(p1234, p1, p4);
-    if (d > tol) {
-        // Subdivide the curve
-        cubicBezier(p1, p12, p123, p1234, tol, level + 1, appendPoint);
-        cubicBezier(p1234, p234, p34, p4, tol, level + 1, appendPoint);
-    } else {
-        // Add endpoint
-        appendPoint(p4);
-    }
-}
+// Flatten a cubic into lines, calling emit(point) for each point after p1.
+// A piece is flat enough once both control points are within tolSq (squared)
+// of its chord, otherwise it's halved.  The halves wait on a small stack
+// rather than recursing, first half on top so points come out in order
+template <is2dVector V, typename Emit>
+void flattenCubic(const V& p1, const V& p2, const V& p3, const V& p4, double tolSq, Emit&& emit) {
+    constexpr int maxLevel = 12;
+
+    struct Piece {
+        V p1, p2, p3, p4;
+        int level;
+    };
+
+    // one waiting second half per level, plus the piece being split
+    std::array<Piece, maxLevel + 1> stack;
+    int top = 0;
+    stack[0] = { p1, p2, p3, p4, 0 };
+
+    while (top >= 0) {
+        Piece c = stack[top--];
+
+        if (c.level == maxLevel ||
+            std::max(distPtSeg(c.p2, c.p1, c.p4), distPtSeg(c.p3, c.p1, c.p4)) <= tolSq) {
+            emit(c.p4);
+            continue;
+        }
+
+        // Compute midpoints
+        auto p12 = (c.p1 + c.p2) * 0.5;
+        auto p23 = (c.p2 + c.p3) * 0.5;
+        auto p34 = (c.p3 + c.p4) * 0.5;
+        auto p123 = (p12 + p23) * 0.5;
+        auto p234 = (p23 + p34) * 0.5;
+        auto p1234 = (p123 + p234) * 0.5;
 
-template <is2dVector VIN, is2dVector VOUT>
-void cubicBezier(const VIN& p1, const VIN& p2, const VIN& p3, const VIN& p4,
-                 float tol, bool include1st, std::vector<VOUT>& vertices) {
-    if (include1st) {
-        vertices.push_back(cast<VOUT>(p1));
+        stack[++top] = { p1234, p234, p34, c.p4, c.level + 1 };
+        stack[++top] = { c.p1, p12, p123, p1234, c.level + 1 };
     }
-    cubicBezier<VIN>(p1, p2, p3, p4, tol, 0, [&vertices](const VIN& p) { vertices.push_back(cast<VOUT>(p)); });
 }
 
+} // namespace
+
 Svg::Svg(std::string filename)
+    : cachedBucket{std::numeric_limits<int>::min()}
 {
     image = nsvgParseFromFile(filename.c_str(), "px", 96);
+    if (!image) {
+        throw std::runtime_error("Cannot open " + filename);
+    }
 }
 
 Svg::~Svg()
@@ -66,91 +87,99 @@ Svg::~Svg()
     nsvgDelete(image);
 }
 
-void Svg::draw(SvgRenderer& renderer, Vec2d position)
+// Rebuild the cache if scale isn't in the bucket it was built for.  Bucket n
+// covers scales up to 2^n, and is flattened finely enough for 2^n
+void Svg::flatten(double scale)
 {
-    std::vector<Vec2d> points;
+    if (!(scale > 0) || !std::isfinite(scale)) {
+        throw std::invalid_argument("Svg scale must be positive");
+    }
+
+    int bucket = static_cast<int>(std::ceil(std::log2(scale)));
+    if (bucket == cachedBucket) {
+        return;
+    }
+    cachedBucket = bucket;
+
+    double tolerance = flatness / std::ldexp(1.0, bucket);
+    double tolSq = tolerance * tolerance;
+
+    cachedPoints.clear();
+    cachedPaths.clear();
 
-  //  printf("size: %f x %f\n", image->width, image->height);
-    // Use...
     for (auto shape = image->shapes; shape != NULL; shape = shape->next) {
+        if (!(shape->flags & NSVG_FLAGS_VISIBLE)) {
+            continue;
+        }
         mssm::Color fill = mssm::Color::fromIntBGR(shape->fill.color);
         mssm::Color stroke = mssm::Color::fromIntBGR(shape->stroke.color);
         for (auto path = shape->paths; path != NULL; path = path->next) {
-            points.clear();
-            for (int i = 0; i < path->npts-1; i += 3) {
-                Vec2f* p = reinterpret_cast<Vec2f*>(&path->pts[i*2]);
-                cubicBezier<Vec2f, Vec2d>(p[0]*10, p[1]*10, p[2]*10, p[3]*10, 1000, true, points);
+            if (path->npts == 0) {
+                continue;
             }
-            if (path->closed) {
-                std::reverse(points.begin(), points.end());
-                renderer.polygon(points, stroke, fill);
+            size_t start = cachedPoints.size();
+            const float* pts = path->pts;
+            cachedPoints.push_back({ pts[0], pts[1] });
+            for (int i = 0; i + 3 < path->npts; i += 3) {
+                const float* p = &pts[i * 2];
+                flattenCubic(Vec2d{ p[0], p[1] }, Vec2d{ p[2], p[3] }, Vec2d{ p[4], p[5] }, Vec2d{ p[6], p[7] }, tolSq,
+                             [this](const Vec2d& point) { cachedPoints.push_back(point); });
             }
-            else {
-                for (auto& p : points) {
-                    p += position;
-                }
-                renderer.polyline(points, stroke);
+            if (path->closed) {
+                std::reverse(cachedPoints.begin() + start, cachedPoints.end());
             }
+            cachedPaths.push_back({ start, cachedPoints.size() - start, path->closed != 0, stroke, fill });
         }
     }
 }
 
-void Svg::draw(SvgRenderer &renderer, Vec2d position, mssm::Color stroke, mssm::Color fill)
+// path's points scaled and moved into place, in scratch.  closeLine repeats
+// the first point at the end, to outline a closed path with a polyline
+const std::vector<Vec2d>& Svg::placed(const CachedPath& path, Vec2d position, double scale, bool closeLine)
 {
-    std::vector<Vec2d> points;
+    const Vec2d* from = cachedPoints.data() + path.start;
+    scratch.resize(path.count);
+    for (size_t i = 0; i < path.count; i++) {
+        scratch[i] = from[i] * scale + position;
+    }
+    if (closeLine) {
+        scratch.push_back(scratch.front());
+    }
+    return scratch;
+}
 
-    //  printf("size: %f x %f\n", image->width, image->height);
-    // Use...
-    for (auto shape = image->shapes; shape != NULL; shape = shape->next) {
-        // mssm::Color fill = mssm::Color::fromIntBGR(shape->fill.color);
-        // mssm::Color stroke = mssm::Color::fromIntBGR(shape->stroke.color);
-        for (auto path = shape->paths; path != NULL; path = path->next) {
-            points.clear();
-            for (int i = 0; i < path->npts-1; i += 3) {
-                Vec2f* p = reinterpret_cast<Vec2f*>(&path->pts[i*2]);
-                cubicBezier<Vec2f, Vec2d>(p[0]*10, p[1]*10, p[2]*10, p[3]*10, 1000, true, points);
-            }
-            for (auto& p : points) {
-                p += position;
-            }
-            if (path->closed) {
-                std::reverse(points.begin(), points.end());
-                renderer.polygon(points, stroke, fill);
-            }
-            else {
-                renderer.polyline(points, stroke);
-            }
-            break;
+void Svg::draw(SvgRenderer& renderer, Vec2d position, double scale)
+{
+    flatten(scale);
+    for (auto& path : cachedPaths) {
+        mssm::Color stroke = path.stroke;
+        if (path.closed) {
+            mssm::Color fill = path.fill;
+            renderer.polygon(placed(path, position, scale, false), stroke, fill);
+        }
+        else {
+            renderer.polyline(placed(path, position, scale, false), stroke);
         }
-        break;
     }
 }
 
-void Svg::drawLines(SvgRenderer &renderer, Vec2d position, mssm::Color stroke)
+void Svg::draw(SvgRenderer &renderer, Vec2d position, mssm::Color stroke, mssm::Color fill, double scale)
 {
-    std::vector<Vec2d> points;
-
-    //  printf("size: %f x %f\n", image->width, image->height);
-    // Use...
-    for (auto shape = image->shapes; shape != NULL; shape = shape->next) {
-        // mssm::Color fill = mssm::Color::fromIntBGR(shape->fill.color);
-        // mssm::Color stroke = mssm::Color::fromIntBGR(shape->stroke.color);
-        for (auto path = shape->paths; path != NULL; path = path->next) {
-            points.clear();
-            if (path->npts == 0) {
-                continue;
-            }
-            for (int i = 0; i < path->npts-1; i += 3) {
-                Vec2f* p = reinterpret_cast<Vec2f*>(&path->pts[i*2]);
-                cubicBezier<Vec2f, Vec2d>(p[0], p[1], p[2], p[3], 1, true, points);
-            }
-            if (path->closed) {
-                points.push_back(points.front());
-            }
-            for (auto& p : points) {
-                p += position;
-            }
-            renderer.polyline(points, stroke);
+    flatten(scale);
+    for (auto& path : cachedPaths) {
+        if (path.closed) {
+            renderer.polygon(placed(path, position, scale, false), stroke, fill);
         }
+        else {
+            renderer.polyline(placed(path, position, scale, false), stroke);
+        }
+    }
+}
+
+void Svg::drawLines(SvgRenderer &renderer, Vec2d position, mssm::Color stroke, double scale)
+{
+    flatten(scale);
+    for (auto& path : cachedPaths) {
+        renderer.polyline(placed(path, position, scale, path.closed), stroke);
     }
 }
@@ -4,6 +4,7 @@
 #include "color.h"
 #include "vec2d.h"
 #include <string>
+#include <vector>
 
 struct NSVGimage;
 
@@ -14,15 +15,44 @@ public:
     virtual void polyline(const std::vector<Vec2d>& points, mssm::Color& stroke) = 0;
 };
 
+// An SVG file, drawn as polygons (closed paths) and polylines (open ones).
+//
+// The curves are flattened once into a cache of points in the file's own
+// units, with a tolerance that keeps them within a fraction of a pixel at the
+// scale drawn.  Scales are grouped into power of two buckets and the cache is
+// only rebuilt when a draw lands in a different bucket, so drawing is
+// normally just a scale and translate of the cached points.
 class Svg
 {
+    class CachedPath {
+    public:
+        size_t      start;  // into cachedPoints
+        size_t      count;
+        bool        closed;
+        mssm::Color stroke;
+        mssm::Color fill;
+    };
+
     struct NSVGimage* image;
+
+    int                     cachedBucket;
+    std::vector<Vec2d>      cachedPoints;
+    std::vector<CachedPath> cachedPaths;
+    std::vector<Vec2d>      scratch;      // the path being handed to the renderer
 public:
     Svg(std::string filename);
     ~Svg();
-    void draw(SvgRenderer& renderer, Vec2d position);
-    void draw(SvgRenderer& renderer, Vec2d position, mssm::Color stroke, mssm::Color fill);
-    void drawLines(SvgRenderer& renderer, Vec2d position, mssm::Color stroke);
+
+    Svg(const Svg&) = delete;
+    Svg& operator=(const Svg&) = delete;
+
+    // scale: pixels per SVG unit
+    void draw(SvgRenderer& renderer, Vec2d position, double scale = 1);
+    void draw(SvgRenderer& renderer, Vec2d position, mssm::Color stroke, mssm::Color fill, double scale = 1);
+    void drawLines(SvgRenderer& renderer, Vec2d position, mssm::Color stroke, double scale = 1);
+private:
+    void flatten(double scale);
+    const std::vector<Vec2d>& placed(const CachedPath& path, Vec2d position, double scale, bool closeLine);
 };
 
 
@@ -3,21 +3,20 @@
 
 #include <algorithm>
 #include <cctype>
+#include <charconv>
 #include <optional>
-#include <ranges>
 #include <string>
 
 using namespace std;
 
-ParseInput::ParseInput(const std::string& txt)
-    : _text(txt), root(this), parent(nullptr), start(0), pos(0), failed(false)
+ParseInput::ParseInput(std::string_view txt)
+    : _text(txt), parent(nullptr), pos(0), failed(false)
 {
 }
 
 ParseInput::ParseInput(ParseInput& par)
-    : root(par.root), parent(&par), start(par.start + par.pos), pos(0), failed(false)
+    : _text(par.text()), parent(&par), pos(0), failed(false)
 {
-    _text = text(); // TODO: REMOVE THIS! just to help with debugging
 }
 
 ParseInput::~ParseInput()
@@ -38,12 +37,12 @@ bool ParseInput::fail(const std::string& errorMsg)
 
 bool ParseInput::isEnd() const
 {
-    return pos >= root->_text.size();
+    return pos >= _text.size();
 }
 
 void ParseInput::skipWhitespace()
 {
-    while (pos < root->_text.size() && std::isspace(root->_text[start + pos]))
+    while (pos < _text.size() && std::isspace(static_cast<unsigned char>(_text[pos])))
     {
         ++pos;
     }
@@ -57,53 +56,55 @@ void ParseInput::advance(size_t n)
 bool ParseInput::readInt(int& value, bool skipWs)
 {
     if (skipWs) skipWhitespace();
-    auto subrange = std::ranges::subrange(root->_text.begin() + start + pos, root->_text.end());
-    auto it = subrange.begin();
+    const char* begin = _text.data() + pos;
+    const char* end = _text.data() + _text.size();
+    const char* digits = begin < end && *begin == '+' ? begin + 1 : begin; // from_chars doesn't take a plus sign
 
-    size_t len = 0;
-    try
-    {
-        value = std::stoi(std::string(it, subrange.end()), &len);
-    }
-    catch (...)
+    auto [last, ec] = std::from_chars(digits, end, value);
+    if (ec != std::errc())
     {
         return fail("Failed to read integer.");
     }
 
-    advance(len);
+    advance(last - begin);
     return success();
 }
 
 bool ParseInput::readDouble(double& value, bool skipWs)
 {
     if (skipWs) skipWhitespace();
-    auto subrange = std::ranges::subrange(root->_text.begin() + start + pos, root->_text.end());
-    auto it = subrange.begin();
+    const char* begin = _text.data() + pos;
+    const char* end = _text.data() + _text.size();
+    const char* digits = begin < end && *begin == '+' ? begin + 1 : begin;
 
-    size_t len = 0;
-    try
-    {
-        value = std::stod(std::string(it, subrange.end()), &len);
-    }
-    catch (...)
+    auto [last, ec] = std::from_chars(digits, end, value);
+    if (ec != std::errc())
     {
         return fail("Failed to read double.");
     }
 
-    advance(len);
+    advance(last - begin);
     return success();
 }
 
-bool ParseInput::readToken(std::string& value, bool skipWs)
+bool ParseInput::readToken(std::string_view& value, bool skipWs)
 {
     if (skipWs) skipWhitespace();
-    auto subrange = std::ranges::subrange(root->_text.begin() + start + pos, root->_text.end());
-    auto it = std::ranges::find_if_not(subrange, [](unsigned char c) { return std::isalnum(c); });
+    auto rest = text();
+    auto it = std::find_if_not(rest.begin(), rest.end(), [](unsigned char c) { return std::isalnum(c); });
 
-    if (it == subrange.begin()) return fail("Failed to read token.");
+    if (it == rest.begin()) return fail("Failed to read token.");
 
-    value = std::string(subrange.begin(), it);
-    advance(it - subrange.begin());
+    value = rest.substr(0, it - rest.begin());
+    advance(value.size());
+    return success();
+}
+
+bool ParseInput::readToken(std::string& value, bool skipWs)
+{
+    std::string_view token;
+    if (!readToken(token, skipWs)) return false;
+    value = token;
     return success();
 }
 
@@ -112,17 +113,16 @@ bool ParseInput::readChar(char& value, bool skipWs)
     if (skipWs) skipWhitespace();
     if (isEnd()) return fail("Reached end of input.");
 
-    value = root->_text[start + pos];
+    value = _text[pos];
     advance(1);
     return success();
 }
 
-bool ParseInput::readFixedToken(const std::string& expected, bool skipWs)
+bool ParseInput::readFixedToken(std::string_view expected, bool skipWs)
 {
     if (skipWs) skipWhitespace();
-    auto subrange = std::ranges::subrange(root->_text.begin() + start + pos, root->_text.end());
 
-    if (!std::ranges::equal(expected, subrange | std::views::take(expected.size())))
+    if (!text().starts_with(expected))
     {
         return fail("Fixed token mismatch.");
     }
@@ -142,13 +142,13 @@ bool ParseInput::readFixedChar(char c, bool skipWs)
 bool ParseInput::skip(char c, bool skipWs)
 {
     if (skipWs) {
-        while (pos < root->_text.size() && (std::isspace(root->_text[start + pos]) || root->_text[start + pos] == c))
+        while (pos < _text.size() && (std::isspace(static_cast<unsigned char>(_text[pos])) || _text[pos] == c))
         {
             ++pos;
         }
     }
     else {
-        if (pos < root->_text.size() && root->_text[start + pos] == c)
+        if (pos < _text.size() && _text[pos] == c)
         {
             ++pos;
         }
@@ -156,6 +156,20 @@ bool ParseInput::skip(char c, bool skipWs)
     return true;
 }
 
+bool ParseInput::peek(char& value, bool skipWs)
+{
+    if (skipWs) skipWhitespace();
+    if (isEnd()) return false;
+
+    value = _text[pos];
+    return true;
+}
+
+bool ParseInput::atEnd(bool skipWs)
+{
+    if (skipWs) skipWhitespace();
+    return isEnd();
+}
 
 bool ParseInput::readOneOf(const char *charSet, int& index, bool skipWs)
 {
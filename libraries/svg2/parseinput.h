@@ -4,34 +4,44 @@
 #include <cctype>
 #include <optional>
 #include <string>
-
-
+#include <string_view>
+
+// A cursor over text that it doesn't own (the text has to outlive it).
+//
+// A ParseInput made from another starts where that one has got to, and when
+// it goes away moves the other on by however far it read - unless it failed,
+// which puts it back to its start.  So a parser can try something with a
+// child input and only keep what it read if it worked.
 class ParseInput
 {
-    std::string _text;
-    ParseInput* root;
+    std::string_view _text;
     ParseInput* parent;
-    size_t start;
     size_t pos;
     bool failed;
     std::optional<std::string> errorMessage;
 
 public:
-    ParseInput(const std::string& text);
+    ParseInput(std::string_view text);
     ParseInput(ParseInput& par);
     ~ParseInput();
 
-    std::string text() const { return root->_text.substr(start + pos); }
+    std::string_view text() const { return _text.substr(pos); }
+    size_t position() const { return pos; }
 
     bool readInt(int& value, bool skipWs = true);
     bool readDouble(double& value, bool skipWs = true);
     bool readToken(std::string& value, bool skipWs = true);
+    bool readToken(std::string_view& value, bool skipWs = true);
     bool readChar(char& value, bool skipWs = true);
-    bool readFixedToken(const std::string& expected, bool skipWs = true);
+    bool readFixedToken(std::string_view expected, bool skipWs = true);
     bool readFixedChar(char c, bool skipWs = true);
     bool skip(char c, bool skipWs = true);
     bool readOneOf(const char* charSet, int& index, bool skipWs = true);
 
+    // the next character, without reading it.  False at the end
+    bool peek(char& value, bool skipWs = true);
+    bool atEnd(bool skipWs = true);
+
     bool fail(const std::string& errorMsg = "");
     bool success() { return true; }
     bool gotFail() const { return failed; }
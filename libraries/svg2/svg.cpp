@@ -1,10 +1,13 @@
 #include "svg.h"
+#include <fstream>
 #include <iostream>
 #include <ostream>
+#include <stdexcept>
 
 using namespace tinyxml2;
 
 Svg::Svg(const std::string& filename)
+    : SvgStructElement(std::make_shared<SvgArena>())
 {
     if (!filename.empty())
     {
@@ -177,123 +180,64 @@ void Svg::save(const std::string& filename)
 
 }
 
-template<typename I>
-I begin(std::pair<I, I> collection)
-{
-    return collection.first;
-}
+namespace {
 
-std::string fixZero(const char* str)
+// the header attribute, or nothing if it isn't there
+std::string headerValue(const SvgElement& element, std::string_view key)
 {
-    return str ? std::string(str) : "";
+    return std::string(element.attribute(key));
 }
 
+} // namespace
+
 void Svg::load(const std::string& filename)
 {
-    tinyxml2::XMLDocument doc;
-    if (doc.LoadFile(filename.c_str()) != tinyxml2::XML_SUCCESS) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) {
         std::cerr << "Failed to load SVG file: " << filename << std::endl;
         return;
     }
 
-    // Retrieve root element
-    tinyxml2::XMLElement* root = doc.RootElement();
-    if (!root || std::string(root->Name()) != "svg") {
-        std::cerr << "Invalid SVG root element." << std::endl;
+    std::string text(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    if (!file.read(text.data(), static_cast<std::streamsize>(text.size()))) {
+        std::cerr << "Failed to load SVG file: " << filename << std::endl;
         return;
     }
 
-    // Read attributes from root element
-    headerInfo.xmlns_dc = fixZero(root->Attribute("xmlns:dc"));
-    headerInfo.xmlns_cc = fixZero(root->Attribute("xmlns:cc"));
-    headerInfo.xmlns_rdf = fixZero(root->Attribute("xmlns:rdf"));
-    headerInfo.xmlns_svg = fixZero(root->Attribute("xmlns:svg"));
-    headerInfo.xmlns = fixZero(root->Attribute("xmlns"));
-    headerInfo.width = fixZero(root->Attribute("width"));
-    headerInfo.height = fixZero(root->Attribute("height"));
-    headerInfo.viewBox = fixZero(root->Attribute("viewBox"));
-    headerInfo.id = fixZero(root->Attribute("id"));
-    headerInfo.version = fixZero(root->Attribute("version"));
-
-    // Handle metadata, defs, and other child elements
-    tinyxml2::XMLElement* metadata = root->FirstChildElement("metadata");
-    if (metadata) {
-        tinyxml2::XMLElement* rdfRDF = metadata->FirstChildElement("rdf:RDF");
-        if (rdfRDF) {
-            tinyxml2::XMLElement* ccWork = rdfRDF->FirstChildElement("cc:Work");
-            if (ccWork) {
-                // Read attributes and child elements of cc:Work
-                //const char* about = ccWork->Attribute("rdf:about");
-                tinyxml2::XMLElement* dcFormat = ccWork->FirstChildElement("dc:format");
-                if (dcFormat) {
-                    //const char* format = dcFormat->GetText();
-                }
-                tinyxml2::XMLElement* dcType = ccWork->FirstChildElement("dc:type");
-                if (dcType) {
-                    //const char* resource = dcType->Attribute("rdf:resource");
-                }
-                //tinyxml2::XMLElement* dcTitle = ccWork->FirstChildElement("dc:title");
-                // Handle dc:title if necessary
-            }
-        }
-    }
+    // the elements point into the text, so it's kept for as long as they are
+    arena = std::make_shared<SvgArena>(std::move(text));
+    attributes.clear();
+    elements.clear();
 
-    SvgStructElement::load(root);
+    try {
+        SvgXmlReader reader(*arena);
+        SvgXmlTag root;
 
-    // // Parse child elements like groups or paths
-    // for (tinyxml2::XMLElement* child = root->FirstChildElement("g"); child; child = child->NextSiblingElement("g")) {
-    //     auto group = createGroup();
-    //     group->load(child);
-    //     elements.push_back(group);
-    // }
-
-    // // Additional parsing for specific elements
-    // for (SvgElementPtr element : elements) {
-    //     element->loadFromXml(root);
-    // }
-    //
-    //     /*
-    //     auto kids = doc.root().getChildren("g");
-
-    //     for (auto gi = kids.first; gi != kids.second; ++gi)
-    //     {
-    //         // load groups
-    //         auto group = createGroup();
-    //         group->load(*gi);
-    //     }
-    //     */
-    //        /*
-    //       <defs
-    //          id="defs4" />
-    //       <metadata
-    //          id="metadata7">
-    //         <rdf:RDF>
-    //           <cc:Work
-    //              rdf:about="">
-    //             <dc:format>image/svg+xml</dc:format>
-    //             <dc:type
-    //                rdf:resource="http://purl.org/dc/dcmitype/StillImage" />
-    //             <dc:title></dc:title>
-    //           </cc:Work>
-    //         </rdf:RDF>
-    //       </metadata>
-    //       <g
-    //          style="display:inline"
-    //          id="layer2">
-    //         <path
-    //            id="path4640"
-    //            style="fill:#1b1918;fill-rule:evenodd;stroke:#000000;stroke-width:0.1;stroke-miterlimit:4;stroke-dasharray:none"
-    //            d="m 357.02507,426.67697 -0.0917,-0.7335 -0.4584,-0.6418 -0.6418,-0.4584 -0.8252,-0.1834 -0.8251,0.1834 -0.6418,0.4584 -0.3667,0.6418 -0.1834,0.7335 0.1834,0.8252 0.3667,0.6418 0.6418,0.4584 0.8251,0.1833 0.8252,-0.1833 0.6418,-0.4584 0.4584,-0.6418 0.0917,-0.8252 z" />
-    //         <path
-    //            id="path4642"
-    //            */
-    // }
-    // catch (zen::XmlFileError &err)
-    // {
+        if (!reader.nextChild(root) || root.name != "svg") {
+            std::cerr << "Invalid SVG root element." << std::endl;
+            return;
+        }
 
-    // }
-    // catch (zen::XmlParsingError &err)
-    // {
+        SvgStructElement::load(reader, root);
+    }
+    catch (const std::runtime_error& e) {
+        std::cerr << "Failed to load SVG file: " << filename << ": " << e.what() << std::endl;
+        return;
+    }
 
-    // }
+    // Read attributes from root element
+    headerInfo.xmlns_dc = headerValue(*this, "xmlns:dc");
+    headerInfo.xmlns_cc = headerValue(*this, "xmlns:cc");
+    headerInfo.xmlns_rdf = headerValue(*this, "xmlns:rdf");
+    headerInfo.xmlns_svg = headerValue(*this, "xmlns:svg");
+    headerInfo.xmlns = headerValue(*this, "xmlns");
+    headerInfo.width = headerValue(*this, "width");
+    headerInfo.height = headerValue(*this, "height");
+    headerInfo.viewBox = headerValue(*this, "viewBox");
+    headerInfo.id = headerValue(*this, "id");
+    headerInfo.version = headerValue(*this, "version");
+
+    // metadata, defs and anything else the model doesn't handle are skipped
+    // as the children are read
 }
@@ -0,0 +1,61 @@
+#include "svgarena.h"
+#include <cstring>
+#include <functional>
+
+SvgArena::SvgArena(std::string text)
+    : source(std::move(text))
+{
+}
+
+std::string_view SvgArena::keep(std::string_view text)
+{
+    if (text.empty()) {
+        return {};
+    }
+
+    if (text.size() > blockSize / 4) {
+        // big ones get a block to themselves, leaving the current one to fill
+        auto block = std::make_unique<char[]>(text.size());
+        char* copy = block.get();
+        std::memcpy(copy, text.data(), text.size());
+        blocks.insert(blocks.empty() ? blocks.end() : blocks.end() - 1, std::move(block));
+        return { copy, text.size() };
+    }
+
+    if (blockSize - blockUsed < text.size()) {
+        blocks.push_back(std::make_unique<char[]>(blockSize));
+        blockUsed = 0;
+    }
+
+    char* copy = blocks.back().get() + blockUsed;
+    std::memcpy(copy, text.data(), text.size());
+    blockUsed += text.size();
+    return { copy, text.size() };
+}
+
+SvgName SvgArena::intern(std::string_view name)
+{
+    auto found = nameIds.find(name);
+    if (found != nameIds.end()) {
+        return found->second;
+    }
+
+    // names read from the source can point into it; any other has to be kept
+    std::less<const char*> before;
+    bool inSource = !before(name.data(), source.data()) && !before(source.data() + source.size(), name.data() + name.size());
+    std::string_view kept = inSource ? name : keep(name);
+
+    SvgName id = static_cast<SvgName>(names.size());
+    names.push_back(kept);
+    nameIds.emplace(kept, id);
+    return id;
+}
+
+std::optional<SvgName> SvgArena::find(std::string_view name) const
+{
+    auto found = nameIds.find(name);
+    if (found == nameIds.end()) {
+        return std::nullopt;
+    }
+    return found->second;
+}
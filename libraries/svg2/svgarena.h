@@ -0,0 +1,49 @@
+#ifndef SVGARENA_H
+#define SVGARENA_H
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using SvgName = uint32_t;
+
+// The text of a loaded document, and everything the model points into it.
+//
+// Element and attribute names are interned to small ids, and attribute
+// values are views of the source text.  Strings that aren't in the source
+// (values with entities decoded, values set after loading) are copied into
+// blocks owned here.  Nothing is freed or moved until the arena goes, so the
+// views stay good for as long as it does (elements share it for that reason).
+class SvgArena
+{
+    static constexpr size_t blockSize = 64 * 1024;
+
+    std::string source;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    size_t blockUsed{blockSize};
+
+    std::vector<std::string_view> names;
+    std::unordered_map<std::string_view, SvgName> nameIds;
+public:
+    SvgArena(std::string text = {});
+
+    SvgArena(const SvgArena&) = delete;
+    SvgArena& operator=(const SvgArena&) = delete;
+
+    std::string_view text() const { return source; }
+
+    // a copy of text that lasts as long as the arena
+    std::string_view keep(std::string_view text);
+
+    SvgName intern(std::string_view name);
+    std::optional<SvgName> find(std::string_view name) const;
+    std::string_view name(SvgName id) const { return names[id]; }
+};
+
+using SvgArenaPtr = std::shared_ptr<SvgArena>;
+
+#endif // SVGARENA_H
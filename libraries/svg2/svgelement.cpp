@@ -3,41 +3,84 @@
 #include "svgstructelement.h"
 #include "tinyxml2.h"
 
-
 using namespace std;
 
 
-SvgElement::SvgElement() {}
+SvgElement::SvgElement(SvgArenaPtr arena) : arena(std::move(arena)) {}
 
-void SvgElement::loadAttributes(tinyxml2::XMLElement* xmlElement) {
-    for (const tinyxml2::XMLAttribute* attr = xmlElement->FirstAttribute(); attr; attr = attr->Next()) {
-        attributes[attr->Name()] = attr->Value();
+// index in attributes, or attributes.size() if it isn't there
+size_t SvgElement::findAttribute(std::string_view key) const
+{
+    auto id = arena->find(key);
+    if (!id) {
+        return attributes.size(); // no element anywhere has it
+    }
+    size_t i = 0;
+    while (i < attributes.size() && attributes[i].key != *id) {
+        i++;
     }
+    return i;
+}
+
+std::string_view SvgElement::attribute(std::string_view key) const
+{
+    size_t i = findAttribute(key);
+    return i < attributes.size() ? attributes[i].value : std::string_view{};
+}
+
+bool SvgElement::hasAttribute(std::string_view key) const
+{
+    return findAttribute(key) < attributes.size();
+}
+
+void SvgElement::setAttribute(std::string_view key, std::string_view value)
+{
+    value = arena->keep(value);
+    size_t i = findAttribute(key);
+    if (i < attributes.size()) {
+        attributes[i].value = value;
+    }
+    else {
+        attributes.push_back({ arena->intern(key), value });
+    }
+}
+
+void SvgElement::removeAttribute(std::string_view key)
+{
+    size_t i = findAttribute(key);
+    if (i < attributes.size()) {
+        attributes.erase(attributes.begin() + i);
+    }
+}
+
+void SvgElement::loadAttributes(const SvgXmlTag& tag) {
+    attributes = tag.attributes;
 }
 
 void SvgElement::saveAttributes(tinyxml2::XMLElement* xmlElement) {
     for (const auto& attr : attributes) {
-        xmlElement->SetAttribute(attr.first.c_str(), attr.second.c_str());
+        xmlElement->SetAttribute(std::string(arena->name(attr.key)).c_str(), std::string(attr.value).c_str());
     }
 }
 
-SvgElementPtr SvgElement::createFromXml(tinyxml2::XMLElement* xmlElement) {
+SvgElementPtr SvgElement::createFromXml(SvgXmlReader& reader, const SvgXmlTag& tag, SvgArenaPtr arena) {
     SvgElementPtr ptr;
 
-    std::string name = xmlElement->Name();
-
-    if (name == "path") {
-        ptr.reset(new SvgPath());
-    } else if (name == "g") {
-        ptr.reset(new SvgStructElement());
-    } else if (name == "rect") {
+    if (tag.name == "path") {
+        ptr.reset(new SvgPath(arena));
+    } else if (tag.name == "g") {
+        ptr.reset(new SvgStructElement(arena));
+    } else if (tag.name == "rect") {
         // Handle 'rect' element
-    } else if (name == "ellipse") {
+    } else if (tag.name == "ellipse") {
         // Handle 'ellipse' element
     }
 
     if (ptr) {
-        ptr->load(xmlElement);
+        ptr->load(reader, tag);
+    }
+    else {
+        reader.skip(tag);
     }
 
     return ptr;
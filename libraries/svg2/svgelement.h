@@ -3,56 +3,51 @@
 
 #include <vector>
 #include <memory>
-#include <map>
 #include <string>
+#include <string_view>
+#include "svgarena.h"
+#include "svgxml.h"
 #include "tinyxml2.h"
 
-namespace zen
-{
-    class XmlElement;
-}
-
-// template <typename I>
-// struct iter_pair : std::pair<I, I>
-// {
-//     iter_pair(const std::pair<I, I>& p) : std::pair<I,I>{p} {}
-// //    using std::pair<I, I>::pair; // inherit the constructors from std::pair
-
-//     I begin() { return this->first; }
-//     I end() { return this->second; }
-// };
-
-// template<typename T>
-// iter_pair<T> iterable(const std::pair<T, T>& p)
-// {
-//     return iter_pair<T>{p};
-// }
-
 class SvgElement;
 using SvgElementPtr = std::shared_ptr<SvgElement>;
 
 
+// Attributes are kept in the order they were read, keyed by names interned in
+// the document's arena, with values that are views into it.  Elements only
+// have a handful, so they're searched in turn
 class SvgElement
 {
 protected:
-    std::map<std::string, std::string> attributes;
+    SvgArenaPtr arena;
+    std::vector<SvgAttribute> attributes;
 public:
-    SvgElement();
+    SvgElement(SvgArenaPtr arena);
     virtual ~SvgElement() {}
 
-    std::string& attribute(const std::string& key) { return attributes[key]; }
+    // empty if there's no such attribute
+    std::string_view attribute(std::string_view key) const;
+    bool hasAttribute(std::string_view key) const;
+    void setAttribute(std::string_view key, std::string_view value); // value is copied
+    void removeAttribute(std::string_view key);
+    const std::vector<SvgAttribute>& attributeList() const { return attributes; }
+    std::string_view attributeName(const SvgAttribute& attr) const { return arena->name(attr.key); }
 
     virtual void beforeSave() = 0;  // build svg attributes from other data if necessary for the save
     virtual void afterSave()  = 0;  // clean up svg attributes (get rid of any that were needed only for the save)
     virtual void afterLoad()  = 0;  // clean up svg attributes (get rid of any attributes that have been converted to another form)
 
-    void loadAttributes(tinyxml2::XMLElement* xmlElement);
+    void loadAttributes(const SvgXmlTag& tag);
     void saveAttributes(tinyxml2::XMLElement* xmlElement);
 
-    virtual void load(tinyxml2::XMLElement* xmlElement) = 0;
+    // tag has just been read; load it and (unless it's empty) its children
+    virtual void load(SvgXmlReader& reader, const SvgXmlTag& tag) = 0;
     virtual void saveAsChildOf(tinyxml2::XMLElement* xmlElement) = 0;
 
-    static SvgElementPtr createFromXml(tinyxml2::XMLElement* xmlElement);
+    // null (with the element skipped) if it isn't one the model handles
+    static SvgElementPtr createFromXml(SvgXmlReader& reader, const SvgXmlTag& tag, SvgArenaPtr arena);
+private:
+    size_t findAttribute(std::string_view key) const;
 };
 
 
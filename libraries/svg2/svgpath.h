@@ -1,8 +1,11 @@
 #ifndef SVGPATH_H
 #define SVGPATH_H
 
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
 #include "svgshape.h"
-#include "vec2d.h"
 
 
 
@@ -124,108 +127,66 @@ digit:
  * */
 
 
-class SvgPathElement;
-
-using SvgPathElementPtr = std::unique_ptr<SvgPathElement>;
-
-class SvgPathElement
-{
-    // enum class ElementType
-    // {
-    //     MoveTo,
-    //     LineTo,
-    // };
-};
-
-class SvgPathMoveTo : public SvgPathElement
-{
-    std::string   name{"MoveTo"};
-public:
-    bool          relative;
-    std::vector<Vec2d> coords;
-};
-
-class SvgPathLineTo : public SvgPathElement
-{
-    std::string   name{"LineTo"};
-public:
-    bool          relative;
-    std::vector<Vec2d> coords;
-};
-
-class SvgPathClosePath : public SvgPathElement
-{
-    std::string   name{"ClosePath"};
-};
-
-
-
-class SvgPathHVLineTo : public SvgPathElement
+// A path's "d" as flat arrays: one command per segment (repeated arguments,
+// as in "L 1 2 3 4", become a command each, and the pairs after a moveto
+// become linetos), with all their numbers in one list.  Arcs take
+// rx ry x-axis-rotation large-arc-flag sweep-flag x y, flags as 0 or 1
+enum class SvgPathOp : uint8_t
 {
-    std::string   name{"HVLineTo"};
-public:
-    bool isVertical;
-    std::vector<double> values;
-};
-
-class SvgPathCurveTo : public SvgPathElement
-{
-    std::string   name{"CurveTo"};
-public:
-    std::vector<Vec2d> coords;
-};
-
-class SvgPathSmoothCurveTo : public SvgPathElement
-{
-    std::string   name{"SmoothCurveTo"};
-public:
-    std::vector<Vec2d> coords;
+    MoveTo,
+    LineTo,
+    HorizontalLineTo,
+    VerticalLineTo,
+    CurveTo,
+    SmoothCurveTo,
+    QuadraticBezierCurveTo,
+    SmoothQuadraticBezierCurveTo,
+    EllipticalArc,
+    ClosePath,
+    Bearing
 };
 
-class SvgQuadraticBezierCurveTo : public SvgPathElement
+class SvgPathCommand
 {
-    std::string   name{"QuadraticBezierCurveTo"};
 public:
-    std::vector<Vec2d> coords;
+    SvgPathOp op;
+    bool      relative;  // lower case letter
+    uint32_t  first;     // its first number in SvgPathData::values
 };
 
-class SvgSmoothQuadraticBezierCurveTo : public SvgPathElement
+class SvgPathData
 {
-    std::string   name{"SmoothQuadraticBezierCurveTo"};
 public:
-    std::vector<Vec2d> coords;
+    std::vector<SvgPathCommand> commands;
+    std::vector<double>         values;
+
+    static int argumentCount(SvgPathOp op);
+    std::span<const double> arguments(const SvgPathCommand& command) const
+    {
+        return { values.data() + command.first, static_cast<size_t>(argumentCount(command.op)) };
+    }
 };
 
-class SvgEllipticalArcSegment : public SvgPathElement
-{
-    std::string   name{"EllipticalArcSeg"};
-public:
-    double v1, v2, v3;
-    int flag1;
-    int flag2;
-    Vec2d pt;
-};
-
-class SvgBearing : public SvgPathElement
-{
-    std::string   name{"Bearing"};
-public:
-    std::vector<double> values;
-};
+// Parse d into data (replacing what was there).  On an error, data keeps the
+// commands before it (as SVG renders paths up to the first error) and
+// false is returned
+bool parseSvgPathData(std::string_view d, SvgPathData& data);
 
 
 class SvgPath : public SvgShape
 {
 private:
-
+    SvgPathData data;
 public:
-    SvgPath();
+    SvgPath(SvgArenaPtr arena);
+
+    const SvgPathData& pathData() const { return data; }
 
     virtual void beforeSave() override;
     virtual void afterSave() override;
     virtual void afterLoad() override;
 
-    void load(tinyxml2::XMLElement* xmlElement) override;
+    void load(SvgXmlReader& reader, const SvgXmlTag& tag) override;
     void saveAsChildOf(tinyxml2::XMLElement* xmlElement) override;
 };
 
@@ -1,6 +1,7 @@
 #include "svgshape.h"
 
-SvgShape::SvgShape()
+SvgShape::SvgShape(SvgArenaPtr arena)
+    : SvgElement(std::move(arena))
 {
 
 }
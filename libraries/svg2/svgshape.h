@@ -6,7 +6,7 @@
 class SvgShape : public SvgElement
 {
 public:
-    SvgShape();
+    SvgShape(SvgArenaPtr arena);
 };
 
 
@@ -1,7 +1,8 @@
 #include "svgstructelement.h"
 #include "svgpath.h"
 
-SvgStructElement::SvgStructElement()
+SvgStructElement::SvgStructElement(SvgArenaPtr arena)
+    : SvgElement(std::move(arena))
 {
 
 }
@@ -30,7 +31,7 @@ SvgStructElementPtr SvgStructElement::createGroup()
 {
     SvgStructElementPtr group;
 
-    group.reset(new SvgStructElement());
+    group.reset(new SvgStructElement(arena));
 
     elements.push_back(group);
 
@@ -41,20 +42,23 @@ SvgPathPtr SvgStructElement::createPath()
 {
     SvgPathPtr path;
 
-    path.reset(new SvgPath());
+    path.reset(new SvgPath(arena));
 
     elements.push_back(path);
 
     return path;
 }
 
-void SvgStructElement::load(tinyxml2::XMLElement* element) {
-    loadAttributes(element);
+void SvgStructElement::load(SvgXmlReader& reader, const SvgXmlTag& tag) {
+    loadAttributes(tag);
 
-    for (tinyxml2::XMLElement* child = element->FirstChildElement(); child; child = child->NextSiblingElement()) {
-        auto svgElement = SvgElement::createFromXml(child);
-        if (svgElement) {
-            elements.push_back(svgElement);
+    if (!tag.empty) {
+        SvgXmlTag child;
+        while (reader.nextChild(child)) {
+            auto svgElement = SvgElement::createFromXml(reader, child, arena);
+            if (svgElement) {
+                elements.push_back(svgElement);
+            }
         }
     }
 
@@ -14,7 +14,7 @@ class SvgStructElement : public SvgElement
 protected:
     std::vector<SvgElementPtr> elements;
 public:
-    SvgStructElement();
+    SvgStructElement(SvgArenaPtr arena);
     std::vector<SvgElementPtr> children();
     SvgStructElementPtr createGroup();
     SvgPathPtr createPath();
@@ -23,7 +23,7 @@ public:
     virtual void afterSave() override;
     virtual void afterLoad() override;
 
-    void load(tinyxml2::XMLElement* element) override;
+    void load(SvgXmlReader& reader, const SvgXmlTag& tag) override;
     void saveAsChildOf(tinyxml2::XMLElement* xmlElement) override;
 };
 
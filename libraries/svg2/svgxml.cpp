@@ -0,0 +1,230 @@
+#include "svgxml.h"
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+bool isNameEnd(char c)
+{
+    return std::isspace(static_cast<unsigned char>(c)) || c == '/' || c == '>' || c == '=';
+}
+
+void appendUtf8(std::string& out, uint32_t c)
+{
+    if (c < 0x80) {
+        out += static_cast<char>(c);
+    }
+    else if (c < 0x800) {
+        out += static_cast<char>(0xC0 | (c >> 6));
+        out += static_cast<char>(0x80 | (c & 0x3F));
+    }
+    else if (c < 0x10000) {
+        out += static_cast<char>(0xE0 | (c >> 12));
+        out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (c & 0x3F));
+    }
+    else {
+        out += static_cast<char>(0xF0 | (c >> 18));
+        out += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (c & 0x3F));
+    }
+}
+
+// the predefined entities and character references.  Anything else is left as it is
+std::string decodeEntities(std::string_view value)
+{
+    static constexpr std::pair<std::string_view, char> named[] = {
+        { "amp", '&' }, { "lt", '<' }, { "gt", '>' }, { "quot", '"' }, { "apos", '\'' }
+    };
+
+    std::string out;
+    out.reserve(value.size());
+
+    for (size_t i = 0; i < value.size(); i++) {
+        size_t semi;
+        if (value[i] != '&' || (semi = value.find(';', i)) == std::string_view::npos) {
+            out += value[i];
+            continue;
+        }
+
+        std::string_view entity = value.substr(i + 1, semi - i - 1);
+        bool decoded = false;
+
+        if (entity.starts_with('#')) {
+            bool hex = entity.starts_with("#x");
+            std::string_view digits = entity.substr(hex ? 2 : 1);
+            uint32_t c;
+            auto [last, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), c, hex ? 16 : 10);
+            if (ec == std::errc() && last == digits.data() + digits.size() && !digits.empty() && c <= 0x10FFFF) {
+                appendUtf8(out, c);
+                decoded = true;
+            }
+        }
+        else {
+            for (auto& [name, c] : named) {
+                if (entity == name) {
+                    out += c;
+                    decoded = true;
+                    break;
+                }
+            }
+        }
+
+        if (decoded) {
+            i = semi;
+        }
+        else {
+            out += '&';
+        }
+    }
+
+    return out;
+}
+
+} // namespace
+
+SvgXmlReader::SvgXmlReader(SvgArena& arena)
+    : arena(arena), text(arena.text())
+{
+}
+
+void SvgXmlReader::error(const char* what) const
+{
+    throw std::runtime_error(std::string(what) + " at byte " + std::to_string(pos));
+}
+
+void SvgXmlReader::skipPast(std::string_view terminator, const char* what)
+{
+    size_t at = text.find(terminator, pos);
+    if (at == std::string_view::npos) {
+        error(what);
+    }
+    pos = at + terminator.size();
+}
+
+void SvgXmlReader::skipSpace()
+{
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+        pos++;
+    }
+}
+
+std::string_view SvgXmlReader::readName()
+{
+    size_t start = pos;
+    while (pos < text.size() && !isNameEnd(text[pos])) {
+        pos++;
+    }
+    return text.substr(start, pos - start);
+}
+
+std::string_view SvgXmlReader::readValue()
+{
+    if (pos >= text.size() || (text[pos] != '"' && text[pos] != '\'')) {
+        error("Expected a quoted attribute value");
+    }
+
+    char quote = text[pos++];
+    size_t end = text.find(quote, pos);
+    if (end == std::string_view::npos) {
+        error("Unterminated attribute value");
+    }
+
+    std::string_view value = text.substr(pos, end - pos);
+    pos = end + 1;
+
+    if (value.find('&') != std::string_view::npos) {
+        return arena.keep(decodeEntities(value));
+    }
+    return value;
+}
+
+bool SvgXmlReader::nextChild(SvgXmlTag& tag)
+{
+    for (;;) {
+        size_t open = text.find('<', pos);
+        if (open == std::string_view::npos) {
+            pos = text.size();
+            return false;
+        }
+        pos = open + 1;
+
+        std::string_view rest = text.substr(pos);
+
+        if (rest.starts_with("!--")) {
+            skipPast("-->", "Unterminated comment");
+        }
+        else if (rest.starts_with("![CDATA[")) {
+            skipPast("]]>", "Unterminated CDATA");
+        }
+        else if (rest.starts_with('!')) {
+            // DOCTYPE and the like, perhaps with an internal subset in []
+            size_t close = text.find_first_of("[>", pos);
+            if (close != std::string_view::npos && text[close] == '[') {
+                pos = close;
+                skipPast("]", "Unterminated declaration");
+            }
+            skipPast(">", "Unterminated declaration");
+        }
+        else if (rest.starts_with('?')) {
+            skipPast("?>", "Unterminated processing instruction");
+        }
+        else if (rest.starts_with('/')) {
+            skipPast(">", "Unterminated end tag");
+            return false;
+        }
+        else {
+            break;
+        }
+    }
+
+    tag.name = readName();
+    if (tag.name.empty()) {
+        error("Expected a tag name");
+    }
+    tag.attributes.clear();
+    tag.empty = false;
+
+    for (;;) {
+        skipSpace();
+        if (pos >= text.size()) {
+            error("Unterminated tag");
+        }
+        if (text[pos] == '>') {
+            pos++;
+            return true;
+        }
+        if (text.substr(pos).starts_with("/>")) {
+            pos += 2;
+            tag.empty = true;
+            return true;
+        }
+
+        std::string_view name = readName();
+        if (name.empty()) {
+            error("Expected an attribute name");
+        }
+        skipSpace();
+        if (pos >= text.size() || text[pos] != '=') {
+            error("Expected = after attribute name");
+        }
+        pos++;
+        skipSpace();
+        tag.attributes.push_back({ arena.intern(name), readValue() });
+    }
+}
+
+void SvgXmlReader::skip(const SvgXmlTag& tag)
+{
+    if (tag.empty) {
+        return;
+    }
+
+    SvgXmlTag child;
+    while (nextChild(child)) {
+        skip(child);
+    }
+}
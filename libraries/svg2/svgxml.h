@@ -0,0 +1,52 @@
+#ifndef SVGXML_H
+#define SVGXML_H
+
+#include <string_view>
+#include <vector>
+#include "svgarena.h"
+
+class SvgAttribute
+{
+public:
+    SvgName          key;
+    std::string_view value;
+};
+
+class SvgXmlTag
+{
+public:
+    std::string_view          name;
+    std::vector<SvgAttribute> attributes;
+    bool                      empty{false}; // <tag ... />, so no children
+};
+
+// Reads the arena's text as XML, one start tag at a time, in a single pass
+// with no tree built.  Names and values are views of the text (values are
+// only copied when they have entities to decode).  Declarations, comments,
+// CDATA and character data are skipped; the model has no use for them.
+//
+// Throws std::runtime_error on XML it can't make sense of.
+class SvgXmlReader
+{
+    SvgArena& arena;
+    std::string_view text;
+    size_t pos{0};
+public:
+    SvgXmlReader(SvgArena& arena);
+
+    // The next child of the element being read into tag, true if there was
+    // one.  False once the element's end tag (or the end of the text) is
+    // reached, with the end tag read
+    bool nextChild(SvgXmlTag& tag);
+
+    // pass over everything inside tag, which nextChild just returned
+    void skip(const SvgXmlTag& tag);
+private:
+    [[noreturn]] void error(const char* what) const;
+    void skipPast(std::string_view terminator, const char* what);
+    void skipSpace();
+    std::string_view readName();
+    std::string_view readValue();
+};
+
+#endif // SVGXML_H
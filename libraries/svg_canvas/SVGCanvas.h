@@ -3,11 +3,31 @@
 
 #include "canvas2d.h"
 #include "svg.hpp"
+#include "svgstreamwriter.h"
 #include <stack>
 #include <memory>
 #include <fstream>
+#include <vector>
 
+// Draws into an SVG file.
+//
+// In Document mode (the default) the drawing is built up as an svg.hpp tree
+// and written out by save().  In Streaming mode each element is written to
+// the file as it's drawn, through a fixed size buffer, so memory use stays
+// the same however much is drawn.  Consecutive lines and polylines of the
+// same colour are run together into one <path>.  save() finishes the file,
+// after which nothing more can be drawn.  A viewport set after drawing has
+// started is ignored there, and setBackground after drawing has started
+// paints a rectangle over what's already been drawn (clearing it, within the
+// current clip).  A clip pushed with replace closes the clips inside the
+// innermost pushGroup and popClip puts them back; clips outside that group
+// can't be lifted, so they still apply.
 class SVGCanvas : public mssm::Canvas2d {
+public:
+    enum class Mode {
+        Document,
+        Streaming
+    };
 private:
     int m_width;
     int m_height;
@@ -15,6 +35,21 @@ private:
     SVG::SVG m_svg;
     std::stack<SVG::Group*> m_groupStack;
     std::string m_filename;
+    SVG::Element* m_background{nullptr};
+
+    // streaming mode
+    std::unique_ptr<SVGStreamWriter> m_stream;
+    std::string m_viewBox;
+    bool m_haveBackground{false};
+    bool m_started{false};      // <svg> written
+    bool m_finished{false};     // </svg> written
+    std::vector<int> m_openGroups;             // clip path number of each open <g>, 0 for pushGroup's
+    std::vector<std::vector<int>> m_replacedClips; // per pushClip, the clips it closed to replace them
+    int  m_clipCount{0};
+    bool m_pathOpen{false};     // a <path> of lines is being added to
+    mssm::Color m_pathStroke;
+    Vec2d m_pathEnd;
+    size_t m_pathSegments{0};
 
     // Helper method to get the current drawing target (either the SVG or the top group)
     SVG::Element* currentTarget();
@@ -25,12 +60,28 @@ private:
     // Apply stroke and fill attributes to an SVG Element
     void applyStyle(SVG::Element* shape, const mssm::Color& stroke, const mssm::Color& fill = mssm::TRANSPARENT);
 
+    // Streaming mode output
+    void streamStart();
+    void beginElement(std::string_view name);
+    void attr(std::string_view name, double value);
+    void attr(std::string_view name, std::string_view value);
+    void style(const mssm::Color& stroke, const mssm::Color& fill = mssm::TRANSPARENT);
+    void endElement();
+    void streamLines(const Vec2d* points, size_t count, mssm::Color c);
+    void endPath();
+    void closeGroup();
+    void openClipGroup(int clip);
+    void placeholder(Vec2d pos, double w, double h, Vec2d labelPos);
+
 public:
-    SVGCanvas(int width, int height, const std::string& filename = "output.svg");
+    SVGCanvas(int width, int height, const std::string& filename = "output.svg", Mode mode = Mode::Document);
     ~SVGCanvas();
 
-    // Save the SVG to file
-    void save() const;
+    SVGCanvas(const SVGCanvas&) = delete;
+    SVGCanvas& operator=(const SVGCanvas&) = delete;
+
+    // Save the SVG to file (or in Streaming mode, finish it)
+    void save();
 
     // Override methods from Canvas2d
     bool isDrawable() override;
@@ -2,8 +2,68 @@
 #include <cmath>
 #include <cstdio>
 #include <algorithm>
+#include <stdexcept>
 #include "image.h"
 
+namespace {
+
+// a path of lines is ended and a new one started after this many segments,
+// to keep each "d" a reasonable length for viewers
+constexpr size_t maxPathSegments = 10000;
+
+class ArcEnds {
+public:
+    Vec2d start;
+    Vec2d end;
+    double rx;
+    double ry;
+    int largeArcFlag;
+    int sweepFlag;
+};
+
+// the ends of an arc of the ellipse w x h around center, from angle a (degrees) for alen
+ArcEnds arcEnds(Vec2d center, double w, double h, double a, double alen) {
+    // Convert angles from degrees to radians
+    double startAngle = a * M_PI / 180.0;
+    double endAngle = (a + alen) * M_PI / 180.0;
+
+    ArcEnds ends;
+    ends.rx = w / 2;
+    ends.ry = h / 2;
+    ends.start = { center.x + ends.rx * cos(startAngle), center.y + ends.ry * sin(startAngle) };
+    ends.end = { center.x + ends.rx * cos(endAngle), center.y + ends.ry * sin(endAngle) };
+
+    // SVG large-arc-flag is 0 for arcs less than 180 degrees, 1 for arcs greater than 180
+    ends.largeArcFlag = (alen > 180) ? 1 : 0;
+
+    // SVG sweep-flag is 1 for clockwise, 0 for counterclockwise
+    ends.sweepFlag = (alen > 0) ? 1 : 0;
+
+    return ends;
+}
+
+void writePoint(SVGStreamWriter& out, Vec2d p) {
+    out.number(p.x);
+    out.write(' ');
+    out.number(p.y);
+}
+
+// " A rx ry 0 large sweep x y"
+void writeArc(SVGStreamWriter& out, const ArcEnds& arc) {
+    out.write(" A ");
+    out.number(arc.rx);
+    out.write(' ');
+    out.number(arc.ry);
+    out.write(" 0 ");
+    out.number(arc.largeArcFlag);
+    out.write(' ');
+    out.number(arc.sweepFlag);
+    out.write(' ');
+    writePoint(out, arc.end);
+}
+
+} // namespace
+
 // Helper methods
 SVG::Element* SVGCanvas::currentTarget() {
     if (!m_groupStack.empty()) {
@@ -35,21 +95,185 @@ void SVGCanvas::applyStyle(SVG::Element* shape, const mssm::Color& stroke, const
     }
 }
 
+// Streaming mode output
+
+// the <svg> tag (and background) go out with the first thing drawn, so the
+// viewport and background can still be set up before that
+void SVGCanvas::streamStart() {
+    if (m_finished) {
+        throw std::logic_error("SVGCanvas: drawing after save() in streaming mode");
+    }
+    if (m_started) {
+        return;
+    }
+    m_started = true;
+
+    m_stream->write("<svg xmlns=\"http://www.w3.org/2000/svg\"");
+    attr("width", m_width);
+    attr("height", m_height);
+    attr("viewBox", m_viewBox);
+    m_stream->write(">\n");
+
+    if (m_haveBackground) {
+        setBackground(m_backgroundColor);
+    }
+}
+
+void SVGCanvas::beginElement(std::string_view name) {
+    endPath();
+    streamStart();
+    m_stream->write('<');
+    m_stream->write(name);
+}
+
+void SVGCanvas::attr(std::string_view name, double value) {
+    m_stream->write(' ');
+    m_stream->write(name);
+    m_stream->write("=\"");
+    m_stream->number(value);
+    m_stream->write('"');
+}
+
+void SVGCanvas::attr(std::string_view name, std::string_view value) {
+    m_stream->write(' ');
+    m_stream->write(name);
+    m_stream->write("=\"");
+    m_stream->escaped(value);
+    m_stream->write('"');
+}
+
+void SVGCanvas::style(const mssm::Color& stroke, const mssm::Color& fill) {
+    m_stream->write(" stroke=\"");
+    m_stream->color(stroke);
+    m_stream->write("\" fill=\"");
+    m_stream->color(fill);
+    m_stream->write('"');
+
+    if (stroke.a > 0) {
+        m_stream->write(" stroke-width=\"1\"");
+    }
+}
+
+void SVGCanvas::endElement() {
+    m_stream->write("/>\n");
+}
+
+// Lines go into the open path if it's the same colour, as a new subpath
+// unless they carry on from where it ended
+void SVGCanvas::streamLines(const Vec2d* points, size_t count, mssm::Color c) {
+    if (count < 2) {
+        return;
+    }
+
+    if (m_pathOpen && (!(c == m_pathStroke) || m_pathSegments >= maxPathSegments)) {
+        endPath();
+    }
+
+    if (!m_pathOpen) {
+        beginElement("path");
+        style(c);
+        m_stream->write(" d=\"M ");
+        writePoint(*m_stream, points[0]);
+        m_pathOpen = true;
+        m_pathStroke = c;
+        m_pathSegments = 0;
+    }
+    else if (!points[0].exactlyEquals(m_pathEnd)) {
+        m_stream->write(" M ");
+        writePoint(*m_stream, points[0]);
+    }
+
+    m_stream->write(" L");
+    for (size_t i = 1; i < count; i++) {
+        m_stream->write(' ');
+        writePoint(*m_stream, points[i]);
+    }
+
+    m_pathEnd = points[count - 1];
+    m_pathSegments += count - 1;
+}
+
+void SVGCanvas::endPath() {
+    if (m_pathOpen) {
+        m_stream->write("\"/>\n");
+        m_pathOpen = false;
+    }
+}
+
+void SVGCanvas::closeGroup() {
+    if (!m_openGroups.empty()) {
+        endPath();
+        m_stream->write("</g>\n");
+        m_openGroups.pop_back();
+    }
+}
+
+// a group clipped by the clip path already written out as clip_<clip>
+void SVGCanvas::openClipGroup(int clip) {
+    beginElement("g");
+    attr("clip-path", "url(#clip_" + std::to_string(clip) + ")");
+    m_stream->write(">\n");
+    m_openGroups.push_back(clip);
+}
+
+// the grey box with "Image" in it that stands in for an image
+void SVGCanvas::placeholder(Vec2d pos, double w, double h, Vec2d labelPos) {
+    beginElement("rect");
+    attr("x", pos.x);
+    attr("y", pos.y);
+    attr("width", w);
+    attr("height", h);
+    m_stream->write(" fill=\"grey\" stroke=\"black\"");
+    endElement();
+
+    beginElement("text");
+    attr("x", labelPos.x);
+    attr("y", labelPos.y);
+    m_stream->write(" text-anchor=\"middle\" dominant-baseline=\"middle\" fill=\"black\">Image</text>\n");
+}
+
 // Constructor and destructor
-SVGCanvas::SVGCanvas(int width, int height, const std::string& filename)
+SVGCanvas::SVGCanvas(int width, int height, const std::string& filename, Mode mode)
     : m_width(width), m_height(height), m_backgroundColor(mssm::BLACK), m_filename(filename) {
 
+    m_viewBox = "0 0 " + std::to_string(width) + " " + std::to_string(height);
+
+    if (mode == Mode::Streaming) {
+        m_stream = std::make_unique<SVGStreamWriter>(filename);
+        return;
+    }
+
     m_svg.set_attr("width", width);
     m_svg.set_attr("height", height);
-    m_svg.set_attr("viewBox", "0 0 " + std::to_string(width) + " " + std::to_string(height));
+    m_svg.set_attr("viewBox", m_viewBox);
 }
 
 SVGCanvas::~SVGCanvas() {
-    save();
+    try {
+        save();
+    }
+    catch (...) {
+        // nowhere to report it from here
+    }
 }
 
 // Public methods
-void SVGCanvas::save() const {
+void SVGCanvas::save() {
+    if (m_stream) {
+        if (m_finished) {
+            return;
+        }
+        streamStart();
+        endPath();
+        while (!m_openGroups.empty()) {
+            closeGroup();
+        }
+        m_stream->write("</svg>\n");
+        m_finished = true;
+        m_stream->flush();
+        return;
+    }
+
     std::ofstream out(m_filename);
     if (out) {
         // Convert the SVG to string using the operator std::string() which calls svg_to_string internally
@@ -72,130 +296,179 @@ int SVGCanvas::height() {
 void SVGCanvas::setBackground(mssm::Color c) {
     m_backgroundColor = c;
 
+    if (m_stream) {
+        m_haveBackground = true;
+        // what's written can't be taken back, so after the first element this
+        // paints over it (inside any open groups, so within the current clip)
+        if (m_started) {
+            beginElement("rect");
+            m_stream->write(" x=\"0\" y=\"0\"");
+            attr("width", m_width);
+            attr("height", m_height);
+            m_stream->write(" fill=\"");
+            m_stream->color(c);
+            m_stream->write('"');
+            endElement();
+        }
+        return;
+    }
+
     // Find or create the background rectangle
-    SVG::Element* background = m_svg.get_element_by_id("background");
-    if (!background) {
-        background = m_svg.add_child<SVG::Rect>();
-        background->set_attr("id", "background");
-        background->set_attr("x", "0");
-        background->set_attr("y", "0");
-        background->set_attr("width", std::to_string(m_width));
-        background->set_attr("height", std::to_string(m_height));
+    if (!m_background) {
+        m_background = m_svg.add_child<SVG::Rect>();
+        m_background->set_attr("id", "background");
+        m_background->set_attr("x", "0");
+        m_background->set_attr("y", "0");
+        m_background->set_attr("width", std::to_string(m_width));
+        m_background->set_attr("height", std::to_string(m_height));
     }
 
-    background->set_attr("fill", colorToString(c));
+    m_background->set_attr("fill", colorToString(c));
 }
 
 void SVGCanvas::line(Vec2d p1, Vec2d p2, mssm::Color c) {
+    if (m_stream) {
+        Vec2d ends[2] = { p1, p2 };
+        streamLines(ends, 2, c);
+        return;
+    }
+
     auto line = currentTarget()->add_child<SVG::Line>(p1.x, p2.x, p1.y, p2.y);
     applyStyle(line, c);
 }
 
 void SVGCanvas::ellipse(Vec2d center, double w, double h, mssm::Color c, mssm::Color f) {
+    if (m_stream) {
+        beginElement("ellipse");
+        attr("cx", center.x);
+        attr("cy", center.y);
+        attr("rx", w/2);
+        attr("ry", h/2);
+        style(c, f);
+        endElement();
+        return;
+    }
+
     auto ellipse = currentTarget()->add_child<SVG::Ellipse>(center.x, center.y, w/2, h/2);
     applyStyle(ellipse, c, f);
 }
 
 void SVGCanvas::arc(Vec2d center, double w, double h, double a, double alen, mssm::Color c) {
+    ArcEnds ends = arcEnds(center, w, h, a, alen);
+
+    if (m_stream) {
+        beginElement("path");
+        style(c);
+        m_stream->write(" d=\"M ");
+        writePoint(*m_stream, ends.start);
+        writeArc(*m_stream, ends);
+        m_stream->write('"');
+        endElement();
+        return;
+    }
+
     // SVG path for arc
     auto path = currentTarget()->add_child<SVG::Path>();
 
-    // Convert angles from degrees to radians
-    double startAngle = a * M_PI / 180.0;
-    double endAngle = (a + alen) * M_PI / 180.0;
-
-    // Calculate start and end points
-    double rx = w / 2;
-    double ry = h / 2;
-    double x1 = center.x + rx * cos(startAngle);
-    double y1 = center.y + ry * sin(startAngle);
-    double x2 = center.x + rx * cos(endAngle);
-    double y2 = center.y + ry * sin(endAngle);
-
     // Create the path
-    path->start(x1, y1);
-
-    // SVG large-arc-flag is 0 for arcs less than 180 degrees, 1 for arcs greater than 180
-    int largeArcFlag = (alen > 180) ? 1 : 0;
-
-    // SVG sweep-flag is 1 for clockwise, 0 for counterclockwise
-    int sweepFlag = (alen > 0) ? 1 : 0;
-
-    path->curve_to(rx, ry, 0.0, largeArcFlag, sweepFlag, x2, y2);
+    path->start(ends.start.x, ends.start.y);
+    path->curve_to(ends.rx, ends.ry, 0.0, ends.largeArcFlag, ends.sweepFlag, ends.end.x, ends.end.y);
 
     applyStyle(path, c);
     path->set_attr("fill", "none");
 }
 
 void SVGCanvas::chord(Vec2d center, double w, double h, double a, double alen, mssm::Color c, mssm::Color f) {
+    ArcEnds ends = arcEnds(center, w, h, a, alen);
+
+    if (m_stream) {
+        beginElement("path");
+        style(c, f);
+        m_stream->write(" d=\"M ");
+        writePoint(*m_stream, ends.start);
+        writeArc(*m_stream, ends);
+        m_stream->write(" L ");
+        writePoint(*m_stream, ends.start);
+        m_stream->write('"');
+        endElement();
+        return;
+    }
+
     // SVG path for chord
     auto path = currentTarget()->add_child<SVG::Path>();
 
-    // Convert angles from degrees to radians
-    double startAngle = a * M_PI / 180.0;
-    double endAngle = (a + alen) * M_PI / 180.0;
-
-    // Calculate start and end points
-    double rx = w / 2;
-    double ry = h / 2;
-    double x1 = center.x + rx * cos(startAngle);
-    double y1 = center.y + ry * sin(startAngle);
-    double x2 = center.x + rx * cos(endAngle);
-    double y2 = center.y + ry * sin(endAngle);
-
     // Create the path
-    path->start(x1, y1);
-
-    // SVG large-arc-flag is 0 for arcs less than 180 degrees, 1 for arcs greater than 180
-    int largeArcFlag = (alen > 180) ? 1 : 0;
-
-    // SVG sweep-flag is 1 for clockwise, 0 for counterclockwise
-    int sweepFlag = (alen > 0) ? 1 : 0;
-
-    path->curve_to(rx, ry, 0.0, largeArcFlag, sweepFlag, x2, y2);
-    path->line_to(x1, y1); // Close the chord
+    path->start(ends.start.x, ends.start.y);
+    path->curve_to(ends.rx, ends.ry, 0.0, ends.largeArcFlag, ends.sweepFlag, ends.end.x, ends.end.y);
+    path->line_to(ends.start.x, ends.start.y); // Close the chord
 
     applyStyle(path, c, f);
 }
 
 void SVGCanvas::pie(Vec2d center, double w, double h, double a, double alen, mssm::Color c, mssm::Color f) {
+    ArcEnds ends = arcEnds(center, w, h, a, alen);
+
+    if (m_stream) {
+        beginElement("path");
+        style(c, f);
+        m_stream->write(" d=\"M ");
+        writePoint(*m_stream, center);
+        m_stream->write(" L ");
+        writePoint(*m_stream, ends.start);
+        writeArc(*m_stream, ends);
+        m_stream->write(" L ");
+        writePoint(*m_stream, center);
+        m_stream->write('"');
+        endElement();
+        return;
+    }
+
     // SVG path for pie slice
     auto path = currentTarget()->add_child<SVG::Path>();
 
-    // Convert angles from degrees to radians
-    double startAngle = a * M_PI / 180.0;
-    double endAngle = (a + alen) * M_PI / 180.0;
-
-    // Calculate start and end points
-    double rx = w / 2;
-    double ry = h / 2;
-    double x1 = center.x + rx * cos(startAngle);
-    double y1 = center.y + ry * sin(startAngle);
-    double x2 = center.x + rx * cos(endAngle);
-    double y2 = center.y + ry * sin(endAngle);
-
     // Create the path
     path->start(center.x, center.y); // Start at center
-    path->line_to(x1, y1); // Line to first point
-
-    // SVG large-arc-flag is 0 for arcs less than 180 degrees, 1 for arcs greater than 180
-    int largeArcFlag = (alen > 180) ? 1 : 0;
-
-    // SVG sweep-flag is 1 for clockwise, 0 for counterclockwise
-    int sweepFlag = (alen > 0) ? 1 : 0;
-
-    path->curve_to(rx, ry, 0.0, largeArcFlag, sweepFlag, x2, y2);
+    path->line_to(ends.start.x, ends.start.y); // Line to first point
+    path->curve_to(ends.rx, ends.ry, 0.0, ends.largeArcFlag, ends.sweepFlag, ends.end.x, ends.end.y);
     path->line_to(center.x, center.y); // Close the pie slice
 
     applyStyle(path, c, f);
 }
 
 void SVGCanvas::rect(Vec2d corner, double w, double h, mssm::Color c, mssm::Color f) {
+    if (m_stream) {
+        beginElement("rect");
+        attr("x", corner.x);
+        attr("y", corner.y);
+        attr("width", w);
+        attr("height", h);
+        style(c, f);
+        endElement();
+        return;
+    }
+
     auto rect = currentTarget()->add_child<SVG::Rect>(corner.x, corner.y, w, h, 0);
     applyStyle(rect, c, f);
 }
 
 void SVGCanvas::polygon(const std::vector<Vec2d>& points, mssm::Color c, mssm::Color f) {
+    if (m_stream) {
+        beginElement("polygon");
+        m_stream->write(" points=\"");
+        for (size_t i = 0; i < points.size(); i++) {
+            if (i > 0) {
+                m_stream->write(' ');
+            }
+            m_stream->number(points[i].x);
+            m_stream->write(',');
+            m_stream->number(points[i].y);
+        }
+        m_stream->write('"');
+        style(c, f);
+        endElement();
+        return;
+    }
+
     std::vector<SVG::Point> svgPoints;
     for (const auto& pt : points) {
         svgPoints.emplace_back(pt.x, pt.y);
@@ -209,6 +482,11 @@ void SVGCanvas::polyline(const std::vector<Vec2d>& points, mssm::Color c) {
     // Create a path instead since SVG doesn't have a direct polyline
     if (points.empty()) return;
 
+    if (m_stream) {
+        streamLines(points.data(), points.size(), c);
+        return;
+    }
+
     auto path = currentTarget()->add_child<SVG::Path>();
     path->start(points[0].x, points[0].y);
 
@@ -261,25 +539,56 @@ void SVGCanvas::points(std::initializer_list<Vec2d> points, mssm::Color c) {
 void SVGCanvas::text(Vec2d pos, const FontInfo& sizeAndFace, const std::string& str,
                      mssm::Color textcolor, HAlign hAlign, VAlign vAlign) {
 
-    auto text = currentTarget()->add_child<SVG::Text>(pos.x, pos.y, str);
-    text->set_attr("fill", colorToString(textcolor));
-  //  text->set_attr("font-family", sizeAndFace.family);
-    text->set_attr("font-size", std::to_string(sizeAndFace.getSize()) + "px");
+    const char* anchor = nullptr;
+    const char* baseline = nullptr;
 
     // Set text alignment
     if (hAlign == HAlign::center) {
-        text->set_attr("text-anchor", "middle");
+        anchor = "middle";
     } else if (hAlign == HAlign::right) {
-        text->set_attr("text-anchor", "end");
+        anchor = "end";
     }
 
     // Set vertical alignment
     if (vAlign == VAlign::top) {
-        text->set_attr("dominant-baseline", "text-before-edge");
+        baseline = "text-before-edge";
     } else if (vAlign == VAlign::center) {
-        text->set_attr("dominant-baseline", "middle");
+        baseline = "middle";
     } else if (vAlign == VAlign::bottom) {
-        text->set_attr("dominant-baseline", "text-after-edge");
+        baseline = "text-after-edge";
+    }
+
+    if (m_stream) {
+        beginElement("text");
+        attr("x", pos.x);
+        attr("y", pos.y);
+        m_stream->write(" fill=\"");
+        m_stream->color(textcolor);
+        m_stream->write("\" font-size=\"");
+        m_stream->number(sizeAndFace.getSize());
+        m_stream->write("px\"");
+        if (anchor) {
+            attr("text-anchor", anchor);
+        }
+        if (baseline) {
+            attr("dominant-baseline", baseline);
+        }
+        m_stream->write('>');
+        m_stream->escaped(str);
+        m_stream->write("</text>\n");
+        return;
+    }
+
+    auto text = currentTarget()->add_child<SVG::Text>(pos.x, pos.y, str);
+    text->set_attr("fill", colorToString(textcolor));
+  //  text->set_attr("font-family", sizeAndFace.family);
+    text->set_attr("font-size", std::to_string(sizeAndFace.getSize()) + "px");
+
+    if (anchor) {
+        text->set_attr("text-anchor", anchor);
+    }
+    if (baseline) {
+        text->set_attr("dominant-baseline", baseline);
     }
 }
 
@@ -315,6 +624,16 @@ std::vector<double> SVGCanvas::getCharacterXOffsets(const FontInfo& sizeAndFace,
 }
 
 void SVGCanvas::point(Vec2d pos, mssm::Color c) {
+    if (m_stream) {
+        beginElement("circle");
+        attr("cx", pos.x);
+        attr("cy", pos.y);
+        m_stream->write(" r=\"1\"");
+        style(c, c);
+        endElement();
+        return;
+    }
+
     // Draw a small circle to represent a point
     auto circle = currentTarget()->add_child<SVG::Circle>(pos.x, pos.y, 1);
     applyStyle(circle, c, c);
@@ -322,7 +641,10 @@ void SVGCanvas::point(Vec2d pos, mssm::Color c) {
 
 void SVGCanvas::image(Vec2d pos, const mssm::Image& img, double alpha) {
 
-
+    if (m_stream) {
+        placeholder(pos, img.width(), img.height(), { pos.x + img.width()/2, pos.y + img.height()/2 });
+        return;
+    }
 
     // SVG can't directly embed images, would need to use <image> with base64 data
     // For simplicity, just draw a placeholder rectangle
@@ -343,6 +665,11 @@ void SVGCanvas::image(Vec2d pos, const mssm::Image& img, Vec2d src, int srcw, in
 }
 
 void SVGCanvas::image(Vec2d pos, double w, double h, const mssm::Image& img, double alpha) {
+    if (m_stream) {
+        placeholder(pos, w, h, { pos.x + w/2, pos.y + h/2 });
+        return;
+    }
+
     // Simplified placeholder
     auto rect = currentTarget()->add_child<SVG::Rect>(pos.x, pos.y, w, h, 0);
     rect->set_attr("fill", "grey");
@@ -360,23 +687,7 @@ void SVGCanvas::image(Vec2d pos, double w, double h, const mssm::Image& img, Vec
 }
 
 void SVGCanvas::imageC(Vec2d center, double angle, const mssm::Image& img, double alpha) {
-    // SVG can do transforms, but for simplicity with placeholder
-    double w = img.width();
-    double h = img.height();
-    Vec2d topLeft(center.x - w/2, center.y - h/2);
-
-    auto group = currentTarget()->add_child<SVG::Group>();
-    group->set_attr("transform", "rotate(" + std::to_string(angle) + " " +
-                                     std::to_string(center.x) + " " + std::to_string(center.y) + ")");
-
-    auto rect = group->add_child<SVG::Rect>(topLeft.x, topLeft.y, w, h, 0);
-    rect->set_attr("fill", "grey");
-    rect->set_attr("stroke", "black");
-
-    auto text = group->add_child<SVG::Text>(center.x, center.y, "Image");
-    text->set_attr("text-anchor", "middle");
-    text->set_attr("dominant-baseline", "middle");
-    text->set_attr("fill", "black");
+    imageC(center, angle, img.width(), img.height(), img, alpha);
 }
 
 void SVGCanvas::imageC(Vec2d center, double angle, const mssm::Image& img, Vec2d src, int srcw, int srch, double alpha) {
@@ -387,6 +698,19 @@ void SVGCanvas::imageC(Vec2d center, double angle, const mssm::Image& img, Vec2d
 void SVGCanvas::imageC(Vec2d center, double angle, double w, double h, const mssm::Image& img, double alpha) {
     Vec2d topLeft(center.x - w/2, center.y - h/2);
 
+    if (m_stream) {
+        beginElement("g");
+        m_stream->write(" transform=\"rotate(");
+        m_stream->number(angle);
+        m_stream->write(' ');
+        writePoint(*m_stream, center);
+        m_stream->write(")\">\n");
+        placeholder(topLeft, w, h, center);
+        m_stream->write("</g>\n");
+        return;
+    }
+
+    // SVG can do transforms, but for simplicity with placeholder
     auto group = currentTarget()->add_child<SVG::Group>();
     group->set_attr("transform", "rotate(" + std::to_string(angle) + " " +
                                      std::to_string(center.x) + " " + std::to_string(center.y) + ")");
@@ -412,6 +736,32 @@ bool SVGCanvas::isClipped(Vec2d pos) const {
 }
 
 void SVGCanvas::pushClip(int x, int y, int w, int h, bool replace) {
+    if (m_stream) {
+        // a real clip path this time, as it's written out as it goes.  Nested
+        // clipped groups intersect, so replacing means closing the ones open
+        // (back to the innermost pushGroup) until the matching popClip
+        std::vector<int> replaced;
+        if (replace) {
+            while (!m_openGroups.empty() && m_openGroups.back() != 0) {
+                replaced.push_back(m_openGroups.back());
+                closeGroup();
+            }
+        }
+        m_replacedClips.push_back(std::move(replaced));
+
+        int clip = ++m_clipCount;
+        beginElement("clipPath");
+        attr("id", "clip_" + std::to_string(clip));
+        m_stream->write("><rect");
+        attr("x", x);
+        attr("y", y);
+        attr("width", w);
+        attr("height", h);
+        m_stream->write("/></clipPath>\n");
+        openClipGroup(clip);
+        return;
+    }
+
     // SVG clipping would require defining a clipPath and applying it
     // This is a simplified implementation
     auto group = currentTarget()->add_child<SVG::Group>();
@@ -425,6 +775,19 @@ void SVGCanvas::pushClip(int x, int y, int w, int h, bool replace) {
 }
 
 void SVGCanvas::popClip() {
+    if (m_stream) {
+        closeGroup();
+        if (!m_replacedClips.empty()) {
+            // reopen what a replacing clip closed, outermost first
+            auto& replaced = m_replacedClips.back();
+            for (auto clip = replaced.rbegin(); clip != replaced.rend(); ++clip) {
+                openClipGroup(*clip);
+            }
+            m_replacedClips.pop_back();
+        }
+        return;
+    }
+
     if (!m_groupStack.empty()) {
         m_groupStack.pop();
     }
@@ -437,6 +800,14 @@ void SVGCanvas::setClip(int x, int y, int w, int h) {
 }
 
 void SVGCanvas::resetClip() {
+    if (m_stream) {
+        while (!m_openGroups.empty()) {
+            closeGroup();
+        }
+        m_replacedClips.clear();
+        return;
+    }
+
     // Clear all clip state
     while (!m_groupStack.empty()) {
         m_groupStack.pop();
@@ -445,15 +816,31 @@ void SVGCanvas::resetClip() {
 
 void SVGCanvas::setViewport(int x, int y, int w, int h) {
     // SVG viewBox can be used for this
-    m_svg.set_attr("viewBox", std::to_string(x) + " " + std::to_string(y) + " " +
-                                  std::to_string(w) + " " + std::to_string(h));
+    m_viewBox = std::to_string(x) + " " + std::to_string(y) + " " +
+                std::to_string(w) + " " + std::to_string(h);
+    if (!m_stream) {
+        m_svg.set_attr("viewBox", m_viewBox);
+    }
 }
 
 void SVGCanvas::resetViewport() {
-    m_svg.set_attr("viewBox", "0 0 " + std::to_string(m_width) + " " + std::to_string(m_height));
+    m_viewBox = "0 0 " + std::to_string(m_width) + " " + std::to_string(m_height);
+    if (!m_stream) {
+        m_svg.set_attr("viewBox", m_viewBox);
+    }
 }
 
 void SVGCanvas::pushGroup(std::string groupName) {
+    if (m_stream) {
+        beginElement("g");
+        if (!groupName.empty()) {
+            attr("id", groupName);
+        }
+        m_stream->write(">\n");
+        m_openGroups.push_back(0);
+        return;
+    }
+
     auto group = currentTarget()->add_child<SVG::Group>();
     if (!groupName.empty()) {
         group->set_attr("id", groupName);
@@ -462,6 +849,11 @@ void SVGCanvas::pushGroup(std::string groupName) {
 }
 
 void SVGCanvas::popGroup() {
+    if (m_stream) {
+        closeGroup();
+        return;
+    }
+
     if (!m_groupStack.empty()) {
         m_groupStack.pop();
     }
@@ -470,6 +862,22 @@ void SVGCanvas::popGroup() {
 void SVGCanvas::polygonPattern(const std::vector<Vec2d>& points, mssm::Color c, mssm::Color f) {
     if (points.size() < 3) return;
 
+    if (m_stream) {
+        beginElement("polygon");
+        m_stream->write(" points=\"");
+        for (const auto& pt : points) {
+            m_stream->number(pt.x);
+            m_stream->write(',');
+            m_stream->number(pt.y);
+            m_stream->write(' ');
+        }
+        m_stream->write("\" stroke=\"");
+        m_stream->color(c);
+        m_stream->write("\" fill=\"url(#crosshatch)\"");
+        endElement();
+        return;
+    }
+
     // First, create the polygon with transparent fill and the specified border
     auto polygonElement = currentTarget()->add_child<SVG::Polygon>(std::vector<SVG::Point>());
 
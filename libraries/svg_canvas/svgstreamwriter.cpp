@@ -0,0 +1,38 @@
+#include "svgstreamwriter.h"
+
+void SVGStreamWriter::color(const mssm::Color& c)
+{
+    if (c.a == 0) {
+        write("none");
+        return;
+    }
+
+    static constexpr char digits[] = "0123456789abcdef";
+    char text[9] = { '#' };
+    uint8_t parts[4] = { c.r, c.g, c.b, c.a };
+    int count = c.a < 255 ? 4 : 3;
+    for (int i = 0; i < count; i++) {
+        text[1 + i * 2] = digits[parts[i] >> 4];
+        text[2 + i * 2] = digits[parts[i] & 15];
+    }
+    write(std::string_view(text, 1 + count * 2));
+}
+
+void SVGStreamWriter::escaped(std::string_view text)
+{
+    for (;;) {
+        size_t special = text.find_first_of("&<>\"'");
+        write(text.substr(0, special));
+        if (special == std::string_view::npos) {
+            return;
+        }
+        switch (text[special]) {
+        case '&':  write("&amp;");  break;
+        case '<':  write("&lt;");   break;
+        case '>':  write("&gt;");   break;
+        case '"':  write("&quot;"); break;
+        default:   write("&apos;"); break;
+        }
+        text.remove_prefix(special + 1);
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef SVGSTREAMWRITER_H
+#define SVGSTREAMWRITER_H
+
+#include "canvasStreamWriter.h"
+#include "color.h"
+#include <string>
+#include <string_view>
+
+// CanvasStreamWriter for SVG text: numbers to two decimals like svg.hpp
+// does, without trailing zeros, plus colours and escaped text
+class SVGStreamWriter : public CanvasStreamWriter
+{
+public:
+    SVGStreamWriter(const std::string& filename, size_t bufferSize = 1 << 20)
+        : CanvasStreamWriter(filename, NumberFormat::fixed(2), bufferSize) {}
+
+    // "none" for fully transparent, otherwise #rrggbb or #rrggbbaa
+    void color(const mssm::Color& c);
+
+    // text with the XML special characters replaced by entities
+    void escaped(std::string_view text);
+};
+
+#endif // SVGSTREAMWRITER_H
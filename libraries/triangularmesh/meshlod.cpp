@@ -0,0 +1,430 @@
+#include <algorithm>
+#include <cmath>
+
+#include "meshlod.h"
+
+namespace {
+
+constexpr uint8_t boundaryVertex = 1;  // on an edge with only one triangle
+constexpr uint8_t lockedVertex = 2;    // on a non-manifold edge: never removed
+constexpr uint8_t deadVertex = 4;      // collapsed into another
+
+// boundary edges are held in place by a plane through the edge, perpendicular to
+// its triangle, weighted this much more than the triangle's own plane
+constexpr double boundaryWeight = 10.0;
+
+uint64_t edgeKey(uint32_t a, uint32_t b)
+{
+    return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+}
+
+} // namespace
+
+// Sum of squared distances to a set of planes, each weighted by its triangle's
+// area; dividing by the total weight gives a mean squared distance, which is
+// what the error is measured in
+class MeshSimplifier::Quadric {
+public:
+    double a2{0}, ab{0}, ac{0}, ad{0};
+    double b2{0}, bc{0}, bd{0};
+    double c2{0}, cd{0};
+    double d2{0};
+    double weight{0};
+public:
+    Quadric() = default;
+
+    // plane n.p + d = 0, n a unit vector
+    Quadric(const Vec3d& n, double d, double w)
+        : a2{w * n.x * n.x}, ab{w * n.x * n.y}, ac{w * n.x * n.z}, ad{w * n.x * d},
+          b2{w * n.y * n.y}, bc{w * n.y * n.z}, bd{w * n.y * d},
+          c2{w * n.z * n.z}, cd{w * n.z * d},
+          d2{w * d * d}, weight{w} {}
+
+    Quadric& operator+=(const Quadric& q) {
+        a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+        b2 += q.b2; bc += q.bc; bd += q.bd;
+        c2 += q.c2; cd += q.cd;
+        d2 += q.d2;
+        weight += q.weight;
+        return *this;
+    }
+
+    // mean squared distance of p from the planes
+    double error(const Vec3d& p) const {
+        double e = a2 * p.x * p.x + 2 * ab * p.x * p.y + 2 * ac * p.x * p.z + 2 * ad * p.x
+                 + b2 * p.y * p.y + 2 * bc * p.y * p.z + 2 * bd * p.y
+                 + c2 * p.z * p.z + 2 * cd * p.z
+                 + d2;
+        return weight > 0 ? std::max(0.0, e / weight) : 0;
+    }
+};
+
+class MeshSimplifier::Collapse {
+public:
+    double   cost;      // mean squared distance after the collapse
+    uint32_t from;      // removed
+    uint32_t to;        // kept
+    uint32_t fromVersion;
+    uint32_t toVersion;
+
+    bool operator>(const Collapse& other) const { return cost > other.cost; }
+};
+
+MeshSimplifier::MeshSimplifier(std::vector<Vec3d> positionsIn, std::vector<uint32_t> trianglesIn)
+    : positions{std::move(positionsIn)}, triangles{std::move(trianglesIn)}
+{
+    size_t vertexCount = positions.size();
+    size_t triangleCount = triangles.size() / 3;
+
+    triangles.resize(triangleCount * 3);
+    inputTriangles = triangles;
+    collapsedInto.resize(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; v++) {
+        collapsedInto[v] = v;
+    }
+    triangleAlive.assign(triangleCount, 1);
+    vertexTriangles.resize(vertexCount);
+    quadrics.resize(vertexCount);
+    versions.assign(vertexCount, 0);
+    vertexFlags.assign(vertexCount, 0);
+    marks.assign(vertexCount, 0);
+
+    liveTriangles = triangleCount;
+
+    // each triangle's plane goes into its corners' quadrics
+    for (uint32_t t = 0; t < triangleCount; t++) {
+        const uint32_t* tri = &triangles[t * 3];
+        for (int c = 0; c < 3; c++) {
+            vertexTriangles[tri[c]].push_back(t);
+        }
+
+        Vec3d normal = crossProduct(positions[tri[1]] - positions[tri[0]], positions[tri[2]] - positions[tri[0]]);
+        double length = normal.magnitude();
+        if (length == 0) {
+            continue;
+        }
+        normal = normal / length;
+        Quadric q(normal, -dotProduct(normal, positions[tri[0]]), length * 0.5);
+        for (int c = 0; c < 3; c++) {
+            quadrics[tri[c]] += q;
+        }
+    }
+
+    // an edge used by one triangle is on a boundary, by more than two is non-manifold
+    std::vector<uint64_t> edges;
+    edges.reserve(triangleCount * 3);
+    for (uint32_t t = 0; t < triangleCount; t++) {
+        const uint32_t* tri = &triangles[t * 3];
+        for (int c = 0; c < 3; c++) {
+            edges.push_back(edgeKey(tri[c], tri[(c + 1) % 3]));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    for (size_t i = 0; i < edges.size();) {
+        size_t j = i + 1;
+        while (j < edges.size() && edges[j] == edges[i]) {
+            j++;
+        }
+        uint32_t a = static_cast<uint32_t>(edges[i] >> 32);
+        uint32_t b = static_cast<uint32_t>(edges[i]);
+        if (j - i == 1) {
+            vertexFlags[a] |= boundaryVertex;
+            vertexFlags[b] |= boundaryVertex;
+        }
+        else if (j - i > 2) {
+            vertexFlags[a] |= lockedVertex;
+            vertexFlags[b] |= lockedVertex;
+        }
+        i = j;
+    }
+
+    // keep boundaries in place with planes standing on them
+    for (uint32_t t = 0; t < triangleCount; t++) {
+        const uint32_t* tri = &triangles[t * 3];
+        Vec3d normal = crossProduct(positions[tri[1]] - positions[tri[0]], positions[tri[2]] - positions[tri[0]]);
+        for (int c = 0; c < 3; c++) {
+            uint32_t a = tri[c];
+            uint32_t b = tri[(c + 1) % 3];
+            if (!(vertexFlags[a] & boundaryVertex) || !(vertexFlags[b] & boundaryVertex)) {
+                continue;
+            }
+            // the edge is only once in the sorted list iff it's a boundary edge
+            auto range = std::equal_range(edges.begin(), edges.end(), edgeKey(a, b));
+            if (range.second - range.first != 1) {
+                continue;
+            }
+            Vec3d along = positions[b] - positions[a];
+            Vec3d across = crossProduct(along, normal);
+            double length = across.magnitude();
+            if (length == 0) {
+                continue;
+            }
+            across = across / length;
+            Quadric q(across, -dotProduct(across, positions[a]), along.magSquared() * boundaryWeight);
+            quadrics[a] += q;
+            quadrics[b] += q;
+        }
+    }
+
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    queue.reserve(edges.size());
+    for (auto key : edges) {
+        pushEdge(static_cast<uint32_t>(key >> 32), static_cast<uint32_t>(key));
+    }
+    std::make_heap(queue.begin(), queue.end(), std::greater<>{});
+}
+
+MeshSimplifier::~MeshSimplifier() = default;
+
+uint32_t MeshSimplifier::nextMark()
+{
+    if (++markStamp == 0) {
+        std::fill(marks.begin(), marks.end(), 0);
+        markStamp = 1;
+    }
+    return markStamp;
+}
+
+size_t MeshSimplifier::simplify(size_t targetTriangles, double errorLimit)
+{
+    double costLimit = errorLimit * errorLimit;
+
+    while (liveTriangles > targetTriangles && !queue.empty()) {
+        Collapse next = queue.front();
+
+        if (next.cost > costLimit) {
+            break;
+        }
+
+        std::pop_heap(queue.begin(), queue.end(), std::greater<>{});
+        queue.pop_back();
+
+        // stale: one of the ends has changed since this was queued
+        if (next.fromVersion != versions[next.from] || next.toVersion != versions[next.to] ||
+            (vertexFlags[next.from] & deadVertex) || (vertexFlags[next.to] & deadVertex)) {
+            continue;
+        }
+
+        if (!canCollapse(next.from, next.to)) {
+            continue; // requeued if its neighbourhood changes
+        }
+
+        collapse(next.from, next.to);
+        maxError = std::max(maxError, std::sqrt(next.cost));
+    }
+
+    return liveTriangles;
+}
+
+bool MeshSimplifier::canCollapse(uint32_t from, uint32_t to)
+{
+    uint8_t fromFlags = vertexFlags[from];
+
+    if (fromFlags & lockedVertex) {
+        return false;
+    }
+
+    // triangles on the edge, and the vertices across from it
+    uint32_t mark = nextMark();
+    for (auto t : vertexTriangles[to]) {
+        if (!triangleAlive[t]) {
+            continue;
+        }
+        const uint32_t* tri = &triangles[t * 3];
+        for (int c = 0; c < 3; c++) {
+            marks[tri[c]] = mark;
+        }
+    }
+
+    int shared = 0;
+    for (auto t : vertexTriangles[from]) {
+        if (triangleAlive[t]) {
+            const uint32_t* tri = &triangles[t * 3];
+            shared += (tri[0] == to || tri[1] == to || tri[2] == to);
+        }
+    }
+
+    if (shared == 0) {
+        return false; // not adjacent any more
+    }
+
+    // a boundary vertex may only slide along its own boundary edge
+    if ((fromFlags & boundaryVertex) && (!(vertexFlags[to] & boundaryVertex) || shared != 1)) {
+        return false;
+    }
+
+    // link condition: the only vertices next to both ends are those across the edge,
+    // otherwise the collapse would pinch the surface
+    int common = 0;
+    uint32_t commonMark = nextMark();
+    for (auto t : vertexTriangles[from]) {
+        if (!triangleAlive[t]) {
+            continue;
+        }
+        const uint32_t* tri = &triangles[t * 3];
+        for (int c = 0; c < 3; c++) {
+            uint32_t w = tri[c];
+            if (w != from && w != to && marks[w] == mark) {
+                common++;
+                marks[w] = commonMark;
+            }
+        }
+    }
+    if (common > shared) {
+        return false;
+    }
+
+    // moving from onto to must not flip (or flatten) any triangle that survives
+    const Vec3d& target = positions[to];
+    for (auto t : vertexTriangles[from]) {
+        if (!triangleAlive[t]) {
+            continue;
+        }
+        const uint32_t* tri = &triangles[t * 3];
+        if (tri[0] == to || tri[1] == to || tri[2] == to) {
+            continue;
+        }
+        Vec3d p[3];
+        Vec3d q[3];
+        for (int c = 0; c < 3; c++) {
+            p[c] = positions[tri[c]];
+            q[c] = tri[c] == from ? target : p[c];
+        }
+        Vec3d before = crossProduct(p[1] - p[0], p[2] - p[0]);
+        Vec3d after = crossProduct(q[1] - q[0], q[2] - q[0]);
+        if (dotProduct(before, after) <= 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void MeshSimplifier::collapse(uint32_t from, uint32_t to)
+{
+    auto& toTriangles = vertexTriangles[to];
+
+    for (auto t : vertexTriangles[from]) {
+        if (!triangleAlive[t]) {
+            continue;
+        }
+        uint32_t* tri = &triangles[t * 3];
+        if (tri[0] == to || tri[1] == to || tri[2] == to) {
+            triangleAlive[t] = 0;
+            liveTriangles--;
+            continue;
+        }
+        for (int c = 0; c < 3; c++) {
+            if (tri[c] == from) {
+                tri[c] = to;
+            }
+        }
+        toTriangles.push_back(t);
+    }
+
+    std::erase_if(toTriangles, [this](uint32_t t) { return !triangleAlive[t]; });
+
+    vertexTriangles[from].clear();
+    vertexTriangles[from].shrink_to_fit();
+    vertexFlags[from] |= deadVertex;
+    collapsedInto[from] = to;
+    quadrics[to] += quadrics[from];
+    versions[to]++;
+
+    pushCollapses(to);
+}
+
+void MeshSimplifier::pushCollapses(uint32_t v)
+{
+    // every edge at v changed cost
+    uint32_t mark = nextMark();
+    marks[v] = mark;
+    for (auto t : vertexTriangles[v]) {
+        const uint32_t* tri = &triangles[t * 3];
+        for (int c = 0; c < 3; c++) {
+            uint32_t w = tri[c];
+            if (marks[w] == mark) {
+                continue;
+            }
+            marks[w] = mark;
+            if (pushEdge(v, w)) {
+                std::push_heap(queue.begin(), queue.end(), std::greater<>{});
+            }
+        }
+    }
+}
+
+bool MeshSimplifier::pushEdge(uint32_t a, uint32_t b)
+{
+    // only the cheaper of the two directions is queued, which halves the size of the
+    // heap.  If it turns out not to be allowed the edge waits until a neighbour changes
+    auto movable = [this](uint32_t from, uint32_t to) {
+        return !(vertexFlags[from] & lockedVertex) &&
+               (!(vertexFlags[from] & boundaryVertex) || (vertexFlags[to] & boundaryVertex));
+    };
+
+    bool ab = movable(a, b);
+    bool ba = movable(b, a);
+    if (!ab && !ba) {
+        return false;
+    }
+
+    Quadric q = quadrics[a];
+    q += quadrics[b];
+    double abCost = ab ? q.error(positions[b]) : unlimited;
+    double baCost = ba ? q.error(positions[a]) : unlimited;
+
+    if (abCost <= baCost) {
+        queue.push_back({ abCost, a, b, versions[a], versions[b] });
+    }
+    else {
+        queue.push_back({ baCost, b, a, versions[b], versions[a] });
+    }
+    return true;
+}
+
+double MeshSimplifier::maxDistance() const
+{
+    // the live vertex each vertex was collapsed into, following chains of collapses
+    std::vector<uint32_t> survivor = collapsedInto;
+    for (uint32_t v = 0; v < survivor.size(); v++) {
+        uint32_t s = survivor[v];
+        while (survivor[s] != s) {
+            s = survivor[s];
+        }
+        survivor[v] = s;
+    }
+
+    double distance = 0;
+    for (size_t t = 0; t < inputTriangles.size(); t += 3) {
+        const uint32_t* tri = &inputTriangles[t];
+        Vec3d normal = crossProduct(positions[tri[1]] - positions[tri[0]], positions[tri[2]] - positions[tri[0]]);
+        double length = normal.magnitude();
+        if (length == 0) {
+            continue;
+        }
+        normal = normal / length;
+        double d = -dotProduct(normal, positions[tri[0]]);
+        for (int c = 0; c < 3; c++) {
+            distance = std::max(distance, std::abs(dotProduct(normal, positions[survivor[tri[c]]]) + d));
+        }
+    }
+    return distance;
+}
+
+void MeshSimplifier::result(std::vector<uint32_t> &indices, std::vector<uint32_t> &sourceTriangles) const
+{
+    indices.clear();
+    sourceTriangles.clear();
+    indices.reserve(liveTriangles * 3);
+    sourceTriangles.reserve(liveTriangles);
+
+    for (uint32_t t = 0; t < triangleAlive.size(); t++) {
+        if (triangleAlive[t]) {
+            indices.insert(indices.end(), &triangles[t * 3], &triangles[t * 3 + 3]);
+            sourceTriangles.push_back(t);
+        }
+    }
+}
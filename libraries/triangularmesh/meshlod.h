@@ -0,0 +1,221 @@
+#ifndef MESHLOD_H
+#define MESHLOD_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "mesh.h"
+#include "triangularmesh.h"
+#include "vec3d.h"
+
+// Quadric error metric simplification (Garland & Heckbert) of a triangle list.
+//
+// Edges are collapsed cheapest first from a priority queue; entries made stale
+// by earlier collapses are recognised by a per vertex version number and
+// skipped when they come up, rather than searched for and removed.  A collapse
+// moves one end of the edge onto the other (no new positions are made up), so
+// every vertex of the result is one of the input vertices and keeps its
+// attributes.  Collapses that would fold a triangle over, make the surface
+// non-manifold or move an open boundary off itself are not made.
+class MeshSimplifier {
+public:
+    static constexpr double unlimited = std::numeric_limits<double>::infinity();
+private:
+    class Quadric;
+    class Collapse;
+
+    std::vector<Vec3d>    positions;
+    std::vector<uint32_t> triangles;        // three vertices each
+    std::vector<uint32_t> inputTriangles;   // as given, for maxDistance
+    std::vector<uint32_t> collapsedInto;    // by vertex: itself until collapsed
+    std::vector<uint8_t>  triangleAlive;
+    std::vector<std::vector<uint32_t>> vertexTriangles; // may include dead triangles
+    std::vector<Quadric>  quadrics;
+    std::vector<uint32_t> versions;
+    std::vector<uint8_t>  vertexFlags;
+    std::vector<Collapse> queue;            // heap, cheapest on top
+    std::vector<uint32_t> marks;            // scratch for neighbour tests
+    uint32_t markStamp{0};
+
+    size_t liveTriangles{0};
+    double maxError{0};
+public:
+    // triangles index positions; positions with no triangles are fine
+    MeshSimplifier(std::vector<Vec3d> positions, std::vector<uint32_t> triangles);
+    ~MeshSimplifier();
+
+    // collapse edges until at most targetTriangles are left, or the next collapse
+    // would move the surface more than errorLimit.  Can be called again with a
+    // smaller target to carry on.  Returns the number of triangles left
+    size_t simplify(size_t targetTriangles, double errorLimit = unlimited);
+
+    size_t triangleCount() const { return liveTriangles; }
+
+    // largest distance the surface has moved so far, as estimated by the quadrics.
+    // Each collapse's estimate is a mean over the planes it covers, so parts of the
+    // surface can have moved further than this
+    double error() const { return maxError; }
+
+    // largest distance of any input triangle's corners, where they are now, from
+    // that triangle's plane: the worst case of what error() averages.  Goes over
+    // all the input triangles
+    double maxDistance() const;
+
+    // the triangles left: three vertices each, and the input triangle each came from
+    void result(std::vector<uint32_t>& indices, std::vector<uint32_t>& sourceTriangles) const;
+private:
+    void pushCollapses(uint32_t v);
+    bool pushEdge(uint32_t a, uint32_t b);
+    bool canCollapse(uint32_t from, uint32_t to);
+    void collapse(uint32_t from, uint32_t to);
+    uint32_t nextMark();
+};
+
+// Options for buildMeshLods
+struct MeshLodOptions {
+    size_t levels{4};          // at most this many, counting the full detail mesh
+    double reduction{0.5};     // each level keeps about this fraction of the triangles of the one before
+    size_t minTriangles{16};   // don't make levels smaller than this
+    double maxError{MeshSimplifier::unlimited}; // stop once the surface would move further than this (as MeshSimplifier::error estimates it)
+};
+
+// A model at decreasing levels of detail, finest first
+template <typename TVertex>
+struct MeshLods {
+    std::vector<TriangularMesh<TVertex>> levels;
+    std::vector<double> errors;  // how far each level's vertices have moved off the full mesh's surface, at most
+                                 // (MeshSimplifier::maxDistance; 0 for level 0).  Never smaller than the level before
+    Vec3d center;                // bounding sphere of the full mesh
+    double radius{0};
+};
+
+// Builds a chain of levels of detail from a half edge mesh, converting corners
+// to TDestVertex with converter(vertex, face) as buildTriangularMesh does.  Each
+// level is a further simplification of the one before.  Polygons are fan
+// triangulated first.  For 2d meshes (no pos.z) z is taken as 0
+template <typename TDestVertex, typename E, typename V, typename F, typename TConverter>
+MeshLods<TDestVertex> buildMeshLods(const Mesh<E, V, F>& mesh, TConverter converter, MeshLodOptions options = {})
+{
+    using Vertex = typename Mesh<E, V, F>::Vertex;
+    using Face = typename Mesh<E, V, F>::Face;
+
+    MeshLods<TDestVertex> lods;
+
+    // dense numbering of the vertices, and the fan triangles of each face
+    std::vector<const Vertex*> vertices;
+    std::vector<Vec3d> positions;
+    std::vector<uint32_t> vertexIndex;  // by vertex handle
+
+    vertices.reserve(mesh.numVertices());
+    positions.reserve(mesh.numVertices());
+
+    for (const auto& v : mesh.vertices()) {
+        if (vertexIndex.size() <= v.handle()) {
+            vertexIndex.resize(v.handle() + 1);
+        }
+        vertexIndex[v.handle()] = static_cast<uint32_t>(vertices.size());
+        vertices.push_back(&v);
+        if constexpr (requires { v.pos.z; }) {
+            positions.push_back({ v.pos.x, v.pos.y, v.pos.z });
+        }
+        else {
+            positions.push_back({ v.pos.x, v.pos.y, 0 });
+        }
+    }
+
+    std::vector<const Face*> triangleFaces;
+    std::vector<uint32_t> triangles;
+    std::vector<uint32_t> faceCorners;
+
+    for (const auto& face : mesh.faces()) {
+        faceCorners.clear();
+        for (const auto& edge : face.edges()) {
+            faceCorners.push_back(vertexIndex[edge.v1().handle()]);
+        }
+        for (size_t i = 1; i + 1 < faceCorners.size(); i++) {
+            triangles.insert(triangles.end(), { faceCorners[0], faceCorners[i], faceCorners[i + 1] });
+            triangleFaces.push_back(&face);
+        }
+    }
+
+    if (!positions.empty()) {
+        Vec3d lo = positions[0];
+        Vec3d hi = positions[0];
+        for (auto& p : positions) {
+            lo = { std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z) };
+            hi = { std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z) };
+        }
+        lods.center = (lo + hi) * 0.5;
+        for (auto& p : positions) {
+            lods.radius = std::max(lods.radius, (p - lods.center).magnitude());
+        }
+    }
+
+    // one vertex per distinct (vertex, face) corner of a level, so per face attributes
+    // still work, while triangles from the same face share their vertices.  A face is
+    // identified by its first triangle (sources are mapped to that below)
+    std::vector<uint64_t> cornerKeys;
+    auto addLevel = [&](const std::vector<uint32_t>& indices, const std::vector<uint32_t>& sources, double error) {
+        TriangularMesh<TDestVertex> triMesh;
+
+        cornerKeys.clear();
+        for (size_t i = 0; i < indices.size(); i++) {
+            cornerKeys.push_back((static_cast<uint64_t>(sources[i / 3]) << 32) | indices[i]);
+        }
+        std::sort(cornerKeys.begin(), cornerKeys.end());
+        cornerKeys.erase(std::unique(cornerKeys.begin(), cornerKeys.end()), cornerKeys.end());
+
+        triMesh.vertices.reserve(cornerKeys.size());
+        for (auto key : cornerKeys) {
+            triMesh.vertices.push_back(converter(*vertices[static_cast<uint32_t>(key)], *triangleFaces[key >> 32]));
+        }
+
+        triMesh.indices.reserve(indices.size());
+        for (size_t i = 0; i < indices.size(); i++) {
+            uint64_t key = (static_cast<uint64_t>(sources[i / 3]) << 32) | indices[i];
+            triMesh.indices.push_back(static_cast<uint32_t>(std::lower_bound(cornerKeys.begin(), cornerKeys.end(), key) - cornerKeys.begin()));
+        }
+
+        lods.levels.push_back(std::move(triMesh));
+        lods.errors.push_back(error);
+    };
+
+    std::vector<uint32_t> firstTriangleOfFace(triangleFaces.size());
+    for (size_t t = 0; t < triangleFaces.size(); t++) {
+        firstTriangleOfFace[t] = (t > 0 && triangleFaces[t] == triangleFaces[t - 1]) ? firstTriangleOfFace[t - 1] : static_cast<uint32_t>(t);
+    }
+
+    std::vector<uint32_t> indices = triangles;
+    std::vector<uint32_t> sources = firstTriangleOfFace;
+
+    addLevel(indices, sources, 0);
+
+    MeshSimplifier simplifier(std::move(positions), std::move(triangles));
+
+    while (lods.levels.size() < options.levels) {
+        size_t current = simplifier.triangleCount();
+        size_t target = static_cast<size_t>(current * options.reduction);
+        if (target < options.minTriangles) {
+            break;
+        }
+
+        if (simplifier.simplify(target, options.maxError) >= current) {
+            break; // nothing more can be collapsed
+        }
+
+        simplifier.result(indices, sources);
+        for (auto& s : sources) {
+            s = firstTriangleOfFace[s];
+        }
+        addLevel(indices, sources, std::max(lods.errors.back(), simplifier.maxDistance()));
+
+        if (simplifier.triangleCount() > target) {
+            break; // stopped by maxError, or ran out of valid collapses
+        }
+    }
+
+    return lods;
+}
+
+#endif // MESHLOD_H
@@ -0,0 +1,53 @@
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+#include "triangularmesh.h"
+
+void parallelRanges(size_t count, unsigned threads, const std::function<void(size_t, size_t)>& fn)
+{
+    // below this many items per thread, starting the threads costs more than it saves
+    constexpr size_t minPerThread = 4096;
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::min<size_t>(threads, (count + minPerThread - 1) / minPerThread));
+
+    if (threads <= 1) {
+        if (count > 0) {
+            fn(0, count);
+        }
+        return;
+    }
+
+    size_t chunk = (count + threads - 1) / threads;
+
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+
+    auto run = [&fn, &errors, chunk, count](unsigned t) {
+        try {
+            fn(t * chunk, std::min(count, (t + 1) * chunk));
+        }
+        catch (...) {
+            errors[t] = std::current_exception();
+        }
+    };
+
+    for (unsigned t = 1; t < threads; t++) {
+        workers.emplace_back(run, t);
+    }
+    run(0); // the calling thread takes the first range
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
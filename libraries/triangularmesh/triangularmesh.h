@@ -2,8 +2,12 @@
 #define TRIANGULARMESH_H
 
 #include "mesh.h" // The half-edge mesh header
+#include "meshcache.h"
+#include "vertexcache.h"
 #include "tiny_obj_loader.h"
+#include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <optional>
 #include <unordered_map>
 #include <vector>
@@ -15,50 +19,116 @@ struct TriangularMesh {
     std::vector<uint32_t>   indices;
 };
 
+// Options for buildTriangularMesh and loadTriangularMesh
+struct TriangularMeshOptions {
+    // threads to convert vertices on, 0 for one per core.  With more than one the
+    // converter is called from several threads at once, so it must not change
+    // anything shared.  Small meshes are always done on the calling thread
+    unsigned threads{0};
+
+    // loadTriangularMesh only: reorder the triangles and vertices for the GPU's vertex
+    // cache (see vertexcache.h).  Takes longer than the conversion itself, so worth it
+    // for meshes drawn many times.  buildTriangularMesh ignores it: its faces share no
+    // vertices, so there is nothing for the cache to reuse
+    bool optimizeVertexCache{false};
+};
+
+// Calls fn(begin, end) for consecutive ranges covering 0 to count, on up to
+// threads threads (0 for one per core).  Returns when all are done, rethrowing
+// the first exception any of them threw
+void parallelRanges(size_t count, unsigned threads, const std::function<void(size_t, size_t)>& fn);
+
+// Reorders mesh for the GPU's post-transform vertex cache: triangles so nearby
+// ones share vertices, then vertices in the order the triangles first use them
+template <typename TVertex>
+void optimizeVertexCache(TriangularMesh<TVertex>& mesh)
+{
+    optimizeTriangleOrder(mesh.indices, mesh.vertices.size());
+
+    std::vector<uint32_t> order = optimizeVertexOrder(mesh.indices, mesh.vertices.size());
+
+    std::vector<TVertex> vertices;
+    vertices.reserve(order.size());
+    for (auto v : order) {
+        vertices.push_back(std::move(mesh.vertices[v]));
+    }
+    mesh.vertices = std::move(vertices);
+}
+
 // The conversion function
 // This converts from a half-edge mesh to the GPU-friendly triangular mesh.
 // It handles triangulation and demotion of per-face attributes.
 // It is generic, accepting a 'converter' lambda to map source vertex/face data to the destination vertex format.
+//
+// Every corner (a vertex in the context of a specific face) gets its own vertex, which
+// correctly duplicates vertices for per-face attributes (like color).  Since corners are
+// never shared between faces, where each face's vertices and triangles go is known from
+// the corner counts alone, so faces are converted in parallel with the same result as
+// converting them in order.  For the same reason there is no vertex cache ordering
+// here (options.optimizeVertexCache is ignored).
 template <typename TDestVertex, typename E, typename V, typename F, typename TConverter>
-TriangularMesh<TDestVertex> buildTriangularMesh(const Mesh<E, V, F>& mesh, TConverter converter)
+TriangularMesh<TDestVertex> buildTriangularMesh(const Mesh<E, V, F>& mesh, TConverter converter, TriangularMeshOptions options = {})
 {
+    using Face = typename Mesh<E, V, F>::Face;
+
     TriangularMesh<TDestVertex> triMesh;
-    // Use the Edge pointer as a key to uniquely identify a "corner" (a vertex in the context of a specific face)
-    // This correctly duplicates vertices for per-face attributes (like color).
-    std::unordered_map<const typename Mesh<E, V, F>::Edge*, uint32_t> corner_map;
 
+    std::vector<const Face*> faces;
+    faces.reserve(mesh.numFaces());
     for (const auto& face : mesh.faces()) {
-        std::vector<const typename Mesh<E, V, F>::Edge*> face_edges;
-        for (const auto& edge : face.edges()) {
-            face_edges.push_back(&edge);
-        }
+        faces.push_back(&face);
+    }
 
-        if (face_edges.size() < 3) {
-            continue;
-        }
+    // corners and triangles of each face (none for faces with fewer than three
+    // corners), then summed into each face's first vertex and first triangle
+    std::vector<uint32_t> firstVertex(faces.size() + 1, 0);
+    std::vector<uint32_t> firstTriangle(faces.size() + 1, 0);
 
-        // --- Triangulate the face using a triangle fan ---
-        const auto* e0 = face_edges[0];
-        for (size_t i = 1; i < face_edges.size() - 1; ++i) {
-            const auto* e1 = face_edges[i];
-            const auto* e2 = face_edges[i+1];
-            
-            const typename Mesh<E, V, F>::Edge* corners[] = {e0, e1, e2};
-            
-            // For each vertex of the new triangle
-            for (const auto* corner : corners) {
-                // If we haven't created a GPU vertex for this specific corner yet, create one.
-                if (corner_map.find(corner) == corner_map.end()) {
-                    corner_map[corner] = static_cast<uint32_t>(triMesh.vertices.size());
-                    // Call the provided converter to create the destination vertex
-                    triMesh.vertices.push_back(converter(corner->v1(), face));
-                }
-                // Add the index of this corner's vertex to our index buffer.
-                triMesh.indices.push_back(corner_map[corner]);
+    parallelRanges(faces.size(), options.threads, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; f++) {
+            uint32_t corners = 0;
+            for ([[maybe_unused]] const auto& edge : faces[f]->edges()) {
+                corners++;
+            }
+            if (corners >= 3) {
+                firstVertex[f + 1] = corners;
+                firstTriangle[f + 1] = corners - 2;
             }
         }
+    });
+
+    for (size_t f = 0; f < faces.size(); f++) {
+        firstVertex[f + 1] += firstVertex[f];
+        firstTriangle[f + 1] += firstTriangle[f];
     }
 
+    triMesh.vertices.resize(firstVertex.back());
+    triMesh.indices.resize(firstTriangle.back() * 3);
+
+    parallelRanges(faces.size(), options.threads, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; f++) {
+            uint32_t base = firstVertex[f];
+            uint32_t count = firstVertex[f + 1] - base;
+            if (count == 0) {
+                continue;
+            }
+
+            uint32_t v = base;
+            for (const auto& edge : faces[f]->edges()) {
+                // Call the provided converter to create the destination vertex
+                triMesh.vertices[v++] = converter(edge.v1(), *faces[f]);
+            }
+
+            // --- Triangulate the face using a triangle fan ---
+            uint32_t* out = &triMesh.indices[firstTriangle[f] * 3];
+            for (uint32_t i = 1; i + 1 < count; i++) {
+                *out++ = base;
+                *out++ = base + i;
+                *out++ = base + i + 1;
+            }
+        }
+    });
+
     return triMesh;
 }
 
@@ -84,51 +154,81 @@ namespace std {
 
 // This loads an OBJ file directly into a GPU-friendly TriangularMesh,
 // bypassing the half-edge structure. It is robust for non-manifold meshes.
+// The file is read through MeshCache, so after the first load it comes from
+// the binary cache next to it instead of being parsed again.
 template <typename TDestVertex, typename TVertexConverter>
-TriangularMesh<TDestVertex> loadTriangularMesh(const std::string& filename, TVertexConverter converter)
+TriangularMesh<TDestVertex> loadTriangularMesh(const std::string& filename, TVertexConverter converter, TriangularMeshOptions options = {})
 {
     TriangularMesh<TDestVertex> triMesh;
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
 
-    std::string warn, err;
-    std::string folder = filename.substr(0, filename.find_last_of("/\\") + 1);
+    MeshCache cache(filename); // throws if the file can't be read or parsed
 
-    // Always triangulate when loading directly for rendering
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename.c_str(), folder.c_str(), true)) {
-        throw std::runtime_error(warn + err);
-    }
+    size_t vertexCount = cache.vertexCount();
 
-    std::unordered_map<tinyobj::index_t, uint32_t> unique_vertices;
-
-    for (const auto& shape : shapes) {
-        size_t index_offset = 0;
-        for (size_t face_num = 0; face_num < shape.mesh.num_face_vertices.size(); ++face_num) {
-            // Since we triangulated, we know fv is 3
-            size_t fv = 3;
-            
-            for (size_t v_num = 0; v_num < fv; ++v_num) {
-                tinyobj::index_t idx = shape.mesh.indices[index_offset + v_num];
-
-                if (unique_vertices.find(idx) == unique_vertices.end()) {
-                    unique_vertices[idx] = static_cast<uint32_t>(triMesh.vertices.size());
-                    
-                    int material_id = shape.mesh.material_ids[face_num];
-                    std::optional<const tinyobj::material_t*> mat = std::nullopt;
-                    if (material_id >= 0 && material_id < materials.size()) {
-                        mat = &materials[material_id];
-                    }
-                    
-                    // Call the user-provided converter to create the vertex
-                    triMesh.vertices.push_back(converter(attrib, idx, mat));
+    // the converter looks attributes up in an attrib_t, so present the cached
+    // vertices as one: vertex i has position, color, normal and texcoord i
+    tinyobj::attrib_t attrib;
+    attrib.vertices.resize(vertexCount * 3);
+    attrib.colors.resize(vertexCount * 3);
+    attrib.normals.resize(vertexCount * 3);
+    attrib.texcoords.resize(vertexCount * 2);
+
+    parallelRanges(vertexCount, options.threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            auto p = cache.positions()[i];
+            auto c = cache.colors()[i];
+            auto n = cache.normals()[i];
+            auto t = cache.texcoords()[i];
+            std::copy_n(&p.x, 3, &attrib.vertices[i * 3]);
+            std::copy_n(&c.x, 3, &attrib.colors[i * 3]);
+            std::copy_n(&n.x, 3, &attrib.normals[i * 3]);
+            std::copy_n(&t.x, 2, &attrib.texcoords[i * 2]);
+        }
+    });
+
+    // vertices are numbered in order of first use, so walking the faces meets
+    // each one for the first time with the material it was created under
+    std::vector<int32_t> vertexMaterials(vertexCount, -1);
+    {
+        auto faceStarts = cache.faceStarts();
+        auto corners = cache.corners();
+
+        uint32_t next = 0;
+        for (size_t f = 0; f + 1 < faceStarts.size() && next < vertexCount; f++) {
+            for (uint32_t c = faceStarts[f]; c < faceStarts[f + 1]; c++) {
+                if (corners[c] == next) {
+                    vertexMaterials[next++] = cache.faceMaterials()[f];
                 }
-                triMesh.indices.push_back(unique_vertices[idx]);
             }
-            index_offset += fv;
         }
     }
 
+    triMesh.vertices.resize(vertexCount);
+
+    parallelRanges(vertexCount, options.threads, [&](size_t begin, size_t end) {
+        auto attributes = cache.attributes();
+        for (size_t i = begin; i < end; i++) {
+            std::optional<const tinyobj::material_t*> mat = std::nullopt;
+            if (auto m = cache.material(vertexMaterials[i])) {
+                mat = m;
+            }
+
+            tinyobj::index_t idx;
+            idx.vertex_index = static_cast<int>(i);
+            idx.normal_index = (attributes[i] & MeshCache::hasNormal) ? static_cast<int>(i) : -1;
+            idx.texcoord_index = (attributes[i] & MeshCache::hasTexcoord) ? static_cast<int>(i) : -1;
+
+            // Call the user-provided converter to create the vertex
+            triMesh.vertices[i] = converter(attrib, idx, mat);
+        }
+    });
+
+    triMesh.indices.assign(cache.triangles().begin(), cache.triangles().end());
+
+    if (options.optimizeVertexCache) {
+        optimizeVertexCache(triMesh);
+    }
+
     return triMesh;
 }
 
@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "vertexcache.h"
+
+namespace {
+
+constexpr uint32_t noTriangle = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t noVertex = std::numeric_limits<uint32_t>::max();
+
+// modelled cache size and scoring constants from Forsyth's article
+constexpr size_t modelCacheSize = 32;
+constexpr float  cacheDecayPower = 1.5f;
+constexpr float  lastTriangleScore = 0.75f;
+constexpr float  valenceBoostScale = 2.0f;
+constexpr float  valenceBoostPower = 0.5f;
+constexpr size_t valenceTableSize = 32;
+
+class ScoreTables {
+public:
+    std::array<float, modelCacheSize> cachePosition;
+    std::array<float, valenceTableSize> valence;
+public:
+    ScoreTables() {
+        for (size_t i = 0; i < modelCacheSize; i++) {
+            if (i < 3) {
+                // the three vertices of the last triangle get a fixed score, so the next
+                // triangle doesn't just strip along from the one before
+                cachePosition[i] = lastTriangleScore;
+            }
+            else {
+                float scaler = 1.0f / (modelCacheSize - 3);
+                cachePosition[i] = std::pow(1.0f - (i - 3) * scaler, cacheDecayPower);
+            }
+        }
+        for (size_t i = 0; i < valenceTableSize; i++) {
+            valence[i] = i == 0 ? 0 : valenceBoostScale * std::pow(static_cast<float>(i), -valenceBoostPower);
+        }
+    }
+
+    // how much a vertex wants its triangles drawn next: being in the cache, and having
+    // few triangles left (so lone vertices get finished off rather than left behind)
+    float score(int position, uint32_t remaining) const {
+        if (remaining == 0) {
+            return -1;
+        }
+        float s = position >= 0 ? cachePosition[position] : 0;
+        if (remaining < valenceTableSize) {
+            return s + valence[remaining];
+        }
+        return s + valenceBoostScale * std::pow(static_cast<float>(remaining), -valenceBoostPower);
+    }
+};
+
+} // namespace
+
+void optimizeTriangleOrder(std::span<uint32_t> indices, size_t vertexCount)
+{
+    static const ScoreTables tables;
+
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) {
+        return;
+    }
+
+    // triangles using each vertex: the not yet drawn ones are kept at the front of each
+    // vertex's slice, remaining[v] of them
+    std::vector<uint32_t> firstTriangle(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+        firstTriangle[indices[i] + 1]++;
+    }
+    for (size_t v = 0; v < vertexCount; v++) {
+        firstTriangle[v + 1] += firstTriangle[v];
+    }
+
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    std::vector<uint32_t> vertexTriangles(triangleCount * 3);
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (int c = 0; c < 3; c++) {
+            uint32_t v = indices[t * 3 + c];
+            vertexTriangles[firstTriangle[v] + remaining[v]++] = static_cast<uint32_t>(t);
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        vertexScore[v] = tables.score(-1, remaining[v]);
+    }
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<uint8_t> drawn(triangleCount, 0);
+    uint32_t best = noTriangle;
+    float bestScore = -1;
+    for (size_t t = 0; t < triangleCount; t++) {
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+        if (triangleScore[t] > bestScore) {
+            bestScore = triangleScore[t];
+            best = static_cast<uint32_t>(t);
+        }
+    }
+
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+
+    // the cache after drawing a triangle: its three vertices, then what was there before
+    std::array<uint32_t, modelCacheSize + 3> cache;
+    std::array<uint32_t, modelCacheSize + 3> newCache;
+    size_t cacheCount = 0;
+
+    size_t nextUndrawn = 0;
+
+    for (size_t drawnCount = 0; drawnCount < triangleCount; drawnCount++) {
+        if (best == noTriangle) {
+            // nothing in the cache has triangles left: carry on from the next undrawn one
+            // (scanning for the best would make this quadratic)
+            while (drawn[nextUndrawn]) {
+                nextUndrawn++;
+            }
+            best = static_cast<uint32_t>(nextUndrawn);
+        }
+
+        const uint32_t* tri = &indices[best * 3];
+        output.insert(output.end(), tri, tri + 3);
+        drawn[best] = 1;
+
+        size_t newCount = 0;
+        for (int c = 0; c < 3; c++) {
+            uint32_t v = tri[c];
+            if (std::find(newCache.begin(), newCache.begin() + newCount, v) == newCache.begin() + newCount) {
+                newCache[newCount++] = v; // once, even for a degenerate triangle
+            }
+
+            // move best out of v's undrawn triangles
+            uint32_t* first = &vertexTriangles[firstTriangle[v]];
+            uint32_t* last = first + remaining[v] - 1;
+            std::iter_swap(std::find(first, last + 1, best), last);
+            remaining[v]--;
+        }
+        for (size_t i = 0; i < cacheCount; i++) {
+            uint32_t v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2]) {
+                newCache[newCount++] = v;
+            }
+        }
+
+        // rescore the vertices whose cache position changed (including the ones that just
+        // fell out), and pass the change on to their undrawn triangles
+        for (size_t i = 0; i < newCount; i++) {
+            uint32_t v = newCache[i];
+            int position = i < modelCacheSize ? static_cast<int>(i) : -1;
+            cachePosition[v] = position;
+            float score = tables.score(position, remaining[v]);
+            float delta = score - vertexScore[v];
+            vertexScore[v] = score;
+            for (uint32_t j = 0; j < remaining[v]; j++) {
+                triangleScore[vertexTriangles[firstTriangle[v] + j]] += delta;
+            }
+        }
+
+        cacheCount = std::min(newCount, modelCacheSize);
+        std::copy(newCache.begin(), newCache.begin() + cacheCount, cache.begin());
+
+        // the next triangle is the best one touching the cache
+        best = noTriangle;
+        bestScore = -1;
+        for (size_t i = 0; i < cacheCount; i++) {
+            uint32_t v = cache[i];
+            for (uint32_t j = 0; j < remaining[v]; j++) {
+                uint32_t t = vertexTriangles[firstTriangle[v] + j];
+                if (triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        }
+    }
+
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+std::vector<uint32_t> optimizeVertexOrder(std::span<uint32_t> indices, size_t vertexCount)
+{
+    std::vector<uint32_t> newNumber(vertexCount, noVertex);
+    std::vector<uint32_t> order;
+    order.reserve(vertexCount);
+
+    for (auto& i : indices) {
+        if (newNumber[i] == noVertex) {
+            newNumber[i] = static_cast<uint32_t>(order.size());
+            order.push_back(i);
+        }
+        i = newNumber[i];
+    }
+
+    for (size_t v = 0; v < vertexCount; v++) {
+        if (newNumber[v] == noVertex) {
+            order.push_back(static_cast<uint32_t>(v));
+        }
+    }
+
+    return order;
+}
+
+double averageCacheMissRatio(std::span<const uint32_t> indices, size_t vertexCount, size_t cacheSize)
+{
+    if (indices.size() < 3) {
+        return 0;
+    }
+
+    // a vertex is still in the FIFO if fewer than cacheSize misses happened since it went in
+    std::vector<size_t> insertedAt(vertexCount, 0);
+    size_t misses = 0;
+
+    for (auto i : indices) {
+        if (insertedAt[i] == 0 || misses - insertedAt[i] >= cacheSize) {
+            misses++;
+            insertedAt[i] = misses;
+        }
+    }
+
+    return static_cast<double>(misses) / (indices.size() / 3);
+}
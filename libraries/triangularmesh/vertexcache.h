@@ -0,0 +1,28 @@
+#ifndef VERTEXCACHE_H
+#define VERTEXCACHE_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Index buffer reordering for the GPU's post-transform vertex cache.  A vertex
+// shared by nearby triangles is only transformed once if it's still in the
+// cache, so drawing triangles in a cache friendly order (and storing vertices
+// in the order they're first used) cuts vertex shader work and memory traffic.
+
+// Reorder the triangles (three indices each) so consecutive triangles reuse
+// recently used vertices.  Uses Tom Forsyth's "Linear-Speed Vertex Cache
+// Optimisation", which does well on any cache size.  Every index must be less
+// than vertexCount.  Triangle winding is unchanged.
+void optimizeTriangleOrder(std::span<uint32_t> indices, size_t vertexCount);
+
+// Renumber the vertices in the order the indices first use them and rewrite
+// the indices to match.  Returns the old number of each new vertex (vertices
+// no index uses go last).
+std::vector<uint32_t> optimizeVertexOrder(std::span<uint32_t> indices, size_t vertexCount);
+
+// Average number of vertices transformed per triangle by a FIFO vertex cache
+// of cacheSize entries (between 0.5 and 3; lower is better).
+double averageCacheMissRatio(std::span<const uint32_t> indices, size_t vertexCount, size_t cacheSize = 16);
+
+#endif // VERTEXCACHE_H
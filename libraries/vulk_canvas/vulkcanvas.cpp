@@ -6,6 +6,8 @@
 #include "paths.h"
 #include "polypartition.h"
 #include "vfontrenderer.h"
+#include <algorithm>
+#include <cmath>
 #include <vector>
 #include "vertexattrvulk.h"
 
@@ -572,6 +574,28 @@ void VulkCanvas::drawMesh(const StaticMesh& mesh, const mat4x4& modelMatrix)
     }
 }
 
+void VulkCanvas::drawMesh(const StaticMeshLod& mesh, const mat4x4& modelMatrix)
+{
+    // the model matrix is column major: columns 0-2 are the axes, 3 the translation
+    Vec3d center{
+        modelMatrix[0][0] * mesh.center.x + modelMatrix[1][0] * mesh.center.y + modelMatrix[2][0] * mesh.center.z + modelMatrix[3][0],
+        modelMatrix[0][1] * mesh.center.x + modelMatrix[1][1] * mesh.center.y + modelMatrix[2][1] * mesh.center.z + modelMatrix[3][1],
+        modelMatrix[0][2] * mesh.center.x + modelMatrix[1][2] * mesh.center.y + modelMatrix[2][2] * mesh.center.z + modelMatrix[3][2]
+    };
+
+    double scale = 0;
+    for (int i = 0; i < 3; i++) {
+        Vec3d axis{modelMatrix[i][0], modelMatrix[i][1], modelMatrix[i][2]};
+        scale = std::max(scale, axis.magnitude());
+    }
+
+    // size on screen of one model unit at the nearest point of the bounding sphere
+    double distance = std::max((center - cameraParams.camera).magnitude() - mesh.radius * scale, cameraParams.near);
+    double pixelsPerUnit = scale * height() / (2 * std::tan(cameraParams.fov / 2) * distance);
+
+    drawMesh(mesh.select(pixelsPerUnit), modelMatrix);
+}
+
 void VulkCanvas::polygon3d(const std::vector<Vec3d> &points, mssm::Color border, mssm::Color fill)
 {
     if (points.size() != 3) {
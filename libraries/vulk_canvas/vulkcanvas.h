@@ -341,6 +341,7 @@ protected:
 	}
 
     void drawMesh(const StaticMesh& mesh, const mat4x4& modelMatrix) override;
+    void drawMesh(const StaticMeshLod& mesh, const mat4x4& modelMatrix) override;
 
     // Canvas2d interface
 public:
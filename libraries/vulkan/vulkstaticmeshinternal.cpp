@@ -29,3 +29,43 @@ VulkStaticMeshInternal::VulkStaticMeshInternal(VulkDevice& device, VulkCommandPo
         commandBuffer.copyBuffer(indexStagingBuffer, this->indexBuffer, sizeof(uint32_t) * triMesh.indices.size());
     });
 }
+
+VulkStaticMeshInternal::VulkStaticMeshInternal(VulkDevice& device, VulkCommandPool& commandPool, const MeshCache& cache)
+{
+    auto positions = cache.positions();
+    auto normals = cache.normals();
+    auto texcoords = cache.texcoords();
+    auto colors = cache.colors();
+    auto indices = cache.triangles();
+
+    size_t vertexCount = positions.size();
+
+    this->indexCount = static_cast<uint32_t>(indices.size());
+
+    // Create staging buffer for vertices and fill it in place
+    VulkBuffer<Vertex3dUV> vertexStagingBuffer(device, vertexCount, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    auto vertices = vertexStagingBuffer.mappedSpan();
+    for (size_t i = 0; i < vertexCount; i++) {
+        Vertex3dUV& v = vertices[i];
+        v.pos = positions[i];
+        v.normal = normals[i];
+        v.uv = { texcoords[i].x, 1 - texcoords[i].y }; // OBJ format has 0,0 at bottom-left, so flip y
+        v.color = { colors[i].x, colors[i].y, colors[i].z, 1.0f };
+    }
+
+    // Create device-local vertex buffer
+    this->vertexBuffer.initialize(device, vertexCount, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    // Create staging buffer for indices
+    VulkBuffer<uint32_t> indexStagingBuffer(device, indices.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    indexStagingBuffer.copyFrom(indices);
+
+    // Create device-local index buffer
+    this->indexBuffer.initialize(device, indices.size(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    // Copy from staging to device-local buffers
+    VulkCommandBuffer::oneTimeCommmand(commandPool, [&](VulkDevice& device, VulkCommandBuffer& commandBuffer) {
+        commandBuffer.copyBuffer(vertexStagingBuffer, this->vertexBuffer, sizeof(Vertex3dUV) * vertexCount);
+        commandBuffer.copyBuffer(indexStagingBuffer, this->indexBuffer, sizeof(uint32_t) * indices.size());
+    });
+}
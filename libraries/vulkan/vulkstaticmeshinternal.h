@@ -7,6 +7,7 @@
 #include "mesh.h"
 #include "vulkcommandbuffers.h"
 #include "triangularmesh.h"
+#include "meshcache.h"
 
 // Forward declarations
 namespace mssm {
@@ -17,6 +18,8 @@ class VulkCanvas;
 class VulkStaticMeshInternal : public StaticMeshInternal {
 public:
     VulkStaticMeshInternal(VulkDevice& device, VulkCommandPool& commandPool, const TriangularMesh<Vertex3dUV>& mesh);
+    // vertices are written straight into the staging buffer, and indices copied from the (usually mapped) cache
+    VulkStaticMeshInternal(VulkDevice& device, VulkCommandPool& commandPool, const MeshCache& cache);
 
     const VulkBuffer<Vertex3dUV>& getVertexBuffer() const { return vertexBuffer; }
     const VulkBuffer<uint32_t>& getIndexBuffer() const { return indexBuffer; }
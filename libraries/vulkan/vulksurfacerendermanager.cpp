@@ -512,6 +512,12 @@ void VulkSurfaceRenderManager::queueForDestruction(std::shared_ptr<StaticMeshInt
 }
 std::shared_ptr<StaticMeshInternal> VulkSurfaceRenderManager::loadMesh(const std::string& filepath)
 {
-    // TODO: implement loading from .obj file
-    return nullptr;
+    // after the first run this maps the binary cache written next to the .obj
+    MeshCache cache(filepath);
+
+    if (cache.triangles().empty()) {
+        throw std::runtime_error("No triangles in " + filepath);
+    }
+
+    return std::make_shared<VulkStaticMeshInternal>(*device, *graphicsCommandPool, cache);
 }